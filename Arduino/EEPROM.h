@@ -0,0 +1,31 @@
+/*
+ Byte access to the avr eeprom with the same interface as the arduino EEPROM
+ library (read, update and length only).
+*/
+
+#ifndef EEPROM_h
+#define EEPROM_h
+
+#include <inttypes.h>
+#ifndef UNIT_TEST
+#include <avr/eeprom.h>
+#include <avr/io.h>
+
+struct EEPROMClass
+{
+    uint8_t read(int idx)               { return eeprom_read_byte((uint8_t*)idx); }
+    // only writes if the value differs - saves wear
+    void update(int idx, uint8_t val)   { eeprom_update_byte((uint8_t*)idx, val); }
+    uint16_t length()                   { return E2END + 1; }
+};
+#else  // prototypes used in unit tests only. Host builds supply the storage.
+struct EEPROMClass
+{
+    uint8_t read(int idx);
+    void update(int idx, uint8_t val);
+    uint16_t length();
+};
+#endif  // UNIT_TEST
+
+static EEPROMClass EEPROM;
+#endif  // include guard
@@ -1,54 +1,148 @@
 #include <Config.h>
 
-static uint16_t settleTime;
-static uint16_t trackDelay;
-static uint16_t sampleTime;
-static uint16_t thresholdCurrent;
+void Config_InitParams(Config_t *const config)
+{
+    config->settleTime = SETTLE_TIME;
+    config->trackDelay = TRACK_DELAY_TIME;
+    config->sampleTime = SAMPLING_TIME;
+    config->thresholdCurrent = THRESHOLD_CURRENT;
+    config->reuseLimit = REUSE_LIMIT;
+    config->minStep = DV_MPPT_MIN;
+    config->maxStep = DV_MPPT_MAX;
+    config->trackingAlgorithms = TRACKING_ALGORITHMS;
+    config->scanStrategy = SCAN_STRATEGY;
+    config->scanStopMargin = SCAN_STOP_MARGIN;
+    config->lightChangeThreshold = LIGHT_CHANGE_THRESHOLD;
+    config->sampleTolerance = SAMPLE_TOLERANCE;
+    config->dwellDrift = DWELL_DRIFT;
+}
+
+void Config_SetSettleTime(Config_t *const config, uint16_t tSettle)
+{
+    config->settleTime = tSettle;
+}
+
+void Config_SetTrackDelay(Config_t *const config, uint16_t tDelay)
+{
+    config->trackDelay = tDelay;
+}
+
+void Config_SetSampleTime(Config_t *const config, uint16_t tSample)
+{
+    config->sampleTime = tSample;
+}
+
+void Config_SetThresholdCurrent(Config_t *const config, uint16_t iThreshold)
+{
+    config->thresholdCurrent = iThreshold;
+}
+
+void Config_SetReuseLimit(Config_t *const config, uint8_t nReuse)
+{
+    config->reuseLimit = nReuse;
+}
+
+void Config_SetMinStep(Config_t *const config, uint8_t dvMin)
+{
+    config->minStep = dvMin;
+}
+
+void Config_SetMaxStep(Config_t *const config, uint8_t dvMax)
+{
+    config->maxStep = dvMax;
+}
+
+void Config_SetTrackingAlgorithms(Config_t *const config, uint8_t algorithms)
+{
+    config->trackingAlgorithms = algorithms;
+}
+
+void Config_SetScanStrategy(Config_t *const config, uint8_t strategy)
+{
+    config->scanStrategy = strategy;
+}
+
+void Config_SetScanStopMargin(Config_t *const config, uint8_t nPoints)
+{
+    config->scanStopMargin = nPoints;
+}
+
+void Config_SetLightChangeThreshold(Config_t *const config, uint8_t threshold)
+{
+    config->lightChangeThreshold = threshold;
+}
+
+void Config_SetSampleTolerance(Config_t *const config, uint8_t tolerance)
+{
+    config->sampleTolerance = tolerance;
+}
+
+void Config_SetDwellDrift(Config_t *const config, uint8_t drift)
+{
+    config->dwellDrift = drift;
+}
+
+uint16_t Config_GetSettleTime(Config_t const *const config)
+{
+    return config->settleTime;
+}
+
+uint16_t Config_GetTrackDelay(Config_t const *const config)
+{
+    return config->trackDelay;
+}
+
+uint16_t Config_GetSampleTime(Config_t const *const config)
+{
+    return config->sampleTime;
+}
+
+uint16_t Config_GetThresholdCurrent(Config_t const *const config)
+{
+    return config->thresholdCurrent;
+}
 
-void Config_InitParams(void)
+uint8_t Config_GetReuseLimit(Config_t const *const config)
 {
-    settleTime = SETTLE_TIME;
-    trackDelay = TRACK_DELAY_TIME;
-    sampleTime = SAMPLING_TIME;
-    thresholdCurrent = THRESHOLD_CURRENT;
+    return config->reuseLimit;
 }
 
-void Config_SetSettleTime(uint16_t tSettle)
+uint8_t Config_GetMinStep(Config_t const *const config)
 {
-    settleTime = tSettle;
+    return config->minStep;
 }
 
-void Config_SetTrackDelay(uint16_t tDelay)
+uint8_t Config_GetMaxStep(Config_t const *const config)
 {
-    trackDelay = tDelay;
+    return config->maxStep;
 }
 
-void Config_SetSampleTime(uint16_t tSample)
+uint8_t Config_GetTrackingAlgorithms(Config_t const *const config)
 {
-    sampleTime = tSample;
+    return config->trackingAlgorithms;
 }
 
-void Config_SetThresholdCurrent(uint16_t iThreshold)
+uint8_t Config_GetScanStrategy(Config_t const *const config)
 {
-    thresholdCurrent = iThreshold;
+    return config->scanStrategy;
 }
 
-uint16_t Config_GetSettleTime(void)
+uint8_t Config_GetScanStopMargin(Config_t const *const config)
 {
-    return settleTime;
+    return config->scanStopMargin;
 }
 
-uint16_t Config_GetTrackDelay(void)
+uint8_t Config_GetLightChangeThreshold(Config_t const *const config)
 {
-    return trackDelay;
+    return config->lightChangeThreshold;
 }
 
-uint16_t Config_GetSampleTime(void)
+uint8_t Config_GetSampleTolerance(Config_t const *const config)
 {
-    return sampleTime;
+    return config->sampleTolerance;
 }
 
-uint16_t Config_GetThresholdCurrent(void)
+uint8_t Config_GetDwellDrift(Config_t const *const config)
 {
-    return thresholdCurrent;
+    return config->dwellDrift;
 }
\ No newline at end of file
@@ -15,8 +15,18 @@ extern "C" {
 #define TEMP_CS_PIN           (8U)
 #define LIGHT_SENSOR_PIN      (0U)
 
-#define CS_DELAY              (1U)   // delay between CS edge and spi transfer in ms
-#define CS_DELAY_ADC          (20U)  // ADC is particularly slow
+/* Largest channel table (see LifeTester.cpp). Each channel is a dac channel and
+an adc input on devices with their own chip select pins. The tracking algorithm
+parameter has a bit per channel so a board can't have more than eight.*/
+#define CHANNEL_TABLE_MAX     (8U)
+
+/* Chip select setup (CS edge to first clock) and hold (last clock to CS edge)
+times in us. The datasheet minimums for all three devices are well below 1us
+which is the smallest step delayMicroseconds can make.*/
+#define CS_SETUP_US           (1U)
+#define CS_HOLD_US            (1U)
+#define CS_SETUP_ADC_US       (1U)
+#define CS_HOLD_ADC_US        (1U)
 
 //Measurement settings//
 /*
@@ -27,11 +37,106 @@ extern "C" {
 #define V_SCAN_MIN            (0U)
 #define V_SCAN_MAX            (100U)
 #define DV_SCAN               (1U)   //step size in MPP scan
-#define DV_MPPT               (1U)
+/*
+ How the initial scan looks for the mpp. Linear measures every point from
+ V_SCAN_MIN to V_SCAN_MAX. Golden-section measures both ends then narrows a
+ bracket around the mpp, taking ~12 points instead of ~100.
+*/
+#define SCAN_LINEAR           (0U)
+#define SCAN_GOLDEN_SECTION   (1U)
+#define SCAN_LOCAL            (2U)   // internal - warm start check or re-scan around vThis
+#define SCAN_STRATEGY         (SCAN_LINEAR)
+/*
+ A linear scan stops once this many points in a row have current below
+ MIN_CURRENT, ie. the device is past open circuit. SCAN_NO_EARLY_STOP always
+ scans to V_SCAN_MAX.
+*/
+#define SCAN_STOP_MARGIN      (3U)
+#define SCAN_NO_EARLY_STOP    (0xFFU)
+/*
+ Warm start after a reset. The stored mpp is checked by measuring it and the
+ points WARM_START_SPAN either side. If the power at the stored mpp is within
+ WARM_START_TOLERANCE/256 of the stored power the device and light are as they
+ were, so tracking starts from the best of the three even if the mpp has moved
+ past one of the others. Otherwise, unless the stored mpp is the highest of the
+ three, the light change re-scan runs around the best point. The full scan only
+ runs if none of them had any power. While tracking the mpp is stored every
+ MPP_SAVE_CYCLES cycles (~10 minutes) so the eeprom outlasts the test.
+*/
+#define WARM_START_SPAN       (4U)
+#define WARM_START_TOLERANCE  (26U)
+#define MPP_SAVE_CYCLES       (600U)
+/*
+ Re-scan after a sudden change in light. Each tracking cycle the light sensor is
+ compared with its running average over ~2^LIGHT_FILTER_SHIFT cycles. A change
+ of more than LIGHT_CHANGE_THRESHOLD/256 of the average scans every
+ LIGHT_RESCAN_STEP codes up to LIGHT_RESCAN_SPAN either side of the mpp and
+ tracking restarts from the best point. LIGHT_CHANGE_OFF disables the check.
+ ~64 (25%) catches lamp steps and passing shade.
+*/
+#define LIGHT_CHANGE_OFF      (0U)
+#define LIGHT_CHANGE_THRESHOLD (LIGHT_CHANGE_OFF)
+#define LIGHT_FILTER_SHIFT    (3U)
+#define LIGHT_RESCAN_SPAN     (6U)
+#define LIGHT_RESCAN_STEP     (2U)
+#define DV_MPPT               (1U)   //offset of the next point from this point
+/*
+ Limits of the step this point moves by on each tracking cycle. Steps scale with
+ the normalised slope of the power curve |dP/dV|/(P/V) which is ~1 far from the
+ mpp and 0 at it. They can at most double in the same direction and at least
+ halve on a reversal. If the light moved by more than DV_LIGHT_TOLERANCE/256
+ since the last cycle the slope is down to the light rather than the curve, so
+ the minimum step is taken. Setting both to DV_MPPT gives fixed step
+ perturb-observe.
+*/
+#define DV_MPPT_MIN           (1U)
+#define DV_MPPT_MAX           (1U)
+#define DV_LIGHT_TOLERANCE    (4U)
+/*
+ Tracking algorithm for each channel. Bit n selects the algorithm for adc
+ channel n: 0 = perturb-observe, 1 = incremental conductance.
+*/
+#define TRACKING_ALGORITHMS   (0U)
+#define PERTURB_OBSERVE       (0U)
+#define INC_CONDUCTANCE       (1U)
+/*
+ Incremental conductance holds at the mpp when |dI/dV + I/V| is within this
+ fraction of I/V (in 256ths).
+*/
+#define INC_COND_TOLERANCE    (64U)
+/*
+ Dwell at the mpp. Perturb-observe ends up cycling between neighbouring codes
+ at the mpp. Once this point has stayed within DWELL_DETECT_SPAN codes for
+ DWELL_DETECT_CYCLES cycles the tracker sits at the best code measured. Only
+ that point is measured, with the next point checked every DWELL_PERTURB_CYCLES
+ cycles. Tracking resumes when the next point has more power or the power
+ drifts by more than DWELL_DRIFT/256 of its value when dwelling started.
+ DWELL_DRIFT_OFF never dwells.
+*/
+#define DWELL_DRIFT_OFF       (0U)
+#define DWELL_DRIFT           (DWELL_DRIFT_OFF)
+#define DWELL_DETECT_SPAN     (2U)
+#define DWELL_DETECT_CYCLES   (8U)
+#define DWELL_PERTURB_CYCLES  (8U)
 // ddefault timings set at start up
 #define SETTLE_TIME           (200U) //settle time after setting DAC to ADC measurement
 #define SAMPLING_TIME         (200U) //time interval over which ADC measurements are made continuously then averaged afterward
 #define TRACK_DELAY_TIME      (200U) //time period between tracking measurements
+/*
+ Adaptive sampling. The sampling window ends early once the standard error of
+ the mean current is within this many adc codes, after at least
+ SAMPLE_MIN_COUNT samples. The sample time is then the longest a point can take.
+ SAMPLE_TOLERANCE_OFF always samples for the whole window.
+*/
+#define SAMPLE_TOLERANCE_OFF  (0U)
+#define SAMPLE_TOLERANCE      (SAMPLE_TOLERANCE_OFF)
+#define SAMPLE_MIN_COUNT      (4U)
+/*
+ Cycles in a row that may reuse the next point's measurement as this point after
+ moving uphill. 0 always measures both points, REUSE_UNLIMITED always reuses.
+*/
+#define REUSE_LIMIT           (0U)
+#define REUSE_UNLIMITED       (0xFFU)
 
 // error handling
 #define MAX_ERROR_READS       (20U)  //number of allowed bad readings before error state
@@ -47,15 +152,60 @@ extern "C" {
 #define INIT_LED_ON_TIME      (100U)
 #define INIT_LED_OFF_TIME     (100U)
 
-void Config_InitParams(void);
-void Config_SetSettleTime(uint16_t tSettle);
-void Config_SetTrackDelay(uint16_t tDelay);
-void Config_SetSampleTime(uint16_t tSample);
-void Config_SetThresholdCurrent(uint16_t iThreshold);
-uint16_t Config_GetSettleTime(void);
-uint16_t Config_GetTrackDelay(void);
-uint16_t Config_GetSampleTime(void);
-uint16_t Config_GetThresholdCurrent(void);
+/*
+ Longest the main loop sleeps while every channel is waiting on a timer. Keeps
+ commands from the i2c master from waiting long to be picked up.
+*/
+#define LOOP_IDLE_MAX_TIME    (5U)
+
+/*
+ Run-time measurement settings. Defaults come from the defines above via
+ Config_InitParams and the master can change them over I2C. Each life tester
+ points at the config it runs with.
+*/
+typedef struct Config_s {
+    uint16_t settleTime;
+    uint16_t trackDelay;
+    uint16_t sampleTime;
+    uint16_t thresholdCurrent;
+    uint8_t  reuseLimit;
+    uint8_t  minStep;
+    uint8_t  maxStep;
+    uint8_t  trackingAlgorithms;
+    uint8_t  scanStrategy;
+    uint8_t  scanStopMargin;
+    uint8_t  lightChangeThreshold;
+    uint8_t  sampleTolerance;
+    uint8_t  dwellDrift;
+} Config_t;
+
+void Config_InitParams(Config_t *const config);
+void Config_SetSettleTime(Config_t *const config, uint16_t tSettle);
+void Config_SetTrackDelay(Config_t *const config, uint16_t tDelay);
+void Config_SetSampleTime(Config_t *const config, uint16_t tSample);
+void Config_SetThresholdCurrent(Config_t *const config, uint16_t iThreshold);
+void Config_SetReuseLimit(Config_t *const config, uint8_t nReuse);
+void Config_SetMinStep(Config_t *const config, uint8_t dvMin);
+void Config_SetMaxStep(Config_t *const config, uint8_t dvMax);
+void Config_SetTrackingAlgorithms(Config_t *const config, uint8_t algorithms);
+void Config_SetScanStrategy(Config_t *const config, uint8_t strategy);
+void Config_SetScanStopMargin(Config_t *const config, uint8_t nPoints);
+void Config_SetLightChangeThreshold(Config_t *const config, uint8_t threshold);
+void Config_SetSampleTolerance(Config_t *const config, uint8_t tolerance);
+void Config_SetDwellDrift(Config_t *const config, uint8_t drift);
+uint16_t Config_GetSettleTime(Config_t const *const config);
+uint16_t Config_GetTrackDelay(Config_t const *const config);
+uint16_t Config_GetSampleTime(Config_t const *const config);
+uint16_t Config_GetThresholdCurrent(Config_t const *const config);
+uint8_t Config_GetReuseLimit(Config_t const *const config);
+uint8_t Config_GetMinStep(Config_t const *const config);
+uint8_t Config_GetMaxStep(Config_t const *const config);
+uint8_t Config_GetTrackingAlgorithms(Config_t const *const config);
+uint8_t Config_GetScanStrategy(Config_t const *const config);
+uint8_t Config_GetScanStopMargin(Config_t const *const config);
+uint8_t Config_GetLightChangeThreshold(Config_t const *const config);
+uint8_t Config_GetSampleTolerance(Config_t const *const config);
+uint8_t Config_GetDwellDrift(Config_t const *const config);
 
 #endif
 #ifdef _cplusplus
@@ -0,0 +1,153 @@
+#include "Arduino.h"
+#include "IoStats.h"
+#include "Macros.h"
+#include <string.h> // memset
+
+/*
+ Finds the entry for the current context or adds one. When the table is full
+ the last entry collects everything that doesn't fit.
+*/
+static IoStatsEntry_t *GetActiveEntry(IoStats_t *const stats)
+{
+    if (stats->active != NULL)
+    {
+        return stats->active;
+    }
+    for (uint8_t i = 0U; i < stats->nEntries; i++)
+    {
+        IoStatsEntry_t *const entry = &stats->entries[i];
+        if ((entry->channel == stats->channel) && (entry->label == stats->label))
+        {
+            stats->active = entry;
+            return entry;
+        }
+    }
+    if (stats->nEntries < IO_STATS_MAX_ENTRIES)
+    {
+        IoStatsEntry_t *const entry = &stats->entries[stats->nEntries++];
+        entry->channel = stats->channel;
+        entry->label = stats->label;
+        memset(&entry->counters, 0U, sizeof(IoCounters_t));
+        stats->active = entry;
+        return entry;
+    }
+    return &stats->entries[IO_STATS_MAX_ENTRIES - 1U];
+}
+
+static void PrintEntry(IoStatsEntry_t const *const entry)
+{
+    SERIAL_PRINT("io, ", "%s");
+    SERIAL_PRINT(entry->channel, "%u");
+    SERIAL_PRINT(", ", "%s");
+    SERIAL_PRINT((entry->label != NULL) ? entry->label : "none", "%s");
+    SERIAL_PRINT(", ", "%s");
+    SERIAL_PRINT(entry->counters.spiBytes, "%u");
+    SERIAL_PRINT(", ", "%s");
+    SERIAL_PRINT(entry->counters.csToggles, "%u");
+    SERIAL_PRINT(", ", "%s");
+    SERIAL_PRINT(entry->counters.delayUs, "%u");
+    SERIAL_PRINT(", ", "%s");
+    SERIAL_PRINTLN(entry->counters.drdyPolls, "%u");
+}
+
+void IoStats_Reset(IoStats_t *const stats)
+{
+    if (stats == NULL)
+    {
+        return;
+    }
+    memset(stats->entries, 0U, sizeof(stats->entries));
+    stats->nEntries = 0U;
+    stats->active = NULL;
+    IoStats_ClearContext(stats);
+}
+
+void IoStats_SetContext(IoStats_t *const stats, uint8_t channel, const char *label)
+{
+    if (stats == NULL)
+    {
+        return;
+    }
+    if ((channel != stats->channel) || (label != stats->label))
+    {
+        stats->channel = channel;
+        stats->label = label;
+        stats->active = NULL;
+    }
+}
+
+void IoStats_ClearContext(IoStats_t *const stats)
+{
+    IoStats_SetContext(stats, IO_STATS_NO_CHANNEL, NULL);
+}
+
+void IoStats_AddSpiBytes(IoStats_t *const stats, uint8_t n)
+{
+    if (stats != NULL)
+    {
+        GetActiveEntry(stats)->counters.spiBytes += n;
+    }
+}
+
+void IoStats_AddCsToggle(IoStats_t *const stats)
+{
+    if (stats != NULL)
+    {
+        GetActiveEntry(stats)->counters.csToggles++;
+    }
+}
+
+void IoStats_AddDelay(IoStats_t *const stats, uint16_t us)
+{
+    if (stats != NULL)
+    {
+        GetActiveEntry(stats)->counters.delayUs += us;
+    }
+}
+
+void IoStats_AddDrdyPolls(IoStats_t *const stats, uint16_t n)
+{
+    if (stats != NULL)
+    {
+        GetActiveEntry(stats)->counters.drdyPolls += n;
+    }
+}
+
+uint8_t IoStats_GetNumEntries(IoStats_t const *const stats)
+{
+    return (stats != NULL) ? stats->nEntries : 0U;
+}
+
+IoStatsEntry_t const *IoStats_GetEntry(IoStats_t const *const stats, uint8_t idx)
+{
+    return (idx < IoStats_GetNumEntries(stats)) ? &stats->entries[idx] : NULL;
+}
+
+void IoStats_SetCycleReport(IoStats_t *const stats, bool enable)
+{
+    if (stats != NULL)
+    {
+        stats->cycleReport = enable;
+    }
+}
+
+void IoStats_CycleDone(IoStats_t *const stats, uint8_t channel)
+{
+    if ((stats == NULL) || !stats->cycleReport)
+    {
+        return;
+    }
+    SERIAL_PRINTLN("io, channel, state, spi bytes, cs toggles, delay us, drdy polls", "%s");
+    for (uint8_t i = 0U; i < stats->nEntries; i++)
+    {
+        IoStatsEntry_t *const entry = &stats->entries[i];
+        IoCounters_t const *const c = &entry->counters;
+        const bool idle = (c->spiBytes == 0U) && (c->csToggles == 0U)
+                          && (c->delayUs == 0U) && (c->drdyPolls == 0U);
+        if ((entry->channel == channel) && !idle)
+        {
+            PrintEntry(entry);
+            memset(&entry->counters, 0U, sizeof(IoCounters_t));
+        }
+    }
+}
@@ -0,0 +1,88 @@
+#ifndef IOSTATS_H
+#define IOSTATS_H
+
+#ifdef _cplusplus
+extern "C" {
+#endif
+
+/*
+ I/O cost accounting. Spi bytes, chip select toggles, blocking delays and adc
+ DRDY polls are counted against the channel and state label that was active
+ when the i/o happened. I/O outside of the state machine (temperature sensor)
+ is counted against IO_STATS_NO_CHANNEL with a NULL label. Devices only count
+ once the board hands them its stats after setting them up.
+
+ Counters wrap on target (16 bit) so read them as differences. On host builds
+ counters are 32 bit and a table can be printed at the end of each tracking
+ cycle of a channel.
+
+ Counters live in an IoStats_t that the board owns and hands to its channels
+ and devices. Every function takes the stats to update. A NULL pointer counts
+ nothing so that a device or channel can be left out.
+*/
+#include <stdint.h>
+#include <stdbool.h>
+
+#define IO_STATS_MAX_ENTRIES    (16U)    // channel/state pairs tracked
+#define IO_STATS_NO_CHANNEL     (0xFFU)
+
+#ifdef UNIT_TEST
+    typedef uint32_t IoCount_t;
+#else
+    typedef uint16_t IoCount_t;
+#endif
+
+typedef struct IoCounters_s {
+    IoCount_t spiBytes;   // bytes transferred over spi
+    IoCount_t csToggles;  // chip select edges
+    IoCount_t delayUs;    // time blocked in chip select delays
+    IoCount_t drdyPolls;  // reads of the adc comms register waiting for data
+} IoCounters_t;
+
+typedef struct IoStatsEntry_s {
+    uint8_t      channel;
+    const char   *label;
+    IoCounters_t counters;
+} IoStatsEntry_t;
+
+typedef struct IoStats_s {
+    IoStatsEntry_t entries[IO_STATS_MAX_ENTRIES];
+    uint8_t        nEntries;
+    IoStatsEntry_t *active;       // entry that i/o is counted against
+    uint8_t        channel;       // context for lazily creating the active entry
+    const char     *label;
+    bool           cycleReport;
+} IoStats_t;
+
+// Clears all entries and restores the context to no channel
+void IoStats_Reset(IoStats_t *const stats);
+
+// Subsequent i/o is counted against this channel and state label
+void IoStats_SetContext(IoStats_t *const stats, uint8_t channel, const char *label);
+
+// Subsequent i/o is counted against no channel
+void IoStats_ClearContext(IoStats_t *const stats);
+
+void IoStats_AddSpiBytes(IoStats_t *const stats, uint8_t n);
+void IoStats_AddCsToggle(IoStats_t *const stats);
+void IoStats_AddDelay(IoStats_t *const stats, uint16_t us);
+void IoStats_AddDrdyPolls(IoStats_t *const stats, uint16_t n);
+
+// Table access for reading counters
+uint8_t IoStats_GetNumEntries(IoStats_t const *const stats);
+IoStatsEntry_t const *IoStats_GetEntry(IoStats_t const *const stats, uint8_t idx);
+
+// Print a channel's counters when it finishes a tracking cycle
+void IoStats_SetCycleReport(IoStats_t *const stats, bool enable);
+
+/*
+ Marks the end of a tracking cycle for a channel. If reporting is enabled the
+ channel's counters are printed and cleared.
+*/
+void IoStats_CycleDone(IoStats_t *const stats, uint8_t channel);
+
+#ifdef _cplusplus
+}
+#endif
+
+#endif // IOSTATS_H
@@ -4,15 +4,20 @@
 #ifdef UNIT_TEST
     #include <stdio.h>
     #define STATIC
+#else
+    #define STATIC                    static
+#endif // UNIT_TEST
+
+// Unit tests print with printf. The target and host simulations (SIM_SERIAL) use Serial.
+#if defined(UNIT_TEST) && !defined(SIM_SERIAL)
     #define SERIAL_PRINT(MSG, FMT)    printf(FMT, MSG)
     #define SERIAL_PRINTLN(MSG, FMT)  printf(FMT "\n", MSG)
     #define SERIAL_PRINTLNEND()       printf("\n")
 #else
-    #define STATIC                    static
     #define SERIAL_PRINT(MSG, FMT)    Serial.print(MSG)  
     #define SERIAL_PRINTLN(MSG, FMT)  Serial.println(MSG)  
     #define SERIAL_PRINTLNEND()       Serial.println()
-#endif // UNIT_TEST
+#endif // UNIT_TEST && !SIM_SERIAL
 
 #ifdef DEBUG
     #define DBG_PRINT(MSG, FMT)       SERIAL_PRINT(MSG, FMT)
@@ -0,0 +1,142 @@
+#include "EEPROM.h"
+#include "MppStore.h"
+#include <stddef.h> // NULL
+
+// Byte offsets within a record
+#define SEQ_OFFSET      (0U)
+#define V_OFFSET        (1U)
+#define P_OFFSET        (2U)
+#define ERROR_OFFSET    (6U)
+#define CHECK_OFFSET    (7U)
+
+typedef struct Slot_s {
+    uint8_t d[MPP_STORE_RECORD_SIZE];
+} Slot_t;
+
+static uint16_t SlotAddress(MppStore_t const *const store,
+                            uint8_t channel,
+                            uint8_t slot)
+{
+    return store->base
+        + ((uint16_t)channel * MPP_STORE_SLOTS + slot) * MPP_STORE_RECORD_SIZE;
+}
+
+static bool HasChannel(MppStore_t const *const store, uint8_t channel)
+{
+    return (store != NULL) && (channel < store->nChannels);
+}
+
+/*
+ Complement of the byte sum so that erased (all 0xFF) and zeroed slots don't
+ pass as valid.
+*/
+static uint8_t CheckSum(Slot_t const *const s)
+{
+    uint8_t sum = 0U;
+    for (uint8_t i = 0U; i < CHECK_OFFSET; i++)
+    {
+        sum += s->d[i];
+    }
+    return (uint8_t)~sum;
+}
+
+static bool ReadSlot(MppStore_t const *const store,
+                     uint8_t channel,
+                     uint8_t slot,
+                     Slot_t *const s)
+{
+    const uint16_t address = SlotAddress(store, channel, slot);
+    for (uint8_t i = 0U; i < MPP_STORE_RECORD_SIZE; i++)
+    {
+        s->d[i] = EEPROM.read(address + i);
+    }
+    return (s->d[CHECK_OFFSET] == CheckSum(s));
+}
+
+/*
+ Finds the newest valid slot in the channel's ring. Sequence numbers wrap so
+ they are compared as differences - valid records are always within
+ MPP_STORE_SLOTS of each other. Returns false if no slot is valid.
+*/
+static bool FindNewest(MppStore_t const *const store,
+                       uint8_t channel,
+                       uint8_t *const newest,
+                       Slot_t *const s)
+{
+    bool found = false;
+    for (uint8_t slot = 0U; slot < MPP_STORE_SLOTS; slot++)
+    {
+        Slot_t candidate;
+        if (!ReadSlot(store, channel, slot, &candidate))
+        {
+            continue;
+        }
+        if (!found
+            || ((int8_t)(candidate.d[SEQ_OFFSET] - s->d[SEQ_OFFSET]) > 0))
+        {
+            *s = candidate;
+            *newest = slot;
+            found = true;
+        }
+    }
+    return found;
+}
+
+void MppStore_Init(MppStore_t *const store, uint16_t base, uint8_t nChannels)
+{
+    store->base = base;
+    store->nChannels = nChannels;
+}
+
+void MppStore_Save(MppStore_t const *const store,
+                   uint8_t channel,
+                   MppRecord_t const *const record)
+{
+    if (!HasChannel(store, channel))
+    {
+        return;
+    }
+    Slot_t  s;
+    uint8_t newest;
+    uint8_t slot = 0U;
+    uint8_t seq = 0U;
+    if (FindNewest(store, channel, &newest, &s))
+    {
+        slot = (newest + 1U) % MPP_STORE_SLOTS;
+        seq = s.d[SEQ_OFFSET] + 1U;
+    }
+    s.d[SEQ_OFFSET] = seq;
+    s.d[V_OFFSET] = record->v;
+    for (uint8_t i = 0U; i < 4U; i++)
+    {
+        s.d[P_OFFSET + i] = (uint8_t)(record->p >> (8U * i));
+    }
+    s.d[ERROR_OFFSET] = record->error;
+    s.d[CHECK_OFFSET] = CheckSum(&s);
+    // checksum goes last so a write cut short by a reset leaves an invalid slot
+    const uint16_t address = SlotAddress(store, channel, slot);
+    for (uint8_t i = 0U; i < MPP_STORE_RECORD_SIZE; i++)
+    {
+        EEPROM.update(address + i, s.d[i]);
+    }
+}
+
+bool MppStore_Load(MppStore_t const *const store,
+                   uint8_t channel,
+                   MppRecord_t *const record)
+{
+    Slot_t  s;
+    uint8_t newest;
+    if (!HasChannel(store, channel) || !FindNewest(store, channel, &newest, &s))
+    {
+        return false;
+    }
+    record->v = s.d[V_OFFSET];
+    record->p = 0U;
+    for (uint8_t i = 0U; i < 4U; i++)
+    {
+        record->p |= (uint32_t)s.d[P_OFFSET + i] << (8U * i);
+    }
+    record->error = s.d[ERROR_OFFSET];
+    return true;
+}
@@ -0,0 +1,58 @@
+#ifndef MPPSTORE_H
+#define MPPSTORE_H
+
+#ifdef _cplusplus
+extern "C" {
+#endif
+
+/*
+ Keeps the last mpp of each channel in eeprom so that tracking can warm start
+ after a reset. Each channel has a ring of MPP_STORE_SLOTS records. Every save
+ goes into the slot after the newest one, which spreads the wear over the ring.
+ Records carry a sequence number to find the newest and a checksum so erased
+ or part written slots are ignored.
+
+ A store is a block of rings in eeprom that the board owns and hands to its
+ channels. The channel number picks the ring within the store.
+*/
+#include "Config.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+#define MPP_STORE_BASE          (0U)   // default eeprom address of the first ring
+#define MPP_STORE_CHANNELS      (CHANNEL_TABLE_MAX)  // default rings - fills the 1k eeprom
+#define MPP_STORE_SLOTS         (16U)  // records per channel
+#define MPP_STORE_RECORD_SIZE   (8U)   // seq, v, p (4), error, checksum
+
+typedef struct MppRecord_s {
+    uint8_t  v;      // dac code of the mpp
+    uint32_t p;      // power at the mpp
+    uint8_t  error;  // error state of the channel (ErrorCode_t)
+} MppRecord_t;
+
+typedef struct MppStore_s {
+    uint16_t base;       // eeprom address of the first ring
+    uint8_t  nChannels;  // rings in the store
+} MppStore_t;
+
+// Places a store of nChannels rings at the eeprom address given
+void MppStore_Init(MppStore_t *const store, uint16_t base, uint8_t nChannels);
+
+/*
+ Writes the record into the next slot of the channel's ring. Channels outside
+ the store, or a NULL store, aren't saved.
+*/
+void MppStore_Save(MppStore_t const *const store,
+                   uint8_t channel,
+                   MppRecord_t const *const record);
+
+// Reads the newest valid record for the channel. False if there isn't one.
+bool MppStore_Load(MppStore_t const *const store,
+                   uint8_t channel,
+                   MppRecord_t *const record);
+
+#ifdef _cplusplus
+}
+#endif
+
+#endif // MPPSTORE_H
@@ -1,7 +1,11 @@
 #include "Arduino.h"
+#include "IoStats.h"
 #include "SPI.h"
 #include "SpiCommon.h"
 
+// Stats of the connection that's open. Bytes are counted against the device.
+static IoStats_t *openStats = NULL;
+
 void SpiBegin(void)
 {
     // open the spi bus
@@ -24,19 +28,26 @@ void OpenSpiConnection(const SpiSettings_t *settings)
                     settings->bitOrder,
                     settings->dataMode));
     digitalWrite(settings->chipSelectPin, LOW);
-    delay(settings->chipSelectDelay);
+    delayMicroseconds(settings->chipSelectSetup);
+    openStats = settings->stats;
+    IoStats_AddCsToggle(openStats);
+    IoStats_AddDelay(openStats, settings->chipSelectSetup);
 }
 
 // Transmits and receives a byte
 uint8_t SpiTransferByte(const uint8_t transmit)
 {
+    IoStats_AddSpiBytes(openStats, 1U);
     return SPI.transfer(transmit);
 }
 
 // function to close SPI connection on required CS pin
 void CloseSpiConnection(const SpiSettings_t *settings)
 {
-  delay(settings->chipSelectDelay);
+  delayMicroseconds(settings->chipSelectHold);
   digitalWrite(settings->chipSelectPin, HIGH);
   SPI.endTransaction();
+  IoStats_AddCsToggle(settings->stats);
+  IoStats_AddDelay(settings->stats, settings->chipSelectHold);
+  openStats = NULL;
 } 
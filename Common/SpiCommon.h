@@ -4,14 +4,17 @@
 #ifdef _cplusplus
 extern "C"{
 #endif
+#include "IoStats.h"
 #include <stdint.h>
 
 typedef struct SpiSettings_s{
     uint8_t  chipSelectPin;
-    uint16_t chipSelectDelay;
+    uint16_t chipSelectSetup;  // cs falling edge to first clock in us
+    uint16_t chipSelectHold;   // last clock to cs rising edge in us
     uint32_t clockSpeed;
     uint8_t  bitOrder;
     uint8_t  dataMode;
+    IoStats_t *stats;          // i/o on this device is counted here - NULL if not
 } SpiSettings_t;
 
 // Opens the Spi bus only - needs to be called once during setup
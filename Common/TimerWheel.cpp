@@ -0,0 +1,179 @@
+#include "TimerWheel.h"
+#include <stddef.h>
+
+#define SLOT_MASK   (TIMER_WHEEL_SLOTS - 1U)
+
+// Due times wrap with millis so they are compared as differences
+static bool IsDue(Timer_t const *const timer, uint32_t tNow)
+{
+    return ((int32_t)(tNow - timer->due) >= 0);
+}
+
+// Adds the timer to the end of its slot so timers due together fire in order
+static void Link(TimerWheel_t *const wheel, Timer_t *const timer)
+{
+    Timer_t **link = &wheel->slots[timer->due & SLOT_MASK];
+    while (*link != NULL)
+    {
+        link = &(*link)->next;
+    }
+    timer->next = NULL;
+    *link = timer;
+    timer->running = true;
+}
+
+static void Unlink(TimerWheel_t *const wheel, Timer_t *const timer)
+{
+    Timer_t **link = &wheel->slots[timer->due & SLOT_MASK];
+    while ((*link != NULL) && (*link != timer))
+    {
+        link = &(*link)->next;
+    }
+    if (*link != NULL)
+    {
+        *link = timer->next;
+    }
+    timer->next = NULL;
+    timer->running = false;
+}
+
+// Removes and returns the first timer in the slot that's due. NULL if none are.
+static Timer_t *TakeDue(TimerWheel_t *const wheel, uint8_t slot, uint32_t tNow)
+{
+    for (Timer_t *timer = wheel->slots[slot]; timer != NULL; timer = timer->next)
+    {
+        if (IsDue(timer, tNow))
+        {
+            Unlink(wheel, timer);
+            return timer;
+        }
+    }
+    return NULL;
+}
+
+/*
+ Periodic timers are re-armed from when they were due rather than when they
+ were serviced so they don't drift. If servicing was so late that a whole
+ period was missed the missed firings are dropped. Re-arming before the
+ callback lets the callback stop the timer.
+*/
+static void Fire(TimerWheel_t *const wheel, Timer_t *const timer, uint32_t tNow)
+{
+    if (timer->period > 0U)
+    {
+        timer->due += timer->period;
+        if (IsDue(timer, tNow))
+        {
+            timer->due = tNow + timer->period;
+        }
+        Link(wheel, timer);
+    }
+    timer->fn(timer->context, timer->event);
+}
+
+static void Arm(TimerWheel_t *const wheel,
+                Timer_t *const timer,
+                uint32_t delay,
+                uint32_t period,
+                TimerFn_t *fn,
+                void *context,
+                uint8_t event)
+{
+    TimerWheel_Stop(wheel, timer);
+    // a zero delay would be due again straight away if started from a callback
+    timer->due = wheel->now + ((delay > 0U) ? delay : 1U);
+    timer->period = period;
+    timer->fn = fn;
+    timer->context = context;
+    timer->event = event;
+    Link(wheel, timer);
+}
+
+void TimerWheel_Init(TimerWheel_t *const wheel, uint32_t tNow)
+{
+    for (uint8_t slot = 0U; slot < TIMER_WHEEL_SLOTS; slot++)
+    {
+        wheel->slots[slot] = NULL;
+    }
+    wheel->now = tNow;
+}
+
+void TimerWheel_Start(TimerWheel_t *const wheel,
+                      Timer_t *const timer,
+                      uint32_t delay,
+                      TimerFn_t *fn,
+                      void *context,
+                      uint8_t event)
+{
+    Arm(wheel, timer, delay, 0U, fn, context, event);
+}
+
+void TimerWheel_StartPeriodic(TimerWheel_t *const wheel,
+                              Timer_t *const timer,
+                              uint32_t period,
+                              TimerFn_t *fn,
+                              void *context,
+                              uint8_t event)
+{
+    Arm(wheel, timer, period, period, fn, context, event);
+}
+
+void TimerWheel_Stop(TimerWheel_t *const wheel, Timer_t *const timer)
+{
+    if (timer->running)
+    {
+        Unlink(wheel, timer);
+    }
+}
+
+bool TimerWheel_IsRunning(Timer_t const *const timer)
+{
+    return timer->running;
+}
+
+/*
+ Only the slots for the milliseconds since the last service can hold timers
+ that have come due, so those are the only ones visited - all of them if a
+ whole turn of the wheel has passed. Timers further ahead share the slots and
+ are left where they are. A slot is searched from the start again after each
+ callback since the callback may start or stop timers.
+*/
+void TimerWheel_Service(TimerWheel_t *const wheel, uint32_t tNow)
+{
+    const uint32_t tPrevious = wheel->now;
+    const uint32_t elapsed = tNow - tPrevious;
+    const uint32_t nTicks = (elapsed < TIMER_WHEEL_SLOTS) ?
+        elapsed : TIMER_WHEEL_SLOTS;
+    // callbacks that start timers start them from now
+    wheel->now = tNow;
+    for (uint32_t tick = 1U; tick <= nTicks; tick++)
+    {
+        const uint8_t slot = (uint8_t)((tPrevious + tick) & SLOT_MASK);
+        Timer_t *timer;
+        while ((timer = TakeDue(wheel, slot, tNow)) != NULL)
+        {
+            Fire(wheel, timer, tNow);
+        }
+    }
+}
+
+uint32_t TimerWheel_Now(TimerWheel_t const *const wheel)
+{
+    return wheel->now;
+}
+
+uint32_t TimerWheel_TimeToNext(TimerWheel_t const *const wheel)
+{
+    uint32_t tNext = TIMER_WHEEL_IDLE;
+    for (uint8_t slot = 0U; slot < TIMER_WHEEL_SLOTS; slot++)
+    {
+        for (Timer_t const *timer = wheel->slots[slot]; timer != NULL;
+             timer = timer->next)
+        {
+            const int32_t dt = (int32_t)(timer->due - wheel->now);
+            const uint32_t wait = (dt > 0) ? (uint32_t)dt : 0U;
+            tNext = (wait < tNext) ? wait : tNext;
+        }
+    }
+    return tNext;
+}
@@ -0,0 +1,85 @@
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#ifdef _cplusplus
+extern "C" {
+#endif
+
+/*
+ Cooperative one-shot and periodic timers. Timers are hashed into
+ TIMER_WHEEL_SLOTS lists by the millisecond they are due so that servicing
+ only looks at the slots for the time that has passed since the last call.
+ Callbacks run from TimerWheel_Service in the main loop, never from an
+ interrupt. The wheel only knows the time it was last serviced at and timers
+ are started relative to that.
+*/
+#include <stdint.h>
+#include <stdbool.h>
+
+#define TIMER_WHEEL_SLOTS   (16U)  // power of 2
+#define TIMER_WHEEL_IDLE    (0xFFFFFFFFUL)  // time to next when nothing is running
+
+// Called when a timer is due with the context and event it was started with
+typedef void TimerFn_t(void *context, uint8_t event);
+
+// Must start zeroed, eg. static or in a zero initialised struct
+typedef struct Timer_s {
+    struct Timer_s *next;    // next timer in the same slot
+    uint32_t       due;      // time it fires (ms)
+    uint32_t       period;   // re-armed with this after firing. 0 for one-shot
+    TimerFn_t      *fn;
+    void           *context;
+    uint8_t        event;
+    bool           running;
+} Timer_t;
+
+typedef struct TimerWheel_s {
+    Timer_t  *slots[TIMER_WHEEL_SLOTS];
+    uint32_t now;  // time of the last service (ms)
+} TimerWheel_t;
+
+// Empties the wheel and sets its time
+void TimerWheel_Init(TimerWheel_t *const wheel, uint32_t tNow);
+
+/*
+ Starts a one-shot timer that calls fn(context, event) delay ms after the last
+ service. A running timer is restarted. A delay of 0 fires on the next service
+ that moves time on.
+*/
+void TimerWheel_Start(TimerWheel_t *const wheel,
+                      Timer_t *const timer,
+                      uint32_t delay,
+                      TimerFn_t *fn,
+                      void *context,
+                      uint8_t event);
+
+// As TimerWheel_Start but the timer fires every period ms until stopped
+void TimerWheel_StartPeriodic(TimerWheel_t *const wheel,
+                              Timer_t *const timer,
+                              uint32_t period,
+                              TimerFn_t *fn,
+                              void *context,
+                              uint8_t event);
+
+// Stops a timer. Does nothing if it isn't running.
+void TimerWheel_Stop(TimerWheel_t *const wheel, Timer_t *const timer);
+
+bool TimerWheel_IsRunning(Timer_t const *const timer);
+
+// Fires the timers that are due by tNow (ms) and moves the wheel's time on
+void TimerWheel_Service(TimerWheel_t *const wheel, uint32_t tNow);
+
+// Time of the last service (ms)
+uint32_t TimerWheel_Now(TimerWheel_t const *const wheel);
+
+/*
+ Time from the last service until the next timer is due (ms). 0 if one is
+ overdue and TIMER_WHEEL_IDLE if none are running.
+*/
+uint32_t TimerWheel_TimeToNext(TimerWheel_t const *const wheel);
+
+#ifdef _cplusplus
+}
+#endif
+
+#endif // TIMERWHEEL_H
@@ -9,37 +9,28 @@
 #include "LedFlash.h"
 #include "LedFlashPrivate.h"
 
-//initilize class varibles
-uint8_t  ledPin;     // the number of the LED pin
-uint32_t onTime;     // milliseconds of on-time
-uint32_t offTime;    // milliseconds of off-time
-
-// These maintain the current state
-uint8_t  ledState;
-uint32_t previousMillis;
-uint32_t currentMillis;   // will store last time LED was updated
-int16_t  nFlash;          //number of blinks to complete
-bool     flashConst;      //state used to tell us if LED is blinking constantly or for a fixed number
-
 // Constructor which initialises flasher class with certain things when we create it
-Flasher::Flasher(uint8_t pin)
+Flasher::Flasher(uint8_t pin, TimerWheel_t *wheel)
 {
     ledPin = pin;
+    timers = wheel;
     pinMode(ledPin, OUTPUT);    
 
     // Initialise led in off state
     ledState = LOW;
     digitalWrite(pin, ledState);
 
-    previousMillis = 0U;
+    // flashing starts when keepFlashing or stopAfter is called
+    timer.running = false;
     //initialise to a value so we don't have errors
-    //eg if someone tries to update without calling t method first.
+    //eg if someone tries to flash without calling t method first.
     onTime = DEFAULT_ON_TIME; 
     offTime = DEFAULT_OFF_TIME;
+    nFlash = 0;
     flashConst = true;
 }
 
-//change on/off times
+//change on/off times. Takes effect from the next change of the led.
 void Flasher::t(uint32_t onNew, uint32_t offNew)
 {
     onTime = onNew;
@@ -50,6 +41,7 @@ void Flasher::t(uint32_t onNew, uint32_t offNew)
 void Flasher::keepFlashing(void)
 {
     flashConst = true;
+    start();
 }
 
 // Flash only a given number of times
@@ -57,40 +49,44 @@ void Flasher::stopAfter(int16_t n)
 {
     nFlash = n;
     flashConst = false;
+    start();
 }
 
-// Update the state of the led depending on time elapsed
-void Flasher::update(void)
+/*
+ Times the current on or off period if the led is flashing. A flash that's on
+ is always finished. Does nothing if the timer is already running - the new
+ settings are picked up when it fires.
+*/
+void Flasher::start(void)
 {
-    //check state of flashConst - do we need to flash?
-    if (flashConst || (!flashConst && nFlash > 0))
+    const bool flashing = flashConst || (nFlash > 0);
+    if (!TimerWheel_IsRunning(&timer) && (flashing || (ledState == HIGH)))
     {
-        // check to see if it's time to change the state of the LED
-        currentMillis = millis();
-        const uint32_t elapsedTime = currentMillis - previousMillis; 
-
-        if((ledState == HIGH) && (elapsedTime > onTime))
-        {
-            ledState = LOW;  // Turn it off
-            previousMillis = currentMillis;  // Remember the time
-            digitalWrite(ledPin, ledState);  // Update the actual LED
+        const uint32_t period = (ledState == HIGH) ? onTime : offTime;
+        TimerWheel_Start(timers, &timer, period, toggle, this, 0U);
+    }
+}
 
-            if (!flashConst)
-            {
-                nFlash--; //done a flash therefore decrement counter
-            }
-        }
-        else if ((ledState == LOW) && (elapsedTime > offTime))
-        {
-            ledState = HIGH;  // turn it on
-            previousMillis = currentMillis;   // Remember the time
-            digitalWrite(ledPin, ledState);   // Update the actual LED
-        }
-        else
+// Called by the timer at the end of each on and off time
+void Flasher::toggle(void *context, uint8_t event)
+{
+    (void)event;  // only one timer
+    Flasher *const led = (Flasher *)context;
+    if (led->ledState == HIGH)
+    {
+        led->ledState = LOW;  // Turn it off
+        digitalWrite(led->ledPin, led->ledState);  // Update the actual LED
+        if (!led->flashConst)
         {
-            // nothing to do here - no transition occuring
+            led->nFlash--; //done a flash therefore decrement counter
         }
     }
+    else
+    {
+        led->ledState = HIGH;  // turn it on
+        digitalWrite(led->ledPin, led->ledState);   // Update the actual LED
+    }
+    led->start();
 }
 
 //just turn it on
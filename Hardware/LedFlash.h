@@ -11,29 +11,36 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "TimerWheel.h"
 
+/*
+ Flashes an led from a timer on the wheel it's given. Nothing needs polling -
+ the timer changes the led over at the end of each on and off time.
+*/
 class Flasher
 {
   public:
-    Flasher(uint8_t);
+    Flasher(uint8_t pin, TimerWheel_t *timers);
     void t(uint32_t onTime, uint32_t offTime);
-    void update(void);
     void on(void);
     void off(void);
     void stopAfter(int16_t);
     void keepFlashing(void);
   private:
+    static void toggle(void *context, uint8_t event);
+    void start(void);
+
     // Class Member Variables
     // These are initialized at startup
     uint8_t  ledPin;     // the number of the LED pin
     uint32_t onTime;     // milliseconds of on-time
     uint32_t offTime;    // milliseconds of off-time
+    TimerWheel_t *timers;
 
     // These maintain the current state
     bool     ledState;       // led output state
-    uint32_t currentMillis;
-    uint32_t previousMillis;
-    uint16_t nFlash;
+    Timer_t  timer;          // fires at the next change of the led
+    int16_t  nFlash;
     bool     flashConst;
 };
 
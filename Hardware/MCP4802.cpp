@@ -5,14 +5,14 @@
 #include "Print.h"
 #include "SpiCommon.h"
 
-static gainSelect_t gain;
-
-SpiSettings_t MCP4802SpiSettings = {
+static const SpiSettings_t MCP4802SpiDefaults = {
     0U,
-    CS_DELAY,       // defined in Config.h
+    CS_SETUP_US,    // defined in Config.h
+    CS_HOLD_US,
     SPI_CLOCK_SPEED,// default values
     SPI_BIT_ORDER,
-    SPI_DATA_MODE
+    SPI_DATA_MODE,
+    NULL            // stats - set by the board
 };
 
 // Gets the dac command that controls the device
@@ -30,33 +30,34 @@ STATIC uint16_t MCP4802_GetDacCommand(chSelect_t   ch,
 }
 
 // Sends binary Spi command to the dac
-static void SendSpiCommand(uint16_t command)
+static void SendSpiCommand(MCP4802_t const *const dac, uint16_t command)
 {
-    OpenSpiConnection(&MCP4802SpiSettings);
+    OpenSpiConnection(&dac->spi);
     const uint8_t msb = ((command >> 8U) & 0xFF); 
     const uint8_t lsb = (command & 0xFF); 
     SpiTransferByte(msb);
     SpiTransferByte(lsb);
-    CloseSpiConnection(&MCP4802SpiSettings);
+    CloseSpiConnection(&dac->spi);
 }
 
-void MCP4802_Init(uint8_t pin)
+void MCP4802_Init(MCP4802_t *const dac, uint8_t pin)
 {
-    MCP4802SpiSettings.chipSelectPin = pin;
-    gain = lowGain;
+    dac->spi = MCP4802SpiDefaults;
+    dac->spi.chipSelectPin = pin;
     InitChipSelectPin(pin);
 
-    MCP4802_SetGain(gain);
-    MCP4802_Output(0u, chASelect);
-    MCP4802_Output(0u, chBSelect);
+    MCP4802_SetGain(dac, lowGain);
+    MCP4802_Output(dac, 0u, chASelect);
+    MCP4802_Output(dac, 0u, chBSelect);
 }
 
-void MCP4802_Output(uint8_t output, chSelect_t ch)
+void MCP4802_Output(MCP4802_t *const dac, uint8_t output, chSelect_t ch)
 {
     const uint16_t dacCommand = 
-        MCP4802_GetDacCommand(ch, gain, shdnOff, output);
+        MCP4802_GetDacCommand(ch, dac->gain, shdnOff, output);
 
-    SendSpiCommand(dacCommand);
+    SendSpiCommand(dac, dacCommand);
+    dac->output[ch] = output;
 
     #if DEBUG
       Serial.print("MCP4802 sending: ");
@@ -65,17 +66,22 @@ void MCP4802_Output(uint8_t output, chSelect_t ch)
     
 }
 
-void MCP4802_Shutdown(chSelect_t ch)
+uint8_t MCP4802_GetOutput(MCP4802_t const *const dac, chSelect_t ch)
+{
+    return dac->output[ch];
+}
+
+void MCP4802_Shutdown(MCP4802_t const *const dac, chSelect_t ch)
 {
-    SendSpiCommand(MCP4802_GetDacCommand(ch, gain, shdnOn, 0U));
+    SendSpiCommand(dac, MCP4802_GetDacCommand(ch, dac->gain, shdnOn, 0U));
 }
 
-void MCP4802_SetGain(gainSelect_t requestedGain)
+void MCP4802_SetGain(MCP4802_t *const dac, gainSelect_t requestedGain)
 {
-    gain = requestedGain;
+    dac->gain = requestedGain;
 }
 
-gainSelect_t MCP4802_GetGain(void)
+gainSelect_t MCP4802_GetGain(MCP4802_t const *const dac)
 {
-    return gain;
+    return dac->gain;
 }
\ No newline at end of file
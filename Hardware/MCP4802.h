@@ -6,6 +6,7 @@ extern "C"
 {
 #endif
 
+#include "SpiCommon.h"
 #include <stdint.h>
 
 /*
@@ -33,8 +34,19 @@ typedef enum chSelect_e {
     nChannels
 } chSelect_t;
 
+/*
+ Driver state for one MCP4802. Each device on the board has its own, passed to
+ every call. The device can't be read back so the last code sent to each channel
+ is kept here.
+ */
+typedef struct MCP4802_s {
+    SpiSettings_t spi;
+    gainSelect_t  gain;
+    uint8_t       output[nChannels];
+} MCP4802_t;
+
 // Function to initialise the interface with DAC
-void MCP4802_Init(uint8_t pin);
+void MCP4802_Init(MCP4802_t *const dac, uint8_t pin);
 
 /*
  * Function to set the channel ('a' or 'b') to the required code
@@ -43,16 +55,19 @@ void MCP4802_Init(uint8_t pin);
  * Bit 15 14 13 12 11 10 09 08 07 06 05 04 03 02 01 00
  *     A/B - GA SD D7 D6 D5 D4 D3 D2 D1 D0  x  x  x  x
  */
-void MCP4802_Output(uint8_t output, chSelect_t ch);
+void MCP4802_Output(MCP4802_t *const dac, uint8_t output, chSelect_t ch);
+
+// Gets the last code sent to the channel
+uint8_t MCP4802_GetOutput(MCP4802_t const *const dac, chSelect_t ch);
 
 // Shut down the given channel - overidden by a call to output
-void MCP4802_Shutdown(chSelect_t ch);
+void MCP4802_Shutdown(MCP4802_t const *const dac, chSelect_t ch);
 
 // Set the gain. This applies to both channels.
-void MCP4802_SetGain(gainSelect_t requestedGain);
+void MCP4802_SetGain(MCP4802_t *const dac, gainSelect_t requestedGain);
 
 // Gets the current gain setting.
-gainSelect_t MCP4802_GetGain(void);
+gainSelect_t MCP4802_GetGain(MCP4802_t const *const dac);
 
 #ifdef _cplusplus
 }
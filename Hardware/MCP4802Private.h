@@ -22,7 +22,4 @@ STATIC uint16_t MCP4802_GetDacCommand(chSelect_t   ch,
                                       gainSelect_t gain,
                                       shdnSelect_t shdn,
                                       uint8_t      output);
-
-// Make spi settings available to test code.
-extern SpiSettings_t MCP4802SpiSettings;
 #endif //include guard
\ No newline at end of file
@@ -6,36 +6,45 @@
     #include "Print.h"
 // #endif
 
-SpiSettings_t mx7705SpiSettings = {
+static const SpiSettings_t mx7705SpiDefaults = {
     0U,
-    CS_DELAY_ADC,     // defined in Config.h
+    CS_SETUP_ADC_US,  // defined in Config.h
+    CS_HOLD_ADC_US,
     SPI_CLOCK_SPEED,  // default values
     SPI_BIT_ORDER,
-    SPI_DATA_MODE
+    SPI_DATA_MODE,
+    NULL              // stats - set by the board
 };
 
-static bool MX7705_errorCondition = false;
-
-// Sends a single byte over SPI to the MX7705
-static void MX7705_Write(uint8_t sendByte)
+/*
+ Register access. The comms byte selecting the register and the register
+ contents are clocked under a single chip select assertion so each access costs
+ one transaction.
+*/
+// Writes a single byte register following a write request in the comms byte
+static void MX7705_WriteReg(MX7705_t const *const adc,
+                            uint8_t command,
+                            uint8_t sendByte)
 { 
-    OpenSpiConnection(&mx7705SpiSettings);
+    OpenSpiConnection(&adc->spi);
 
     #ifdef DEBUG
         Serial.print("MX7705: Sending... ");
         Serial.println(sendByte, BIN);
     #endif
 
+    SpiTransferByte(command);
     SpiTransferByte(sendByte);
 
-    CloseSpiConnection(&mx7705SpiSettings);
+    CloseSpiConnection(&adc->spi);
 }
 
-// Reads a single byte from the MX7705 over SPI
-static uint8_t MX7705_ReadByte(void)
+// Reads a single byte register following a read request in the comms byte
+static uint8_t MX7705_ReadReg8(MX7705_t const *const adc, uint8_t command)
 {
-    OpenSpiConnection(&mx7705SpiSettings);
+    OpenSpiConnection(&adc->spi);
 
+    SpiTransferByte(command);
     const uint8_t readByte = SpiTransferByte(0u);
 
     #ifdef DEBUG
@@ -43,16 +52,17 @@ static uint8_t MX7705_ReadByte(void)
         Serial.println(readByte, BIN);
     #endif
 
-    CloseSpiConnection(&mx7705SpiSettings);
+    CloseSpiConnection(&adc->spi);
 
     return readByte;
 }
 
-// Reads a uint16_t over spi. Used in reading data following voltage conversion.
-static uint16_t MX7705_Read16Bit(void)
+// Reads a 16 bit register. Used in reading data following voltage conversion.
+static uint16_t MX7705_ReadReg16(MX7705_t const *const adc, uint8_t command)
 {
-    OpenSpiConnection(&mx7705SpiSettings);
+    OpenSpiConnection(&adc->spi);
 
+    SpiTransferByte(command);
     const uint8_t msb = SpiTransferByte(0u);
     const uint8_t lsb = SpiTransferByte(0u);
     const uint16_t retVal = (msb << 8U) | lsb;
@@ -63,7 +73,7 @@ static uint16_t MX7705_Read16Bit(void)
         Serial.println(lsb, BIN);
     #endif
 
-    CloseSpiConnection(&mx7705SpiSettings);
+    CloseSpiConnection(&adc->spi);
     return retVal;
 }
 
@@ -153,115 +163,168 @@ STATIC uint8_t SetSetupSettings(AdcMode_t mode,
 }
 
 // Reads the DRDY bit of comms reg. Returns data ready status.
-static bool IsCommsRegBusy(uint8_t channel)
+static bool IsCommsRegBusy(MX7705_t const *const adc, uint8_t channel)
 {
     // Read comms register
-    MX7705_Write(RequestRegRead(CommsReg, channel));
-    const uint8_t commsRegister = MX7705_ReadByte();
+    const uint8_t commsRegister =
+        MX7705_ReadReg8(adc, RequestRegRead(CommsReg, channel));
     // read DRDY bit - 1 = busy, 0 = ready
     return bitRead(commsRegister, DRDY_BIT);
 }
 
-void MX7705_Init(const uint8_t pin, const uint8_t channel)
+void MX7705_Init(MX7705_t *const adc, const uint8_t pin, const uint8_t channel)
 {
-    MX7705_errorCondition = false;
-    // set the value of the chip select pin in mx7705SpiSettings global
-    mx7705SpiSettings.chipSelectPin = pin;
+    adc->errorCondition = false;
+    adc->pollCount = 0U;
+    adc->readStart = 0U;
+    adc->spi = mx7705SpiDefaults;
+    adc->spi.chipSelectPin = pin;
 
     InitChipSelectPin(pin);
 #ifndef UNIT_TEST  // TODO fix tests. Need definitions to remove compile guards
     InitClockOuput(PWMout);
 #endif
-    // Request a write to the clock register
-    MX7705_Write(RequestRegWrite(ClockReg, channel));
     /*
-     turn on clockdis bit - using clock from ATMEGA. Turn off clk bit for optimum
-     performance at 1MHz with clkdiv 0.
+     Write the clock register. turn on clockdis bit - using clock from ATMEGA.
+     Turn off clk bit for optimum performance at 1MHz with clkdiv 0.
      */
-    const uint8_t clockRegToSet = SetClockSettings(true, false, false, 1U);
-    MX7705_Write(clockRegToSet);
-    // Writing to comms reg. Request a write operation to the setup register
-    MX7705_Write(RequestRegWrite(SetupReg, channel));
-    // Write to setup register - self calibration mode, unipolar, unbuffered, clear Fsync
-    const uint8_t setupRegToSet = SetSetupSettings(SelfCalibMode, 0U, true, false, false);
-    MX7705_Write(setupRegToSet);
+    adc->clockShadow[channel] = SetClockSettings(true, false, false, 1U);
+    // Setup register - unipolar, unbuffered, clear Fsync
+    adc->setupShadow[channel] = SetSetupSettings(NormalMode, 0U, true, false, false);
+    // write the shadow registers with self calibration mode set
+    MX7705_Resync(adc, channel);
 
     /* Now read setup and clock registers to verify that we have written the
      correct settings and communication is working ok. */
-    MX7705_Write(RequestRegRead(ClockReg, channel));
-    const uint8_t clockRegRead = MX7705_ReadByte();
-    
-    MX7705_Write(RequestRegRead(SetupReg, channel));
-    const uint8_t setupRegRead = MX7705_ReadByte();
-    
+    (void)MX7705_Verify(adc, channel);
+}
+
+bool MX7705_Verify(MX7705_t *const adc, const uint8_t channel)
+{
+    const uint8_t clockRegRead =
+        MX7705_ReadReg8(adc, RequestRegRead(ClockReg, channel));
+    const uint8_t setupRegRead =
+        MX7705_ReadReg8(adc, RequestRegRead(SetupReg, channel));
+
+    // mode bits are ignored - they change when calibration finishes
+    uint8_t setupRegExpected = adc->setupShadow[channel];
+    uint8_t setupRegActual = setupRegRead;
+    bitInsert(setupRegExpected, NormalMode, MODE_MASK, MODE_OFFSET);
+    bitInsert(setupRegActual, NormalMode, MODE_MASK, MODE_OFFSET);
+
     // Check that data read back matches expectations
-    if ((setupRegRead != setupRegToSet) || (clockRegRead != clockRegToSet))
+    const bool match = (setupRegActual == setupRegExpected)
+                       && (clockRegRead == adc->clockShadow[channel]);
+    if (!match)
     {
-        MX7705_errorCondition = true;
+        adc->errorCondition = true;
         #ifdef DEBUG
             Serial.println("MX7705: Error condition");
         #endif
     }
+    return match;
 }
 
-bool MX7705_GetError(void)
+void MX7705_Resync(MX7705_t const *const adc, const uint8_t channel)
 {
-    return MX7705_errorCondition;
+    MX7705_WriteReg(adc, RequestRegWrite(ClockReg, channel), adc->clockShadow[channel]);
+
+    /* Contents of the device can't be trusted so calibrate again. Mode bits
+    return to normal by themselves when calibration is done.*/
+    uint8_t setupRegToSet = adc->setupShadow[channel];
+    bitInsert(setupRegToSet, SelfCalibMode, MODE_MASK, MODE_OFFSET);
+    MX7705_WriteReg(adc, RequestRegWrite(SetupReg, channel), setupRegToSet);
 }
 
-uint16_t MX7705_ReadData(const uint8_t channel)
+bool MX7705_GetError(MX7705_t const *const adc)
 {
-    uint8_t         commsRegister = 0U;
-    const uint32_t  tic = millis();
-    uint32_t        toc;
-    uint16_t        pollCount = 0U;
-    bool            timeout = false;
-      
-    // polling DRDY bit of comms register waiting for measurement to finish    
-    do
-    {
-        toc = millis();
-        timeout = ((toc - tic) > TIMEOUT_MS);
-        pollCount++;
+    return adc->errorCondition;
+}
 
-    } while (IsCommsRegBusy(channel) && !timeout);
+void MX7705_StartRead(MX7705_t *const adc, const uint8_t channel)
+{
+    adc->readStart = millis();
+    adc->pollCount = 0U;
+}
+
+MX7705ReadStatus_t MX7705_PollRead(MX7705_t *const adc, const uint8_t channel)
+{
+    const uint32_t toc = millis();
+    const bool     timeout = ((toc - adc->readStart) > TIMEOUT_MS);
+    adc->pollCount++;
+
+    // single poll of DRDY bit of comms register
+    const bool busy = IsCommsRegBusy(adc, channel);
 
+    if (timeout)
+    {
+        adc->errorCondition = true;
+        return MX7705ReadTimeout;
+    }
+    else if (busy)
+    {
+        return MX7705ReadBusy;
+    }
+    else
+    {
+        return MX7705ReadReady;
+    }
+}
+
+uint16_t MX7705_CompleteRead(MX7705_t const *const adc, const uint8_t channel)
+{
     #ifdef DEBUG
-        if (pollCount > 0)
+        if (adc->pollCount > 0)
         {
             Serial.print("MX7705: DRDY bit polled... ");
-            Serial.print(pollCount);
+            Serial.print(adc->pollCount);
             Serial.println(" times");
         }
     #endif
 
-    if (timeout)
-    {
-        MX7705_errorCondition = true;
-        return 0u;
-    }
-    else
+    // request and read the data register
+    return MX7705_ReadReg16(adc, RequestRegRead(DataReg, channel));
+}
+
+uint16_t MX7705_ReadData(MX7705_t *const adc, const uint8_t channel)
+{
+    MX7705ReadStatus_t status;
+
+    MX7705_StartRead(adc, channel);
+    // polling DRDY bit of comms register waiting for measurement to finish
+    do
     {
-        //request data register reading
-        MX7705_Write(RequestRegRead(DataReg, channel));
+        status = MX7705_PollRead(adc, channel);
+    } while (status == MX7705ReadBusy);
 
-        return MX7705_Read16Bit();
-    }
+    return (status == MX7705ReadTimeout) ? 0u : MX7705_CompleteRead(adc, channel);
+}
+
+uint16_t MX7705_GetPollCount(MX7705_t const *const adc)
+{
+    return adc->pollCount;
 }
 
-uint8_t MX7705_GetGain(const uint8_t channel)
+uint16_t MX7705_GetConversionTime(MX7705_t const *const adc, const uint8_t channel)
 {
-  // request read of the setup register of the given channel
-  MX7705_Write(RequestRegRead(SetupReg, channel));
-  
-  // now read setup register.
-  const uint8_t setupRegister = MX7705_ReadByte();
-  
-  // Extract gain settings and return
-  return bitExtract(setupRegister, PGA_MASK, PGA_OFFSET); 
+    // output data rates (Hz) for each filter selection at CLK = 0 and CLK = 1
+    static const uint16_t outputRate[2][4] = {{20U, 25U, 100U, 200U},
+                                              {50U, 60U, 250U, 500U}};
+    const uint8_t clockRegister = adc->clockShadow[channel];
+    const uint16_t rate = outputRate[bitRead(clockRegister, CLK_BIT)]
+        [bitExtract(clockRegister, FILTER_SELECT_MASK, FILTER_SELECT_OFFSET)];
+    return (1000U + rate - 1U) / rate;
 }
 
-void MX7705_SetGain(const uint8_t requiredGain, const uint8_t channel)
+uint8_t MX7705_GetGain(MX7705_t const *const adc, const uint8_t channel)
+{
+  // Extract gain settings from the shadow setup register and return
+  return bitExtract(adc->setupShadow[channel], PGA_MASK, PGA_OFFSET); 
+}
+
+void MX7705_SetGain(MX7705_t *const adc,
+                    const uint8_t requiredGain,
+                    const uint8_t channel)
 {
     // required gain is unsigned so don't need to check values lower than 0
     if (requiredGain > PGA_MASK)
@@ -274,35 +337,26 @@ void MX7705_SetGain(const uint8_t requiredGain, const uint8_t channel)
     }
     else
     {
-        /* Request a read of the setup register for the given channel - store
-        and amend gain bits only. We don't want to change data that's already here.*/
-        MX7705_Write(RequestRegRead(SetupReg, channel));
-
-        // Now read setup register.
-        const uint8_t setupRegPrev = MX7705_ReadByte();
-
-        // Write the required gain onto setupRegister then send back to adc
-        uint8_t setupRegNew = setupRegPrev;
-        bitInsert(setupRegNew, requiredGain, PGA_MASK, PGA_OFFSET);
-
-        // Request write to setup register
-        MX7705_Write(RequestRegWrite(SetupReg, channel));
+        /* Amend gain bits of the shadow setup register only. We don't want to
+        change data that's already here.*/
+        bitInsert(adc->setupShadow[channel], requiredGain, PGA_MASK, PGA_OFFSET);
 
         // Write new setupRegister
-        MX7705_Write(setupRegNew);
+        MX7705_WriteReg(adc, RequestRegWrite(SetupReg, channel),
+                        adc->setupShadow[channel]);
     }
 }
 
-void MX7705_IncrementGain(const uint8_t channel)
+void MX7705_IncrementGain(MX7705_t *const adc, const uint8_t channel)
 {
-    uint8_t gain = MX7705_GetGain(channel);
+    uint8_t gain = MX7705_GetGain(adc, channel);
     gain++;
-    MX7705_SetGain(gain, channel);
+    MX7705_SetGain(adc, gain, channel);
 }
 
-void MX7705_DecrementGain(const uint8_t channel)
+void MX7705_DecrementGain(MX7705_t *const adc, const uint8_t channel)
 {
-    uint8_t gain = MX7705_GetGain(channel);
+    uint8_t gain = MX7705_GetGain(adc, channel);
     gain--;
-    MX7705_SetGain(gain, channel);
+    MX7705_SetGain(adc, gain, channel);
 }
@@ -8,51 +8,99 @@ extern "C" {
 #include "SpiCommon.h"
 #include <stdint.h>
 
+// Result of polling a conversion started with MX7705_StartRead
+typedef enum MX7705ReadStatus_e {
+    MX7705ReadBusy,
+    MX7705ReadReady,
+    MX7705ReadTimeout
+} MX7705ReadStatus_t;
+
+/*
+ Conversions after the input mux switches that still hold some of the previous
+ input. The sinc3 filter isn't reset by a channel change so it takes three
+ conversion periods to settle.
+*/
+#define MX7705_MUX_SETTLE_CONVERSIONS (3U)
+
+#define MX7705_CHANNELS         (4U)      // channels addressable by CH0-1 bits
+
 /*
- enum containing all available registers that can be selected from RS0-2 bits
- of the comms register.
+ Driver state for one MX7705. Each device on the board has its own, passed to
+ every call. The setup shadow holds normal mode since self calibration returns
+ the mode bits to normal when it's finished.
 */
-typedef enum RegisterSelection_e {
-    CommsReg,
-    SetupReg,
-    ClockReg,
-    DataReg,
-    TestReg,
-    NoOperation,
-    OffsetReg,
-    GainReg,
-    NumberOfEntries
-} RegisterSelection_t;
+typedef struct MX7705_s {
+    SpiSettings_t spi;
+    bool          errorCondition;
+    uint16_t      pollCount;   // DRDY polls since the last read was started
+    uint32_t      readStart;   // millis() when the read in flight was started
+    uint8_t       setupShadow[MX7705_CHANNELS];
+    uint8_t       clockShadow[MX7705_CHANNELS];
+} MX7705_t;
 
 /*
  * Setup the MX7705 in unipolar, unbuffered mode. Allow the user to 
  * select which channel they want. 0/1 = AIN1+ to AIN1-/AIN2+ to AIN2-.
  */
-void MX7705_Init(const uint8_t pin, const uint8_t channel);
+void MX7705_Init(MX7705_t *const adc, const uint8_t pin, const uint8_t channel);
 
 // Gets the error condition
-bool MX7705_GetError(void);
+bool MX7705_GetError(MX7705_t const *const adc);
+
+/*
+ Reads back the setup and clock registers and compares them with the driver's
+ shadow copies. Sets the error condition and returns false on a mismatch.
+ */
+bool MX7705_Verify(MX7705_t *const adc, const uint8_t channel);
+
+/*
+ Rewrites the setup and clock registers from the shadow copies and starts a
+ self calibration. Use after a failed verify.
+ */
+void MX7705_Resync(MX7705_t const *const adc, const uint8_t channel);
 
 /*
  Reads two bytes from the ADC and convert to a 16Bit unsigned int representing
  the converted voltage.
  */
-uint16_t MX7705_ReadData(const uint8_t channel);
+uint16_t MX7705_ReadData(MX7705_t *const adc, const uint8_t channel);
+
+/*
+ Non-blocking alternative to MX7705_ReadData. Start a read, then poll DRDY once
+ per call until the conversion is ready and collect it with MX7705_CompleteRead.
+ A timeout sets the error condition. Only one read can be in flight at a time
+ on each device since polling a channel switches the adc input mux.
+ */
+void MX7705_StartRead(MX7705_t *const adc, const uint8_t channel);
+MX7705ReadStatus_t MX7705_PollRead(MX7705_t *const adc, const uint8_t channel);
+uint16_t MX7705_CompleteRead(MX7705_t const *const adc, const uint8_t channel);
+
+// Number of times DRDY was polled since the last read was started
+uint16_t MX7705_GetPollCount(MX7705_t const *const adc);
+
+/*
+ Time one conversion takes with the clock settings of a channel (ms, rounded
+ up). Taken from the shadow clock register, assuming the CLK bit matches the
+ master clock.
+ */
+uint16_t MX7705_GetConversionTime(MX7705_t const *const adc, const uint8_t channel);
 
-// Reads the currently set gain of a given channel
-uint8_t MX7705_GetGain(const uint8_t channel);
+// Returns the gain of a given channel from the shadow setup register
+uint8_t MX7705_GetGain(MX7705_t const *const adc, const uint8_t channel);
 
 /*
  Sets the gain of the MX7705. Note that gain is set as an unsigned int from
  0 - 7 inclusive
  */
-void MX7705_SetGain(const uint8_t requiredGain, const uint8_t channel);
+void MX7705_SetGain(MX7705_t *const adc,
+                    const uint8_t requiredGain,
+                    const uint8_t channel);
 
 // Increases the gain of selected channel by one step
-void MX7705_IncrementGain(const uint8_t channel);
+void MX7705_IncrementGain(MX7705_t *const adc, const uint8_t channel);
 
 // Decreases the gain of selected channel by one step
-void MX7705_DecrementGain(const uint8_t channel);
+void MX7705_DecrementGain(MX7705_t *const adc, const uint8_t channel);
 
 #ifdef _cplusplus
 }
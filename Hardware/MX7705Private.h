@@ -36,6 +36,22 @@
 #define CLKDIS_BIT              (4U)
 #define MXID_BIT                (7U) // maxim id bit. Read only
 
+/*
+ enum containing all available registers that can be selected from RS0-2 bits
+ of the comms register.
+*/
+typedef enum RegisterSelection_e {
+    CommsReg,
+    SetupReg,
+    ClockReg,
+    DataReg,
+    TestReg,
+    NoOperation,
+    OffsetReg,
+    GainReg,
+    NumberOfEntries
+} RegisterSelection_t;
+
 
 //MX7705 commands - note these are not very portable.
 //TODO: rewrite binary commands in hex for portability
@@ -69,9 +85,11 @@ typedef enum AdcMode_e {
     NumModes
 } AdcMode_t;
 
-static void MX7705_Write(uint8_t sendByte);
-static uint8_t MX7705_ReadByte(void);
-static uint16_t MX7705_Read16Bit(void);
+static void MX7705_WriteReg(MX7705_t const *const adc,
+                            uint8_t command,
+                            uint8_t sendByte);
+static uint8_t MX7705_ReadReg8(MX7705_t const *const adc, uint8_t command);
+static uint16_t MX7705_ReadReg16(MX7705_t const *const adc, uint8_t command);
 #ifndef UNIT_TEST
     static void InitClockOuput(uint8_t pin); 
 #endif
@@ -89,7 +107,4 @@ STATIC uint8_t SetSetupSettings(AdcMode_t mode,
                                 bool unipolarMode,
                                 bool enableBuffer,
                                 bool filterSync);
-static bool IsCommsRegBusy(uint8_t channel);
-
-
-extern SpiSettings_t mx7705SpiSettings;
\ No newline at end of file
+static bool IsCommsRegBusy(MX7705_t const *const adc, uint8_t channel);
\ No newline at end of file
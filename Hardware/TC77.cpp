@@ -8,18 +8,16 @@
 #include "TC77.h"
 #include "TC77Private.h"
 
-SpiSettings_t tc77SpiSettings = {
+static const SpiSettings_t tc77SpiDefaults = {
     0U,
-    CS_DELAY,  // defined in Config.h
+    CS_SETUP_US,  // defined in Config.h
+    CS_HOLD_US,
     SPI_CLOCK_SPEED,
     SPI_BIT_ORDER,
-    SPI_DATA_MODE
+    SPI_DATA_MODE,
+    NULL          // stats - set by the board
 };
 
-static bool     errorCondition;
-static uint16_t previousReading;
-static uint32_t previousTime;    //previousTime set to last measurement
-
 // reads TC77 data ready bit
 static bool TC77_IsReady(uint16_t readReg)
 {
@@ -33,19 +31,19 @@ static bool TC77_IsOverTemp(uint8_t msb)
 }
 
 // reads raw data from TC77 for conversion elsewhere
-static uint16_t TC77_ReadRawData(void)
+static uint16_t TC77_ReadRawData(TC77_t const *const tc77)
 {
     uint8_t msb; // most sig byte read first
     uint8_t lsb; // then least sig
     uint16_t readReg;
 
-    OpenSpiConnection(&tc77SpiSettings);
+    OpenSpiConnection(&tc77->spi);
 
     //read data
     msb = SpiTransferByte(0u);
     lsb = SpiTransferByte(0u);
 
-    CloseSpiConnection(&tc77SpiSettings);
+    CloseSpiConnection(&tc77->spi);
 
     //pack data into a single uint16_t
     readReg = (uint16_t)((msb << 8U) | lsb);
@@ -62,14 +60,52 @@ static uint16_t TC77_ReadRawData(void)
     return readReg;
 }
 
-void TC77_Init(uint8_t pin)
+/*
+ Updates the measurement and checks for error condition. Called by the timer
+ once per conversion so a new reading should be ready.
+*/
+static void TC77_Update(void *context, uint8_t event)
 {
-    tc77SpiSettings.chipSelectPin = pin;
+    (void)event;  // only one timer
+    TC77_t *const tc77 = (TC77_t *)context;
+    uint16_t currentReading;
+    currentReading = TC77_ReadRawData(tc77);
+
+    // Now check the reading - should we update our data or not?
+    if (TC77_IsOverTemp(currentReading >> 8U))
+    {
+        // previousReading is not updated.
+        tc77->errorCondition = true;
+        #ifdef DEBUG
+            Serial.println("TC77 overtemperature error.");
+        #endif
+        tc77->previousReading = currentReading;
+    }
+    else if (!TC77_IsReady(currentReading)) 
+    {
+        // previousReading is not updated.
+        #ifdef DEBUG
+            Serial.println("TC77 not ready.");
+        #endif
+    }
+    else
+    {
+        // only update if there are no error conditions
+        tc77->previousReading = currentReading;
+    }
+}
+
+void TC77_Init(TC77_t *const tc77, uint8_t pin, TimerWheel_t *const timers)
+{
+    tc77->spi = tc77SpiDefaults;
+    tc77->spi.chipSelectPin = pin;
     InitChipSelectPin(pin);
 
-    errorCondition = false;
-    previousReading = 0U;
-    previousTime = 0U;
+    tc77->errorCondition = false;
+    tc77->previousReading = 0U;
+    // conversion time places upper limit on measurement rate
+    TimerWheel_StartPeriodic(timers, &tc77->timer, CONVERSION_TIME,
+                             TC77_Update, tc77, 0U);
 }
 
 float TC77_ConvertToTemp(uint16_t readReg)
@@ -92,50 +128,12 @@ float TC77_ConvertToTemp(uint16_t readReg)
     return temperature;
 }
 
-void TC77_Update(void)
-{
-    const uint32_t currentTime = millis();
-    const uint32_t elapsedTime = currentTime - previousTime;
-
-    //update data only if the last measurement was longer than conversion time ago. 
-    if (elapsedTime > CONVERSION_TIME)
-    {
-        uint16_t currentReading;
-        currentReading = TC77_ReadRawData();
-        //reset the previousTime
-        previousTime = currentTime;
-
-        // Now check the reading - should we update our data or not?
-        if (TC77_IsOverTemp(currentReading >> 8U))
-        {
-            // previousReading is not updated.
-            errorCondition = true;
-            #ifdef DEBUG
-                Serial.println("TC77 overtemperature error.");
-            #endif
-            previousReading = currentReading;
-        }
-        else if (!TC77_IsReady(currentReading)) 
-        {
-            // previousReading is not updated.
-            #ifdef DEBUG
-                Serial.println("TC77 not ready.");
-            #endif
-        }
-        else
-        {
-            // only update if there are no error conditions
-            previousReading = currentReading;
-        }
-    }
-}
-
-uint16_t TC77_GetRawData(void)
+uint16_t TC77_GetRawData(TC77_t const *const tc77)
 {
-    return previousReading;
+    return tc77->previousReading;
 }
 
-bool TC77_GetError(void)
+bool TC77_GetError(TC77_t const *const tc77)
 {
-    return errorCondition;
+    return tc77->errorCondition;
 }
\ No newline at end of file
@@ -4,23 +4,34 @@
 extern "C"{
 #endif
 
+#include "SpiCommon.h"
+#include "TimerWheel.h"
 #include <stdint.h>
 #include <stdbool.h>
 
-// Initialises chip select pin and static variables
-void TC77_Init(uint8_t chipSelectPin);
+// Driver state for one TC77 - passed to every call
+typedef struct TC77_s {
+    SpiSettings_t spi;
+    bool          errorCondition;
+    uint16_t      previousReading;
+    Timer_t       timer;           // reads the sensor every conversion
+} TC77_t;
+
+/*
+ Initialises chip select pin and driver state. The sensor is then read on a
+ periodic timer on the wheel given, once per conversion. tc77 must start zeroed.
+*/
+void TC77_Init(TC77_t *const tc77, uint8_t chipSelectPin,
+               TimerWheel_t *const timers);
 
 // Converts rawData from the temperature controller to temperature in deg C
 float TC77_ConvertToTemp(uint16_t rawData);
 
-// Updates measurement if it's time and checks for error condition.
-void TC77_Update(void);
-
 // Gets raw data from the spi read register
-uint16_t TC77_GetRawData(void);
+uint16_t TC77_GetRawData(TC77_t const *const tc77);
 
 // Gets the current error condition
-bool TC77_GetError(void);
+bool TC77_GetError(TC77_t const *const tc77);
 
 #ifdef _cplusplus
 }
@@ -1,4 +1,4 @@
-#include "Config.h"    // CS_DELAY
+#include "Config.h"    // CS_SETUP_US, CS_HOLD_US
 #include "SpiCommon.h" // SpiSettings_t
 #include "SpiConfig.h" // spi #defines
 
@@ -8,6 +8,3 @@
 #define SPI_CLOCK_SPEED     (7000000U)
 #define SPI_BIT_ORDER       (MSBFIRST)
 #define SPI_DATA_MODE       (SPI_MODE0)
-
-// extern required so we can access from tests
-extern SpiSettings_t tc77SpiSettings;
\ No newline at end of file
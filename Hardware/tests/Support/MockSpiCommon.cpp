@@ -3,6 +3,7 @@
 #include "CppUTestExt/MockSupport.h"
 #include "CppUTestExt/MockSupportPlugin.h"
 
+#include <stddef.h>         // offsetof
 #include <string.h>         // memset
 #include "SpiCommon.h"
 #include "MockSpiCommon.h"  // declaration of mockSpiState and helper functions
@@ -71,8 +72,8 @@ void CloseSpiConnection(const SpiSettings_t *settings)
 
 void InitialiseMockSpiBus(SpiSettings_t *settings)
 {
-    // sets data to 0 and bools to false
-    memset(&mockSpiState, 0U, (sizeof(MockSpiState_t) - sizeof(SpiSettings_t)));
+    // sets data to 0 and bools to false - everything before the settings pointer
+    memset(&mockSpiState, 0U, offsetof(MockSpiState_t, settings));
     // Point the mock spi state variable to settings from module under test
     mockSpiState.settings = settings;
     /* set chipSelectPin only. Other members contain settings that are only
@@ -9,8 +9,10 @@
 // support
 #include "Arduino.h"
 #include "MockArduino.h"
+#include "TimerWheel.h"
 
-static uint32_t mockMillis;
+static uint32_t     mockMillis;
+static TimerWheel_t wheel;  // led is flashed from a timer on here
 
 /*******************************************************************************
  * Private function implementations for tests
@@ -25,49 +27,44 @@ static void MockForFlasherCreateInstance(int pinNum)
         .withParameter("value", LOW);
 }
 
-static void MockForFlasherUpdateSwitchOff(int pinNum)
+static void MockForFlasherSwitchOff(int pinNum)
 {
-    mock().expectOneCall("millis")
-        .andReturnValue(mockMillis);
     mock().expectOneCall("digitalWrite")
         .withParameter("pin", pinNum)
         .withParameter("value", LOW);
 }
 
-static void MockForFlasherUpdateSwitchOn(int pinNum)
+static void MockForFlasherSwitchOn(int pinNum)
 {
-    mock().expectOneCall("millis")
-        .andReturnValue(mockMillis);
     mock().expectOneCall("digitalWrite")
         .withParameter("pin", pinNum)
         .withParameter("value", HIGH);
 }
 
-static void MockForFlasherUpdateNoSwitch(void)
+// Moves time on and lets the led's timer run
+static void AdvanceTime(uint32_t dt)
 {
-    mock().expectOneCall("millis")
-        .andReturnValue(mockMillis);
+    mockMillis += dt;
+    TimerWheel_Service(&wheel, mockMillis);
 }
 
 /*
  runs an Led cycle. Assumes that we're starting at the beginning of the off cycle
  and that the led has already been initialised and is off.
  */
-static void RunMockLedFlashCycle(Flasher *led, int pinNum, long onTime, long offTime)
+static void RunMockLedFlashCycle(int pinNum, long onTime, long offTime)
 {
     // check that the LED is initialsed and off
     CHECK(IsDigitalPinLow(pinNum));
-    mockMillis += offTime + 1U;
-    MockForFlasherUpdateSwitchOn(pinNum);
-    led->update();
+    AdvanceTime(offTime - 1U);
+    CHECK(IsDigitalPinLow(pinNum));
+    MockForFlasherSwitchOn(pinNum);
+    AdvanceTime(1U);
     CHECK(IsDigitalPinHigh(pinNum));
-    mockMillis += onTime;
-    MockForFlasherUpdateNoSwitch();
-    led->update();
+    AdvanceTime(onTime - 1U);
     CHECK(IsDigitalPinHigh(pinNum));
-    mockMillis += 1U;
-    MockForFlasherUpdateSwitchOff(pinNum);
-    led->update();
+    MockForFlasherSwitchOff(pinNum);
+    AdvanceTime(1U);
     CHECK(IsDigitalPinLow(pinNum));
     mock().checkExpectations();
 }
@@ -87,6 +84,7 @@ TEST_GROUP(LedFlashTestGroup)
     {
         ResetDigitalPins();
         mockMillis = 0U;
+        TimerWheel_Init(&wheel, mockMillis);
     }
 
     void teardown(void)
@@ -102,7 +100,7 @@ TEST(LedFlashTestGroup, FlasherOnConstant)
 
     // Instantiate Flasher class
     MockForFlasherCreateInstance(pinNum);
-    Flasher testLed(pinNum);
+    Flasher testLed(pinNum, &wheel);
 
     mock().disable();
     testLed.on();
@@ -116,7 +114,7 @@ TEST(LedFlashTestGroup, FlasherOffConstant)
 
     // Instantiate Flasher class
     MockForFlasherCreateInstance(pinNum);
-    Flasher testLed(pinNum);
+    Flasher testLed(pinNum, &wheel);
 
     // Turn on the Led constantly
     mock().expectOneCall("digitalWrite")
@@ -133,9 +131,12 @@ TEST(LedFlashTestGroup, FlasherCompleteLedFlashCycle)
 
     // Instantiate Flasher class
     MockForFlasherCreateInstance(pinNum);
-    Flasher testLed(pinNum);
+    Flasher testLed(pinNum, &wheel);
+    testLed.keepFlashing();
 
-    RunMockLedFlashCycle(&testLed, pinNum, DEFAULT_ON_TIME, DEFAULT_OFF_TIME);
+    RunMockLedFlashCycle(pinNum, DEFAULT_ON_TIME, DEFAULT_OFF_TIME);
+    // and again
+    RunMockLedFlashCycle(pinNum, DEFAULT_ON_TIME, DEFAULT_OFF_TIME);
 }
 
 // Tests that we can change the on and off periods from default values
@@ -147,10 +148,11 @@ TEST(LedFlashTestGroup, FlasherSettingOnOffTimes)
 
     // Instantiate Flasher class
     MockForFlasherCreateInstance(pinNum);
-    Flasher testLed(pinNum);
+    Flasher testLed(pinNum, &wheel);
     testLed.t(onTime, offTime);
+    testLed.keepFlashing();
 
-    RunMockLedFlashCycle(&testLed, pinNum, onTime, offTime);
+    RunMockLedFlashCycle(pinNum, onTime, offTime);
 }
 
 // Test for only two flashes - non-constant operation
@@ -161,37 +163,47 @@ TEST(LedFlashTestGroup, FlasherTwoFlashesRequested)
 
     // Instantiate Flasher class
     MockForFlasherCreateInstance(pinNum);
-    Flasher testLed(pinNum);
+    Flasher testLed(pinNum, &wheel);
     testLed.stopAfter(numFlashes);
     CHECK(IsDigitalPinLow(pinNum));
 
     for (int i = 0; i < 2; i++)
     {
-        RunMockLedFlashCycle(&testLed, pinNum, DEFAULT_ON_TIME, DEFAULT_OFF_TIME);
+        RunMockLedFlashCycle(pinNum, DEFAULT_ON_TIME, DEFAULT_OFF_TIME);
     }
     /*
      After doing the required number of flashes, the led should be off all the
-     time. Updating led now should not do anything - not even call millis. All
-     the flashes have been done. Just sit pretty.
+     time. The timer isn't started again so there's nothing left on the wheel
+     and no more writes to the pin. All the flashes have been done. Just sit
+     pretty.
      */
+    CHECK_EQUAL(TIMER_WHEEL_IDLE, TimerWheel_TimeToNext(&wheel));
 
     // Fast forward to end of the off period
-    mockMillis += DEFAULT_OFF_TIME + 1U;
-    
-    // Check that the led is still off at the after another off period
-    testLed.update();
+    AdvanceTime(DEFAULT_OFF_TIME + 1U);
     CHECK(IsDigitalPinLow(pinNum));
 
     // fast forward to the end of the on period
-    mockMillis += DEFAULT_ON_TIME;
-
-    // led should still be off
-    testLed.update();
-    CHECK(IsDigitalPinLow(pinNum));
-    //...a bit more time passes and we're now in the next off period
-    mockMillis += 1U;
-    testLed.update();
+    AdvanceTime(DEFAULT_ON_TIME + 1U);
     CHECK(IsDigitalPinLow(pinNum));
     // Finally check the mock function calls match expectations
     mock().checkExpectations();
-}
\ No newline at end of file
+}
+
+// Once stopped the led can be asked to flash again
+TEST(LedFlashTestGroup, FlasherFlashesAgainAfterStopping)
+{
+    const int pinNum = 2;
+
+    // Instantiate Flasher class
+    MockForFlasherCreateInstance(pinNum);
+    Flasher testLed(pinNum, &wheel);
+    testLed.stopAfter(1);
+    RunMockLedFlashCycle(pinNum, DEFAULT_ON_TIME, DEFAULT_OFF_TIME);
+    AdvanceTime(DEFAULT_OFF_TIME);
+    CHECK(IsDigitalPinLow(pinNum));
+
+    testLed.stopAfter(1);
+    RunMockLedFlashCycle(pinNum, DEFAULT_ON_TIME, DEFAULT_OFF_TIME);
+    CHECK_EQUAL(TIMER_WHEEL_IDLE, TimerWheel_TimeToNext(&wheel));
+}
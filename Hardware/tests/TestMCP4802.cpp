@@ -31,6 +31,8 @@ typedef struct mockDacState_s {
 
 // DAC object storing settings and status of the whole device
 static mockDacState_t mockDac;
+// driver state for the device under test
+static MCP4802_t dac;
 
 /* Mock spi buffers used in transferring data
 TODO: move to mockSpiState defined in MockSpiCommon.cpp */
@@ -53,7 +55,8 @@ static void ResetMockSpiBuffers(void)
 // Checks the contets of the spi settings data agrees with private data
 static void CheckSpiSettings(const SpiSettings_t *settings)
 {
-    CHECK_EQUAL(CS_DELAY, settings->chipSelectDelay);
+    CHECK_EQUAL(CS_SETUP_US, settings->chipSelectSetup);
+    CHECK_EQUAL(CS_HOLD_US, settings->chipSelectHold);
     CHECK_EQUAL(SPI_CLOCK_SPEED, settings->clockSpeed);
     CHECK_EQUAL(SPI_BIT_ORDER, settings->bitOrder);
     CHECK_EQUAL(SPI_DATA_MODE, settings->dataMode);
@@ -122,20 +125,26 @@ static void SetupMockSpiConnection(const SpiSettings_t *settings)
 /*******************************************************************************
  * Mock function implementations for tests
  ******************************************************************************/
-// Mocks needed for writing data into mock spi reg
-static void MockForMCP4802Write(uint16_t data)
+// Mocks needed for writing data into mock spi reg of the given device
+static void MockForMCP4802WriteTo(MCP4802_t const *const device, uint16_t data)
 {
     const uint8_t msb = (data >> 8U) & 0xFF;
     const uint8_t lsb = data & 0xFF;
 
     mock().expectOneCall("OpenSpiConnection")
-        .withParameter("settings", &MCP4802SpiSettings);
+        .withParameter("settings", (void *)&device->spi);
     mock().expectOneCall("SpiTransferByte")
         .withParameter("byteToSpiBus", msb);
     mock().expectOneCall("SpiTransferByte")
         .withParameter("byteToSpiBus", lsb);
     mock().expectOneCall("CloseSpiConnection")
-        .withParameter("settings", &MCP4802SpiSettings);
+        .withParameter("settings", (void *)&device->spi);
+}
+
+// ...and of the device under test
+static void MockForMCP4802Write(uint16_t data)
+{
+    MockForMCP4802WriteTo(&dac, data);
 }
 
 // Contains commands for mocks for calls to init function
@@ -163,7 +172,7 @@ TEST_GROUP(MCP4802TestGroup)
 {
     void setup(void)
     {
-        InitialiseMockSpiBus(&MCP4802SpiSettings);
+        InitialiseMockSpiBus(&dac.spi);
         
         SpiTransferByte_Callback = &TransferMockSpiData;
         OpenSpiConnection_Callback = &SetupMockSpiConnection;
@@ -184,10 +193,10 @@ TEST_GROUP(MCP4802TestGroup)
 TEST(MCP4802TestGroup, InitOk)
 {
     const uint8_t pinNum = 2U;
-    CHECK_EQUAL(0xFF, MCP4802SpiSettings.chipSelectPin);
+    CHECK_EQUAL(0xFF, dac.spi.chipSelectPin);
 
     MockForMCP4802Init(pinNum);
-    MCP4802_Init(pinNum);
+    MCP4802_Init(&dac, pinNum);
 
     CHECK_EQUAL(lowGain, mockDac.gainMode);
     CHECK_EQUAL(0U, mockDac.chA.output);
@@ -206,23 +215,23 @@ TEST(MCP4802TestGroup, InitOk)
 TEST(MCP4802TestGroup, SetChAandChBWithOutputOnLowGain)
 {
     const uint8_t pinNum = 2U;
-    CHECK_EQUAL(0xFF, MCP4802SpiSettings.chipSelectPin);
+    CHECK_EQUAL(0xFF, dac.spi.chipSelectPin);
 
     // initialise the Dac
     MockForMCP4802Init(pinNum);
-    MCP4802_Init(pinNum);
+    MCP4802_Init(&dac, pinNum);
 
     // Set arbitrary output code to both channels
     const uint8_t outputExpected = 116U;
     MockForMCP4802Write(
         MCP4802_GetDacCommand(chASelect, lowGain, shdnOff, outputExpected));
 
-    MCP4802_Output(outputExpected, chASelect);
+    MCP4802_Output(&dac, outputExpected, chASelect);
 
     MockForMCP4802Write(
         MCP4802_GetDacCommand(chBSelect, lowGain, shdnOff, outputExpected));
 
-    MCP4802_Output(outputExpected, chBSelect);
+    MCP4802_Output(&dac, outputExpected, chBSelect);
 
     CHECK_EQUAL(lowGain, mockDac.gainMode);
     CHECK_EQUAL(outputExpected, mockDac.chA.output);
@@ -242,29 +251,29 @@ TEST(MCP4802TestGroup, SetChAandChBWithOutputOnLowGain)
 TEST(MCP4802TestGroup, SetChAandChBWithOutputOnHighGain)
 {
     const uint8_t pinNum = 4U;
-    CHECK_EQUAL(0xFF, MCP4802SpiSettings.chipSelectPin);
+    CHECK_EQUAL(0xFF, dac.spi.chipSelectPin);
 
     // initialise the mock dac object
     MockForMCP4802Init(pinNum);
-    MCP4802_Init(pinNum);
+    MCP4802_Init(&dac, pinNum);
 
     // Set arbitrary output code to both channels and gain
     const uint8_t outputExpected = 78U;
     const gainSelect_t gainExpected = highGain;
-    MCP4802_SetGain(gainExpected);
+    MCP4802_SetGain(&dac, gainExpected);
     
     MockForMCP4802Write(
         MCP4802_GetDacCommand(chASelect, highGain, shdnOff, outputExpected));
 
-    MCP4802_Output(outputExpected, chASelect);
+    MCP4802_Output(&dac, outputExpected, chASelect);
 
     MockForMCP4802Write(
         MCP4802_GetDacCommand(chBSelect, highGain, shdnOff, outputExpected));
 
-    MCP4802_Output(outputExpected, chBSelect);
+    MCP4802_Output(&dac, outputExpected, chBSelect);
 
     CHECK_EQUAL(gainExpected, mockDac.gainMode);
-    CHECK_EQUAL(gainExpected, MCP4802_GetGain());
+    CHECK_EQUAL(gainExpected, MCP4802_GetGain(&dac));
 
     CHECK_EQUAL(outputExpected, mockDac.chA.output);
     CHECK_EQUAL(shdnOff, mockDac.chA.shdnMode);
@@ -281,11 +290,11 @@ TEST(MCP4802TestGroup, SetChAandChBWithOutputOnHighGain)
 TEST(MCP4802TestGroup, SetChAOutputOffChBShouldBeOn)
 {
     const uint8_t pinNum = 3U;
-    CHECK_EQUAL(0xFF, MCP4802SpiSettings.chipSelectPin);
+    CHECK_EQUAL(0xFF, dac.spi.chipSelectPin);
 
     // initialise the mock dac object
     MockForMCP4802Init(pinNum);
-    MCP4802_Init(pinNum);
+    MCP4802_Init(&dac, pinNum);
 
     const uint8_t outputExpected = 0U;
     CHECK_EQUAL(outputExpected, mockDac.chA.output);
@@ -296,7 +305,7 @@ TEST(MCP4802TestGroup, SetChAOutputOffChBShouldBeOn)
     MockForMCP4802Write(
         MCP4802_GetDacCommand(chASelect, lowGain, shdnOn, outputExpected));
     // call function under test.
-    MCP4802_Shutdown(chASelect);
+    MCP4802_Shutdown(&dac, chASelect);
     // check that the shutdown is on for channel A and not B.
     CHECK_EQUAL(outputExpected, mockDac.chA.output);
     CHECK_EQUAL(shdnOn, mockDac.chA.shdnMode);
@@ -305,4 +314,43 @@ TEST(MCP4802TestGroup, SetChAOutputOffChBShouldBeOn)
     
     // check function calls
     mock().checkExpectations();
-}
\ No newline at end of file
+}
+
+/*
+ Test for a board with two dacs. Each sends on its own chip select and keeps its
+ own gain and last outputs.
+ */
+TEST(MCP4802TestGroup, TwoDacsKeepTheirOwnState)
+{
+    MCP4802_t secondDac;
+    const uint8_t pinNum = 2U;
+    const uint8_t secondPinNum = 5U;
+
+    MockForMCP4802Init(pinNum);
+    MCP4802_Init(&dac, pinNum);
+    mock().expectOneCall("InitChipSelectPin")
+        .withParameter("pin", secondPinNum);
+    MockForMCP4802WriteTo(&secondDac,
+        MCP4802_GetDacCommand(chASelect, lowGain, shdnOff, 0U));
+    MockForMCP4802WriteTo(&secondDac,
+        MCP4802_GetDacCommand(chBSelect, lowGain, shdnOff, 0U));
+    MCP4802_Init(&secondDac, secondPinNum);
+    CHECK_EQUAL(secondPinNum, secondDac.spi.chipSelectPin);
+
+    MCP4802_SetGain(&secondDac, highGain);
+    MockForMCP4802Write(
+        MCP4802_GetDacCommand(chASelect, lowGain, shdnOff, 45U));
+    MCP4802_Output(&dac, 45U, chASelect);
+    MockForMCP4802WriteTo(&secondDac,
+        MCP4802_GetDacCommand(chASelect, highGain, shdnOff, 90U));
+    MCP4802_Output(&secondDac, 90U, chASelect);
+
+    CHECK_EQUAL(lowGain, MCP4802_GetGain(&dac));
+    CHECK_EQUAL(highGain, MCP4802_GetGain(&secondDac));
+    CHECK_EQUAL(45U, MCP4802_GetOutput(&dac, chASelect));
+    CHECK_EQUAL(90U, MCP4802_GetOutput(&secondDac, chASelect));
+    CHECK_EQUAL(0U, MCP4802_GetOutput(&secondDac, chBSelect));
+
+    // check function calls
+    mock().checkExpectations();
+}
@@ -5,7 +5,7 @@
 
 // Code under test
 #include "MX7705.h"
-#include "MX7705Private.h" // defines and mx7705SpiSettings
+#include "MX7705Private.h" // defines
 
 // support
 #include "Arduino.h"       // arduino function prototypes - implemented MockAduino.c
@@ -53,12 +53,14 @@ typedef struct AdcIoRegisters_s {
 } AdcIoRegisters_t;
 
 static AdcIoRegisters_t mx7705Adc; 
+static MX7705_t         adc;       // driver state for the device under test
 static uint32_t mockMillis;
 /* Mock spi buffers used in transferring data
 TODO: move to mockSpiState defined in MockSpiCommon.cpp */
 static uint8_t inputBuffer[BUFFER_SIZE];
 static uint8_t outputBuffer[BUFFER_SIZE];
 static uint8_t counter;
+static uint8_t bytesPending; // register bytes still to follow the comms byte
 
 // Used to mock read error for verification failure in init for example.
 static bool mockReadError = false;
@@ -119,24 +121,13 @@ static uint8_t GetChannel(uint8_t commsReg)
 // Checks the contets of the spi settings data agrees with private data
 static void CheckSpiSettings(const SpiSettings_t *settings)
 {
-    CHECK_EQUAL(CS_DELAY_ADC, settings->chipSelectDelay);
+    CHECK_EQUAL(CS_SETUP_ADC_US, settings->chipSelectSetup);
+    CHECK_EQUAL(CS_HOLD_ADC_US, settings->chipSelectHold);
     CHECK_EQUAL(SPI_CLOCK_SPEED, settings->clockSpeed);
     CHECK_EQUAL(SPI_BIT_ORDER, settings->bitOrder);
     CHECK_EQUAL(SPI_DATA_MODE, settings->dataMode);
 }
 
-/*
- Manages commands transferred to the spi bus and data is returned to the output.
- A pointer to this function is passed to the source when SpiTransferByte is called.
- */
-static uint8_t TransferMockSpiData(uint8_t byteReceived)
-{
-    inputBuffer[counter] = byteReceived;
-    const uint8_t retVal = outputBuffer[counter];
-    counter++;
-    return retVal;
-}
-
 /*
  Loads data (digital converted voltage) in the adc object from the selected 
  channel (comms register) into the output buffer. 
@@ -196,79 +187,54 @@ static void UpdateMeasurementStatus(void)
     }
 }
 
-// write the data from the input buffer into the io registers
-static void TeardownMockSpiConnection(const SpiSettings_t *settings)
+// Number of bytes that follow a comms byte addressing the given register
+static uint8_t GetRegisterBytes(RegisterSelection_t reg)
 {
-    CheckSpiSettings(settings);
+    return (reg == DataReg) ? DATA_REG_BYTES : SETUP_REG_BYTES;
+}
 
+// write the data from the input buffer into the io registers
+static void WriteMockRegister(void)
+{
     const RegisterSelection_t regRequest = 
         GetRequestedRegister(mx7705Adc.commsReg);
+    const uint8_t ch = GetChannel(mx7705Adc.commsReg);
 
-    if (IsReadOp(mx7705Adc.commsReg))
+    switch (regRequest)
     {
-        // Command done so reset the register.
-        mx7705Adc.commsReg = 0U;
-    }
-    else //writeop, then data is copied into the relevant reg from inputBuffer
-    {
-        const uint8_t ch = GetChannel(mx7705Adc.commsReg);
-        switch (regRequest)
-        {
-            case CommsReg:
-                /*
-                 Write requested into comms reg - copy from bytes captured in the
-                 mock spi input buffer
-                 Is this accurate. If several bytes are written what will end up in the comms reg?
-                */
-                mx7705Adc.commsReg = inputBuffer[0U]; 
-
-                // No need to reset the register as we've just written in a command.
-                break;
-            case SetupReg:
-                /*write requested into other reg - copy from byte(s) captured in the
-                mock spi input buffer*/
-                mx7705Adc.setupReg[ch] = inputBuffer[0U];
-                // Command done so reset the register.
-                mx7705Adc.commsReg = 0U;
-                break;
-            case ClockReg:
-                mx7705Adc.clockReg[ch] = inputBuffer[0U];
-                // Command done so reset the register.
-                mx7705Adc.commsReg = 0U;
-                break;
-            case DataReg:
-                // You can write to the data register but this is ignored.
-                mx7705Adc.dataReg[ch] = 
-                    (uint16_t)((inputBuffer[0U] << 8U) | inputBuffer[1U]);
-                // Command done so reset the register.
-                mx7705Adc.commsReg = 0U;
-                break;
-            default:
-                FAIL("Register request not implemented.");
-                break;
-        }
+        case SetupReg:
+            /*write requested into other reg - copy from byte(s) captured in the
+            mock spi input buffer*/
+            mx7705Adc.setupReg[ch] = inputBuffer[0U];
+            break;
+        case ClockReg:
+            mx7705Adc.clockReg[ch] = inputBuffer[0U];
+            break;
+        case DataReg:
+            // You can write to the data register but this is ignored.
+            mx7705Adc.dataReg[ch] = 
+                (uint16_t)((inputBuffer[0U] << 8U) | inputBuffer[1U]);
+            break;
+        default:
+            FAIL("Register request not implemented.");
+            break;
     }
 }
 
-// Loads data into the spi output buffer if a read is requested in the comms reg
-static void SetupMockSpiConnection(const SpiSettings_t *settings)
-{
-    CheckSpiSettings(settings);
-    ResetMockSpiBuffers();
-
-    const RegisterSelection_t regRequest = GetRequestedRegister(mx7705Adc.commsReg);
+/*
+ Loads data into the spi output buffer if a read is requested in the comms reg.
 
-    /* 
-     If it's a readOp, then load data into the required spi output buffer. 
-     
-     Mocking of data ready (DRDY) bit 7 of comms reagister is implemented here. 
-     Ready bit set to 1 when conversion has finished. And data is ready to be 
-     read from the data reg. 
+ Mocking of data ready (DRDY) bit 7 of comms reagister is implemented here. 
+ Ready bit set to 1 when conversion has finished. And data is ready to be 
+ read from the data reg. 
 
-     Read error is mocked by preventing data being copied into spi output.
-     */
+ Read error is mocked by preventing data being copied into spi output.
+ */
+static void LoadMockRegister(void)
+{
+    const RegisterSelection_t regRequest = GetRequestedRegister(mx7705Adc.commsReg);
 
-    if (IsReadOp(mx7705Adc.commsReg) && !mockReadError)
+    if (!mockReadError)
     {
         const uint8_t ch = GetChannel(mx7705Adc.commsReg);
         switch (regRequest)
@@ -308,63 +274,115 @@ static void SetupMockSpiConnection(const SpiSettings_t *settings)
     }
 }
 
+/*
+ Manages commands transferred to the spi bus and data is returned to the output.
+ A pointer to this function is passed to the source when SpiTransferByte is called.
+ The first byte of each register access is written into the comms reg and
+ addresses the register that the following bytes are read from or written to.
+ */
+static uint8_t TransferMockSpiData(uint8_t byteReceived)
+{
+    if (bytesPending == 0U)
+    {
+        ResetMockSpiBuffers();
+        mx7705Adc.commsReg = byteReceived;
+        bytesPending = GetRegisterBytes(GetRequestedRegister(byteReceived));
+        if (IsReadOp(byteReceived))
+        {
+            LoadMockRegister();
+        }
+        return 0U;
+    }
+
+    inputBuffer[counter] = byteReceived;
+    const uint8_t retVal = outputBuffer[counter];
+    counter++;
+    bytesPending--;
+    if (bytesPending == 0U)
+    {
+        if (!IsReadOp(mx7705Adc.commsReg))
+        {
+            WriteMockRegister();
+        }
+        // Command done so reset the register.
+        mx7705Adc.commsReg = 0U;
+    }
+    return retVal;
+}
+
+// Register accesses must not be split across chip select transactions
+static void TeardownMockSpiConnection(const SpiSettings_t *settings)
+{
+    CheckSpiSettings(settings);
+    CHECK_EQUAL(0U, bytesPending);
+}
+
+static void SetupMockSpiConnection(const SpiSettings_t *settings)
+{
+    CheckSpiSettings(settings);
+    CHECK_EQUAL(0U, bytesPending);
+}
+
 /*******************************************************************************
  * Mock function implementations for tests
  ******************************************************************************/
 
-// Mocks needed for writing data into mock spi reg
-static void MockForMX7705Write(uint8_t sendByte)
+// Mocks needed for writing a register in a single transaction
+static void MockForMX7705WriteReg(uint8_t command, uint8_t sendByte)
 {
     mock().expectOneCall("OpenSpiConnection")
-        .withParameter("settings", &mx7705SpiSettings);
+        .withParameter("settings", &adc.spi);
+    mock().expectOneCall("SpiTransferByte")
+        .withParameter("byteToSpiBus", command);
     mock().expectOneCall("SpiTransferByte")
         .withParameter("byteToSpiBus", sendByte);
     mock().expectOneCall("CloseSpiConnection")
-        .withParameter("settings", &mx7705SpiSettings);
+        .withParameter("settings", &adc.spi);
 }
 
-// Mocks needed for reading single byte data from mock spi reg
-static uint8_t MockForMX7705Read(void)
+// Mocks needed for reading a single byte register in a single transaction
+static void MockForMX7705ReadReg8(uint8_t command)
 {
     mock().expectOneCall("OpenSpiConnection")
-        .withParameter("settings", &mx7705SpiSettings);
+        .withParameter("settings", &adc.spi);
+    mock().expectOneCall("SpiTransferByte")
+        .withParameter("byteToSpiBus", command);
     mock().expectOneCall("SpiTransferByte")
         .withParameter("byteToSpiBus", 0U);
     mock().expectOneCall("CloseSpiConnection")
-        .withParameter("settings", &mx7705SpiSettings);
+        .withParameter("settings", &adc.spi);
 }
 
-// Mocks needed for reading data from mock spi reg
-static uint16_t MockForMX7705Read16Bit(void)
+// Mocks needed for reading the 16 bit data register in a single transaction
+static void MockForMX7705ReadReg16(uint8_t command)
 {
     mock().expectOneCall("OpenSpiConnection")
-        .withParameter("settings", &mx7705SpiSettings);
+        .withParameter("settings", &adc.spi);
+    mock().expectOneCall("SpiTransferByte")
+        .withParameter("byteToSpiBus", command);
     mock().expectOneCall("SpiTransferByte")
         .withParameter("byteToSpiBus", 0U);
     mock().expectOneCall("SpiTransferByte")
         .withParameter("byteToSpiBus", 0U);
     mock().expectOneCall("CloseSpiConnection")
-        .withParameter("settings", &mx7705SpiSettings);
+        .withParameter("settings", &adc.spi);
 }
 
 // Mocks for calling MX7705_Init
 static void MockForMX7705Init(uint8_t channel)
 {
-    MockForMX7705Write(RequestRegWrite(ClockReg, channel));
-    MockForMX7705Write(SetClockSettings(true, false, false, 1U));
-    MockForMX7705Write(RequestRegWrite(SetupReg, channel));
-    MockForMX7705Write(SetSetupSettings(SelfCalibMode, 0U, true, false, false));
-    MockForMX7705Write(RequestRegRead(ClockReg, channel));
-    MockForMX7705Read();
-    MockForMX7705Write(RequestRegRead(SetupReg, channel));
-    MockForMX7705Read();
+    MockForMX7705WriteReg(RequestRegWrite(ClockReg, channel),
+                          SetClockSettings(true, false, false, 1U));
+    MockForMX7705WriteReg(RequestRegWrite(SetupReg, channel),
+                          SetSetupSettings(SelfCalibMode, 0U, true, false, false));
+    MockForMX7705ReadReg8(RequestRegRead(ClockReg, channel));
+    MockForMX7705ReadReg8(RequestRegRead(SetupReg, channel));
 }
 
 // Mocks for calling read data function
 static void MockForMX7705DataRead(uint8_t channel)
 {   
-    MockForMX7705Write(RequestRegRead(DataReg, channel));
-    MockForMX7705Read16Bit();        
+    MockForMX7705ReadReg16(RequestRegRead(DataReg, channel));
 }
 
 // Mocks for polling comms reg on the specified channel
@@ -385,30 +403,18 @@ static void MockForMX7705Polling(uint8_t channel)
     {
         mock().expectOneCall("millis")
             .andReturnValue(mockMillis);
-        MockForMX7705Write(RequestRegRead(CommsReg, channel));
-        MockForMX7705Read();        
+        MockForMX7705ReadReg8(RequestRegRead(CommsReg, channel));        
         mockMillis += roundtripTime;
     }
 }    
 
-// Mocks for calling get gain  
-static void MockForMX7705GetGain(uint8_t channel)
-{
-    MockForMX7705Write(RequestRegRead(SetupReg, channel));
-    // MockForMX7705Write(MX7705_REQUEST_SETUP_READ_CH0);
-    MockForMX7705Read();
-}
-
 /*
- Mocks for calling get gain - note that the setup register is read, altered
- and then rewritten when we get gain so we need access to the adc object.
+ Mocks for calling set gain - the gain is changed in the driver's shadow of the
+ setup register which is then written to the adc. Get gain doesn't use the bus.
 */
 static void MockForMX7705SetGain(uint8_t channel, uint8_t newSetupReg)
 {
-    MockForMX7705Write(RequestRegRead(SetupReg, channel));
-    MockForMX7705Read();
-    MockForMX7705Write(RequestRegWrite(SetupReg, channel));
-    MockForMX7705Write(newSetupReg);
+    MockForMX7705WriteReg(RequestRegWrite(SetupReg, channel), newSetupReg);
 }
 
 /*******************************************************************************
@@ -419,8 +425,10 @@ TEST_GROUP(MX7705TestGroup)
 {
     void setup(void)
     {
-        InitialiseMockSpiBus(&mx7705SpiSettings);
+        InitialiseMockSpiBus(&adc.spi);
         InitAdcRegsData();
+        ResetMockSpiBuffers();
+        bytesPending = 0U;
         mockMillis = 0U;
         elapsedTime = 0U;
         
@@ -451,14 +459,14 @@ TEST(MX7705TestGroup, InitialiseAdcChannelZero)
     const uint8_t pinNum = 1U;
     const uint8_t channel = 0U;
     
-    CHECK_EQUAL(0xFF, mx7705SpiSettings.chipSelectPin);
+    CHECK_EQUAL(0xFF, adc.spi.chipSelectPin);
     // Mock calls to low level spi function
     mock().expectOneCall("InitChipSelectPin")
         .withParameter("pin", pinNum);
     
     MockForMX7705Init(channel);
 
-    MX7705_Init(pinNum, channel);
+    MX7705_Init(&adc, pinNum, channel);
 
     const uint8_t clockRegExp = MX7705_WRITE_CLOCK_SETTINGS;
     const uint8_t clockRegAct = mx7705Adc.clockReg[channel];
@@ -468,27 +476,47 @@ TEST(MX7705TestGroup, InitialiseAdcChannelZero)
     const uint8_t setupRegAct = mx7705Adc.setupReg[channel];
     CHECK_EQUAL(setupRegExp, setupRegAct);
 
-    CHECK_EQUAL(false, MX7705_GetError()); 
-    CHECK_EQUAL(pinNum, mx7705SpiSettings.chipSelectPin = pinNum);
+    CHECK_EQUAL(false, MX7705_GetError(&adc)); 
+    CHECK_EQUAL(pinNum, adc.spi.chipSelectPin = pinNum);
 
     // check function calls
     mock().checkExpectations();
 }
 
+// Conversion time comes from the clock settings - 25Hz after init at 1MHz
+TEST(MX7705TestGroup, ConversionTimeFollowsClockSettings)
+{
+    const uint8_t channel = 0U;
+    mock().expectOneCall("InitChipSelectPin")
+        .withParameter("pin", 1U);
+    MockForMX7705Init(channel);
+    MX7705_Init(&adc, 1U, channel);
+    CHECK_EQUAL(40U, MX7705_GetConversionTime(&adc, channel));
+
+    // CLK = 1, FS = 11 is 500Hz at 2.4576MHz
+    adc.clockShadow[channel] = B00000111;
+    CHECK_EQUAL(2U, MX7705_GetConversionTime(&adc, channel));
+    // CLK = 1, FS = 01 is 60Hz - rounded up
+    adc.clockShadow[channel] = B00000101;
+    CHECK_EQUAL(17U, MX7705_GetConversionTime(&adc, channel));
+
+    mock().checkExpectations();
+}
+
 // Test for initialising MX7705 device on channel 1.
 TEST(MX7705TestGroup, InitialiseAdcChannelOne)
 {
     const uint8_t pinNum = 1U;
     const uint8_t channel = 1U;
     
-    CHECK_EQUAL(0xFF, mx7705SpiSettings.chipSelectPin);
+    CHECK_EQUAL(0xFF, adc.spi.chipSelectPin);
     // Mock calls to low level spi function
     mock().expectOneCall("InitChipSelectPin")
         .withParameter("pin", pinNum);
     
     MockForMX7705Init(channel);
 
-    MX7705_Init(pinNum, channel);
+    MX7705_Init(&adc, pinNum, channel);
 
     const uint8_t clockRegExp = MX7705_WRITE_CLOCK_SETTINGS;
     const uint8_t clockRegAct = mx7705Adc.clockReg[channel];
@@ -498,8 +526,8 @@ TEST(MX7705TestGroup, InitialiseAdcChannelOne)
     const uint8_t setupRegAct = mx7705Adc.setupReg[channel];
     CHECK_EQUAL(setupRegExp, setupRegAct);
 
-    CHECK_EQUAL(false, MX7705_GetError()); 
-    CHECK_EQUAL(pinNum, mx7705SpiSettings.chipSelectPin);
+    CHECK_EQUAL(false, MX7705_GetError(&adc)); 
+    CHECK_EQUAL(pinNum, adc.spi.chipSelectPin);
 
     // check function calls
     mock().checkExpectations();
@@ -514,7 +542,7 @@ TEST(MX7705TestGroup, InitialiseAdcChannelOneVerifyFail)
     const uint8_t pinNum = 1U;
     const uint8_t channel = 1U;
     
-    CHECK_EQUAL(0xFF, mx7705SpiSettings.chipSelectPin);
+    CHECK_EQUAL(0xFF, adc.spi.chipSelectPin);
     // Mock calls to low level spi function
     mock().expectOneCall("InitChipSelectPin")
         .withParameter("pin", pinNum);
@@ -524,11 +552,11 @@ TEST(MX7705TestGroup, InitialiseAdcChannelOneVerifyFail)
     // allows us to mock a read fail which triggers verification fail
     mockReadError = true;
     // call function under test
-    MX7705_Init(pinNum, channel);
+    MX7705_Init(&adc, pinNum, channel);
 
-    CHECK_EQUAL(pinNum, mx7705SpiSettings.chipSelectPin);
+    CHECK_EQUAL(pinNum, adc.spi.chipSelectPin);
 
-    CHECK_EQUAL(true, MX7705_GetError()); 
+    CHECK_EQUAL(true, MX7705_GetError(&adc)); 
 
     // check function calls
     mock().checkExpectations();
@@ -549,9 +577,9 @@ TEST(MX7705TestGroup, ReadDataChZeroOkPollingDrdyBit)
     
     MockForMX7705Init(channel);
     
-    MX7705_Init(pinNum, channel);
+    MX7705_Init(&adc, pinNum, channel);
     // Initialise should be successful and no error raised
-    CHECK_EQUAL(false, MX7705_GetError()); 
+    CHECK_EQUAL(false, MX7705_GetError(&adc)); 
 
     // Mocks needed to call function under test
     MockForMX7705Polling(channel);
@@ -559,9 +587,9 @@ TEST(MX7705TestGroup, ReadDataChZeroOkPollingDrdyBit)
 
     // Set an input to the adc and call function under test
     adcInput = 25667U;
-    CHECK_EQUAL(adcInput, MX7705_ReadData(channel));
+    CHECK_EQUAL(adcInput, MX7705_ReadData(&adc, channel));
     // expect error condition due to measurement timeout
-    CHECK_EQUAL(false, MX7705_GetError()); 
+    CHECK_EQUAL(false, MX7705_GetError(&adc)); 
 
     // check function calls
     mock().checkExpectations();
@@ -582,25 +610,25 @@ TEST(MX7705TestGroup, ReadDataChOneOkPollingDrdyBit)
     
     MockForMX7705Init(channel);
     
-    MX7705_Init(pinNum, channel);
+    MX7705_Init(&adc, pinNum, channel);
     // Initialise should be successful and no error raised
-    CHECK_EQUAL(false, MX7705_GetError()); 
+    CHECK_EQUAL(false, MX7705_GetError(&adc)); 
 
     // Check that there is no data in the Adc data reg to begin with
     MockForMX7705Polling(channel);
     MockForMX7705DataRead(channel);
     CHECK_EQUAL(0U, adcInput);
-    CHECK_EQUAL(adcInput, MX7705_ReadData(channel));
+    CHECK_EQUAL(adcInput, MX7705_ReadData(&adc, channel));
     // expect error condition due to measurement timeout
-    CHECK_EQUAL(false, MX7705_GetError());     
+    CHECK_EQUAL(false, MX7705_GetError(&adc));     
 
     // Set an input to the adc and call function under test
     MockForMX7705Polling(channel);
     MockForMX7705DataRead(channel);
     adcInput = 25667U;
-    CHECK_EQUAL(adcInput, MX7705_ReadData(channel));
+    CHECK_EQUAL(adcInput, MX7705_ReadData(&adc, channel));
     // expect error condition due to measurement timeout
-    CHECK_EQUAL(false, MX7705_GetError()); 
+    CHECK_EQUAL(false, MX7705_GetError(&adc)); 
 
     // check function calls
     mock().checkExpectations();
@@ -621,9 +649,9 @@ TEST(MX7705TestGroup, ReadDataChZeroPollingTimeoutErrorCondition)
     
     MockForMX7705Init(channel);
     
-    MX7705_Init(pinNum, channel);
+    MX7705_Init(&adc, pinNum, channel);
     // Initialise should be successful and no error raised
-    CHECK_EQUAL(false, MX7705_GetError()); 
+    CHECK_EQUAL(false, MX7705_GetError(&adc)); 
 
     // mock input
     adcInput = 2456U;
@@ -638,12 +666,12 @@ TEST(MX7705TestGroup, ReadDataChZeroPollingTimeoutErrorCondition)
     const uint16_t dataToExpect = mx7705Adc.dataReg[channel];
 
     // Call funtion under test and record as actual data
-    const uint16_t dataActual = MX7705_ReadData(channel);
+    const uint16_t dataActual = MX7705_ReadData(&adc, channel);
     
     // compare expected and actual data
     CHECK_EQUAL(dataToExpect, dataActual);
     // expect error condition due to measurement timeout
-    CHECK_EQUAL(true, MX7705_GetError());     
+    CHECK_EQUAL(true, MX7705_GetError(&adc));     
 
     // check function calls
     mock().checkExpectations();
@@ -664,9 +692,9 @@ TEST(MX7705TestGroup, ReadDataChOnePollingTimeoutErrorCondition)
     
     MockForMX7705Init(channel);
     
-    MX7705_Init(pinNum, channel);
+    MX7705_Init(&adc, pinNum, channel);
     // Initialise should be successful and no error raised
-    CHECK_EQUAL(false, MX7705_GetError()); 
+    CHECK_EQUAL(false, MX7705_GetError(&adc)); 
 
     // mock input
     adcInput = 2456U;
@@ -681,12 +709,104 @@ TEST(MX7705TestGroup, ReadDataChOnePollingTimeoutErrorCondition)
     const uint16_t dataToExpect = mx7705Adc.dataReg[channel];
 
     // Call funtion under test and record as actual data
-    const uint16_t dataActual = MX7705_ReadData(channel);
+    const uint16_t dataActual = MX7705_ReadData(&adc, channel);
     
     // compare expected and actual data
     CHECK_EQUAL(dataToExpect, dataActual);
     // expect error condition due to measurement timeout
-    CHECK_EQUAL(true, MX7705_GetError());     
+    CHECK_EQUAL(true, MX7705_GetError(&adc));     
+
+    // check function calls
+    mock().checkExpectations();
+}
+
+/*
+ Non-blocking read on channel 0. Each call to poll checks DRDY once and returns
+ busy until the conversion is done. Data is then collected with complete read.
+ */
+TEST(MX7705TestGroup, StartPollCompleteReadChZeroReturnsBusyUntilReady)
+{
+    const uint8_t pinNum = 2U;
+    const uint8_t channel = 0U;
+    
+    // Mock calls to low level spi function
+    mock().expectOneCall("InitChipSelectPin")
+        .withParameter("pin", pinNum);
+    
+    MockForMX7705Init(channel);
+    
+    MX7705_Init(&adc, pinNum, channel);
+    CHECK_EQUAL(false, MX7705_GetError(&adc)); 
+
+    adcInput = 25667U;
+    mock().expectOneCall("millis")
+        .andReturnValue(mockMillis);
+    MX7705_StartRead(&adc, channel);
+    mock().checkExpectations();
+
+    // Poll once per call until the conversion is ready
+    MX7705ReadStatus_t status;
+    uint16_t nPolls = 0U;
+    do
+    {
+        mock().expectOneCall("millis")
+            .andReturnValue(mockMillis);
+        MockForMX7705ReadReg8(RequestRegRead(CommsReg, channel));
+        status = MX7705_PollRead(&adc, channel);
+        nPolls++;
+        mock().checkExpectations();
+    } while ((status == MX7705ReadBusy) && (nPolls <= (TIMEOUT_MS / roundtripTime)));
+
+    CHECK_EQUAL(MX7705ReadReady, status);
+    CHECK(nPolls > 1U);
+    CHECK_EQUAL(nPolls, MX7705_GetPollCount(&adc));
+
+    MockForMX7705DataRead(channel);
+    CHECK_EQUAL(adcInput, MX7705_CompleteRead(&adc, channel));
+    CHECK_EQUAL(false, MX7705_GetError(&adc)); 
+
+    // check function calls
+    mock().checkExpectations();
+}
+
+/*
+ Verify reads back the setup and clock registers and compares them with the
+ shadow. A device reset to power on defaults is detected and resync restores
+ the registers and starts a self calibration.
+ */
+TEST(MX7705TestGroup, VerifyDetectsResetAndResyncRestoresRegisters)
+{
+    const uint8_t pinNum = 1U;
+    const uint8_t channel = 1U;
+    
+    mock().expectOneCall("InitChipSelectPin")
+        .withParameter("pin", pinNum);
+    MockForMX7705Init(channel);
+    MX7705_Init(&adc, pinNum, channel);
+    CHECK_EQUAL(false, MX7705_GetError(&adc)); 
+
+    // Registers match the shadow
+    MockForMX7705ReadReg8(RequestRegRead(ClockReg, channel));
+    MockForMX7705ReadReg8(RequestRegRead(SetupReg, channel));
+    CHECK_EQUAL(true, MX7705_Verify(&adc, channel));
+    CHECK_EQUAL(false, MX7705_GetError(&adc)); 
+
+    // Device resets to power on defaults
+    InitAdcRegsData();
+    MockForMX7705ReadReg8(RequestRegRead(ClockReg, channel));
+    MockForMX7705ReadReg8(RequestRegRead(SetupReg, channel));
+    CHECK_EQUAL(false, MX7705_Verify(&adc, channel));
+    CHECK_EQUAL(true, MX7705_GetError(&adc)); 
+
+    // Resync writes the same registers as init
+    MockForMX7705WriteReg(RequestRegWrite(ClockReg, channel),
+                          SetClockSettings(true, false, false, 1U));
+    MockForMX7705WriteReg(RequestRegWrite(SetupReg, channel),
+                          SetSetupSettings(SelfCalibMode, 0U, true, false, false));
+    MX7705_Resync(&adc, channel);
+    MockForMX7705ReadReg8(RequestRegRead(ClockReg, channel));
+    MockForMX7705ReadReg8(RequestRegRead(SetupReg, channel));
+    CHECK_EQUAL(true, MX7705_Verify(&adc, channel));
 
     // check function calls
     mock().checkExpectations();
@@ -704,19 +824,19 @@ TEST(MX7705TestGroup, SetGetGainChannelOne)
     
     MockForMX7705Init(channel);
     
-    MX7705_Init(pinNum, channel);
+    MX7705_Init(&adc, pinNum, channel);
 
-    // Mocks for calling get gain
-    MockForMX7705GetGain(channel);
 
     // Read the initial gain. Should match the settings stored in the setup reg
     const uint8_t setupRegInitial = mx7705Adc.setupReg[channel];
-    uint8_t gainActual = MX7705_GetGain(channel);
+    uint8_t gainActual = MX7705_GetGain(&adc, channel);
     uint8_t gainExpected = bitExtract(setupRegInitial, PGA_MASK, PGA_OFFSET);
     CHECK_EQUAL(gainExpected, gainActual);
 
-    // Work out the expected setup register after changing gain.
+    /* Work out the expected setup register after changing gain. Self calibration
+    mode written by init is cleared by the adc when it's done.*/
     uint8_t setupRegExpected = setupRegInitial;
+    bitInsert(setupRegExpected, NormalMode, MODE_MASK, MODE_OFFSET);
     // increment gain to be written back into the setup reg.
     gainExpected++;
     // write in the new gain
@@ -725,15 +845,13 @@ TEST(MX7705TestGroup, SetGetGainChannelOne)
     MockForMX7705SetGain(channel, setupRegExpected);
 
     // Call to set gain
-    MX7705_SetGain(gainExpected, channel);
+    MX7705_SetGain(&adc, gainExpected, channel);
     
     // Now call get gain again to check that the gain has actually been written.
 
-    // Mocks for calling get gain
-    MockForMX7705GetGain(channel);
 
     // check the gain returned matches gain requested
-    gainActual = MX7705_GetGain(channel);
+    gainActual = MX7705_GetGain(&adc, channel);
     CHECK_EQUAL(gainExpected, gainActual);
 
     // check that the setup register matches expectations
@@ -760,24 +878,20 @@ TEST(MX7705TestGroup, SetGetGainOutsideRangeCommandIgnoredChannelOne)
     
     MockForMX7705Init(channel);
     
-    MX7705_Init(pinNum, channel);
+    MX7705_Init(&adc, pinNum, channel);
 
     // Get the gain and setup reg data to begin with...
-    // Mocks for calling get gain
-    MockForMX7705GetGain(channel);
     const uint8_t setupRegInitial = mx7705Adc.setupReg[channel];
-    const uint8_t gainInitial = MX7705_GetGain(channel);
+    const uint8_t gainInitial = MX7705_GetGain(&adc, channel);
 
     // now request gain outside range
     const uint8_t gainRequested = PGA_MASK + 1U;
-    MX7705_SetGain(gainRequested, channel);
+    MX7705_SetGain(&adc, gainRequested, channel);
     
     // Get the gain and setup reg data again to compare against...
-    // Mocks for calling get gain
-    MockForMX7705GetGain(channel);
     // check the gain returned matches gain requested
     const uint8_t setupRegFinal = mx7705Adc.setupReg[channel];
-    const uint8_t gainFinal = MX7705_GetGain(channel);
+    const uint8_t gainFinal = MX7705_GetGain(&adc, channel);
 
     CHECK_EQUAL(gainFinal, gainInitial);
     CHECK_EQUAL(setupRegFinal, setupRegInitial);
@@ -798,19 +912,19 @@ TEST(MX7705TestGroup, SetGetGainChannelZero)
     
     MockForMX7705Init(channel);
     
-    MX7705_Init(pinNum, channel);
+    MX7705_Init(&adc, pinNum, channel);
 
-    // Mocks for calling get gain
-    MockForMX7705GetGain(channel);
 
     // Read the initial gain. Should match the settings stored in the setup reg
     const uint8_t setupRegInitial = mx7705Adc.setupReg[channel];
-    uint8_t gainActual = MX7705_GetGain(channel);
+    uint8_t gainActual = MX7705_GetGain(&adc, channel);
     uint8_t gainExpected = bitExtract(setupRegInitial, PGA_MASK, PGA_OFFSET);
     CHECK_EQUAL(gainExpected, gainActual);
 
-    // Work out the expected setup register after changing gain.
+    /* Work out the expected setup register after changing gain. Self calibration
+    mode written by init is cleared by the adc when it's done.*/
     uint8_t setupRegExpected = setupRegInitial;
+    bitInsert(setupRegExpected, NormalMode, MODE_MASK, MODE_OFFSET);
     // increment gain to be written back into the setup reg.
     gainExpected++;
     // write in the new gain
@@ -818,14 +932,12 @@ TEST(MX7705TestGroup, SetGetGainChannelZero)
     // mocks for calling set gain
     MockForMX7705SetGain(channel, setupRegExpected);
     // Call to set gain
-    MX7705_SetGain(gainExpected, channel);
+    MX7705_SetGain(&adc, gainExpected, channel);
     
     // Now call get gain again to check that the gain has actually been written.
 
-    // Mocks for calling get gain
-    MockForMX7705GetGain(channel);
     // check the gain returned matches gain requested
-    gainActual = MX7705_GetGain(channel);
+    gainActual = MX7705_GetGain(&adc, channel);
     CHECK_EQUAL(gainExpected, gainActual);
 
     // check that the setup register matches expectations
@@ -852,24 +964,20 @@ TEST(MX7705TestGroup, SetGetGainOutsideRangeCommandIgnoredChannelZero)
     
     MockForMX7705Init(channel);
     
-    MX7705_Init(pinNum, channel);
+    MX7705_Init(&adc, pinNum, channel);
 
     // Get the gain and setup reg data to begin with...
-    // Mocks for calling get gain
-    MockForMX7705GetGain(channel);
     const uint8_t setupRegInitial = mx7705Adc.setupReg[channel];
-    const uint8_t gainInitial = MX7705_GetGain(channel);
+    const uint8_t gainInitial = MX7705_GetGain(&adc, channel);
 
     // now request gain outside range
     const uint8_t gainRequested = PGA_MASK + 1U;
-    MX7705_SetGain(gainRequested, channel);
+    MX7705_SetGain(&adc, gainRequested, channel);
     
     // Get the gain and setup reg data again to compare against...
-    // Mocks for calling get gain
-    MockForMX7705GetGain(channel);
     // check the gain returned matches gain requested
     const uint8_t setupRegFinal = mx7705Adc.setupReg[channel];
-    const uint8_t gainFinal = MX7705_GetGain(channel);
+    const uint8_t gainFinal = MX7705_GetGain(&adc, channel);
 
     CHECK_EQUAL(gainFinal, gainInitial);
     CHECK_EQUAL(setupRegFinal, setupRegInitial);
@@ -893,35 +1001,32 @@ TEST(MX7705TestGroup, IncrementGainChannelZero)
     
     MockForMX7705Init(channel);
     
-    MX7705_Init(pinNum, channel);
+    MX7705_Init(&adc, pinNum, channel);
 
-    // Mocks for calling get gain
-    MockForMX7705GetGain(channel);
 
     // Read the initial gain. Should match the settings stored in the setup reg
     const uint8_t setupRegInitial = mx7705Adc.setupReg[channel];
-    uint8_t gainActual = MX7705_GetGain(channel);
+    uint8_t gainActual = MX7705_GetGain(&adc, channel);
     uint8_t gainExpected = bitExtract(setupRegInitial, PGA_MASK, PGA_OFFSET);
     CHECK_EQUAL(gainExpected, gainActual);
 
-    // Work out the expected setup register after changing gain.
+    /* Work out the expected setup register after changing gain. Self calibration
+    mode written by init is cleared by the adc when it's done.*/
     uint8_t setupRegExpected = setupRegInitial;
+    bitInsert(setupRegExpected, NormalMode, MODE_MASK, MODE_OFFSET);
     // increment gain to be written back into the setup reg.
     gainExpected++;
     // write in the new gain
     bitInsert(setupRegExpected, gainExpected, PGA_MASK, PGA_OFFSET);
-    // mocks for calling increment gain (get then set gain)
-    MockForMX7705GetGain(channel);
+    // mocks for calling increment gain (set gain from shadow)
     MockForMX7705SetGain(channel, setupRegExpected);
     // Call to increment gain
-    MX7705_IncrementGain(channel);
+    MX7705_IncrementGain(&adc, channel);
     
     // Now call get gain again to check that the gain has actually been written.
 
-    // Mocks for calling get gain
-    MockForMX7705GetGain(channel);
     // check the gain returned matches gain requested
-    gainActual = MX7705_GetGain(channel);
+    gainActual = MX7705_GetGain(&adc, channel);
     CHECK_EQUAL(gainExpected, gainActual);
 
     // check that the setup register matches expectations
@@ -948,39 +1053,40 @@ TEST(MX7705TestGroup, DecrementGainChannelZero)
     
     MockForMX7705Init(channel);
     
-    MX7705_Init(pinNum, channel);
+    MX7705_Init(&adc, pinNum, channel);
     /* Note that gain is initialised to idx 0. So lets change to 3 so it can be
-    decremented. Change setup reg direcly. */
-    bitInsert(mx7705Adc.setupReg[channel], initGain, PGA_MASK, PGA_OFFSET);
+    decremented.*/
+    uint8_t setupRegInit = mx7705Adc.setupReg[channel];
+    bitInsert(setupRegInit, NormalMode, MODE_MASK, MODE_OFFSET);
+    bitInsert(setupRegInit, initGain, PGA_MASK, PGA_OFFSET);
+    MockForMX7705SetGain(channel, setupRegInit);
+    MX7705_SetGain(&adc, initGain, channel);
 
-    // Mocks for calling get gain
-    MockForMX7705GetGain(channel);
 
     // Read the initial gain. Should match the settings stored in the setup reg
     const uint8_t setupRegInitial = mx7705Adc.setupReg[channel];
-    uint8_t gainActual = MX7705_GetGain(channel);
+    uint8_t gainActual = MX7705_GetGain(&adc, channel);
     uint8_t gainExpected = initGain;
     // check that the gain we get back was what we set
     CHECK_EQUAL(gainExpected, gainActual);
 
-    // Work out the expected setup register after changing gain.
+    /* Work out the expected setup register after changing gain. Self calibration
+    mode written by init is cleared by the adc when it's done.*/
     uint8_t setupRegExpected = setupRegInitial;
+    bitInsert(setupRegExpected, NormalMode, MODE_MASK, MODE_OFFSET);
     // decrement gain to be written back into the setup reg.
     gainExpected--;
     // write in the new gain
     bitInsert(setupRegExpected, gainExpected, PGA_MASK, PGA_OFFSET);
-    // mocks for calling increment gain (get then set gain)
-    MockForMX7705GetGain(channel);
+    // mocks for calling increment gain (set gain from shadow)
     MockForMX7705SetGain(channel, setupRegExpected);
     // Call to increment gain
-    MX7705_DecrementGain(channel);
+    MX7705_DecrementGain(&adc, channel);
     
     // Now call get gain again to check that the gain has actually been written.
 
-    // Mocks for calling get gain
-    MockForMX7705GetGain(channel);
     // check the gain returned matches gain requested
-    gainActual = MX7705_GetGain(channel);
+    gainActual = MX7705_GetGain(&adc, channel);
     CHECK_EQUAL(gainExpected, gainActual);
 
     // check that the setup register matches expectations
@@ -5,16 +5,20 @@
 
 // Code under test
 #include "TC77.h"
-#include "TC77Private.h"   // Spi settings
+#include "TC77Private.h"   // spi #defines
 
 // support
 #include "Arduino.h"       // arduino function prototypes - implemented MockAduino.c
 #include "MockArduino.h"
 #include "MockSpiCommon.h" // Mock spi interface
 #include "SpiCommon.h"     // spi function prototypes - mocks implemented here.
+#include "TimerWheel.h"
 #include <stdint.h>
+#include <string.h>
 
-static uint32_t mockMillis;
+static TC77_t       tc77;        // device under test
+static TimerWheel_t wheel;       // sensor is read from a timer on here
+static uint32_t     mockMillis;
 
 /*******************************************************************************
  * Private function implementations for tests
@@ -96,13 +100,13 @@ static void UpdateReadReg(float temperature, bool ready)
 static void MockForTC77ReadRawData(void)
 {
     mock().expectOneCall("OpenSpiConnection")
-        .withParameter("settings", &tc77SpiSettings);
+        .withParameter("settings", &tc77.spi);
     mock().expectOneCall("SpiTransferByte")
         .withParameter("byteToSpiBus", 0U);
     mock().expectOneCall("SpiTransferByte")
         .withParameter("byteToSpiBus", 0U);
     mock().expectOneCall("CloseSpiConnection")
-        .withParameter("settings", &tc77SpiSettings);
+        .withParameter("settings", &tc77.spi);
 }
 
 /*******************************************************************************
@@ -119,8 +123,10 @@ TEST_GROUP(TC77TestGroup)
         CloseSpiConnection_Callback = &DummyCallback;
 
         // Clear mock spi data
-        InitialiseMockSpiBus(&tc77SpiSettings);
+        memset(&tc77, 0U, sizeof(tc77));
+        InitialiseMockSpiBus(&tc77.spi);
         mockMillis = 0U;
+        TimerWheel_Init(&wheel, mockMillis);
     }
 
     void teardown(void)
@@ -136,20 +142,24 @@ TEST(TC77TestGroup, InitialiseTC77)
     // Mock calls to low level spi function
     mock().expectOneCall("InitChipSelectPin")
         .withParameter("pin", pinNum);
-    TC77_Init(pinNum);
+    TC77_Init(&tc77, pinNum, &wheel);
 
-    CHECK_EQUAL(CS_DELAY, tc77SpiSettings.chipSelectDelay);
-    CHECK_EQUAL(SPI_CLOCK_SPEED, tc77SpiSettings.clockSpeed);
-    CHECK_EQUAL(SPI_BIT_ORDER, tc77SpiSettings.bitOrder);
-    CHECK_EQUAL(SPI_DATA_MODE, tc77SpiSettings.dataMode);
+    CHECK_EQUAL(CS_SETUP_US, tc77.spi.chipSelectSetup);
+    CHECK_EQUAL(CS_HOLD_US, tc77.spi.chipSelectHold);
+    CHECK_EQUAL(SPI_CLOCK_SPEED, tc77.spi.clockSpeed);
+    CHECK_EQUAL(SPI_BIT_ORDER, tc77.spi.bitOrder);
+    CHECK_EQUAL(SPI_DATA_MODE, tc77.spi.dataMode);
+    // reading starts once the first conversion is done
+    CHECK(TimerWheel_IsRunning(&tc77.timer));
+    CHECK_EQUAL(CONVERSION_TIME, TimerWheel_TimeToNext(&wheel));
 
     // check function calls
     mock().checkExpectations();
 }
 
 /*
- Test for initialising then calling update function on TC77 device before 
- conversion has taken place. So 0 should be returned.
+ Test for initialising then servicing timers on TC77 device before conversion
+ has taken place. The sensor isn't read so 0 should be returned.
  */
 TEST(TC77TestGroup, ReadingTC77BeforeConversionNoData)
 {
@@ -157,20 +167,19 @@ TEST(TC77TestGroup, ReadingTC77BeforeConversionNoData)
     // Mock calls to low level spi function
     mock().expectOneCall("InitChipSelectPin")
         .withParameter("pin", pinNum);
-    TC77_Init(pinNum);
+    TC77_Init(&tc77, pinNum, &wheel);
 
-    mock().expectOneCall("millis")
-        .andReturnValue(mockMillis);
-    TC77_Update();
-    CHECK_EQUAL(0U, TC77_GetRawData());   
+    mockMillis = CONVERSION_TIME - 1U;
+    TimerWheel_Service(&wheel, mockMillis);
+    CHECK_EQUAL(0U, TC77_GetRawData(&tc77));   
     mock().checkExpectations();
 }
 
 /*
- Test for initialising then calling update function on TC77 device before 
- the device is ready - reading the ready bit of the read register. Expect 0 to be
- returned even though there is data in the register ie. initial data doesn't get
- updated and 0 remains.
+ Test for initialising then reading TC77 device after the conversion time but
+ before the device is ready - reading the ready bit of the read register. Expect
+ 0 to be returned even though there is data in the register ie. initial data
+ doesn't get updated and 0 remains.
  */
 TEST(TC77TestGroup, ReadingTC77AfterConversionNotReady)
 {
@@ -178,24 +187,23 @@ TEST(TC77TestGroup, ReadingTC77AfterConversionNotReady)
     // Mock calls to low level spi function
     mock().expectOneCall("InitChipSelectPin")
         .withParameter("pin", pinNum);
-    TC77_Init(pinNum);
+    TC77_Init(&tc77, pinNum, &wheel);
 
-    mock().expectOneCall("millis")
-        .andReturnValue(mockMillis);
-    
     // Put data into read register - do not expect to see this. Device not ready.
     const float mockTemperature = 25.2F;
     // Now update read reg but set state to busy
     UpdateReadReg(mockTemperature, false);
-    TC77_Update();
+    mockMillis = CONVERSION_TIME;
+    MockForTC77ReadRawData();
+    TimerWheel_Service(&wheel, mockMillis);
     
-    CHECK_EQUAL(0U, TC77_GetRawData());   
+    CHECK_EQUAL(0U, TC77_GetRawData(&tc77));   
     mock().checkExpectations();
 }
 
 /*
- Test for calling update function on TC77 device after conversion time. We expect
- data to be available and for it to be returned over spi bus. 
+ Test for servicing timers on TC77 device after conversion time. We expect data
+ to be available and for it to be returned over spi bus. 
  */
 TEST(TC77TestGroup, ReadingTC77AfterConversionExpectData)
 {
@@ -203,10 +211,10 @@ TEST(TC77TestGroup, ReadingTC77AfterConversionExpectData)
     // Mock calls to low level spi function for init
     mock().expectOneCall("InitChipSelectPin")
         .withParameter("pin", pinNum);
-    TC77_Init(pinNum);
+    TC77_Init(&tc77, pinNum, &wheel);
 
     // Do not expect error condition
-    CHECK(!TC77_GetError());
+    CHECK(!TC77_GetError(&tc77));
 
     // Put data into read register
     const float mockTemperature = 25.2F;
@@ -215,26 +223,24 @@ TEST(TC77TestGroup, ReadingTC77AfterConversionExpectData)
     mockMillis = CONVERSION_TIME + 10U;
     
     // mock spi calls when data is read from TC77 device.
-    mock().expectOneCall("millis")
-        .andReturnValue(mockMillis);
     MockForTC77ReadRawData();
     
-    TC77_Update();
+    TimerWheel_Service(&wheel, mockMillis);
 
     // Check data returned against expectations
-    const uint16_t rawDataActual = TC77_GetRawData();
+    const uint16_t rawDataActual = TC77_GetRawData(&tc77);
     const uint16_t rawDataExpected = GetSpiReadReg();
     CHECK_EQUAL(rawDataExpected, rawDataActual);
     DOUBLES_EQUAL(mockTemperature, TC77_ConvertToTemp(rawDataActual), 0.1);
     // Do not expect error condition
-    CHECK(!TC77_GetError());
+    CHECK(!TC77_GetError(&tc77));
     
     // Checking mock function calls
     mock().checkExpectations();
 }
 
 /*
- Test for calling update function on TC77 device after conversion time with an
+ Test for servicing timers on TC77 device after conversion time with an
  overtemp condition. Data should be returned but with error condition must be
  set to true.
  */
@@ -247,9 +253,9 @@ TEST(TC77TestGroup, ReadingTC77AfterConversionWithOverTemp)
         .withParameter("pin", pinNum);
     
     // Call init function with required pin setting - chip select
-    TC77_Init(pinNum);
+    TC77_Init(&tc77, pinNum, &wheel);
     // Should be no error condition at this point.
-    CHECK(!TC77_GetError());
+    CHECK(!TC77_GetError(&tc77));
 
     /* max temperature is 125C. So setting the temperature above this should
     trigger an overtemperature error */
@@ -261,22 +267,49 @@ TEST(TC77TestGroup, ReadingTC77AfterConversionWithOverTemp)
     mockMillis = CONVERSION_TIME + 10U;
 
     // mock spi calls when data is read from TC77 device.
-    mock().expectOneCall("millis")
-        .andReturnValue(mockMillis);
     MockForTC77ReadRawData();
     
-    // now call the update function
-    TC77_Update();
+    // now let the timer read the sensor
+    TimerWheel_Service(&wheel, mockMillis);
 
     // Compare returned data against expectations
     const uint16_t rawDataExpected = GetSpiReadReg();
-    const uint16_t rawDataActual = TC77_GetRawData();
+    const uint16_t rawDataActual = TC77_GetRawData(&tc77);
     CHECK_EQUAL(rawDataExpected, rawDataActual);
     DOUBLES_EQUAL(mockTemperature, TC77_ConvertToTemp(rawDataActual), 0.1);
     
     // expect error condition because of over temperature
-    CHECK(TC77_GetError());
+    CHECK(TC77_GetError(&tc77));
 
     // Checking mock function calls
     mock().checkExpectations();
-}
\ No newline at end of file
+}
+
+/*
+ The sensor is read again at the end of every conversion. Late servicing
+ doesn't push the next reading back.
+ */
+TEST(TC77TestGroup, ReadingTC77EveryConversionTime)
+{
+    const uint8_t pinNum = 1U;
+    mock().expectOneCall("InitChipSelectPin")
+        .withParameter("pin", pinNum);
+    TC77_Init(&tc77, pinNum, &wheel);
+
+    UpdateReadReg(25.2F, true);
+    mockMillis = CONVERSION_TIME + 10U;
+    MockForTC77ReadRawData();
+    TimerWheel_Service(&wheel, mockMillis);
+    DOUBLES_EQUAL(25.2F, TC77_ConvertToTemp(TC77_GetRawData(&tc77)), 0.1);
+
+    // not read again until the next conversion is done
+    UpdateReadReg(31.7F, true);
+    mockMillis = (2U * CONVERSION_TIME) - 1U;
+    TimerWheel_Service(&wheel, mockMillis);
+    DOUBLES_EQUAL(25.2F, TC77_ConvertToTemp(TC77_GetRawData(&tc77)), 0.1);
+    mockMillis += 1U;
+    MockForTC77ReadRawData();
+    TimerWheel_Service(&wheel, mockMillis);
+    DOUBLES_EQUAL(31.7F, TC77_ConvertToTemp(TC77_GetRawData(&tc77)), 0.1);
+    mock().checkExpectations();
+}
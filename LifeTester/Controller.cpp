@@ -6,10 +6,6 @@
 #include "StateMachine.h"
 #include "Wire.h"
 
-STATIC DataBuffer_t transmitBuffer;
-STATIC uint8_t      cmdReg;
-static bool         cmdRegReadRequested = false;
-    
 STATIC void ResetBuffer(DataBuffer_t *const buf)
 {
     memset(buf->d, EMPTY_BYTE, BUFFER_MAX_SIZE);
@@ -64,9 +60,9 @@ static void WriteUint32(DataBuffer_t *const buf, uint32_t data)
     }
 }
 
-static void TransmitData(void)
+static void TransmitData(Controller_t const *const controller)
 {
-    Wire.write(transmitBuffer.d, NumBytes(&transmitBuffer));
+    Wire.write(controller->transmitBuffer.d, NumBytes(&controller->transmitBuffer));
 }
 
 static void FlushReadBuffer(void)
@@ -100,50 +96,62 @@ STATIC void PrintBuffer(DataBuffer_t const *const buf)
     SERIAL_PRINTLNEND();
 }
 
-STATIC void WriteDataToTransmitBuffer(LifeTester_t const *const lifeTester)
+STATIC void WriteDataToTransmitBuffer(DataBuffer_t *const buf,
+                                      LifeTester_t const *const lifeTester)
 {
     // TODO: handle dodgy pointers in vActive, iActive
-    ResetBuffer(&transmitBuffer);
-    WriteUint32(&transmitBuffer, lifeTester->timer);
-    WriteUint8(&transmitBuffer, *lifeTester->data.vActive);
-    WriteUint16(&transmitBuffer, *lifeTester->data.iActive);
-    WriteUint16(&transmitBuffer, TempGetRawData());
-    WriteUint16(&transmitBuffer, analogRead(LIGHT_SENSOR_PIN));
-    WriteUint8(&transmitBuffer, (uint8_t)lifeTester->error);
-    WriteUint8(&transmitBuffer, CheckSum(&transmitBuffer));
+    ResetBuffer(buf);
+    WriteUint32(buf, lifeTester->timer);
+    WriteUint8(buf, *lifeTester->data.vActive);
+    WriteUint16(buf, *lifeTester->data.iActive);
+    WriteUint16(buf, TempGetRawData(lifeTester->io.tempSensor));
+    WriteUint16(buf, analogRead(LIGHT_SENSOR_PIN));
+    WriteUint8(buf, (uint8_t)lifeTester->error);
+    WriteUint8(buf, CheckSum(buf));
 }
 
-static void WriteParamsToTransmitBuffer(void)
+static void WriteParamsToTransmitBuffer(Controller_t *const controller)
 {
-    ResetBuffer(&transmitBuffer);
-    WriteUint16(&transmitBuffer, Config_GetSettleTime());
-    WriteUint16(&transmitBuffer, Config_GetTrackDelay());
-    WriteUint16(&transmitBuffer, Config_GetSampleTime());
-    WriteUint16(&transmitBuffer, Config_GetThresholdCurrent());
+    DataBuffer_t *const buf = &controller->transmitBuffer;
+    Config_t const *const config = controller->config;
+    ResetBuffer(buf);
+    WriteUint16(buf, Config_GetSettleTime(config));
+    WriteUint16(buf, Config_GetTrackDelay(config));
+    WriteUint16(buf, Config_GetSampleTime(config));
+    WriteUint16(buf, Config_GetThresholdCurrent(config));
+    WriteUint8(buf, Config_GetTrackingAlgorithms(config));
 }
 
 /*
- Sets measurement parameters from byte width variables.
+ Sets measurement parameters from byte width variables. Masters that don't know
+ about tracking algorithms leave off the last byte - the current ones are kept.
 */
-static void ReadNewParamsFromMaster(void)
+static void ReadNewParamsFromMaster(Config_t *const config, int numBytes)
 {
-    Config_SetSettleTime(ReadUint16());
-    Config_SetTrackDelay(ReadUint16());
-    Config_SetSampleTime(ReadUint16());
-    Config_SetThresholdCurrent(ReadUint16());
+    Config_SetSettleTime(config, ReadUint16());
+    Config_SetTrackDelay(config, ReadUint16());
+    Config_SetSampleTime(config, ReadUint16());
+    Config_SetThresholdCurrent(config, ReadUint16());
+    if (numBytes == PARAMS_REG_SIZE)
+    {
+        Config_SetTrackingAlgorithms(config, Wire.read());
+    }
 }
 /*
  Copies everything except rdy bit and clears any error codes 
 */
-static void LoadNewCmdToReg(uint8_t newCmdReg)
+static void LoadNewCmdToReg(Controller_t *const controller,
+                            uint8_t newCmdReg,
+                            uint8_t newChannel)
 {
-    bitCopy(cmdReg, newCmdReg, CH_SELECT_BIT);
-    bitCopy(cmdReg, newCmdReg, RW_BIT);
-    bitDelete(cmdReg, ERROR_MASK, ERROR_OFFSET);
-    SET_COMMAND(cmdReg, GET_COMMAND(newCmdReg));
+    controller->cmdChannel = newChannel;
+    bitCopy(controller->cmdReg, newCmdReg, CH_SELECT_BIT);
+    bitCopy(controller->cmdReg, newCmdReg, RW_BIT);
+    bitDelete(controller->cmdReg, ERROR_MASK, ERROR_OFFSET);
+    SET_COMMAND(controller->cmdReg, GET_COMMAND(newCmdReg));
 }
 
-static void UpdateStatusBits(uint8_t newCmdReg)
+static void UpdateStatusBits(Controller_t *const controller, uint8_t newCmdReg)
 {
     const ControllerCommand_t c = GET_COMMAND(newCmdReg);
     // set status bits
@@ -154,11 +162,11 @@ static void UpdateStatusBits(uint8_t newCmdReg)
             case Reset:
             case ParamsReg:
             case CmdReg:
-                CLEAR_RDY_STATUS(cmdReg);  // only applies for reading/loading
+                CLEAR_RDY_STATUS(controller->cmdReg);  // only applies for reading/loading
                 break;
             case DataReg: // Master can't write to the data register
             default:
-                SET_ERROR(cmdReg, UnkownCmdError);
+                SET_ERROR(controller->cmdReg, UnkownCmdError);
                 break;
         }
     }
@@ -167,48 +175,55 @@ static void UpdateStatusBits(uint8_t newCmdReg)
         switch (c)
         {
             case Reset:
-                CLEAR_RDY_STATUS(cmdReg);
+                CLEAR_RDY_STATUS(controller->cmdReg);
                 break;
             case ParamsReg:
             case DataReg:
                 // data requested - need to load into buffer now. Set busy
-                CLEAR_RDY_STATUS(cmdReg);
+                CLEAR_RDY_STATUS(controller->cmdReg);
                 break;
             case CmdReg:  // command not loaded - preserve reg as is for reading
                 break;
             default:
-                SET_ERROR(cmdReg, UnkownCmdError);
+                SET_ERROR(controller->cmdReg, UnkownCmdError);
                 break;
         }
     }
 }
 
-void Controller_Init(void)
+void Controller_Init(Controller_t *const controller,
+                     LifeTester_t *const lifeTesters,
+                     uint8_t nLifeTesters,
+                     Config_t *const config)
 {
-    ResetBuffer(&transmitBuffer);
-    cmdReg = 0U;
-    SET_RDY_STATUS(cmdReg);
+    controller->lifeTesters = lifeTesters;
+    controller->nLifeTesters = nLifeTesters;
+    controller->config = config;
+    ResetBuffer(&controller->transmitBuffer);
+    controller->cmdReg = 0U;
+    controller->cmdChannel = LIFETESTER_CH_A;
+    SET_RDY_STATUS(controller->cmdReg);
     FlushReadBuffer();
-    cmdRegReadRequested = false;
+    controller->cmdRegReadRequested = false;
 }
 
-void Controller_RequestHandler(void)
+void Controller_RequestHandler(Controller_t *const controller)
 {
     digitalWrite(COMMS_LED_PIN, HIGH);
-    if (cmdRegReadRequested)
+    if (controller->cmdRegReadRequested)
     {
-        cmdRegReadRequested = false;
-        Wire.write(cmdReg);
+        controller->cmdRegReadRequested = false;
+        Wire.write(controller->cmdReg);
     }
     else
     {
-        if (!IsEmpty(&transmitBuffer))
+        if (!IsEmpty(&controller->transmitBuffer))
         {
-            TransmitData();
+            TransmitData(controller);
         }
         else
         {
-            SET_ERROR(cmdReg, BusyError);
+            SET_ERROR(controller->cmdReg, BusyError);
         }
     }
     digitalWrite(COMMS_LED_PIN, LOW);
@@ -217,7 +232,7 @@ void Controller_RequestHandler(void)
 /*
  Handles data write from master device/slave read
 */
-void Controller_ReceiveHandler(int numBytes)
+void Controller_ReceiveHandler(Controller_t *const controller, int numBytes)
 {
     digitalWrite(COMMS_LED_PIN, HIGH);
     /*
@@ -225,25 +240,29 @@ void Controller_ReceiveHandler(int numBytes)
      Note that all params MUST be written in a single transaction and polling
      can't be done here (not necessary). How would we know the difference bet-
      ween a request to read the cmd reg and the actual params being written.*/
-    if ((GET_COMMAND(cmdReg) == ParamsReg)
-        && IS_WRITE(cmdReg))
+    if ((GET_COMMAND(controller->cmdReg) == ParamsReg)
+        && IS_WRITE(controller->cmdReg))
     {
-        if (numBytes == PARAMS_REG_SIZE)
+        if ((numBytes == PARAMS_REG_SIZE)
+            || (numBytes == PARAMS_REG_SIZE_NO_ALGORITHMS))
         {
-            ReadNewParamsFromMaster();
+            ReadNewParamsFromMaster(controller->config, numBytes);
             // protect from another write without command
-            SET_READ_MODE(cmdReg);
+            SET_READ_MODE(controller->cmdReg);
         }
         else
         {
             // chuck away bad settings - wrong size
             FlushReadBuffer();
-            SET_ERROR(cmdReg, BadParamsError);
+            SET_ERROR(controller->cmdReg, BadParamsError);
         }
     }
     else // new command isued...
     {
         const uint8_t newCmdReg = Wire.read();
+        // boards with more than two channels need the channel number too
+        const uint8_t newChannel =
+            (numBytes > 1) ? Wire.read() : GET_CHANNEL(newCmdReg);
         // Make sure old commands don't fill up buffer
         FlushReadBuffer();
         // requesting write to cmd reg
@@ -251,26 +270,26 @@ void Controller_ReceiveHandler(int numBytes)
         {
             if (IS_WRITE(newCmdReg))
             {
-                if (IS_RDY(cmdReg))
+                if (IS_RDY(controller->cmdReg))
                 {
-                    LoadNewCmdToReg(newCmdReg);
+                    LoadNewCmdToReg(controller, newCmdReg, newChannel);
                 }
                 else
                 {
-                    SET_ERROR(cmdReg, BusyError);
+                    SET_ERROR(controller->cmdReg, BusyError);
                 }
             }
             // Master requested read command reg - see request handler
             else
             {
-                cmdRegReadRequested = true;
+                controller->cmdRegReadRequested = true;
             }
         }
         // write cmd already requested now receiving new command 
-        else if (GET_COMMAND(cmdReg) == CmdReg)
+        else if (GET_COMMAND(controller->cmdReg) == CmdReg)
         {
-            LoadNewCmdToReg(newCmdReg);
-            UpdateStatusBits(newCmdReg);
+            LoadNewCmdToReg(controller, newCmdReg, newChannel);
+            UpdateStatusBits(controller, newCmdReg);
         }
         else
         {
@@ -280,40 +299,54 @@ void Controller_ReceiveHandler(int numBytes)
     digitalWrite(COMMS_LED_PIN, LOW);
 }
 
-void Controller_ConsumeCommand(LifeTester_t *const lifeTesterChA,
-                               LifeTester_t *const lifeTesterChB)
+void Controller_ConsumeCommand(Controller_t *const controller)
 {
-    LifeTester_t *const ch = 
-        (GET_CHANNEL(cmdReg) == LIFETESTER_CH_A) ? lifeTesterChA : lifeTesterChB;
-    switch (GET_COMMAND(cmdReg))
+    const uint8_t channel = controller->cmdChannel;
+    LifeTester_t *const ch = (channel < controller->nLifeTesters)
+        ? &controller->lifeTesters[channel] : NULL;
+    switch (GET_COMMAND(controller->cmdReg))
     {
         case Reset:
-            if (!IS_RDY(cmdReg))  // RW bit ignored
+            if (!IS_RDY(controller->cmdReg))  // RW bit ignored
             {
-                StateMachine_Reset(ch);
-                SET_RDY_STATUS(cmdReg);
+                if (ch != NULL)
+                {
+                    StateMachine_Reset(ch);
+                }
+                else
+                {
+                    SET_ERROR(controller->cmdReg, UnkownCmdError);
+                }
+                SET_RDY_STATUS(controller->cmdReg);
             }
             break;
         case ParamsReg:
-            if (!IS_WRITE(cmdReg))
+            if (!IS_WRITE(controller->cmdReg))
             {
-                WriteParamsToTransmitBuffer();
-                SET_RDY_STATUS(cmdReg);
+                WriteParamsToTransmitBuffer(controller);
+                SET_RDY_STATUS(controller->cmdReg);
             }
             else
             {
                 FlushReadBuffer();
-                SET_RDY_STATUS(cmdReg);
+                SET_RDY_STATUS(controller->cmdReg);
             }
             break;
         case DataReg:
-            if (!IS_WRITE(cmdReg))
+            if (!IS_WRITE(controller->cmdReg))
             {
-                if (!IS_RDY(cmdReg))
+                if (!IS_RDY(controller->cmdReg))
                 {
                     // ensure data isn't loaded again
-                    WriteDataToTransmitBuffer(ch);
-                    SET_RDY_STATUS(cmdReg);                    
+                    if (ch != NULL)
+                    {
+                        WriteDataToTransmitBuffer(&controller->transmitBuffer, ch);
+                    }
+                    else
+                    {
+                        SET_ERROR(controller->cmdReg, UnkownCmdError);
+                    }
+                    SET_RDY_STATUS(controller->cmdReg);                    
                 }
             }
             break;
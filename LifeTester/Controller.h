@@ -6,6 +6,15 @@
  Bit:  7  6   5  4  3  2  1  0
  Func: Ch RW RDY X  X |  CMD  |
  comms register mask and bit shifts
+
+ Ch selects channel 0 or 1 of the channel table. Boards with more channels need
+ the master to follow the command byte with the channel number in the same
+ write. Commands for a channel that isn't in the table set UnkownCmdError.
+
+ params register (little endian)
+ Byte: 0-1     2-3         4-5     6-7        8
+ Func: tSettle tTrackDelay tSample iThreshold tracking algorithm (bit/channel)
+ Older masters write bytes 0-7 only. The tracking algorithms are left as they are.
 */
 #ifndef CONTROLLER_H
 #define CONTROLLER_H
@@ -14,32 +23,59 @@
 extern "C" {
 #endif
 
+#include "Config.h"
 #include "LifeTesterTypes.h"
 
+#define BUFFER_MAX_SIZE   (32U)
+
+// Buffer type used to store data ready for transmitting over I2C
+typedef struct DataBuffer_s {
+    uint8_t d[BUFFER_MAX_SIZE];
+    uint8_t tail;
+    uint8_t head;
+} DataBuffer_t;
+
+/*
+ Controller state for one I2C slave - its registers and the channel table and
+ config that commands act on.
+*/
+typedef struct Controller_s {
+    DataBuffer_t  transmitBuffer;
+    uint8_t       cmdReg;
+    uint8_t       cmdChannel;          // index into the channel table
+    bool          cmdRegReadRequested;
+    LifeTester_t *lifeTesters;         // channel table
+    uint8_t       nLifeTesters;
+    Config_t     *config;              // params register
+} Controller_t;
+
 /*
- Initialises controller register and clears transmit buffer
+ Initialises controller register and clears transmit buffer. Commands act on
+ the given channel table and params are read from and written to config.
 */
-void Controller_Init(void);
+void Controller_Init(Controller_t *const controller,
+                     LifeTester_t *const lifeTesters,
+                     uint8_t nLifeTesters,
+                     Config_t *const config);
 
 /*
  Updates the sate of the controller after a command has been received. This 
  function is called repeatedly in the main loop.
 */
-void Controller_ConsumeCommand(LifeTester_t *const lifeTesterChA,
-                               LifeTester_t *const lifeTesterChB);
+void Controller_ConsumeCommand(Controller_t *const controller);
 
 /*
  Handles a data write from the master device over I2C. Slave (LifeTestere)
  expects either a new command or a write to the params register.
 */
-void Controller_ReceiveHandler(int numBytes);
+void Controller_ReceiveHandler(Controller_t *const controller, int numBytes);
 
 /*
  Handles a request for data from the master which may be either a read from the
  (buffered) data or params registers or simply a read from the command register
  to check status or error etc.
 */
-void Controller_RequestHandler(void);
+void Controller_RequestHandler(Controller_t *const controller);
 
 
 #ifdef _cplusplus
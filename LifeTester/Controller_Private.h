@@ -1,9 +1,9 @@
 #include "Arduino.h"
 #include "Macros.h"
 
-#define BUFFER_MAX_SIZE   (32U)
 #define DATA_SEND_SIZE    (13U)  // size of data sent for single channel
-#define PARAMS_REG_SIZE   (8U)
+#define PARAMS_REG_SIZE   (9U)
+#define PARAMS_REG_SIZE_NO_ALGORITHMS (8U)  // masters from before tracking algorithms
 
 // Register mapping
 #define COMMAND_MASK      (7U)
@@ -24,13 +24,6 @@
 // Stores the channel request in the channel bit
 typedef bool LtChannel_t;
 
-// Buffer type used to store data ready for transmitting over I2C
-typedef struct DataBuffer_s {
-    uint8_t d[BUFFER_MAX_SIZE];
-    uint8_t tail;
-    uint8_t head;
-} DataBuffer_t;
-
 // Commands from master stored in the command register
 typedef enum ControllerCommand_e {
     CmdReg,
@@ -70,13 +63,6 @@ typedef enum ControllerError_e {
 #define SET_ERROR(REG, ERR) \
     bitInsert(REG, (uint8_t)ERR, ERROR_MASK, ERROR_OFFSET)
 
-// Expose certain variables for unit testing only
-#ifdef UNIT_TEST
-    extern DataBuffer_t transmitBuffer;
-    extern DataBuffer_t receiveBuffer;
-    extern uint8_t      cmdReg;
-#endif
-
 STATIC uint8_t NumBytes(DataBuffer_t const *const buf);
 STATIC void ResetBuffer(DataBuffer_t *const buf);
 static bool IsFull(DataBuffer_t const *const buf);
@@ -86,4 +72,5 @@ static void WriteUint16(DataBuffer_t *const buf, uint16_t data);
 static void WriteUint32(DataBuffer_t *const buf, uint32_t data);
 STATIC uint8_t CheckSum(DataBuffer_t const *const buf);
 STATIC void PrintBuffer(DataBuffer_t const *const buf);
-STATIC void WriteDataToTransmitBuffer(LifeTester_t const *const lifeTester);
\ No newline at end of file
+STATIC void WriteDataToTransmitBuffer(DataBuffer_t *const buf,
+                                      LifeTester_t const *const lifeTester);
\ No newline at end of file
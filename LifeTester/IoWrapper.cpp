@@ -5,61 +5,63 @@
  */
 #include "Arduino.h"
 #include "Config.h"
+#include "IoStats.h"
 #include "IoWrapper.h"
 #include "LifeTesterTypes.h"
 #include "MCP4802.h"
 #include "MX7705.h"
 #include "TC77.h"
 
-// records a copy of the last output set on the dac for each channel.
-static uint8_t dacOutput[nChannels];
+#define ADC_NO_OWNER    (0xFFU)
 
 /////////////////
 //DAC functions//
 /////////////////
-void DacInit(void)
+/*
+ Initialises a dac on the board. Both outputs of the device are zeroed. I/O
+ after that is counted in the stats given (NULL to not count it).
+*/
+void DacInit(MCP4802_t *const dac, uint8_t pin, IoStats_t *const stats)
 {
-    MCP4802_Init(DAC_CS_PIN);
+    MCP4802_Init(dac, pin);
+    dac->spi.stats = stats;
 }
 
 void DacSetOutputToActiveVoltage(LifeTester_t const *const lifeTester)
 {
-    DacSetOutput(*lifeTester->data.vActive, lifeTester->io.dac);
+    DacSetOutput(lifeTester, *lifeTester->data.vActive);
 }
 
 void DacSetOutputToThisVoltage(LifeTester_t const *const lifeTester)
 {
-    DacSetOutput(lifeTester->data.vThis, lifeTester->io.dac);
+    DacSetOutput(lifeTester, lifeTester->data.vThis);
 }
 
 void DacSetOutputToNextVoltage(LifeTester_t const *const lifeTester)
 {
-    DacSetOutput(lifeTester->data.vNext, lifeTester->io.dac);
+    DacSetOutput(lifeTester, lifeTester->data.vNext);
 }
 
 void DacSetOutputToScanVoltage(LifeTester_t const *const lifeTester)
 {
-    DacSetOutput(lifeTester->data.vScan, lifeTester->io.dac);
+    DacSetOutput(lifeTester, lifeTester->data.vScan);
 }
 
-void DacSetOutput(uint8_t output, chSelect_t ch)
+void DacSetOutput(LifeTester_t const *const lifeTester, uint8_t output)
 {
-    MCP4802_Output(output, ch);
+    MCP4802_Output(lifeTester->io.dacDevice, output, lifeTester->io.dac);
     #if DEBUG
         Serial.print("Setting Dac channel ");
-        Serial.print((uint8_t)ch);
+        Serial.print(lifeTester->io.channel);
         Serial.print(" output to ");
         Serial.println(output);
     #endif
-    
-    // keep a copy of last voltage set on this channel
-    dacOutput[ch] = output;
 }
 
 uint8_t DacGetOutput(LifeTester_t const *const lifeTester)
 {
-    const chSelect_t ch = lifeTester->io.dac;
-    return dacOutput[ch];
+    // the dac keeps a copy of the last output set on each channel
+    return MCP4802_GetOutput(lifeTester->io.dacDevice, lifeTester->io.dac);
 }
 
 bool DacOutputSetToActiveVoltage(LifeTester_t const *const lifeTester)
@@ -82,35 +84,183 @@ bool DacOutputSetToScanVoltage(LifeTester_t const *const lifeTester)
     return DacGetOutput(lifeTester) == lifeTester->data.vScan;
 }
 
-void DacSetGain(gainSelect_t requestedGain)
+void DacSetGain(MCP4802_t *const dac, gainSelect_t requestedGain)
 {
-    MCP4802_SetGain(requestedGain);
+    MCP4802_SetGain(dac, requestedGain);
 }
 
-gainSelect_t DacGetGain(void)
+gainSelect_t DacGetGain(MCP4802_t const *const dac)
 {
-    return MCP4802_GetGain();
+    return MCP4802_GetGain(dac);
 }
 
 /////////////////
 //Adc functions//
 /////////////////
-void AdcInit(void)
+/*
+ Sets up both inputs of an adc on the board. No channel owns it to start with.
+ Its i/o and DRDY polls are counted in the stats given.
+*/
+void AdcInit(IoAdc_t *const adc, uint8_t pin, IoStats_t *const stats)
 {
-    MX7705_Init(ADC_CS_PIN, 0U);
-    MX7705_Init(ADC_CS_PIN, 1U);
+    MX7705_Init(&adc->device, pin, 0U);
+    MX7705_Init(&adc->device, pin, 1U);
+    adc->device.spi.stats = stats;
+    adc->owner = ADC_NO_OWNER;
+    adc->windowOwner = ADC_NO_OWNER;
+    adc->muxInput = ADC_NO_OWNER;
+    adc->muxSettleReads = 0U;
 }
 
 uint16_t AdcReadLifeTesterCurrent(LifeTester_t const *const lifeTester)
 {
-    return AdcReadData(lifeTester->io.adc);
+    return AdcReadData(lifeTester->io.adcDevice, lifeTester->io.adc);
+}
+
+/*
+ Non-blocking current read. Polls DRDY once and returns true with the sample
+ when a conversion is ready (or zero on timeout as AdcReadData does). Returns
+ false without bus traffic while another channel on the same adc has a read in
+ flight.
+ Conversions made while the filter settles after a mux switch are thrown away.
+ The channel keeps the adc while it waits for a settled one, so consecutive
+ reads of a channel stay on the same mux setting.
+ */
+bool AdcPollLifeTesterCurrent(LifeTester_t const *const lifeTester, uint16_t *sample)
+{
+    IoAdc_t *const adc = lifeTester->io.adcDevice;
+    const uint8_t channel = lifeTester->io.channel;
+    const uint8_t input = lifeTester->io.adc;
+    if (input > 1U)
+    {
+        *sample = 0U;
+        return true;
+    }
+    if ((adc->windowOwner != ADC_NO_OWNER) && (adc->windowOwner != channel))
+    {
+        return false;
+    }
+    if (adc->owner == ADC_NO_OWNER)
+    {
+        adc->owner = channel;
+        MX7705_StartRead(&adc->device, input);
+        if (adc->muxInput != input)
+        {
+            // polling switches the mux - conversions until it settles are mixed
+            adc->muxInput = input;
+            adc->muxSettleReads = MX7705_MUX_SETTLE_CONVERSIONS;
+        }
+    }
+    else if (adc->owner != channel)
+    {
+        return false;
+    }
+
+    const MX7705ReadStatus_t status = MX7705_PollRead(&adc->device, input);
+    IoStats_AddDrdyPolls(adc->device.spi.stats, 1U);
+    if (status == MX7705ReadBusy)
+    {
+        return false;
+    }
+    if ((status == MX7705ReadReady) && (adc->muxSettleReads > 0U))
+    {
+        // still holds some of the other input. Read it to clear DRDY and wait for the next.
+        MX7705_CompleteRead(&adc->device, input);
+        adc->muxSettleReads--;
+        MX7705_StartRead(&adc->device, input);
+        return false;
+    }
+
+    *sample = (status == MX7705ReadReady) ? MX7705_CompleteRead(&adc->device, input) : 0U;
+    adc->owner = ADC_NO_OWNER;
+    #if DEBUG
+        Serial.print("Adc data ch ");
+        Serial.print(channel);
+        Serial.print(" = ");
+        Serial.println(*sample);
+    #endif
+    return true;
 }
 
-uint16_t AdcReadData(uint8_t channel)
+/*
+ Drops the read in flight. If the mux was still settling it isn't known how
+ many conversions go by before the next read, so settling starts again.
+ */
+static void DropRead(IoAdc_t *const adc)
 {
+    adc->owner = ADC_NO_OWNER;
+    if (adc->muxSettleReads > 0U)
+    {
+        adc->muxInput = ADC_NO_OWNER;
+    }
+}
+
+/*
+ Opens a sampling window for this life tester. Returns false while another
+ channel on the same adc has a window open. Other channels on it can't start
+ reads until the window is closed with AdcCancelLifeTesterRead, so all conversions in it go to this
+ channel. Any read in flight when the window opens is dropped so that sampling
+ starts on a new conversion.
+ */
+bool AdcClaimSampleWindow(LifeTester_t const *const lifeTester)
+{
+    IoAdc_t *const adc = lifeTester->io.adcDevice;
+    const uint8_t channel = lifeTester->io.channel;
+    if ((adc->windowOwner != ADC_NO_OWNER) && (adc->windowOwner != channel))
+    {
+        return false;
+    }
+    if (adc->windowOwner != channel)
+    {
+        DropRead(adc);
+        adc->windowOwner = channel;
+    }
+    return true;
+}
+
+/*
+ Time (ms) the adc needs before it can give this life tester a settled reading.
+ All the settle conversions if the mux is on another input, those still to be
+ thrown away if it's part way through settling on this one, otherwise none.
+ */
+uint16_t AdcGetMuxSettleTime(LifeTester_t const *const lifeTester)
+{
+    IoAdc_t const *const adc = lifeTester->io.adcDevice;
+    const uint8_t input = lifeTester->io.adc;
+    if (input > 1U)
+    {
+        return 0U;
+    }
+    const uint8_t nConversions = (adc->muxInput == input) ? adc->muxSettleReads
+                                                          : MX7705_MUX_SETTLE_CONVERSIONS;
+    return nConversions * MX7705_GetConversionTime(&adc->device, input);
+}
+
+// Releases the adc if this life tester has a read in flight or a window open
+void AdcCancelLifeTesterRead(LifeTester_t const *const lifeTester)
+{
+    IoAdc_t *const adc = lifeTester->io.adcDevice;
+    if (adc->owner == lifeTester->io.channel)
+    {
+        DropRead(adc);
+    }
+    if (adc->windowOwner == lifeTester->io.channel)
+    {
+        adc->windowOwner = ADC_NO_OWNER;
+    }
+}
+
+uint16_t AdcReadData(IoAdc_t *const adc, uint8_t channel)
+{
+    if (channel <= 1U)
+    {
+        // blocking reads switch the mux too
+        adc->muxInput = channel;
+    }
     if (channel == 0U)
     {
-        const uint16_t dataA = MX7705_ReadData(0U);
+        const uint16_t dataA = MX7705_ReadData(&adc->device, 0U);
+        IoStats_AddDrdyPolls(adc->device.spi.stats, MX7705_GetPollCount(&adc->device));
         #if DEBUG
             Serial.print("Adc data ch A = ");
             Serial.println(dataA);
@@ -119,7 +269,8 @@ uint16_t AdcReadData(uint8_t channel)
     }
     else if (channel == 1U)
     {
-        const uint16_t dataB = MX7705_ReadData(1U);
+        const uint16_t dataB = MX7705_ReadData(&adc->device, 1U);
+        IoStats_AddDrdyPolls(adc->device.spi.stats, MX7705_GetPollCount(&adc->device));
         #if DEBUG
             Serial.print("Adc data ch B = ");
             Serial.println(dataB);
@@ -135,26 +286,26 @@ uint16_t AdcReadData(uint8_t channel)
     }
 }
 
-bool AdcGetError(void)
+bool AdcGetError(IoAdc_t const *const adc)
 {
   #if DEBUG
     Serial.println("Error: Cannot read Adc error");
   #endif
-  return MX7705_GetError();
+  return MX7705_GetError(&adc->device);
 }
 
-uint8_t AdcGetGain(const uint8_t channel)
+uint8_t AdcGetGain(IoAdc_t const *const adc, const uint8_t channel)
 {
   #if DEBUG
     Serial.println("Error: Cannot read gain");
   #endif
   if (channel == 0U)
   {
-    return MX7705_GetGain(0u);
+    return MX7705_GetGain(&adc->device, 0u);
   }
   else if (channel == 0U)
   {
-    return MX7705_GetGain(1u);
+    return MX7705_GetGain(&adc->device, 1u);
   }
   else
   {
@@ -165,18 +316,18 @@ uint8_t AdcGetGain(const uint8_t channel)
   }
 }
 
-void AdcSetGain(const uint8_t gain, const uint8_t channel)
+void AdcSetGain(IoAdc_t *const adc, const uint8_t gain, const uint8_t channel)
 {
   #if DEBUG
     Serial.println("Error: Cannot set gain");
   #endif
   if (channel == 0U)
   {
-    MX7705_SetGain(gain, 0u);
+    MX7705_SetGain(&adc->device, gain, 0u);
   }
   else if (channel == 0U)
   {
-    MX7705_SetGain(gain, 0u);
+    MX7705_SetGain(&adc->device, gain, 0u);
   }
   else
   {
@@ -189,28 +340,26 @@ void AdcSetGain(const uint8_t gain, const uint8_t channel)
 ////////////////////////////////
 //Temperature sensor functions//
 ////////////////////////////////
-void TempSenseInit(void)
-{
-  TC77_Init(TEMP_CS_PIN);
-}
-
-void TempSenseUpdate(void)
+// sensor is read from a timer on the wheel given and its i/o counted in stats
+void TempSenseInit(TC77_t *const tempSensor, TimerWheel_t *const timers,
+                   IoStats_t *const stats)
 {
-  TC77_Update();
+  TC77_Init(tempSensor, TEMP_CS_PIN, timers);
+  tempSensor->spi.stats = stats;
 }
 
-uint16_t TempGetRawData(void)
+uint16_t TempGetRawData(TC77_t const *const tempSensor)
 {
-  TC77_GetRawData();
+  return TC77_GetRawData(tempSensor);
 }
 
-float TempReadDegC(void)
+float TempReadDegC(TC77_t const *const tempSensor)
 {
-  return TC77_ConvertToTemp(TC77_GetRawData());
+  return TC77_ConvertToTemp(TC77_GetRawData(tempSensor));
 }
 
-bool TempGetError(void)
+bool TempGetError(TC77_t const *const tempSensor)
 {
-  return TC77_GetError();
+  return TC77_GetError(tempSensor);
 }
 
@@ -11,30 +11,34 @@ extern "C"
 #include <stdint.h>
 #include <stdbool.h>
 
-void DacInit(void);
+void DacInit(MCP4802_t *const dac, uint8_t pin, IoStats_t *const stats);
 void DacSetOutputToActiveVoltage(LifeTester_t const *const lifeTester);
 void DacSetOutputToThisVoltage(LifeTester_t const *const lifeTester);
 void DacSetOutputToNextVoltage(LifeTester_t const *const lifeTester);
 void DacSetOutputToScanVoltage(LifeTester_t const *const lifeTester);
-void DacSetOutput(uint8_t output, chSelect_t ch);
+void DacSetOutput(LifeTester_t const *const lifeTester, uint8_t output);
 uint8_t DacGetOutput(LifeTester_t const *const lifeTester);
 bool DacOutputSetToActiveVoltage(LifeTester_t const *const lifeTester);
 bool DacOutputSetToThisVoltage(LifeTester_t const *const lifeTester);
 bool DacOutputSetToNextVoltage(LifeTester_t const *const lifeTester);
 bool DacOutputSetToScanVoltage(LifeTester_t const *const lifeTester);
-void DacSetGain(gainSelect_t requestedGain);
-gainSelect_t DacGetGain(void);
-void AdcInit(void);
+void DacSetGain(MCP4802_t *const dac, gainSelect_t requestedGain);
+gainSelect_t DacGetGain(MCP4802_t const *const dac);
+void AdcInit(IoAdc_t *const adc, uint8_t pin, IoStats_t *const stats);
 uint16_t AdcReadLifeTesterCurrent(LifeTester_t const *const lifeTester);
-uint16_t AdcReadData(uint8_t channel);
-bool AdcGetError(void);
-uint8_t AdcGetGain(const uint8_t channel);
-void AdcSetGain(const uint8_t gain, const uint8_t channel);
-void TempSenseInit(void);
-void TempSenseUpdate(void);
-uint16_t TempGetRawData(void);
-float TempReadDegC(void);
-bool TempGetError(void);
+bool AdcPollLifeTesterCurrent(LifeTester_t const *const lifeTester, uint16_t *sample);
+bool AdcClaimSampleWindow(LifeTester_t const *const lifeTester);
+uint16_t AdcGetMuxSettleTime(LifeTester_t const *const lifeTester);
+void AdcCancelLifeTesterRead(LifeTester_t const *const lifeTester);
+uint16_t AdcReadData(IoAdc_t *const adc, uint8_t channel);
+bool AdcGetError(IoAdc_t const *const adc);
+uint8_t AdcGetGain(IoAdc_t const *const adc, const uint8_t channel);
+void AdcSetGain(IoAdc_t *const adc, const uint8_t gain, const uint8_t channel);
+void TempSenseInit(TC77_t *const tempSensor, TimerWheel_t *const timers,
+                   IoStats_t *const stats);
+uint16_t TempGetRawData(TC77_t const *const tempSensor);
+float TempReadDegC(TC77_t const *const tempSensor);
+bool TempGetError(TC77_t const *const tempSensor);
 
 #ifdef _cplusplus
 }
@@ -3,31 +3,79 @@
 #include "IoWrapper.h"
 #include "StateMachine.h"
 #include "Controller.h"
+#include "IoStats.h"
 #include "LedFlash.h"
 #include "LifeTesterTypes.h"
+#include "MppStore.h"
 #include "Print.h"
+#include "TimerWheel.h"
 #include <SPI.h>
 #include <Wire.h>
 
-// Lifetester channel data
-LifeTester_t channelA = {
-  {chASelect, 0U},    // io
-  Flasher(LED_A_PIN), // led
-  {0},                // data
-  0U,                 // timer
-  ok,                 // error
-  NULL                // state
-};
+/*
+ Everything on the board that the channels share. Add more devices with their
+ own chip select pins in setup.
+*/
+typedef struct Board_s {
+  MCP4802_t    dac;
+  IoAdc_t      adc;
+  TC77_t       tempSensor;
+  Config_t     config;
+  Controller_t controller;
+  TimerWheel_t timers;    // every channel and device - serviced each loop
+  IoStats_t    ioStats;   // i/o cost of the channels and devices
+  MppStore_t   mppStore;  // mpp of each channel for warm starts
+} Board_t;
+
+static Board_t board;
 
-LifeTester_t channelB = {
-  {chBSelect, 1U},
-  Flasher(LED_B_PIN),
-  {0},
-  0U,
-  ok,
-  NULL,
+/*
+ Lifetester channel table. Each channel is a dac channel and an adc input on
+ the board's devices - {channel, dac, dac channel, adc, adc input, temperature
+ sensor}. The channel number must match the position in the table since the
+ i2c master uses it to pick the channel. The channel's own timers are left
+ zeroed.
+*/
+LifeTester_t channels[] = {
+  {
+    {0U, &board.dac, chASelect, &board.adc, 0U, &board.tempSensor}, // io
+    Flasher(LED_A_PIN, &board.timers), // led
+    {0},                // data
+    0U,                 // timer
+    ok,                 // error
+    NULL,               // state
+    &board.config,      // config
+    &board.timers,      // timers
+    &board.ioStats,     // ioStats
+    &board.mppStore     // mppStore
+  },
+  {
+    {1U, &board.dac, chBSelect, &board.adc, 1U, &board.tempSensor},
+    Flasher(LED_B_PIN, &board.timers),
+    {0},
+    0U,
+    ok,
+    NULL,
+    &board.config,
+    &board.timers,
+    &board.ioStats,
+    &board.mppStore
+  }
 };
 
+#define N_CHANNELS  (sizeof(channels) / sizeof(channels[0]))
+
+// Wire callbacks don't take a context - pass the board's controller on
+static void RequestHandler(void)
+{
+  Controller_RequestHandler(&board.controller);
+}
+
+static void ReceiveHandler(int numBytes)
+{
+  Controller_ReceiveHandler(&board.controller, numBytes);
+}
+
 void setup()
 { 
   // SERIAL PORT COMMUNICATION WITH PC VIA UART
@@ -37,27 +85,46 @@ void setup()
   // I2C COMMUNICATION WITH MASTER ARDUINO
   Wire.begin(I2C_ADDRESS);                   // I2C address defined at compile time
   Wire.setClock(31000L);
-  Wire.onRequest(Controller_RequestHandler); // register event
-  Wire.onReceive(Controller_ReceiveHandler); // register event
-  Controller_Init();
+  Wire.onRequest(RequestHandler); // register event
+  Wire.onReceive(ReceiveHandler); // register event
+  Controller_Init(&board.controller, channels, N_CHANNELS, &board.config);
+  TimerWheel_Init(&board.timers, millis());
+  IoStats_Reset(&board.ioStats);
+  MppStore_Init(&board.mppStore, MPP_STORE_BASE, MPP_STORE_CHANNELS);
   // INITIALISE I/O
   Serial.println("Initialising IO...");
   pinMode(COMMS_LED_PIN, OUTPUT);
-  DacInit();
-  AdcInit();
-  TempSenseInit();
-  Config_InitParams();
-  StateMachine_Reset(&channelA);
-  StateMachine_Reset(&channelB);
+  DacInit(&board.dac, DAC_CS_PIN, &board.ioStats);
+  AdcInit(&board.adc, ADC_CS_PIN, &board.ioStats);
+  TempSenseInit(&board.tempSensor, &board.timers, &board.ioStats);
+  Config_InitParams(&board.config);
+  for (uint8_t i = 0U; i < N_CHANNELS; i++)
+  {
+    StateMachine_Reset(&channels[i]);
+  }
 
   Serial.println("Finished setup. Entering main loop.");
 }
 
 void loop()
 {
-  StateMachine_UpdateStep(&channelA);
-  StateMachine_UpdateStep(&channelB);
+  // settle times, sampling windows, delays, leds and the temperature sensor
+  TimerWheel_Service(&board.timers, millis());
+  for (uint8_t i = 0U; i < N_CHANNELS; i++)
+  {
+    StateMachine_UpdateStep(&channels[i]);
+  }
+
+  Controller_ConsumeCommand(&board.controller);
 
-  TempSenseUpdate();
-  Controller_ConsumeCommand(&channelA, &channelB);
+  // nothing to do until a timer fires - sleep rather than spin
+  bool waiting = true;
+  for (uint8_t i = 0U; i < N_CHANNELS; i++)
+  {
+    waiting = waiting && StateMachine_Waiting(&channels[i]);
+  }
+  if (waiting)
+  {
+    delay(min(TimerWheel_TimeToNext(&board.timers), (uint32_t)LOOP_IDLE_MAX_TIME));
+  }
 }
\ No newline at end of file
@@ -6,7 +6,13 @@ extern "C"
 {
 #endif
 
+#include "Config.h"
+#include "IoStats.h"
 #include "MCP4802.h"  // dac types
+#include "MppStore.h"
+#include "MX7705.h"
+#include "TC77.h"
+#include "TimerWheel.h"
 #include "LedFlash.h"
 #include <stdint.h>
 
@@ -23,6 +29,11 @@ typedef enum ErrorCode_e {
     DacSetFailed      // couldn't set dac
 } ErrorCode_t;
 
+// scan points the mpp fit is made over - centred on the best one
+#define SCAN_FIT_POINTS (5U)
+// fitted mpp voltage is in 1/2^SCAN_FIT_SHIFT dac codes
+#define SCAN_FIT_SHIFT  (4U)
+
 /*
  Measurements that the lifetester may take on a given channel. Note that this
  and next refer to the current operating point and another neigbouring point for
@@ -34,6 +45,13 @@ typedef struct LifeTesterData_s {
     uint8_t vScan;       // voltage of point being scanned
     uint8_t *vActive;    // voltage for point currently being measured
     uint8_t vScanMpp;    // max power point measured in scan
+    uint8_t vScanLow;    // bracket around the mpp in a golden-section scan
+    uint8_t vScanHigh;
+    uint8_t vProbeLow;   // golden-section points inside the bracket
+    uint8_t vProbeHigh;
+    uint8_t vCycleLow;   // range of codes this point has covered while tracking
+    uint8_t vCycleHigh;
+    uint8_t vBest;       // best point measured within that range
     
     uint32_t pThis;       // power at this point
     uint32_t pNext;       // power at neighbouring point
@@ -42,26 +60,85 @@ typedef struct LifeTesterData_s {
     uint32_t pScanInitial;// power associated with first point
     uint32_t pScanFinal;  // ...and the last one (for checking scan shape)
     uint32_t pScanMpp;    // max power measured from scan
+    uint32_t pProbeLow;   // power at the golden-section points
+    uint32_t pProbeHigh;
+    uint32_t pScanFit;    // power at the mpp fitted to the scan peak
+    uint32_t pScanRecent[SCAN_FIT_POINTS]; // last few scan powers, newest last
+    uint32_t pBest;       // power at vBest
+    uint32_t pDwell;      // power when dwelling at the mpp started
+    uint32_t pWarmStart;  // power stored with the warm start mpp
 
     uint16_t iThis;       // average current from current samples at this point
     uint16_t iNext;
     uint16_t iScan;
     uint16_t *iActive;    // current for the point being measured
     uint16_t iScanMpp;
+    uint16_t vScanFit;    // mpp voltage fitted to the scan peak (see SCAN_FIT_SHIFT)
     uint32_t iSampleSum;  // sum of all currents measured during sampling window
+    uint32_t iSampleDevSqSum; // sum of squared deviations from the first sample
+    uint16_t iSampleFirst;// first current sampled in the window
+    uint32_t iVarThis;    // variance of the current samples at each point
+    uint32_t iVarNext;
+    uint32_t iVarScan;
+    uint32_t *iVarActive; // variance for the point being measured
     
     uint16_t nSamples;    // counting number of readings taken by ADC during sampling window
     uint16_t nErrorReads; // number of readings outside allowed limits
+    uint8_t  nReused;     // cycles in a row that reused the next measurement
+    uint8_t  nScanned;    // points measured so far in the scan
+    uint8_t  scanStrategy;// SCAN_LINEAR, SCAN_GOLDEN_SECTION or SCAN_LOCAL
+    uint8_t  scanStep;    // step between points of a local scan
+    uint8_t  scanStopMargin; // see Config_SetScanStopMargin, fixed for the scan
+    uint8_t  nScanLowCurrent;// scan points in a row with current below MIN_CURRENT
+    uint8_t  nScanRecent; // scan points held in pScanRecent
+    uint8_t  nSinceScanMpp;// scan points measured after the best one
+    uint16_t nSinceSave;  // tracking cycles since the mpp was stored
+    uint8_t  nCycle;      // tracking cycles this point has stayed within its range
+    uint8_t  nDwell;      // dwell cycles since the next point was checked
+    int16_t  dvLast;      // last tracking step, negative if it went down
+    uint16_t light;       // light sensor reading from this tracking cycle
+    uint16_t lightPrev;   // ...and from the cycle before
+    uint16_t lightAvg;    // running average of the light x 2^LIGHT_FILTER_SHIFT
 
     bool     thisDone;    // status of measurements
     bool     nextDone;
     bool     delayDone;
+    bool     scanDone;
+    bool     warmStart;   // stored mpp found at init - check it instead of scanning
+    bool     warmStartMatch; // power at the stored mpp is close to the stored power
+    bool     rescan;      // light changed - scan around the mpp
+    bool     lightAvgValid; // lightAvg has a reading since the last scan
+    bool     dwell;       // sitting at the mpp rather than perturbing around it
+    bool     settled;     // settle time is up for the point being measured
+    bool     windowOpen;  // adc claimed for the sampling window of that point
+    bool     windowPending; // window held back while another channel has the adc
 } LifeTesterData_t;
 
-// holds the channel info for the DAC and ADC
+/*
+ An adc and the arbitration between the channels that share it. A channel owns
+ the device from starting a read until it completes and only one channel at a
+ time can have a sampling window open. Channels on different adcs don't wait
+ for each other.
+*/
+typedef struct IoAdc_s {
+    MX7705_t device;
+    uint8_t  owner;          // channel with a read in flight
+    uint8_t  windowOwner;    // channel with a sampling window open
+    uint8_t  muxInput;       // input the mux was last switched to
+    uint8_t  muxSettleReads; // conversions to throw away while the filter settles
+} IoAdc_t;
+
+/*
+ Holds the channel info for the DAC and ADC - one entry of the channel table.
+ The devices are shared by the entries wired to them.
+*/
 typedef struct LifeTesterIo_s {
-    const chSelect_t dac;
-    const uint8_t    adc;
+    const uint8_t    channel;    // logical channel - index into the channel table
+    MCP4802_t *const dacDevice;  // dac this channel is wired to
+    const chSelect_t dac;        // channel on that dac
+    IoAdc_t   *const adcDevice;  // adc this channel is wired to
+    const uint8_t    adc;        // input on that adc
+    TC77_t    *const tempSensor; // board temperature sensor
 } LifeTesterIo_t;
 
 typedef enum Event_e {
@@ -71,8 +148,12 @@ typedef enum Event_e {
     MeasurementDoneEvent,
     ScanningDoneEvent,
     TrackDelayStartEvent,
+    LightChangeEvent,
     ResetEvent,  // not implemented yet
     ErrorEvent,
+    SettleDoneEvent,        // timer events
+    SampleWindowDoneEvent,
+    DelayDoneEvent,
     MaxNumEvents
 } Event_t;
 
@@ -110,6 +191,12 @@ struct LifeTester_s {
     uint32_t          timer;     //timer for tracking loop
     ErrorCode_t       error;          
     LifeTesterState_t const* state;
+    Config_t const*   config;    // settings this channel runs with
+    TimerWheel_t*     timers;    // wheel the channel's timers run on
+    IoStats_t*        ioStats;   // i/o cost of the channel - NULL if not counted
+    MppStore_t const* mppStore;  // where the channel keeps its mpp for warm starts
+    Timer_t           delayTimer;  // settle time or tracking delay
+    Timer_t           windowTimer; // end of the sampling window
 };
 typedef LifeTester_s LifeTester_t;
 
@@ -1,13 +1,16 @@
 #include "Arduino.h"
 #include "Config.h"
+#include "IoStats.h"
 #include "IoWrapper.h"
 #include "LedFlash.h"
 #include "LifeTesterTypes.h"
 #include "Macros.h"
+#include "MppStore.h"
 #include "Print.h"
 #include <string.h> // memset
 #include "StateMachine.h"
 #include "StateMachine_Private.h"
+#include "TimerWheel.h"
 
 /*******************************************************************************
 * PRIVATE STATE DEFINITIONS
@@ -62,9 +65,9 @@ STATIC const LifeTesterState_t StateInitialiseDevice = {
 STATIC const LifeTesterState_t StateTrackingDelay = {
     {
         TrackingDelayEntry,       // entry function
-        TrackingDelayStep,        // step function
+        NULL,                     // step function
         TrackingDelayExit,        // exit function
-        NULL                      // transition function
+        TrackingDelayTran         // transition function
     },                            // current state
     &StateTrackingMode,           // parent state pointer
     "StateTrackingDelay"          // label
@@ -106,7 +109,7 @@ STATIC const LifeTesterState_t StateMeasureScanDataPoint = {
 STATIC const LifeTesterState_t StateError = {
     {
         ErrorEntry,               // entry function
-        ErrorStep,                // step function
+        NULL,                     // step function
         NULL,                     // exit function
         NULL                      // transition function
     },                            // current state
@@ -151,13 +154,17 @@ static void PrintScanMpp(LifeTester_t const *const lifeTester)
     SERIAL_PRINT(lifeTester->data.iScanMpp, "%u");
     SERIAL_PRINT(", Vmpp = ", "%s");
     SERIAL_PRINT(lifeTester->data.vScanMpp, "%u");
+    SERIAL_PRINT(", Vfit = ", "%s");
+    SERIAL_PRINT((float)lifeTester->data.vScanFit / (1U << SCAN_FIT_SHIFT), "%f");
+    SERIAL_PRINT(", Pfit = ", "%s");
+    SERIAL_PRINT(lifeTester->data.pScanFit, "%u");
     SERIAL_PRINT(", ", "%s");
     PrintError(lifeTester->error);
 }
 
 static void PrintScanPoint(LifeTester_t const *const lifeTester)
 {
-    SERIAL_PRINT(lifeTester->io.dac, "%u");
+    SERIAL_PRINT(lifeTester->io.channel, "%u");
     SERIAL_PRINT(", ", "%s");
     SERIAL_PRINT(lifeTester->data.vScan, "%u");
     SERIAL_PRINT(", ", "%s");
@@ -165,18 +172,20 @@ static void PrintScanPoint(LifeTester_t const *const lifeTester)
     SERIAL_PRINT(", ", "%s");
     SERIAL_PRINT(lifeTester->data.pScan, "%u");
     SERIAL_PRINT(", ", "%s");
+    SERIAL_PRINT(lifeTester->data.iVarScan, "%u");
+    SERIAL_PRINT(", ", "%s");
     PrintError(lifeTester->error);
 }
 
 static void PrintScanHeader(void)
 {
     SERIAL_PRINTLN("Scanning for MPP...", "%s");
-    SERIAL_PRINTLN("channel, V, I, P, error", "%s");
+    SERIAL_PRINTLN("channel, V, I, P, var(I), error", "%s");
 }
 
 static void PrintNewMpp(LifeTester_t const *const lifeTester)
 {
-    SERIAL_PRINT(lifeTester->io.dac, "%u");
+    SERIAL_PRINT(lifeTester->io.channel, "%u");
     SERIAL_PRINT(", ", "%s");
     SERIAL_PRINT(lifeTester->data.vThis, "%u");
     SERIAL_PRINT(", ", "%s");
@@ -184,9 +193,11 @@ static void PrintNewMpp(LifeTester_t const *const lifeTester)
     SERIAL_PRINT(", ", "%s");
     SERIAL_PRINT(lifeTester->data.pThis, "%u");
     SERIAL_PRINT(", ", "%s");
-    SERIAL_PRINT(analogRead(LIGHT_SENSOR_PIN), "%u");
+    SERIAL_PRINT(lifeTester->data.iVarThis, "%u");
+    SERIAL_PRINT(", ", "%s");
+    SERIAL_PRINT(lifeTester->data.light, "%u");
     SERIAL_PRINT(", ", "%s");
-    SERIAL_PRINT(TempReadDegC(), "%f");
+    SERIAL_PRINT(TempReadDegC(lifeTester->io.tempSensor), "%f");
     SERIAL_PRINT(", ", "%s");
     PrintError(lifeTester->error);
 }
@@ -194,12 +205,33 @@ static void PrintNewMpp(LifeTester_t const *const lifeTester)
 static void PrintMppHeader(void)
 {
     SERIAL_PRINTLN("Tracking max power point...", "%s");
-    SERIAL_PRINTLN("channel, DACx, ADCx, power, Light Sensor, T(C)", "%s");    
+    SERIAL_PRINTLN("channel, DACx, ADCx, power, var(ADCx), Light Sensor, T(C)", "%s");    
 }
 
 static void ResetTimer(LifeTester_t *const lifeTester)
 {
-    lifeTester->timer = millis(); //reset timer
+    lifeTester->timer = TimerWheel_Now(lifeTester->timers); //reset timer
+}
+
+// Timers post their event to the channel that started them
+static void PostTimerEvent(void *context, uint8_t event)
+{
+    StateMachine_PostEvent((LifeTester_t *)context, (Event_t)event);
+}
+
+static void StartTimer(LifeTester_t *const lifeTester,
+                       Timer_t *const timer,
+                       uint32_t delay,
+                       Event_t e)
+{
+    TimerWheel_Start(lifeTester->timers, timer, delay,
+                     PostTimerEvent, lifeTester, (uint8_t)e);
+}
+
+static void StopTimers(LifeTester_t *const lifeTester)
+{
+    TimerWheel_Stop(lifeTester->timers, &lifeTester->delayTimer);
+    TimerWheel_Stop(lifeTester->timers, &lifeTester->windowTimer);
 }
 
 /*
@@ -212,6 +244,7 @@ STATIC void ActivateThisMeasurement(LifeTester_t *const lifeTester)
     data->vActive = &data->vThis;
     data->iActive = &data->iThis;
     data->pActive = &data->pThis;
+    data->iVarActive = &data->iVarThis;
 }
 
 /*
@@ -224,6 +257,7 @@ STATIC void ActivateNextMeasurement(LifeTester_t *const lifeTester)
     data->vActive = &data->vNext;
     data->iActive = &data->iNext;
     data->pActive = &data->pNext;
+    data->iVarActive = &data->iVarNext;
 }
 
 /*
@@ -236,6 +270,24 @@ STATIC void ActivateScanMeasurement(LifeTester_t *const lifeTester)
     data->vActive = &data->vScan;
     data->iActive = &data->iScan;
     data->pActive = &data->pScan;
+    data->iVarActive = &data->iVarScan;
+}
+
+/*
+ Starts the settle time and the sampling window that follows it. The settle
+ timer posts SettleDoneEvent and the window timer SampleWindowDoneEvent.
+*/
+static void StartMeasurementTimers(LifeTester_t *const lifeTester)
+{
+    const uint16_t tSettle = Config_GetSettleTime(lifeTester->config);
+    const uint16_t tSample = Config_GetSampleTime(lifeTester->config);
+    lifeTester->data.settled = false;
+    lifeTester->data.windowOpen = false;
+    lifeTester->data.windowPending = false;
+    ResetTimer(lifeTester);
+    StartTimer(lifeTester, &lifeTester->delayTimer, tSettle, SettleDoneEvent);
+    StartTimer(lifeTester, &lifeTester->windowTimer, (uint32_t)tSettle + tSample,
+               SampleWindowDoneEvent);
 }
 
 static void ResetForNextMeasurement(LifeTester_t *const lifeTester)
@@ -243,7 +295,182 @@ static void ResetForNextMeasurement(LifeTester_t *const lifeTester)
     // Reset lifetester data
     lifeTester->data.nSamples = 0U;
     lifeTester->data.iSampleSum = 0U;
-    ResetTimer(lifeTester);
+    lifeTester->data.iSampleDevSqSum = 0U;
+    StartMeasurementTimers(lifeTester);
+}
+
+/*
+ Adds a sample to the running sums for this point. Squares are summed as
+ deviations from the first sample so they stay small for a steady current. The
+ sum saturates rather than overflowing. A point that noisy won't stop early.
+*/
+static void AddSample(LifeTesterData_t *const data, uint16_t sample)
+{
+    if (data->nSamples == 0U)
+    {
+        data->iSampleFirst = sample;
+    }
+    const uint32_t dev = abs((int32_t)sample - (int32_t)data->iSampleFirst);
+    const uint32_t devSq = dev * dev;
+    data->iSampleDevSqSum = (devSq > (0xFFFFFFFFUL - data->iSampleDevSqSum)) ?
+        0xFFFFFFFFUL : (data->iSampleDevSqSum + devSq);
+    data->iSampleSum += sample;
+    data->nSamples++;
+}
+
+/*
+ Variance of the samples from the sums of deviations d from the first sample,
+ (sum(d^2) - sum(d)^2 / n) / (n - 1). sum(d)^2 / n can't exceed sum(d^2) so
+ there's no overflow.
+*/
+static uint32_t GetSampleVariance(LifeTesterData_t const *const data)
+{
+    const uint16_t n = data->nSamples;
+    if (n < 2U)
+    {
+        return 0U;
+    }
+    if (data->iSampleDevSqSum == 0xFFFFFFFFUL)
+    {
+        return 0xFFFFFFFFUL;
+    }
+    const int32_t  devSum = (int32_t)(data->iSampleSum - (uint32_t)n * data->iSampleFirst);
+    const uint32_t absDevSum = abs(devSum);
+    return (data->iSampleDevSqSum - absDevSum * (absDevSum / n)) / (n - 1U);
+}
+
+/*
+ The sampling window can end early once the standard error of the mean,
+ sqrt(variance / n), is within the tolerance in adc codes.
+*/
+static bool SampleErrorWithinTolerance(LifeTesterData_t const *const data,
+                                       uint8_t tolerance)
+{
+    return (tolerance != SAMPLE_TOLERANCE_OFF)
+           && (data->nSamples >= SAMPLE_MIN_COUNT)
+           && ((GetSampleVariance(data) / data->nSamples)
+               <= ((uint16_t)tolerance * tolerance));
+}
+
+// Averages the samples for the point being measured
+static void FinishMeasurement(LifeTester_t *const lifeTester)
+{
+    LifeTesterData_t *const data = &lifeTester->data;
+    *data->iActive = data->iSampleSum / data->nSamples;
+    *data->pActive = *data->vActive * *data->iActive; 
+    *data->iVarActive = GetSampleVariance(data);
+    // the window may have ended early
+    StopTimers(lifeTester);
+    // Readings are averaged in the transition function for now.
+    StateMachineTransitionOnEvent(lifeTester, MeasurementDoneEvent);
+}
+
+/*
+ End of the sampling window. Closes the window to free the adc for the other
+ channel and averages the samples. If none were taken the measurement was
+ interrupted so the settle time and window are run again. Note that we'll never
+ leave this state if the adc isn't returning data.
+*/
+static void SampleWindowDone(LifeTester_t *const lifeTester)
+{
+    AdcCancelLifeTesterRead(lifeTester);
+    if (lifeTester->data.nSamples > 0U)
+    {
+        FinishMeasurement(lifeTester);
+    }
+    else
+    {
+        StartMeasurementTimers(lifeTester);
+    }
+}
+
+/*
+ Least-squares quadratic through the five scan points centred on the best one
+ at x = -2..2 steps. With d the powers relative to the centre
+   a1 = S1 / 10 where S1 = sum(x * d)
+   a2 = S2 / 14 where S2 = sum((x^2 - 2) * d)
+ and the vertex is at x = -a1 / (2 * a2) = 7 * S1 / (-10 * S2), where the power
+ is a0 + a1 * x / 2. A vertex further than a step from the best point is
+ clamped to that step and the power is the fit there, a0 + a1 * x + a2 * x^2.
+ Only 32-bit integer maths so it's cheap enough to run for each new peak.
+*/
+static void FitScanPeak(LifeTesterData_t *const data)
+{
+    uint32_t const *const p = data->pScanRecent;
+    const int32_t dLow2  = (int32_t)(p[0] - p[2]);
+    const int32_t dLow1  = (int32_t)(p[1] - p[2]);
+    const int32_t dHigh1 = (int32_t)(p[3] - p[2]);
+    const int32_t dHigh2 = (int32_t)(p[4] - p[2]);
+    const int32_t s1 = 2 * (dHigh2 - dLow2) + (dHigh1 - dLow1);
+    const int32_t s2 = 2 * (dHigh2 + dLow2) - (dHigh1 + dLow1);
+    if (s2 >= 0)
+    {
+        // flat or not a peak - keep the best point measured
+        return;
+    }
+    int32_t num = 7 * s1;
+    int32_t den = -10 * s2;
+    int32_t x;  // vertex in 1/2^SCAN_FIT_SHIFT steps
+    int32_t dFit; // fitted power at x less a0
+    if (abs(num) >= den)
+    {
+        // x is a whole step so x^2 = 1
+        x = (num > 0) ? (1 << SCAN_FIT_SHIFT) : -(1 << SCAN_FIT_SHIFT);
+        dFit = ((num > 0) ? s1 : -s1) / 10 + s2 / 14;
+    }
+    else
+    {
+        // scale down so that the shift can't overflow. den > |num| so it stays > 0
+        while (abs(num) >= (1L << (30U - SCAN_FIT_SHIFT)))
+        {
+            num /= 2;
+            den /= 2;
+        }
+        x = (num << SCAN_FIT_SHIFT) / den;
+        dFit = (s1 * x) / (20 << SCAN_FIT_SHIFT);
+    }
+    const int32_t a0 = (12 * (dLow1 + dHigh1) - 3 * (dLow2 + dHigh2)) / 35;
+    const int32_t vFit = ((int32_t)data->vScanMpp << SCAN_FIT_SHIFT)
+                         + x * data->scanStep;
+    data->vScanFit = (uint16_t)max(vFit, 0);
+    data->pScanFit = (uint32_t)((int32_t)p[2] + a0 + dFit);
+}
+
+/*
+ Keeps the last few scan powers. Once the best point has two measured either
+ side of it the peak is fitted. Until then the best point measured is used.
+ Golden-section points aren't evenly spaced so they aren't fitted.
+*/
+static void UpdateScanFit(LifeTesterData_t *const data, bool newMpp)
+{
+    memmove(&data->pScanRecent[0], &data->pScanRecent[1],
+            (SCAN_FIT_POINTS - 1U) * sizeof(data->pScanRecent[0]));
+    data->pScanRecent[SCAN_FIT_POINTS - 1U] = data->pScan;
+    data->nScanRecent = min(data->nScanRecent + 1U, SCAN_FIT_POINTS);
+    if (newMpp)
+    {
+        data->vScanFit = (uint16_t)data->vScanMpp << SCAN_FIT_SHIFT;
+        data->pScanFit = data->pScanMpp;
+        data->nSinceScanMpp = 0U;
+    }
+    else
+    {
+        data->nSinceScanMpp++;
+        if ((data->nSinceScanMpp == (SCAN_FIT_POINTS / 2U))
+            && (data->nScanRecent == SCAN_FIT_POINTS)
+            && (data->scanStrategy != SCAN_GOLDEN_SECTION))
+        {
+            FitScanPeak(data);
+        }
+    }
+}
+
+// Dac code nearest the fitted mpp leaving room for the next point
+static uint8_t GetScanFitCode(LifeTesterData_t const *const data)
+{
+    const uint16_t code = (data->vScanFit + (1U << (SCAN_FIT_SHIFT - 1U)))
+                          >> SCAN_FIT_SHIFT;
+    return (uint8_t)min(code, (uint16_t)(0xFFU - DV_MPPT));
 }
 
 static void UpdateScanData(LifeTester_t *const lifeTester)
@@ -251,12 +478,14 @@ static void UpdateScanData(LifeTester_t *const lifeTester)
     LifeTesterData_t *const data = &lifeTester->data;
     // Update max power and vMPP if we have found a maximum power point.
     data->pScan = data->iScan * data->vScan;
-    if (data->pScan > data->pScanMpp)
+    const bool newMpp = (data->pScan > data->pScanMpp);
+    if (newMpp)
     {  
         data->pScanMpp = data->iScan * data->vScan;
         data->iScanMpp = data->iScan;
         data->vScanMpp = data->vScan;
     }  
+    UpdateScanFit(data, newMpp);
     // Store first and last powers to check scan shape. 
     if (data->vScan == V_SCAN_MIN)
     {
@@ -274,6 +503,254 @@ static void UpdateScanData(LifeTester_t *const lifeTester)
     PrintScanPoint(lifeTester);
 }
 
+/*
+ Warm start from the mpp stored for this channel. Only used if the channel
+ wasn't in error when it was stored and there's room for the check either side.
+*/
+static void LoadWarmStart(LifeTester_t *const lifeTester)
+{
+    LifeTesterData_t *const data = &lifeTester->data;
+    MppRecord_t record;
+    data->warmStart =
+        MppStore_Load(lifeTester->mppStore, lifeTester->io.channel, &record)
+        && (record.error == ok)
+        && (record.v >= WARM_START_SPAN)
+        && (record.v <= (0xFFU - DV_MPPT - WARM_START_SPAN));
+    if (data->warmStart)
+    {
+        data->vThis = record.v;
+        data->pWarmStart = record.p;
+        SERIAL_PRINT("Warm start from stored mpp v = ", "%s");
+        SERIAL_PRINTLN(record.v, "%u");
+    }
+}
+
+static void SaveMpp(LifeTester_t *const lifeTester, uint8_t v, uint32_t p)
+{
+    const MppRecord_t record = {v, p, (uint8_t)lifeTester->error};
+    MppStore_Save(lifeTester->mppStore, lifeTester->io.channel, &record);
+    lifeTester->data.nSinceSave = 0U;
+}
+
+static void SaveMppPeriodically(LifeTester_t *const lifeTester)
+{
+    LifeTesterData_t *const data = &lifeTester->data;
+    data->nSinceSave++;
+    if (data->nSinceSave >= MPP_SAVE_CYCLES)
+    {
+        SaveMpp(lifeTester, data->vThis, data->pThis);
+    }
+}
+
+/*
+ Checks for a sudden change in light since the last cycles. The reading is
+ compared with a running average so that slow drifts are left to tracking and
+ only steps such as shading or a lamp change trigger a re-scan. The reading is
+ kept to print with the mpp.
+*/
+static bool LightChanged(LifeTesterData_t *const data,
+                         Config_t const *const config)
+{
+    const uint8_t threshold = Config_GetLightChangeThreshold(config);
+    data->lightPrev = data->light;
+    data->light = (uint16_t)analogRead(LIGHT_SENSOR_PIN);
+    if (!data->lightAvgValid)
+    {
+        // first cycle since a scan - nothing to compare against yet
+        data->lightAvg = data->light << LIGHT_FILTER_SHIFT;
+        data->lightAvgValid = true;
+        return false;
+    }
+    const uint32_t light = (uint32_t)data->light << LIGHT_FILTER_SHIFT;
+    const uint32_t average = data->lightAvg;
+    const uint32_t change = (light > average) ? (light - average) : (average - light);
+    data->lightAvg = data->lightAvg - (data->lightAvg >> LIGHT_FILTER_SHIFT)
+                     + data->light;
+    return (threshold != LIGHT_CHANGE_OFF)
+           && ((change << 8U) > (average * threshold));
+}
+
+// Scans around vThis. The ends are clamped to the dac range.
+static void StartLocalScan(LifeTesterData_t *const data, uint8_t span, uint8_t step)
+{
+    data->scanStrategy = SCAN_LOCAL;
+    data->scanStopMargin = SCAN_NO_EARLY_STOP;
+    data->scanStep = step;
+    data->vScanLow = data->vThis - min(span, data->vThis);
+    data->vScanHigh = data->vThis
+                      + min(span, (uint8_t)(0xFFU - DV_MPPT - data->vThis));
+}
+
+/*
+ Resets scan data ready for the first point. A warm start or a re-scan measures
+ around the mpp in vThis, otherwise the configured scan strategy is used.
+*/
+static void StartScan(LifeTesterData_t *const data,
+                      Config_t const *const config)
+{
+    data->pScanInitial = 0U;
+    data->pScanFinal = 0U;
+    data->pScanMpp = 0U;
+    data->iScanMpp = 0U;
+    data->vScanMpp = 0U;
+    data->nScanned = 0U;
+    data->nScanLowCurrent = 0U;
+    data->nScanRecent = 0U;
+    data->nSinceScanMpp = 0U;
+    data->vScanFit = 0U;
+    data->pScanFit = 0U;
+    data->scanDone = false;
+    data->lightAvgValid = false;
+    data->dwell = false;
+    data->nCycle = 0U;
+    data->dvLast = 0;
+    data->warmStartMatch = false;
+    if (data->warmStart)
+    {
+        StartLocalScan(data, WARM_START_SPAN, WARM_START_SPAN);
+    }
+    else if (data->rescan)
+    {
+        StartLocalScan(data, LIGHT_RESCAN_SPAN, LIGHT_RESCAN_STEP);
+    }
+    else
+    {
+        data->scanStrategy = Config_GetScanStrategy(config);
+        data->scanStopMargin = Config_GetScanStopMargin(config);
+        data->scanStep = DV_SCAN;
+        data->vScanLow = V_SCAN_MIN;
+        data->vScanHigh = V_SCAN_MAX;
+    }
+    data->vScan = data->vScanLow;
+}
+
+/*
+ Local scan from vScanLow to vScanHigh in steps of scanStep. The ends are the
+ initial and final points for the hill-shape check so it only passes if the mpp
+ is still inside. A warm start takes one step either side of the stored mpp and
+ compares the power at it with the stored power.
+*/
+static void NextLocalScanPoint(LifeTesterData_t *const data)
+{
+    if (data->vScan == data->vScanLow)
+    {
+        data->pScanInitial = data->pScan;
+    }
+    if (data->warmStart && (data->vScan == data->vThis))
+    {
+        const uint32_t change = (data->pScan > data->pWarmStart) ?
+            (data->pScan - data->pWarmStart) : (data->pWarmStart - data->pScan);
+        // v is 8 bits and i 16 bits so p < 2^24 and neither side can overflow
+        data->warmStartMatch =
+            ((change << 8U) <= (data->pWarmStart * WARM_START_TOLERANCE));
+    }
+    // points stay evenly spaced - the last one may fall short of vScanHigh
+    if (((uint16_t)data->vScan + data->scanStep) > data->vScanHigh)
+    {
+        data->pScanFinal = data->pScan;
+        data->scanDone = true;
+    }
+    else
+    {
+        data->vScan += data->scanStep;
+    }
+}
+
+/*
+ Steps through the scan range. Once the current has stayed below MIN_CURRENT
+ for more than the stop margin the device is past open circuit and the rest of
+ the range can't hold the mpp. The last point measured is used as the final
+ point for the hill-shape check.
+*/
+static void NextLinearScanPoint(LifeTesterData_t *const data)
+{
+    data->nScanLowCurrent = (data->iScan < MIN_CURRENT) ?
+        (uint8_t)min(data->nScanLowCurrent + 1U, 0xFFU) : 0U;
+    const bool pastVoc = (data->scanStopMargin != SCAN_NO_EARLY_STOP)
+                         && (data->nScanLowCurrent > data->scanStopMargin);
+    if (pastVoc)
+    {
+        data->pScanFinal = data->pScan;
+        data->scanDone = true;
+    }
+    else
+    {
+        data->vScan += DV_SCAN;
+        data->scanDone = (data->vScan > V_SCAN_MAX);
+    }
+}
+
+// ~0.618 of the width, rounded
+static uint8_t GoldenSection(uint8_t width)
+{
+    return (uint8_t)(((uint16_t)width * 158U + 128U) >> 8U);
+}
+
+/*
+ Golden-section search for the mpp. Both ends of the scan range are measured
+ first so the hill-shape check still works. Then two probes split the bracket
+ between them in the golden ratio. Each step drops the part of the bracket
+ beyond the probe with less power. The other probe is reused, so only one new
+ point is measured per step. The search ends when there's no room left for a
+ new probe. UpdateScanData keeps the best point measured as the mpp.
+*/
+static void NextGoldenSectionPoint(LifeTesterData_t *const data)
+{
+    data->nScanned++;
+    if (data->nScanned == 1U)
+    {
+        data->vScan = V_SCAN_MAX;
+    }
+    else if (data->nScanned == 2U)
+    {
+        const uint8_t golden = GoldenSection(data->vScanHigh - data->vScanLow);
+        data->vProbeLow = data->vScanHigh - golden;
+        data->vProbeHigh = data->vScanLow + golden;
+        data->vScan = data->vProbeLow;
+        // range too narrow for two probes. Both ends are all there is.
+        data->scanDone = (data->vProbeLow >= data->vProbeHigh);
+    }
+    else if (data->nScanned == 3U)
+    {
+        data->pProbeLow = data->pScan;
+        data->vScan = data->vProbeHigh;
+    }
+    else
+    {
+        if (data->vScan == data->vProbeLow)
+        {
+            data->pProbeLow = data->pScan;
+        }
+        else
+        {
+            data->pProbeHigh = data->pScan;
+        }
+
+        if (data->pProbeLow < data->pProbeHigh)  // mpp is above the low probe
+        {
+            data->vScanLow = data->vProbeLow;
+            data->vProbeLow = data->vProbeHigh;
+            data->pProbeLow = data->pProbeHigh;
+            const uint8_t golden = GoldenSection(data->vScanHigh - data->vScanLow);
+            data->vProbeHigh = max((uint8_t)(data->vScanLow + golden),
+                                   (uint8_t)(data->vProbeLow + 1U));
+            data->vScan = data->vProbeHigh;
+            data->scanDone = (data->vProbeHigh >= data->vScanHigh);
+        }
+        else  // mpp is below the high probe
+        {
+            data->vScanHigh = data->vProbeHigh;
+            data->vProbeHigh = data->vProbeLow;
+            data->pProbeHigh = data->pProbeLow;
+            const uint8_t golden = GoldenSection(data->vScanHigh - data->vScanLow);
+            data->vProbeLow = min((uint8_t)(data->vScanHigh - golden),
+                                  (uint8_t)(data->vProbeHigh - 1U));
+            data->vScan = data->vProbeLow;
+            data->scanDone = (data->vProbeLow <= data->vScanLow);
+        }
+    }
+}
+
 /*******************************************************************************
 * FUNCTIONS FOR INITIALISE STATE
 *******************************************************************************/
@@ -282,10 +759,13 @@ STATIC void InitialiseEntry(LifeTester_t *const lifeTester)
     // reset all the data and errors
     memset(&lifeTester->data, 0U, sizeof(LifeTesterData_t));
     // initialise timer.
-    lifeTester->timer = millis();
+    ResetTimer(lifeTester);
     lifeTester->error = ok;
+    // give up the adc and timers if reset part way through a measurement
+    StopTimers(lifeTester);
+    AdcCancelLifeTesterRead(lifeTester);
     // Ensure that the dac can be set or else raise an error
-    DacSetOutput(0U, lifeTester->io.dac);
+    DacSetOutput(lifeTester, 0U);
     // TODO - move to step fn. Simpler to keep transitions to child step fn only
     if (!(DacGetOutput(lifeTester) == 0U)) 
     {
@@ -295,32 +775,35 @@ STATIC void InitialiseEntry(LifeTester_t *const lifeTester)
     // Signal that lifetester is being initialised.
     lifeTester->led.t(INIT_LED_ON_TIME, INIT_LED_OFF_TIME);
     lifeTester->led.keepFlashing();
+    // short-circuit current is read once the device has settled
+    StartTimer(lifeTester, &lifeTester->delayTimer,
+               Config_GetSettleTime(lifeTester->config), SettleDoneEvent);
 }
 
 STATIC void InitialiseStep(LifeTester_t *const lifeTester)
 {
-    lifeTester->led.update();    
     // TODO: Auto gain. Need a new state for this.
     // Check short-circuit current is above required threshold for measurements
-    const uint32_t tPresent   = millis();
-    const uint32_t tElapsed   = tPresent - lifeTester->timer;
-    const bool     stabilised = (tElapsed >= Config_GetSettleTime());
+    uint16_t iShortCircuit;
 
     if (lifeTester->data.nErrorReads > MAX_ERROR_READS)
     {
         // Only transition to error if enough bad readings have happened.
         StateMachineTransitionOnEvent(lifeTester, ErrorEvent);
     }
-    else if (!stabilised)
+    else if (!lifeTester->data.settled)
     {
         // don't do anything just keep waiting
     }
+    else if (!AdcPollLifeTesterCurrent(lifeTester, &iShortCircuit))
+    {
+        // conversion not ready yet - poll again on the next update
+    }
     else
     {
-        const uint16_t iShortCircuit = AdcReadLifeTesterCurrent(lifeTester);
         SERIAL_PRINT("Initialising. Short-circuit current = ", "%s");
         SERIAL_PRINTLN(iShortCircuit, "%u");
-        if (iShortCircuit < Config_GetThresholdCurrent())
+        if (iShortCircuit < Config_GetThresholdCurrent(lifeTester->config))
         {
             lifeTester->error = currentThreshold;
             lifeTester->data.nErrorReads++;
@@ -337,6 +820,7 @@ STATIC void InitialiseStep(LifeTester_t *const lifeTester)
         else
         {
             lifeTester->error = ok;
+            LoadWarmStart(lifeTester);
             StateMachineTransitionOnEvent(lifeTester, MeasurementDoneEvent);
         }
     }
@@ -355,6 +839,10 @@ STATIC void InitialiseTran(LifeTester_t *const lifeTester,
         StateMachineTransitionToState(lifeTester, &StateError);
 
     }
+    else if (e == SettleDoneEvent)
+    {
+        lifeTester->data.settled = true;
+    }
     else
     {
         StateMachineTransitionToState(lifeTester, &StateInitialiseDevice);
@@ -370,7 +858,7 @@ STATIC void ScanningModeEntry(LifeTester_t *const lifeTester)
     PrintScanHeader();
     lifeTester->led.t(SCAN_LED_ON_TIME, SCAN_LED_OFF_TIME);
     lifeTester->led.keepFlashing();
-    lifeTester->data.vScan = 0U;
+    StartScan(&lifeTester->data, lifeTester->config);
 }
 
 STATIC void ScanningModeTran(LifeTester_t *const lifeTester,
@@ -399,14 +887,18 @@ STATIC void ScanningModeTran(LifeTester_t *const lifeTester,
 
 STATIC void ScanningModeStep(LifeTester_t *const lifeTester)
 {
-    lifeTester->led.update();
-
     LifeTesterData_t *const data = &lifeTester->data;
-    if (data->vScan > V_SCAN_MAX)  // scanning done
+    if (data->scanDone)
     {
         // check that the scan is a hill shape
-        const bool scanShapeOk = (data->pScanInitial < data->pScanMpp)
-                                  && (data->pScanFinal < data->pScanMpp);
+        const bool hillShape = (data->pScanInitial < data->pScanMpp)
+                               && (data->pScanFinal < data->pScanMpp);
+        /* A re-scan only seeds tracking. If the mpp has moved outside it the
+        best point is still the closest so tracking carries on from there. The
+        same goes for a warm start that measured the stored power again.*/
+        const bool scanShapeOk = hillShape
+                                 || ((data->rescan || data->warmStartMatch)
+                                     && (data->pScanMpp > 0U));
         lifeTester->error = (!scanShapeOk) ? invalidScan : lifeTester->error;  
         
         // report max power point
@@ -414,10 +906,36 @@ STATIC void ScanningModeStep(LifeTester_t *const lifeTester)
 
         // Update v to max power point if there's no error otherwise set back to initial value.
         // Scanning is done so go to tracking
-        if (lifeTester->error == ok)
+        if ((lifeTester->error == invalidScan) && data->warmStart
+            && (data->pScanMpp > 0U))
         {
+            /* power at the stored mpp has changed so the light or the device
+            has too. Look around the best point like a light change would.*/
+            SERIAL_PRINTLN("Warm start power changed. Re-scanning around mpp", "%s");
+            lifeTester->error = ok;
+            data->warmStart = false;
+            data->rescan = true;
             data->vThis = data->vScanMpp;
-            data->vNext = data->vScanMpp + DV_MPPT;
+            StartScan(data, lifeTester->config);
+        }
+        else if ((lifeTester->error == invalidScan)
+                 && (data->scanStrategy == SCAN_LOCAL))
+        {
+            // mpp isn't where it was - fall back to the full scan
+            SERIAL_PRINTLN("Local scan failed", "%s");
+            lifeTester->error = ok;
+            data->warmStart = false;
+            data->rescan = false;
+            StartScan(data, lifeTester->config);
+        }
+        else if (lifeTester->error == ok)
+        {
+            data->warmStart = false;
+            data->rescan = false;
+            // tracking starts from the fitted mpp rather than the best point
+            data->vThis = GetScanFitCode(data);
+            data->vNext = data->vThis + DV_MPPT;
+            SaveMpp(lifeTester, data->vThis, data->pScanFit);
             StateMachineTransitionOnEvent(lifeTester, ScanningDoneEvent);
         }
         else // error condition so go to error state
@@ -443,8 +961,20 @@ STATIC void ScanningModeExit(LifeTester_t *const lifeTester)
 
 STATIC void MeasureScanDataPointExit(LifeTester_t *const lifeTester)
 {
+    LifeTesterData_t *const data = &lifeTester->data;
     UpdateScanData(lifeTester);
-    lifeTester->data.vScan += DV_SCAN;
+    if (data->scanStrategy == SCAN_GOLDEN_SECTION)
+    {
+        NextGoldenSectionPoint(data);
+    }
+    else if (data->scanStrategy == SCAN_LOCAL)
+    {
+        NextLocalScanPoint(data);
+    }
+    else
+    {
+        NextLinearScanPoint(data);
+    }
 }
 
 /*******************************************************************************
@@ -473,45 +1003,65 @@ STATIC void MeasureDataPointEntry(LifeTester_t *const lifeTester)
     }
 }
 
+/*
+ The settle and window timers do the waiting. Once the settle timer fires the
+ adc is polled for samples until the window timer fires. If the adc mux has to
+ settle onto this channel's input first the window is lengthened by the mux
+ settle time. While another channel has the adc the window timer is stopped,
+ and it's started again once the window is granted.
+*/
 STATIC void MeasureDataPointStep(LifeTester_t *const lifeTester)
 {
     LifeTesterData_t *const data = &lifeTester->data;
 
-    const uint32_t tPresent = millis();
-    const uint16_t tSettle = Config_GetSettleTime();
-    const uint16_t tSample = Config_GetSampleTime();
-    const uint32_t tElapsed = tPresent - lifeTester->timer;
-    const bool     readAdc = (tElapsed >= tSettle)
-                             && (tElapsed < (tSettle + tSample));
-    const bool     samplingExpired = (tElapsed >= (tSettle + tSample));
-    const bool     adcRead = (lifeTester->data.nSamples > 0U);
+    const uint16_t tSettle = Config_GetSettleTime(lifeTester->config);
+    const uint16_t tSample = Config_GetSampleTime(lifeTester->config);
+    const uint8_t  tolerance = Config_GetSampleTolerance(lifeTester->config);
 
-    if (readAdc) // Is it time to read the adc?
+    if (!data->settled)
     {
-        const uint16_t sample = AdcReadLifeTesterCurrent(lifeTester);
-        data->iSampleSum += sample;
-        data->nSamples++;
+        // nothing to do until the settle timer fires
     }
-    else if (samplingExpired)
+    else if (!AdcClaimSampleWindow(lifeTester))
     {
-        if (adcRead)
+        if (!data->windowPending)
         {
-            *data->iActive = data->iSampleSum / data->nSamples;
-            *data->pActive = *data->vActive * *data->iActive; 
-            // Readings are averaged in the transition function for now.
-            StateMachineTransitionOnEvent(lifeTester, MeasurementDoneEvent);
-        }
-        else
-        {
-            /*Measurement interrupted. Restart timer and try again.
-            Note that we'll never leave this state if adc isn't returning data.*/
-            lifeTester->timer = tPresent;
+            // another channel is sampling - hold this window back until it's done
+            data->windowPending = true;
+            TimerWheel_Stop(lifeTester->timers, &lifeTester->windowTimer);
         }
     }
     else
     {
-        /* Do nothing. Just leave update. More time elapses and then 
-        when update is called, the next state will change.*/
+        if (!data->windowOpen)
+        {
+            // conversions thrown away while the mux settles don't count against the window
+            const uint16_t tMuxSettle = AdcGetMuxSettleTime(lifeTester);
+            data->windowOpen = true;
+            if (data->windowPending)
+            {
+                // the window starts now rather than when the settle time ran out
+                lifeTester->timer = TimerWheel_Now(lifeTester->timers) - tSettle;
+            }
+            if (data->windowPending || (tMuxSettle > 0U))
+            {
+                StartTimer(lifeTester, &lifeTester->windowTimer,
+                           (uint32_t)tSample + tMuxSettle, SampleWindowDoneEvent);
+            }
+            data->windowPending = false;
+        }
+        // returns straight away if no conversion is ready yet
+        uint16_t sample;
+        if (AdcPollLifeTesterCurrent(lifeTester, &sample))
+        {
+            AddSample(data, sample);
+            if (SampleErrorWithinTolerance(data, tolerance))
+            {
+                // quiet enough already - no need to wait for the whole window
+                AdcCancelLifeTesterRead(lifeTester);
+                FinishMeasurement(lifeTester);
+            }
+        }
     }
 }
 
@@ -523,10 +1073,18 @@ STATIC void MeasureDataPointTran(LifeTester_t *const lifeTester,
         // transition child->parent. Exit function will get called.
         StateMachineTransitionToState(lifeTester, lifeTester->state->parent);
     }
-    if (e == ErrorEvent)
+    else if (e == ErrorEvent)
     {
         StateMachineTransitionToState(lifeTester, &StateError);
     }
+    else if (e == SettleDoneEvent)
+    {
+        lifeTester->data.settled = true;
+    }
+    else if (e == SampleWindowDoneEvent)
+    {
+        SampleWindowDone(lifeTester);
+    }
     else
     {
         /*Don't do anything. Transition function exits and execution returns to
@@ -545,8 +1103,6 @@ STATIC void TrackingModeEntry(LifeTester_t *const lifeTester)
 
 STATIC void TrackingModeStep(LifeTester_t *const lifeTester)
 {
-    lifeTester->led.update();
-
     const bool measurementsDone = lifeTester->data.thisDone
                                   && lifeTester->data.nextDone;
     const bool trackDelayDone   = lifeTester->data.delayDone;
@@ -562,10 +1118,30 @@ STATIC void TrackingModeStep(LifeTester_t *const lifeTester)
     {
         StateMachineTransitionOnEvent(lifeTester, MeasurementStartEvent);
     }
+    else if (LightChanged(&lifeTester->data, lifeTester->config))
+    {
+        // mpp has moved with the light - re-scan around it rather than creep there
+        SERIAL_PRINTLN("Light changed. Re-scanning around mpp", "%s");
+        lifeTester->data.rescan = true;
+        lifeTester->data.thisDone = false;
+        lifeTester->data.nextDone = false;
+        lifeTester->data.delayDone = false;
+        StateMachineTransitionOnEvent(lifeTester, LightChangeEvent);
+    }
+    else if (Dwelling(lifeTester))
+    {
+        // sitting at the mpp - measurements for the next cycle are set up
+        lifeTester->data.delayDone = false;
+    }
     else // recalculate working mpp and restart measurements
     {
+        const bool    uphill = (lifeTester->data.pNext > lifeTester->data.pThis);
+        const uint8_t vNextPrev = lifeTester->data.vNext;
         UpdateTrackingData(lifeTester);
-        lifeTester->data.thisDone = false;
+        SaveMppPeriodically(lifeTester);
+        // next measurement only applies if this point has moved onto it
+        const bool    onNext = (lifeTester->data.vThis == vNextPrev);
+        lifeTester->data.thisDone = ReuseNextMeasurement(lifeTester, uphill && onNext);
         lifeTester->data.nextDone = false;
         lifeTester->data.delayDone = false;
     }
@@ -595,6 +1171,10 @@ STATIC void TrackingModeTran(LifeTester_t *const lifeTester,
     {
         StateMachineTransitionToState(lifeTester, &StateTrackingDelay);
     }
+    else if (e == LightChangeEvent)
+    {
+        StateMachineTransitionToState(lifeTester, &StateScanningMode);
+    }
     else if (e == ErrorEvent)
     {
         StateMachineTransitionToState(lifeTester, &StateError);
@@ -647,39 +1227,257 @@ static void UpdateErrorReadings(LifeTester_t *const lifeTester)
  function.
  ie. This will only be called if guards are satisfied.
 */
+// True if the light moved by more than DV_LIGHT_TOLERANCE/256 since the last cycle
+static bool LightMovedSinceLastCycle(LifeTesterData_t const *const data)
+{
+    const uint32_t change = (data->light > data->lightPrev) ?
+        (data->light - data->lightPrev) : (data->lightPrev - data->light);
+    return (change << 8U) > ((uint32_t)data->lightPrev * DV_LIGHT_TOLERANCE);
+}
+
+/*
+ Size of the step to move this point by. The maximum step is scaled by the
+ square of the normalised slope of the power curve |dP/dV|/(P/V) = |dP|/(dV * I)
+ measured between this and the next point, clamped to 1. This is ~1 far from
+ the mpp and falls to 0 at it. A step is at most twice the last one in the same
+ direction and at most half of it on a reversal, so overshooting the mpp closes
+ in on it rather than swinging across it. Clamped to the configured min and max
+ steps.
+*/
+static uint8_t GetTrackingStep(LifeTesterData_t const *const data,
+                               Config_t const *const config)
+{
+    const uint8_t  dvMin = Config_GetMinStep(config);
+    const uint8_t  dvMax = Config_GetMaxStep(config);
+    const bool     uphill = (data->pNext > data->pThis);
+    const uint32_t dP = uphill ? (data->pNext - data->pThis)
+                               : (data->pThis - data->pNext);
+    const uint32_t pScale = (uint32_t)data->iThis * DV_MPPT;
+    /* Current can only fall with voltage so a slope above 1 uphill can't come
+    from the power curve. Light must have changed between measurements - don't
+    trust it. Downhill past the mpp the curve is steeper than that.*/
+    if ((pScale == 0U) || (uphill && (dP > pScale))
+        || LightMovedSinceLastCycle(data))
+    {
+        return dvMin;
+    }
+    // slope as a fraction of 256. min(dP, pScale) <= 0xFFFF so this can't overflow
+    const uint32_t slope = (min(dP, pScale) << 8U) / pScale;
+    const uint32_t dvLast = (uint32_t)abs(data->dvLast);
+    uint32_t dv = (slope * slope * dvMax) >> 16U;
+    if ((data->dvLast != 0) && ((data->dvLast > 0) != uphill))
+    {
+        dv = min(dv, dvLast / 2U);
+    }
+    else
+    {
+        dv = min(dv, 2U * max(dvLast, (uint32_t)dvMin));
+    }
+    return (uint8_t)max(dvMin, min(dv, dvMax));
+}
+
+/*
+ Incremental conductance. Taking the conductance between this and the next point
+ at their midpoint, dI/dV + I/V = dP / (V * dV), which is 0 at the mpp and has
+ the same sign as dP either side of it. The tracker is at the mpp when
+ |dI/dV + I/V| is within INC_COND_TOLERANCE/256 of I/V, ie. when
+ |dP| * 256 <= tolerance * I * dV.
+*/
+static bool IncCondAtMpp(LifeTesterData_t const *const data)
+{
+    const uint32_t dP = (data->pNext > data->pThis) ?
+        (data->pNext - data->pThis) : (data->pThis - data->pNext);
+    const uint32_t iMid = ((uint32_t)data->iThis + data->iNext) >> 1U;
+    const uint32_t pScale = iMid * DV_MPPT;
+    // tolerance < 256 so a bigger dP can't be at the mpp. Checking first stops dP * 256 overflowing
+    if (dP > pScale)
+    {
+        return false;
+    }
+    return ((dP << 8U) <= (pScale * INC_COND_TOLERANCE));
+}
+
 static void UpdateTrackingData(LifeTester_t *const lifeTester)
 {
     LifeTesterData_t *const data = &lifeTester->data;
+    const uint8_t algorithm =
+        bitRead(Config_GetTrackingAlgorithms(lifeTester->config), lifeTester->io.channel);
+    if ((algorithm == INC_CONDUCTANCE) && IncCondAtMpp(data))
+    {
+        // hold at the mpp rather than stepping either side of it.
+        data->vNext = data->vThis + DV_MPPT;
+        PrintNewMpp(lifeTester);
+        IoStats_CycleDone(lifeTester->ioStats, lifeTester->io.channel);
+        return;
+    }
+    const uint8_t step = GetTrackingStep(data, lifeTester->config);
     /*if power is higher at the next point, we must be going uphill so move
-    forwards one point for next loop*/
+    forwards for next loop. Steps are clamped to stay within the dac range.*/
     if (data->pNext > data->pThis)
     {
-        data->vThis += DV_MPPT;
+        const uint8_t dv = min(step, (uint8_t)(0xFFU - DV_MPPT - data->vThis));
+        data->vThis += dv;
         data->vNext = data->vThis + DV_MPPT;
+        data->dvLast = dv;
         lifeTester->led.stopAfter(2); //two flashes
     }
     else // otherwise go the other way...
     {
-        data->vThis -= DV_MPPT;
+        const uint8_t dv = min(step, data->vThis);
+        data->vThis -= dv;
         data->vNext = data->vThis + DV_MPPT;
+        data->dvLast = -(int16_t)dv;
         lifeTester->led.stopAfter(1); //one flash
     }
     PrintNewMpp(lifeTester);
+    IoStats_CycleDone(lifeTester->ioStats, lifeTester->io.channel);
+}
+
+/*
+ Perturb-observe at the mpp cycles between neighbouring codes. Keeps the range
+ of codes this point has covered and the best point measured in it. Returns
+ true once this point has stayed within DWELL_DETECT_SPAN codes for
+ DWELL_DETECT_CYCLES cycles.
+*/
+static bool OscillatingAtMpp(LifeTesterData_t *const data)
+{
+    const uint8_t low = min(data->vCycleLow, data->vThis);
+    const uint8_t high = max(data->vCycleHigh, data->vThis);
+    if ((data->nCycle == 0U) || ((high - low) > DWELL_DETECT_SPAN))
+    {
+        // moved away - start a new range here
+        data->vCycleLow = data->vThis;
+        data->vCycleHigh = data->vThis;
+        data->pBest = 0U;
+        data->nCycle = 0U;
+    }
+    else
+    {
+        data->vCycleLow = low;
+        data->vCycleHigh = high;
+    }
+    data->nCycle++;
+    if (data->pThis > data->pBest)
+    {
+        data->vBest = data->vThis;
+        data->pBest = data->pThis;
+    }
+    if (data->pNext > data->pBest)
+    {
+        data->vBest = data->vNext;
+        data->pBest = data->pNext;
+    }
+    return (data->nCycle >= DWELL_DETECT_CYCLES);
+}
+
+/*
+ Dwell at the mpp instead of dithering around it. Only this point is measured
+ while dwelling and the next point is checked every DWELL_PERTURB_CYCLES
+ cycles. Dwelling stops if the next point has more power or this point's power
+ drifts too far. Returns true if the cycle was handled here and false to track
+ as normal.
+*/
+static bool Dwelling(LifeTester_t *const lifeTester)
+{
+    LifeTesterData_t *const data = &lifeTester->data;
+    const uint8_t drift = Config_GetDwellDrift(lifeTester->config);
+    if (drift == DWELL_DRIFT_OFF)
+    {
+        data->dwell = false;
+        return false;
+    }
+    if (!data->dwell)
+    {
+        if (!OscillatingAtMpp(data))
+        {
+            return false;
+        }
+        data->dwell = true;
+        data->vThis = min(data->vBest, (uint8_t)(0xFFU - DV_MPPT));
+        data->vNext = data->vThis + DV_MPPT;
+        data->pDwell = data->pBest;
+        data->nDwell = 0U;
+        data->nReused = 0U;
+        SERIAL_PRINT("Oscillating at mpp. Dwelling at ", "%s");
+        SERIAL_PRINTLN(data->vThis, "%u");
+    }
+    else
+    {
+        const bool     perturbed = (data->nDwell >= DWELL_PERTURB_CYCLES);
+        const bool     uphill = perturbed && (data->pNext > data->pThis);
+        const uint32_t dP = (data->pThis > data->pDwell) ?
+            (data->pThis - data->pDwell) : (data->pDwell - data->pThis);
+        const bool     drifted = (dP > ((data->pDwell >> 8U) * drift));
+        if (uphill || drifted)
+        {
+            SERIAL_PRINTLN("Power moved. Tracking resumed", "%s");
+            data->dwell = false;
+            data->nCycle = 0U;
+            if (perturbed)
+            {
+                // both points are fresh - track on from them
+                return false;
+            }
+            data->thisDone = false;
+            data->nextDone = false;
+            return true;
+        }
+        data->nDwell = perturbed ? 0U : (data->nDwell + 1U);
+    }
+    PrintNewMpp(lifeTester);
+    IoStats_CycleDone(lifeTester->ioStats, lifeTester->io.channel);
+    SaveMppPeriodically(lifeTester);
+    data->thisDone = false;
+    data->nextDone = (data->nDwell < DWELL_PERTURB_CYCLES);
+    return true;
+}
+
+/*
+ After moving uphill the new this point is the old next point which has just
+ been measured. Its measurement is carried forward so that the next cycle only
+ needs to measure the new next point. The reuse limit caps how many cycles in a
+ row compare against a carried measurement rather than a fresh pair. Returns
+ true if this point doesn't need measuring again.
+*/
+static bool ReuseNextMeasurement(LifeTester_t *const lifeTester, bool uphill)
+{
+    LifeTesterData_t *const data = &lifeTester->data;
+    if (!uphill)
+    {
+        data->nReused = 0U;
+        return false;
+    }
+    const uint8_t limit = Config_GetReuseLimit(lifeTester->config);
+    if ((limit != REUSE_UNLIMITED) && (data->nReused >= limit))
+    {
+        data->nReused = 0U;
+        return false;
+    }
+    data->iThis = data->iNext;
+    data->pThis = data->pNext;
+    data->iVarThis = data->iVarNext;
+    data->nReused = (data->nReused < REUSE_UNLIMITED) ? (data->nReused + 1U) : data->nReused;
+    return true;
 }
 
 STATIC void TrackingDelayEntry(LifeTester_t *const lifeTester)
 {
-    lifeTester->timer = millis();
+    ResetTimer(lifeTester);
+    StartTimer(lifeTester, &lifeTester->delayTimer,
+               Config_GetTrackDelay(lifeTester->config), DelayDoneEvent);
 }
 
-STATIC void TrackingDelayStep(LifeTester_t *const lifeTester)
+STATIC void TrackingDelayTran(LifeTester_t *const lifeTester,
+                              Event_t e)
 {
-    const uint32_t tPresent = millis();
-    const uint32_t tElapsed = tPresent - lifeTester->timer;
-    if (tElapsed >= Config_GetTrackDelay())
+    if (e == DelayDoneEvent)
     {
         StateMachineTransitionToState(lifeTester, &StateTrackingMode);
     }
+    else
+    {
+        // still waiting - tracking mode's events are handled once it's done
+    }
 }
 
 STATIC void TrackingDelayExit(LifeTester_t *const lifeTester)
@@ -698,12 +1496,12 @@ STATIC void ErrorEntry(LifeTester_t *const lifeTester)
     #endif
     lifeTester->led.t(ERROR_LED_ON_TIME,ERROR_LED_OFF_TIME);
     lifeTester->led.keepFlashing();
-    DacSetOutput(0U, lifeTester->io.dac);
-}
-
-STATIC void ErrorStep(LifeTester_t *const lifeTester)
-{
-    lifeTester->led.update();
+    DacSetOutput(lifeTester, 0U);
+    // may have come from a measurement - don't keep the other channel waiting
+    StopTimers(lifeTester);
+    AdcCancelLifeTesterRead(lifeTester);
+    // stored with the error so that the next reset doesn't warm start
+    SaveMpp(lifeTester, lifeTester->data.vThis, lifeTester->data.pThis);
 }
 
 static void ExitCurrentChildState(LifeTester_t *const lifeTester)
@@ -724,6 +1522,9 @@ static void ExitCurrentParentState(LifeTester_t *const lifeTester)
 static void EnterTargetChildState(LifeTester_t *const lifeTester,
                                   LifeTesterState_t const* const targetState)
 {
+    // i/o from entry functions is counted against the state being entered
+    IoStats_SetContext(lifeTester->ioStats, lifeTester->io.channel,
+                       targetState->label);
     StateFn_t *entry = targetState->fn.entry;
     RUN_STATE_FN(entry, lifeTester);
 }
@@ -733,6 +1534,8 @@ static void EnterTargetParentState(LifeTester_t *const lifeTester,
 {
     if (targetState->parent != NULL)
     {
+        IoStats_SetContext(lifeTester->ioStats, lifeTester->io.channel,
+                           targetState->label);
         StateFn_t *entry = targetState->parent->fn.entry;
         RUN_STATE_FN(entry, lifeTester);
     }
@@ -818,6 +1621,7 @@ void StateMachine_Reset(LifeTester_t *const lifeTester)
     DBG_PRINTLN("Resetting device", "%s");
     lifeTester->state = &StateNone;
     StateMachineTransitionToState(lifeTester, &StateInitialiseDevice);
+    IoStats_ClearContext(lifeTester->ioStats);
 }
 
 void StateMachine_UpdateStep(LifeTester_t *const lifeTester)
@@ -826,6 +1630,39 @@ void StateMachine_UpdateStep(LifeTester_t *const lifeTester)
     state will only call one step function and one transition. Where as a tran-
     sition from a child state will only call the step fucntion of its parent.
     simpler to debug.*/
+    IoStats_SetContext(lifeTester->ioStats, lifeTester->io.channel,
+                       lifeTester->state->label);
     RunParentStepFn(lifeTester);
     RunChildStepFn(lifeTester);
-}
\ No newline at end of file
+    IoStats_ClearContext(lifeTester->ioStats);
+}
+
+void StateMachine_PostEvent(LifeTester_t *const lifeTester, Event_t e)
+{
+    IoStats_SetContext(lifeTester->ioStats, lifeTester->io.channel,
+                       lifeTester->state->label);
+    StateMachineTransitionOnEvent(lifeTester, e);
+    IoStats_ClearContext(lifeTester->ioStats);
+}
+
+/*
+ A channel is waiting if nothing happens until one of its timers fires.
+*/
+bool StateMachine_Waiting(LifeTester_t const *const lifeTester)
+{
+    LifeTesterState_t const *const state = lifeTester->state;
+    const bool settling = !lifeTester->data.settled;
+    if ((state == &StateTrackingDelay) || (state == &StateError))
+    {
+        return true;
+    }
+    else if ((state == &StateInitialiseDevice)
+             || (state->fn.step == MeasureDataPointStep))
+    {
+        return settling;
+    }
+    else
+    {
+        return false;
+    }
+}
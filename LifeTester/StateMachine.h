@@ -1,10 +1,17 @@
 #ifndef STATEMACHINE_H
 #define STATEMACHINE_H
 #include <stdint.h>
+#include <stdbool.h>
 #include "LifeTesterTypes.h"
 
 void StateMachine_Reset(LifeTester_t *const lifeTester);
 
 void StateMachine_UpdateStep(LifeTester_t *const lifeTester);
 
+// Passes an event to the current state eg. from one of the channel's timers
+void StateMachine_PostEvent(LifeTester_t *const lifeTester, Event_t e);
+
+// True if the channel has nothing to do until one of its timers fires
+bool StateMachine_Waiting(LifeTester_t const *const lifeTester);
+
 #endif
\ No newline at end of file
@@ -11,7 +11,41 @@ static void StateMachineTransitionToState(LifeTester_t *const lifeTester,
                                           LifeTesterState_t const *targetState);
 static void StateMachineTransitionOnEvent(LifeTester_t *const lifeTester,
                                           Event_t e);
+static uint8_t GetTrackingStep(LifeTesterData_t const *const data,
+                               Config_t const *const config);
+static bool IncCondAtMpp(LifeTesterData_t const *const data);
+static void FitScanPeak(LifeTesterData_t *const data);
+static void UpdateScanFit(LifeTesterData_t *const data, bool newMpp);
+static uint8_t GetScanFitCode(LifeTesterData_t const *const data);
+static void PostTimerEvent(void *context, uint8_t event);
+static void StartTimer(LifeTester_t *const lifeTester,
+                       Timer_t *const timer,
+                       uint32_t delay,
+                       Event_t e);
+static void StopTimers(LifeTester_t *const lifeTester);
+static void StartMeasurementTimers(LifeTester_t *const lifeTester);
+static void AddSample(LifeTesterData_t *const data, uint16_t sample);
+static uint32_t GetSampleVariance(LifeTesterData_t const *const data);
+static bool SampleErrorWithinTolerance(LifeTesterData_t const *const data,
+                                       uint8_t tolerance);
+static void FinishMeasurement(LifeTester_t *const lifeTester);
+static void SampleWindowDone(LifeTester_t *const lifeTester);
+static void LoadWarmStart(LifeTester_t *const lifeTester);
+static void SaveMpp(LifeTester_t *const lifeTester, uint8_t v, uint32_t p);
+static void SaveMppPeriodically(LifeTester_t *const lifeTester);
+static bool LightChanged(LifeTesterData_t *const data,
+                         Config_t const *const config);
+static void StartLocalScan(LifeTesterData_t *const data, uint8_t span, uint8_t step);
+static void StartScan(LifeTesterData_t *const data,
+                      Config_t const *const config);
+static void NextLocalScanPoint(LifeTesterData_t *const data);
+static void NextLinearScanPoint(LifeTesterData_t *const data);
+static uint8_t GoldenSection(uint8_t width);
+static void NextGoldenSectionPoint(LifeTesterData_t *const data);
 static void UpdateTrackingData(LifeTester_t *const lifeTester);
+static bool ReuseNextMeasurement(LifeTester_t *const lifeTester, bool uphill);
+static bool OscillatingAtMpp(LifeTesterData_t *const data);
+static bool Dwelling(LifeTester_t *const lifeTester);
 static void UpdateErrorReadings(LifeTester_t *const lifeTester);
 
 // Entry functions 
@@ -26,9 +60,7 @@ STATIC void ErrorEntry(LifeTester_t *const lifeTester);
 STATIC void InitialiseStep(LifeTester_t *const lifeTester);
 STATIC void MeasureDataPointStep(LifeTester_t *const lifeTester);
 STATIC void ScanningModeStep(LifeTester_t *const lifeTester);
-STATIC void TrackingDelayStep(LifeTester_t *const lifeTester);
 STATIC void TrackingModeStep(LifeTester_t *const lifeTester);
-STATIC void ErrorStep(LifeTester_t *const lifeTester);
 
 // Exit functions
 STATIC void AnalyseTrackingDataExit(LifeTester_t *const lifeTester);
@@ -47,6 +79,8 @@ STATIC void ScanningModeTran(LifeTester_t *const lifeTester,
                              Event_t e);
 STATIC void TrackingModeTran(LifeTester_t *const lifeTester,
                              Event_t e);
+STATIC void TrackingDelayTran(LifeTester_t *const lifeTester,
+                              Event_t e);
 
 
 #ifdef UNIT_TEST  // give states external linkage for access from tests
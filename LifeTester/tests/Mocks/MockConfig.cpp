@@ -6,50 +6,158 @@
 #include <stdint.h>
 #include "Config.h"
 
-void Config_SetSettleTime(uint16_t tSettle)
+void Config_SetSettleTime(Config_t *const config, uint16_t tSettle)
 {
     mock().actualCall("Config_SetSettleTime")
         .withParameter("tSettle", tSettle);
 }
 
-void Config_SetTrackDelay(uint16_t tDelay)
+void Config_SetTrackDelay(Config_t *const config, uint16_t tDelay)
 {
     mock().actualCall("Config_SetTrackDelay")
         .withParameter("tDelay", tDelay);
 }
 
-void Config_SetSampleTime(uint16_t tSample)
+void Config_SetSampleTime(Config_t *const config, uint16_t tSample)
 {
     mock().actualCall("Config_SetSampleTime")
         .withParameter("tSample", tSample);
 }
 
-void Config_SetThresholdCurrent(uint16_t iThreshold)
+void Config_SetThresholdCurrent(Config_t *const config, uint16_t iThreshold)
 {
     mock().actualCall("Config_SetThresholdCurrent")
         .withParameter("iThreshold", iThreshold);
 }
 
-uint16_t Config_GetSettleTime(void)
+void Config_SetReuseLimit(Config_t *const config, uint8_t nReuse)
+{
+    mock().actualCall("Config_SetReuseLimit")
+        .withParameter("nReuse", nReuse);
+}
+
+void Config_SetMinStep(Config_t *const config, uint8_t dvMin)
+{
+    mock().actualCall("Config_SetMinStep")
+        .withParameter("dvMin", dvMin);
+}
+
+void Config_SetMaxStep(Config_t *const config, uint8_t dvMax)
+{
+    mock().actualCall("Config_SetMaxStep")
+        .withParameter("dvMax", dvMax);
+}
+
+void Config_SetTrackingAlgorithms(Config_t *const config, uint8_t algorithms)
+{
+    mock().actualCall("Config_SetTrackingAlgorithms")
+        .withParameter("algorithms", algorithms);
+}
+
+void Config_SetScanStrategy(Config_t *const config, uint8_t strategy)
+{
+    mock().actualCall("Config_SetScanStrategy")
+        .withParameter("strategy", strategy);
+}
+
+void Config_SetScanStopMargin(Config_t *const config, uint8_t nPoints)
+{
+    mock().actualCall("Config_SetScanStopMargin")
+        .withParameter("nPoints", nPoints);
+}
+
+void Config_SetLightChangeThreshold(Config_t *const config, uint8_t threshold)
+{
+    mock().actualCall("Config_SetLightChangeThreshold")
+        .withParameter("threshold", threshold);
+}
+
+void Config_SetSampleTolerance(Config_t *const config, uint8_t tolerance)
+{
+    mock().actualCall("Config_SetSampleTolerance")
+        .withParameter("tolerance", tolerance);
+}
+
+void Config_SetDwellDrift(Config_t *const config, uint8_t drift)
+{
+    mock().actualCall("Config_SetDwellDrift")
+        .withParameter("drift", drift);
+}
+
+uint16_t Config_GetSettleTime(Config_t const *const config)
 {
     mock().actualCall("Config_GetSettleTime");
     return mock().unsignedIntReturnValue();
 }
 
-uint16_t Config_GetTrackDelay(void)
+uint16_t Config_GetTrackDelay(Config_t const *const config)
 {
     mock().actualCall("Config_GetTrackDelay");
     return mock().unsignedIntReturnValue();
 }
 
-uint16_t Config_GetSampleTime(void)
+uint16_t Config_GetSampleTime(Config_t const *const config)
 {
     mock().actualCall("Config_GetSampleTime");
     return mock().unsignedIntReturnValue();
 }
 
-uint16_t Config_GetThresholdCurrent(void)
+uint16_t Config_GetThresholdCurrent(Config_t const *const config)
 {
     mock().actualCall("Config_GetThresholdCurrent");
     return mock().unsignedIntReturnValue();
 }
+
+uint8_t Config_GetReuseLimit(Config_t const *const config)
+{
+    mock().actualCall("Config_GetReuseLimit");
+    return mock().unsignedIntReturnValue();
+}
+
+uint8_t Config_GetMinStep(Config_t const *const config)
+{
+    mock().actualCall("Config_GetMinStep");
+    return mock().unsignedIntReturnValue();
+}
+
+uint8_t Config_GetMaxStep(Config_t const *const config)
+{
+    mock().actualCall("Config_GetMaxStep");
+    return mock().unsignedIntReturnValue();
+}
+
+uint8_t Config_GetTrackingAlgorithms(Config_t const *const config)
+{
+    mock().actualCall("Config_GetTrackingAlgorithms");
+    return mock().unsignedIntReturnValue();
+}
+
+uint8_t Config_GetScanStrategy(Config_t const *const config)
+{
+    mock().actualCall("Config_GetScanStrategy");
+    return mock().unsignedIntReturnValue();
+}
+
+uint8_t Config_GetScanStopMargin(Config_t const *const config)
+{
+    mock().actualCall("Config_GetScanStopMargin");
+    return mock().unsignedIntReturnValue();
+}
+
+uint8_t Config_GetLightChangeThreshold(Config_t const *const config)
+{
+    mock().actualCall("Config_GetLightChangeThreshold");
+    return mock().unsignedIntReturnValue();
+}
+
+uint8_t Config_GetSampleTolerance(Config_t const *const config)
+{
+    mock().actualCall("Config_GetSampleTolerance");
+    return mock().unsignedIntReturnValue();
+}
+
+uint8_t Config_GetDwellDrift(Config_t const *const config)
+{
+    mock().actualCall("Config_GetDwellDrift");
+    return mock().unsignedIntReturnValue();
+}
\ No newline at end of file
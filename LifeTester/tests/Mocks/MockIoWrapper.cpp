@@ -3,51 +3,52 @@
 #include "CppUTestExt/MockSupport.h"
 #include "CppUTestExt/MockSupportPlugin.h"
 
+#include "Config.h"
 #include "IoWrapper.h"
 
 // records a copy of the last output set on the dac for each channel.
-static uint8_t dacOutput[nChannels];
+static uint8_t dacOutput[CHANNEL_TABLE_MAX];
 
 
-void DacInit(void)
+void DacInit(MCP4802_t *const dac, uint8_t pin, IoStats_t *const stats)
 {
-    mock().actualCall("DacInit");
+    mock().actualCall("DacInit")
+        .withParameter("pin", pin);
 }
 
 void DacSetOutputToActiveVoltage(LifeTester_t const *const lifeTester)
 {
-    DacSetOutput(*lifeTester->data.vActive, lifeTester->io.dac);
+    DacSetOutput(lifeTester, *lifeTester->data.vActive);
 }
 
 void DacSetOutputToThisVoltage(LifeTester_t const *const lifeTester)
 {
-    DacSetOutput(lifeTester->data.vThis, lifeTester->io.dac);
+    DacSetOutput(lifeTester, lifeTester->data.vThis);
 }
 
 void DacSetOutputToNextVoltage(LifeTester_t const *const lifeTester)
 {
-    DacSetOutput(lifeTester->data.vNext, lifeTester->io.dac);
+    DacSetOutput(lifeTester, lifeTester->data.vNext);
 }
 
 void DacSetOutputToScanVoltage(LifeTester_t const *const lifeTester)
 {
-    DacSetOutput(lifeTester->data.vScan, lifeTester->io.dac);
+    DacSetOutput(lifeTester, lifeTester->data.vScan);
 }
 
-void DacSetOutput(uint8_t output, chSelect_t channel)
+void DacSetOutput(LifeTester_t const *const lifeTester, uint8_t output)
 {
     mock().actualCall("DacSetOutput")
         .withParameter("output", output)
-        .withParameter("channel", channel);
+        .withParameter("channel", lifeTester->io.dac);
     
     // keep a copy of last voltage set on this channel
-    dacOutput[channel] = output;
+    dacOutput[lifeTester->io.channel] = output;
 }
 
 uint8_t DacGetOutput(LifeTester_t const *const lifeTester)
 {
-    const chSelect_t ch = lifeTester->io.dac;
-    return dacOutput[ch];
+    return dacOutput[lifeTester->io.channel];
 }
 
 bool DacOutputSetToActiveVoltage(LifeTester_t const *const lifeTester)
@@ -70,24 +71,25 @@ bool DacOutputSetToScanVoltage(LifeTester_t const *const lifeTester)
     return DacGetOutput(lifeTester) == lifeTester->data.vScan;
 }
 
-void DacSetGain(gainSelect_t requestedGain)
+void DacSetGain(MCP4802_t *const dac, gainSelect_t requestedGain)
 {
     mock().actualCall("DacSetGain")
         .withParameter("requestedGain", requestedGain);
 }
 
-gainSelect_t DacGetGain(void)
+gainSelect_t DacGetGain(MCP4802_t const *const dac)
 {
     mock().actualCall("DacGetGain");
     return (gainSelect_t)mock().intReturnValue();
 }
 
-void AdcInit(void)
+void AdcInit(IoAdc_t *const adc, uint8_t pin, IoStats_t *const stats)
 {
-    mock().actualCall("AdcInit");
+    mock().actualCall("AdcInit")
+        .withParameter("pin", pin);
 }
 
-uint16_t AdcReadData(const uint8_t channel)
+uint16_t AdcReadData(IoAdc_t *const adc, uint8_t channel)
 {
     mock().actualCall("AdcReadData")
         .withParameter("channel", channel);
@@ -96,50 +98,73 @@ uint16_t AdcReadData(const uint8_t channel)
 
 uint16_t AdcReadLifeTesterCurrent(LifeTester_t const *const lifeTester)
 {
-    return AdcReadData(lifeTester->io.adc);
+    return AdcReadData(lifeTester->io.adcDevice, lifeTester->io.adc);
+}
+
+bool AdcPollLifeTesterCurrent(LifeTester_t const *const lifeTester, uint16_t *sample)
+{
+    *sample = AdcReadData(lifeTester->io.adcDevice, lifeTester->io.adc);
+    return true;
+}
+
+bool AdcClaimSampleWindow(LifeTester_t const *const lifeTester)
+{
+    mock().actualCall("AdcClaimSampleWindow")
+        .withParameter("channel", lifeTester->io.adc);
+    return mock().boolReturnValue();
+}
+
+// time the adc mux takes to settle onto a channel's input - set by tests
+uint16_t mockMuxSettleTime = 0U;
+
+uint16_t AdcGetMuxSettleTime(LifeTester_t const *const lifeTester)
+{
+    return mockMuxSettleTime;
 }
 
-bool AdcGetError(void)
+void AdcCancelLifeTesterRead(LifeTester_t const *const lifeTester)
+{
+    mock().actualCall("AdcCancelLifeTesterRead")
+        .withParameter("channel", lifeTester->io.adc);
+}
+
+bool AdcGetError(IoAdc_t const *const adc)
 {
     mock().actualCall("AdcGetError");
     return mock().boolReturnValue();
 }
 
-uint8_t AdcGetGain(const uint8_t channel)
+uint8_t AdcGetGain(IoAdc_t const *const adc, const uint8_t channel)
 {
     mock().actualCall("AdcGetGain");
     return mock().unsignedIntReturnValue();
 }
 
-void AdcSetGain(const uint8_t gain, const uint8_t channel)
+void AdcSetGain(IoAdc_t *const adc, const uint8_t gain, const uint8_t channel)
 {
     mock().actualCall("AdcSetGain")
         .withParameter("gain", gain)
         .withParameter("channel", channel);
 }
 
-void TempSenseInit(void)
+void TempSenseInit(TC77_t *const tempSensor, TimerWheel_t *const timers,
+                   IoStats_t *const stats)
 {
     mock().actualCall("TempSenseInit");
 }
 
-void TempSenseUpdate(void)
-{
-    mock().actualCall("TempSenseUpdate");
-}
-
-uint16_t TempGetRawData(void)
+uint16_t TempGetRawData(TC77_t const *const tempSensor)
 {
     mock().actualCall("TempGetRawData");
     return mock().unsignedIntReturnValue();
 }
 
-float TempReadDegC(void)
+float TempReadDegC(TC77_t const *const tempSensor)
 {
     mock().actualCall("TempReadDegC");
 }
 
-bool TempGetError(void)
+bool TempGetError(TC77_t const *const tempSensor)
 {
     mock().actualCall("TempGetError");
 }
\ No newline at end of file
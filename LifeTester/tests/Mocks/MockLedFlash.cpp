@@ -10,7 +10,7 @@
 
 #include "LedFlash.h"
 
-Flasher::Flasher(uint8_t pin)
+Flasher::Flasher(uint8_t pin, TimerWheel_t *timers)
 {
     mock().actualCall("Flasher")
         .withParameter("pin", pin);
@@ -23,11 +23,6 @@ void Flasher::t(uint32_t onNew, uint32_t offNew)
         .withParameter("offNew", offNew);    
 }
 
-void Flasher::update(void)
-{
-    mock().actualCall("Flasher::update");
-}
-
 void Flasher::on(void)
 {
     mock().actualCall("Flahser::on");
@@ -0,0 +1,43 @@
+// CppUnit Test framework
+#include "CppUTest/TestHarness.h"
+#include "CppUTestExt/MockSupport.h"
+#include "CppUTestExt/MockSupportPlugin.h"
+
+#include <stddef.h>
+#include "MppStore.h"
+
+void MppStore_Init(MppStore_t *const store, uint16_t base, uint8_t nChannels)
+{
+    mock().actualCall("MppStore_Init")
+        .withParameter("base", base)
+        .withParameter("nChannels", nChannels);
+}
+
+void MppStore_Save(MppStore_t const *const store,
+                   uint8_t channel,
+                   MppRecord_t const *const record)
+{
+    mock().actualCall("MppStore_Save")
+        .withParameter("store", (const void *)store)
+        .withParameter("channel", channel)
+        .withParameter("v", record->v)
+        .withParameter("error", record->error);
+}
+
+// Return value is a pointer to the stored record or NULL if there isn't one
+bool MppStore_Load(MppStore_t const *const store,
+                   uint8_t channel,
+                   MppRecord_t *const record)
+{
+    mock().actualCall("MppStore_Load")
+        .withParameter("store", (const void *)store)
+        .withParameter("channel", channel);
+    MppRecord_t const *const stored =
+        (MppRecord_t const *)mock().pointerReturnValue();
+    if (stored == NULL)
+    {
+        return false;
+    }
+    *record = *stored;
+    return true;
+}
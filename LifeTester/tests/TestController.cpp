@@ -30,9 +30,13 @@
 #define WRITE_PARAMS            (0x41U)
 #define WRITE_CH_B_DATA_BAD_CMD (0xC2U)
 
+#define N_MOCK_LIFETESTERS      (4U)
+
 #define GET_LSB(X)  (X & 0xFF)
 #define GET_MSB(X)  ((X >> 8U) & 0xFF)
 
+static Controller_t controller;
+static LifeTester_t *mockLifeTesters;  // channel table
 static LifeTester_t *mockLifeTesterA;
 static LifeTester_t *mockLifeTesterB;
 static DataBuffer_t mockRxBuffer;  // data received by device from master see Wire.cpp
@@ -54,6 +58,7 @@ const uint16_t settleTime = SETTLE_TIME;
 const uint16_t trackDelay = TRACK_DELAY_TIME;
 const uint16_t sampleTime = SAMPLING_TIME;
 const uint16_t thresholdCurrent = THRESHOLD_CURRENT;
+const uint8_t  trackingAlgorithms = 0x02U; // ch B incremental conductance
 /*******************************************************************************
 * PRIVATE FUNCTION IMPLEMENTATIONS
 *******************************************************************************/
@@ -100,8 +105,8 @@ size_t TwoWire::write(const uint8_t *data, size_t quantity)
         .withParameter("data", (uint8_t *)data)
         .withParameter("quantity", quantity);
 
-    memcpy(transmitBuffer.d, data, quantity);
-    transmitBuffer.tail += quantity;
+    memcpy(controller.transmitBuffer.d, data, quantity);
+    controller.transmitBuffer.tail += quantity;
     return (size_t)mock().unsignedIntReturnValue();
 }
 
@@ -201,6 +206,16 @@ static void ExpectsForReceiveHandlerRWCmdReg(uint8_t cmd)
     ExpectCommsLedSwitchOff();
 }
 
+// Command followed by the channel number as sent on boards with > 2 channels
+static void ExpectsForReceiveHandlerCmdWithChannel(uint8_t cmd, uint8_t channel)
+{
+    ExpectCommsLedSwitchOn();
+    ExpectReadBufferFlush();
+    ExpectReceiveByte(cmd);
+    ExpectReceiveByte(channel);
+    ExpectCommsLedSwitchOff();
+}
+
 /*******************************************************************************
 * HELPERS
 *******************************************************************************/
@@ -249,27 +264,34 @@ TEST_GROUP(ControllerTestGroup)
     void setup(void)
     {
         mock().disable();
-        Controller_Init();
         ResetBuffer(&mockRxBuffer);
         pinMode(COMMS_LED_PIN, OUTPUT);
         const LifeTester_t lifeTesterInit = {
-            {chASelect, 0U},    // io
-            Flasher(LED_A_PIN), // led
+            {0U, NULL, chASelect, NULL, 0U, NULL}, // io
+            Flasher(LED_A_PIN, NULL), // led
             {0},                // data
             0U,                 // timer
             ok,                 // error
-            NULL
+            NULL,               // state
+            NULL                // config
         };
         mock().enable();
         // Copy to a static variable for tests to work on
-        static LifeTester_t dataForTestA = lifeTesterInit;
-        static LifeTester_t dataForTestB = lifeTesterInit;
+        static LifeTester_t dataForTest[N_MOCK_LIFETESTERS] = {
+            lifeTesterInit, lifeTesterInit, lifeTesterInit, lifeTesterInit
+        };
         // Need to copy the data every time. A static is only initialised once.
-        memcpy(&dataForTestA, &lifeTesterInit, sizeof(LifeTester_t));
-        memcpy(&dataForTestB, &lifeTesterInit, sizeof(LifeTester_t));
+        for (int i = 0; i < N_MOCK_LIFETESTERS; i++)
+        {
+            memcpy(&dataForTest[i], &lifeTesterInit, sizeof(LifeTester_t));
+        }
         // access data through pointers
-        mockLifeTesterA = &dataForTestA;
-        mockLifeTesterB = &dataForTestB;
+        mockLifeTesters = dataForTest;
+        mockLifeTesterA = &dataForTest[LIFETESTER_CH_A];
+        mockLifeTesterB = &dataForTest[LIFETESTER_CH_B];
+        mock().disable();
+        Controller_Init(&controller, mockLifeTesters, N_MOCK_LIFETESTERS, NULL);
+        mock().enable();
     }
 
     void teardown(void)
@@ -283,13 +305,13 @@ TEST(ControllerTestGroup, DataCopiedToTransmitBufferOk)
     SetExpectedLtDataA(mockLifeTesterA);
     ExpectReadTempAndReturn(tempExpectedA);
     ExpectAnalogReadAndReturn(adcReadExpectedA);
-    WriteDataToTransmitBuffer(mockLifeTesterA);
-    CHECK_EQUAL(timeExpectedA, ReadUint32(&transmitBuffer));
-    CHECK_EQUAL(vExpectedA, ReadUint8(&transmitBuffer));
-    CHECK_EQUAL(iExpectedA, ReadUint16(&transmitBuffer));
-    CHECK_EQUAL(tempExpectedA, ReadUint16(&transmitBuffer));
-    CHECK_EQUAL(adcReadExpectedA, ReadUint16(&transmitBuffer));
-    CHECK_EQUAL(errorExpectedA, ReadUint8(&transmitBuffer));
+    WriteDataToTransmitBuffer(&controller.transmitBuffer, mockLifeTesterA);
+    CHECK_EQUAL(timeExpectedA, ReadUint32(&controller.transmitBuffer));
+    CHECK_EQUAL(vExpectedA, ReadUint8(&controller.transmitBuffer));
+    CHECK_EQUAL(iExpectedA, ReadUint16(&controller.transmitBuffer));
+    CHECK_EQUAL(tempExpectedA, ReadUint16(&controller.transmitBuffer));
+    CHECK_EQUAL(adcReadExpectedA, ReadUint16(&controller.transmitBuffer));
+    CHECK_EQUAL(errorExpectedA, ReadUint8(&controller.transmitBuffer));
     mock().checkExpectations();
 }
 
@@ -313,21 +335,21 @@ TEST(ControllerTestGroup, GetCmdRegChAOk)
     SET_READ_MODE(cmdRegInit);
     SET_RDY_STATUS(cmdRegInit);
     SET_COMMAND(cmdRegInit, DataReg);
-    cmdReg = cmdRegInit;
+    controller.cmdReg = cmdRegInit;
     // Now write to device to request read of cmd reg
     ExpectsForReceiveHandlerRWCmdReg(READ_CH_A_CMD);
     const uint8_t nBytesSent = 1U;
-    Controller_ReceiveHandler(nBytesSent);
+    Controller_ReceiveHandler(&controller, nBytesSent);
     // command reg shouldn't change
-    CHECK_EQUAL(cmdRegInit, cmdReg);    
-    Controller_ConsumeCommand(mockLifeTesterA, mockLifeTesterB);
+    CHECK_EQUAL(cmdRegInit, controller.cmdReg);    
+    Controller_ConsumeCommand(&controller);
     // now read the data back
     ExpectCommsLedSwitchOn();
-    ExpectTransmitByte(cmdReg);
+    ExpectTransmitByte(controller.cmdReg);
     ExpectCommsLedSwitchOff();
-    Controller_RequestHandler();
-    CHECK_EQUAL(cmdRegInit, cmdReg);
-    CHECK_EQUAL(Ok, GET_ERROR(cmdReg));
+    Controller_RequestHandler(&controller);
+    CHECK_EQUAL(cmdRegInit, controller.cmdReg);
+    CHECK_EQUAL(Ok, GET_ERROR(controller.cmdReg));
     mock().checkExpectations();
 }
 
@@ -339,21 +361,21 @@ TEST(ControllerTestGroup, GetCmdRegChBOk)
     SET_READ_MODE(cmdRegInit);
     SET_RDY_STATUS(cmdRegInit);
     SET_COMMAND(cmdRegInit, DataReg);
-    cmdReg = cmdRegInit;
+    controller.cmdReg = cmdRegInit;
     // Now write to device to request read of cmd reg
     ExpectsForReceiveHandlerRWCmdReg(READ_CH_B_CMD);
     const uint8_t nBytesSent = 1U;
-    Controller_ReceiveHandler(nBytesSent);
+    Controller_ReceiveHandler(&controller, nBytesSent);
     // command reg shouldn't change
-    CHECK_EQUAL(cmdRegInit, cmdReg);    
-    Controller_ConsumeCommand(mockLifeTesterA, mockLifeTesterB);
+    CHECK_EQUAL(cmdRegInit, controller.cmdReg);    
+    Controller_ConsumeCommand(&controller);
     // now read the data back
     ExpectCommsLedSwitchOn();
-    ExpectTransmitByte(cmdReg);
+    ExpectTransmitByte(controller.cmdReg);
     ExpectCommsLedSwitchOff();
-    Controller_RequestHandler();
-    CHECK_EQUAL(cmdRegInit, cmdReg);
-    CHECK_EQUAL(Ok, GET_ERROR(cmdReg));
+    Controller_RequestHandler(&controller);
+    CHECK_EQUAL(cmdRegInit, controller.cmdReg);
+    CHECK_EQUAL(Ok, GET_ERROR(controller.cmdReg));
     mock().checkExpectations();
 }
 
@@ -362,32 +384,32 @@ TEST(ControllerTestGroup, ResetChannelAOk)
     // First request a write to the cmd reg
     ExpectsForReceiveHandlerRWCmdReg(WRITE_CH_A_CMD);
     const uint8_t nBytesSent = 1U;
-    Controller_ReceiveHandler(nBytesSent);
-    CHECK(IS_WRITE(cmdReg))
-    CHECK(IS_RDY(cmdReg))
-    CHECK_EQUAL(CmdReg, GET_COMMAND(cmdReg));
-    Controller_ConsumeCommand(mockLifeTesterA, mockLifeTesterB);
+    Controller_ReceiveHandler(&controller, nBytesSent);
+    CHECK(IS_WRITE(controller.cmdReg))
+    CHECK(IS_RDY(controller.cmdReg))
+    CHECK_EQUAL(CmdReg, GET_COMMAND(controller.cmdReg));
+    Controller_ConsumeCommand(&controller);
     // then write the reset command
     ExpectsForReceiveHandlerRWCmdReg(RESET_CH_A);
-    Controller_ReceiveHandler(nBytesSent);
-    CHECK_EQUAL(Reset, GET_COMMAND(cmdReg));
-    CHECK(!IS_RDY(cmdReg));
-    CHECK_EQUAL(LIFETESTER_CH_A, GET_CHANNEL(cmdReg));
+    Controller_ReceiveHandler(&controller, nBytesSent);
+    CHECK_EQUAL(Reset, GET_COMMAND(controller.cmdReg));
+    CHECK(!IS_RDY(controller.cmdReg));
+    CHECK_EQUAL(LIFETESTER_CH_A, GET_CHANNEL(controller.cmdReg));
     mock().expectOneCall("StateMachine_Reset")
         .withParameter("lifeTester", mockLifeTesterA);
-    Controller_ConsumeCommand(mockLifeTesterA, mockLifeTesterB);
+    Controller_ConsumeCommand(&controller);
     // Poll the cmd reg - rdy should be set saying cmd done.
     ExpectsForReceiveHandlerRWCmdReg(READ_CH_A_CMD);
-    Controller_ReceiveHandler(nBytesSent);
-    Controller_ConsumeCommand(mockLifeTesterA, mockLifeTesterB);
+    Controller_ReceiveHandler(&controller, nBytesSent);
+    Controller_ConsumeCommand(&controller);
     // expect to read cmd reg. Rdy bit set and go bit cleared
     ExpectCommsLedSwitchOn();
-    ExpectTransmitByte(cmdReg);
+    ExpectTransmitByte(controller.cmdReg);
     ExpectCommsLedSwitchOff();
-    Controller_RequestHandler();
-    CHECK(IS_RDY(cmdReg));
-    CHECK_EQUAL(Reset, GET_COMMAND(cmdReg));
-    CHECK_EQUAL(Ok, GET_ERROR(cmdReg));
+    Controller_RequestHandler(&controller);
+    CHECK(IS_RDY(controller.cmdReg));
+    CHECK_EQUAL(Reset, GET_COMMAND(controller.cmdReg));
+    CHECK_EQUAL(Ok, GET_ERROR(controller.cmdReg));
     mock().checkExpectations();
 }
 
@@ -396,82 +418,83 @@ TEST(ControllerTestGroup, ResetChannelBOk)
     // First request a write to the cmd reg
     ExpectsForReceiveHandlerRWCmdReg(WRITE_CH_B_CMD);
     const uint8_t nBytesSent = 1U;
-    Controller_ReceiveHandler(nBytesSent);
-    CHECK(IS_WRITE(cmdReg))
-    CHECK(IS_RDY(cmdReg))
-    CHECK_EQUAL(CmdReg, GET_COMMAND(cmdReg));
-    Controller_ConsumeCommand(mockLifeTesterA, mockLifeTesterB);
+    Controller_ReceiveHandler(&controller, nBytesSent);
+    CHECK(IS_WRITE(controller.cmdReg))
+    CHECK(IS_RDY(controller.cmdReg))
+    CHECK_EQUAL(CmdReg, GET_COMMAND(controller.cmdReg));
+    Controller_ConsumeCommand(&controller);
     // then write the reset command
     ExpectsForReceiveHandlerRWCmdReg(RESET_CH_B);
-    Controller_ReceiveHandler(nBytesSent);
-    CHECK_EQUAL(Reset, GET_COMMAND(cmdReg));
-    CHECK(!IS_RDY(cmdReg));
-    CHECK_EQUAL(LIFETESTER_CH_B, GET_CHANNEL(cmdReg));
+    Controller_ReceiveHandler(&controller, nBytesSent);
+    CHECK_EQUAL(Reset, GET_COMMAND(controller.cmdReg));
+    CHECK(!IS_RDY(controller.cmdReg));
+    CHECK_EQUAL(LIFETESTER_CH_B, GET_CHANNEL(controller.cmdReg));
     mock().expectOneCall("StateMachine_Reset")
         .withParameter("lifeTester", mockLifeTesterB);
-    Controller_ConsumeCommand(mockLifeTesterA, mockLifeTesterB);
+    Controller_ConsumeCommand(&controller);
     // Poll the cmd reg - rdy should be set saying cmd done.
     ExpectsForReceiveHandlerRWCmdReg(READ_CH_B_CMD);
-    Controller_ReceiveHandler(nBytesSent);
-    Controller_ConsumeCommand(mockLifeTesterA, mockLifeTesterB);
+    Controller_ReceiveHandler(&controller, nBytesSent);
+    Controller_ConsumeCommand(&controller);
     // expect to read cmd reg. Rdy bit set and go bit cleared
     ExpectCommsLedSwitchOn();
-    ExpectTransmitByte(cmdReg);
+    ExpectTransmitByte(controller.cmdReg);
     ExpectCommsLedSwitchOff();
-    Controller_RequestHandler();
-    CHECK(IS_RDY(cmdReg));
-    CHECK_EQUAL(Reset, GET_COMMAND(cmdReg));
+    Controller_RequestHandler(&controller);
+    CHECK(IS_RDY(controller.cmdReg));
+    CHECK_EQUAL(Reset, GET_COMMAND(controller.cmdReg));
     // check that the command reg has been loaded to transmit buffer
-    CHECK_EQUAL(Ok, GET_ERROR(cmdReg));
+    CHECK_EQUAL(Ok, GET_ERROR(controller.cmdReg));
     mock().checkExpectations();
 }
 
 TEST(ControllerTestGroup, RequestDataFromChANotReadyRdyBitNotSet)
 {   
     // setup cmdReg in read data reg mode with go set but ready not set yet.
-    cmdReg = READ_CH_A_DATA;
+    controller.cmdReg = READ_CH_A_DATA;
     // Request to read the cmdReg - polling
     ExpectsForReceiveHandlerRWCmdReg(READ_CH_A_CMD);
     const uint8_t nBytesSent = 1U;
-    const uint8_t cmdRegInit = cmdReg;
-    Controller_ReceiveHandler(nBytesSent);
-    CHECK_EQUAL(DataReg, GET_COMMAND(cmdReg));
-    CHECK_EQUAL(cmdRegInit, cmdReg);
-    CHECK_EQUAL(Ok, GET_ERROR(cmdReg));
+    const uint8_t cmdRegInit = controller.cmdReg;
+    Controller_ReceiveHandler(&controller, nBytesSent);
+    CHECK_EQUAL(DataReg, GET_COMMAND(controller.cmdReg));
+    CHECK_EQUAL(cmdRegInit, controller.cmdReg);
+    CHECK_EQUAL(Ok, GET_ERROR(controller.cmdReg));
     // Master reads from cmd reg - rdy not set. Go is cleared after call
     ExpectCommsLedSwitchOn();
-    ExpectTransmitByte(cmdReg);
+    ExpectTransmitByte(controller.cmdReg);
     ExpectCommsLedSwitchOff();
-    Controller_RequestHandler();
-    CHECK(!IS_RDY(cmdReg));
-    CHECK_EQUAL(DataReg, GET_COMMAND(cmdReg));
-    CHECK_EQUAL(LIFETESTER_CH_A, GET_CHANNEL(cmdReg));
-    CHECK_EQUAL(Ok, GET_ERROR(cmdReg));
+    Controller_RequestHandler(&controller);
+    CHECK(!IS_RDY(controller.cmdReg));
+    CHECK_EQUAL(DataReg, GET_COMMAND(controller.cmdReg));
+    CHECK_EQUAL(LIFETESTER_CH_A, GET_CHANNEL(controller.cmdReg));
+    CHECK_EQUAL(Ok, GET_ERROR(controller.cmdReg));
     mock().checkExpectations();
 }
 
 TEST(ControllerTestGroup, RequestDataFromChBNotReadyCmdReturnsCmdReg)
 {   
     // setup cmdReg in read data reg mode with go set but ready not set yet.
-    cmdReg = READ_CH_B_DATA;
-    CHECK_EQUAL(Ok, GET_ERROR(cmdReg));
+    controller.cmdReg = READ_CH_B_DATA;
+    controller.cmdChannel = LIFETESTER_CH_B;
+    CHECK_EQUAL(Ok, GET_ERROR(controller.cmdReg));
     // Request to read the cmdReg - polling
     ExpectsForReceiveHandlerRWCmdReg(READ_CH_B_CMD);
     const uint8_t nBytesSent = 1U;
-    const uint8_t cmdRegInit = cmdReg;
-    Controller_ReceiveHandler(nBytesSent);
-    CHECK_EQUAL(DataReg, GET_COMMAND(cmdReg));
-    CHECK_EQUAL(cmdRegInit, cmdReg);
-    CHECK_EQUAL(Ok, GET_ERROR(cmdReg));
+    const uint8_t cmdRegInit = controller.cmdReg;
+    Controller_ReceiveHandler(&controller, nBytesSent);
+    CHECK_EQUAL(DataReg, GET_COMMAND(controller.cmdReg));
+    CHECK_EQUAL(cmdRegInit, controller.cmdReg);
+    CHECK_EQUAL(Ok, GET_ERROR(controller.cmdReg));
     // Master reads from cmd reg - rdy not set. Go is cleared after call
     ExpectCommsLedSwitchOn();
-    ExpectTransmitByte(cmdReg);
+    ExpectTransmitByte(controller.cmdReg);
     ExpectCommsLedSwitchOff();
-    Controller_RequestHandler();
-    CHECK(!IS_RDY(cmdReg));
-    CHECK_EQUAL(DataReg, GET_COMMAND(cmdReg));
-    CHECK_EQUAL(LIFETESTER_CH_B, GET_CHANNEL(cmdReg));
-    CHECK_EQUAL(Ok, GET_ERROR(cmdReg));
+    Controller_RequestHandler(&controller);
+    CHECK(!IS_RDY(controller.cmdReg));
+    CHECK_EQUAL(DataReg, GET_COMMAND(controller.cmdReg));
+    CHECK_EQUAL(LIFETESTER_CH_B, GET_CHANNEL(controller.cmdReg));
+    CHECK_EQUAL(Ok, GET_ERROR(controller.cmdReg));
     mock().checkExpectations();
 }
 
@@ -482,16 +505,16 @@ TEST(ControllerTestGroup, RequestDataFromChANotReadyHackDataRdyCmdBits)
     SET_RDY_STATUS(hackCmd);
     ExpectsForReceiveHandlerRWCmdReg(hackCmd);
     const uint8_t nBytesSent = 1U;
-    Controller_ReceiveHandler(nBytesSent);
+    Controller_ReceiveHandler(&controller, nBytesSent);
     // ready bit is reset when command is parsed
-    CHECK(!IS_RDY(cmdReg));
-    CHECK_EQUAL(Ok, GET_ERROR(cmdReg));
+    CHECK(!IS_RDY(controller.cmdReg));
+    CHECK_EQUAL(Ok, GET_ERROR(controller.cmdReg));
     // master now reads from device. Expect error raised. Busy/data not ready
-    CHECK(IsEmpty(&transmitBuffer));
+    CHECK(IsEmpty(&controller.transmitBuffer));
     ExpectCommsLedSwitchOn();
     ExpectCommsLedSwitchOff();
-    Controller_RequestHandler();
-    CHECK_EQUAL(BusyError, GET_ERROR(cmdReg));
+    Controller_RequestHandler(&controller);
+    CHECK_EQUAL(BusyError, GET_ERROR(controller.cmdReg));
     mock().checkExpectations();
 }
 
@@ -500,29 +523,29 @@ TEST(ControllerTestGroup, WritingNewCommandNotReadyRaisesError)
     // setup cmd reg with by requesting a write
     ExpectsForReceiveHandlerRWCmdReg(WRITE_CH_B_CMD);
     const uint8_t nBytesSent = 1U;
-    Controller_ReceiveHandler(nBytesSent);
+    Controller_ReceiveHandler(&controller, nBytesSent);
     // master then requests a reset on ch b
     ExpectsForReceiveHandlerRWCmdReg(RESET_CH_B);
-    Controller_ReceiveHandler(nBytesSent);
+    Controller_ReceiveHandler(&controller, nBytesSent);
     // device is busy. Requesting to write another command will raise error
-    CHECK(!IS_RDY(cmdReg));
-    CHECK_EQUAL(Ok, GET_ERROR(cmdReg));
+    CHECK(!IS_RDY(controller.cmdReg));
+    CHECK_EQUAL(Ok, GET_ERROR(controller.cmdReg));
     ExpectsForReceiveHandlerRWCmdReg(WRITE_CH_B_CMD);
-    Controller_ReceiveHandler(nBytesSent);
-    CHECK(!IS_RDY(cmdReg));
-    CHECK_EQUAL(BusyError, GET_ERROR(cmdReg));
+    Controller_ReceiveHandler(&controller, nBytesSent);
+    CHECK(!IS_RDY(controller.cmdReg));
+    CHECK_EQUAL(BusyError, GET_ERROR(controller.cmdReg));
 }
 
 TEST(ControllerTestGroup, UnkownCommandRaisesError)
 {
     ExpectsForReceiveHandlerRWCmdReg(WRITE_CH_B_CMD);
     const uint8_t nBytesSent = 1U;
-    Controller_ReceiveHandler(nBytesSent);
-    CHECK_EQUAL(Ok, GET_ERROR(cmdReg));
+    Controller_ReceiveHandler(&controller, nBytesSent);
+    CHECK_EQUAL(Ok, GET_ERROR(controller.cmdReg));
     // write to the data register - not allowed raise error
     ExpectsForReceiveHandlerRWCmdReg(WRITE_CH_B_DATA_BAD_CMD);
-    Controller_ReceiveHandler(nBytesSent);
-    CHECK_EQUAL(UnkownCmdError, GET_ERROR(cmdReg));
+    Controller_ReceiveHandler(&controller, nBytesSent);
+    CHECK_EQUAL(UnkownCmdError, GET_ERROR(controller.cmdReg));
     mock().checkExpectations();
 }
 
@@ -531,19 +554,19 @@ TEST(ControllerTestGroup, WriteAndReadCmdBackFromCmdReg)
     // request to write command for channel A
     ExpectsForReceiveHandlerRWCmdReg(WRITE_CH_A_CMD);
     const uint8_t nBytesSent = 1U;
-    Controller_ReceiveHandler(nBytesSent);
-    CHECK_EQUAL(CmdReg, GET_COMMAND(cmdReg));
-    CHECK(IS_WRITE(cmdReg));
-    CHECK(IS_RDY(cmdReg));
-    CHECK_EQUAL(LIFETESTER_CH_A, GET_CHANNEL(cmdReg));
+    Controller_ReceiveHandler(&controller, nBytesSent);
+    CHECK_EQUAL(CmdReg, GET_COMMAND(controller.cmdReg));
+    CHECK(IS_WRITE(controller.cmdReg));
+    CHECK(IS_RDY(controller.cmdReg));
+    CHECK_EQUAL(LIFETESTER_CH_A, GET_CHANNEL(controller.cmdReg));
     // Now write the command in - request data read ch A
     ExpectsForReceiveHandlerRWCmdReg(READ_CH_A_DATA);
-    Controller_ReceiveHandler(nBytesSent);
-    CHECK_EQUAL(DataReg, GET_COMMAND(cmdReg));
-    CHECK(!IS_WRITE(cmdReg));
-    CHECK(!IS_RDY(cmdReg));
-    CHECK_EQUAL(LIFETESTER_CH_A, GET_CHANNEL(cmdReg));
-    CHECK_EQUAL(Ok, GET_ERROR(cmdReg));
+    Controller_ReceiveHandler(&controller, nBytesSent);
+    CHECK_EQUAL(DataReg, GET_COMMAND(controller.cmdReg));
+    CHECK(!IS_WRITE(controller.cmdReg));
+    CHECK(!IS_RDY(controller.cmdReg));
+    CHECK_EQUAL(LIFETESTER_CH_A, GET_CHANNEL(controller.cmdReg));
+    CHECK_EQUAL(Ok, GET_ERROR(controller.cmdReg));
     mock().checkExpectations();
 }
 
@@ -552,51 +575,51 @@ TEST(ControllerTestGroup, RequestDataFromChAfterReadyStatusIsSet)
     SetExpectedLtDataA(mockLifeTesterA);
     SetExpectedLtDataB(mockLifeTesterB);
     // read ch data already set
-    cmdReg = READ_CH_A_DATA;
-    CHECK(!IS_RDY(cmdReg));
+    controller.cmdReg = READ_CH_A_DATA;
+    CHECK(!IS_RDY(controller.cmdReg));
     // poll cmd reg to see if data is ready
     const uint8_t nBytesSent = 1U;
     ExpectsForReceiveHandlerRWCmdReg(READ_CH_A_CMD);
-    Controller_ReceiveHandler(nBytesSent);
+    Controller_ReceiveHandler(&controller, nBytesSent);
     // Master reads from cmd reg - command not consumed so not ready
     ExpectCommsLedSwitchOn();
-    ExpectTransmitByte(cmdReg);
+    ExpectTransmitByte(controller.cmdReg);
     ExpectCommsLedSwitchOff();
-    Controller_RequestHandler();
-    CHECK_EQUAL(DataReg, GET_COMMAND(cmdReg));
-    CHECK(!IS_WRITE(cmdReg));
-    CHECK(!IS_RDY(cmdReg));
-    CHECK_EQUAL(LIFETESTER_CH_A, GET_CHANNEL(cmdReg));
+    Controller_RequestHandler(&controller);
+    CHECK_EQUAL(DataReg, GET_COMMAND(controller.cmdReg));
+    CHECK(!IS_WRITE(controller.cmdReg));
+    CHECK(!IS_RDY(controller.cmdReg));
+    CHECK_EQUAL(LIFETESTER_CH_A, GET_CHANNEL(controller.cmdReg));
     // now command is consumed and data should be loaded to buffer
     ExpectReadTempAndReturn(tempExpectedA);
     ExpectAnalogReadAndReturn(adcReadExpectedA);
-    Controller_ConsumeCommand(mockLifeTesterA, mockLifeTesterB);
+    Controller_ConsumeCommand(&controller);
     // now data is ready according to reg
-    CHECK_EQUAL(DataReg, GET_COMMAND(cmdReg));
-    CHECK(!IS_WRITE(cmdReg));
-    CHECK(IS_RDY(cmdReg));
+    CHECK_EQUAL(DataReg, GET_COMMAND(controller.cmdReg));
+    CHECK(!IS_WRITE(controller.cmdReg));
+    CHECK(IS_RDY(controller.cmdReg));
     // Master polls device to check data is ready
     ExpectsForReceiveHandlerRWCmdReg(READ_CH_A_CMD);
-    Controller_ReceiveHandler(nBytesSent);
-    Controller_ConsumeCommand(mockLifeTesterA, mockLifeTesterB);
+    Controller_ReceiveHandler(&controller, nBytesSent);
+    Controller_ConsumeCommand(&controller);
     // Next the master will read cmd reg
     ExpectCommsLedSwitchOn();
-    ExpectTransmitByte(cmdReg);
+    ExpectTransmitByte(controller.cmdReg);
     ExpectCommsLedSwitchOff();
-    Controller_RequestHandler();
+    Controller_RequestHandler(&controller);
     // and finally just read out the data.
     ExpectCommsLedSwitchOn();
-    ExpectSendTransmitBuffer(&transmitBuffer);
+    ExpectSendTransmitBuffer(&controller.transmitBuffer);
     ExpectCommsLedSwitchOff();
-    Controller_RequestHandler();
-    CHECK_EQUAL(Ok, GET_ERROR(cmdReg));
-    CHECK_EQUAL(LIFETESTER_CH_A, GET_CHANNEL(cmdReg));
-    CHECK_EQUAL(timeExpectedA, ReadUint32(&transmitBuffer));
-    CHECK_EQUAL(vExpectedA, ReadUint8(&transmitBuffer));
-    CHECK_EQUAL(iExpectedA, ReadUint16(&transmitBuffer));
-    CHECK_EQUAL(tempExpectedA, ReadUint16(&transmitBuffer));
-    CHECK_EQUAL(adcReadExpectedA, ReadUint16(&transmitBuffer));
-    CHECK_EQUAL(errorExpectedA, ReadUint8(&transmitBuffer));
+    Controller_RequestHandler(&controller);
+    CHECK_EQUAL(Ok, GET_ERROR(controller.cmdReg));
+    CHECK_EQUAL(LIFETESTER_CH_A, GET_CHANNEL(controller.cmdReg));
+    CHECK_EQUAL(timeExpectedA, ReadUint32(&controller.transmitBuffer));
+    CHECK_EQUAL(vExpectedA, ReadUint8(&controller.transmitBuffer));
+    CHECK_EQUAL(iExpectedA, ReadUint16(&controller.transmitBuffer));
+    CHECK_EQUAL(tempExpectedA, ReadUint16(&controller.transmitBuffer));
+    CHECK_EQUAL(adcReadExpectedA, ReadUint16(&controller.transmitBuffer));
+    CHECK_EQUAL(errorExpectedA, ReadUint8(&controller.transmitBuffer));
     mock().checkExpectations();
 }
 
@@ -605,50 +628,51 @@ TEST(ControllerTestGroup, RequestDataFromChBfterReadyStatusIsSet)
     SetExpectedLtDataA(mockLifeTesterA);
     SetExpectedLtDataB(mockLifeTesterB);
     // read ch data already set
-    cmdReg = READ_CH_B_DATA;
-    CHECK(!IS_RDY(cmdReg));
+    controller.cmdReg = READ_CH_B_DATA;
+    controller.cmdChannel = LIFETESTER_CH_B;
+    CHECK(!IS_RDY(controller.cmdReg));
     // poll cmd reg to see if data is ready
     const uint8_t nBytesSent = 1U;
     ExpectsForReceiveHandlerRWCmdReg(READ_CH_B_CMD);
-    Controller_ReceiveHandler(nBytesSent);
+    Controller_ReceiveHandler(&controller, nBytesSent);
     // Master reads from cmd reg - command not consumed so not ready
     ExpectCommsLedSwitchOn();
-    ExpectTransmitByte(cmdReg);
+    ExpectTransmitByte(controller.cmdReg);
     ExpectCommsLedSwitchOff();
-    Controller_RequestHandler();
-    CHECK_EQUAL(DataReg, GET_COMMAND(cmdReg));
-    CHECK(!IS_WRITE(cmdReg));
-    CHECK(!IS_RDY(cmdReg));
+    Controller_RequestHandler(&controller);
+    CHECK_EQUAL(DataReg, GET_COMMAND(controller.cmdReg));
+    CHECK(!IS_WRITE(controller.cmdReg));
+    CHECK(!IS_RDY(controller.cmdReg));
     // now command is consumed and data should be loaded to buffer
     ExpectReadTempAndReturn(tempExpectedB);
     ExpectAnalogReadAndReturn(adcReadExpectedB);
-    Controller_ConsumeCommand(mockLifeTesterA, mockLifeTesterB);
+    Controller_ConsumeCommand(&controller);
     // now data is ready according to reg
-    CHECK_EQUAL(DataReg, GET_COMMAND(cmdReg));
-    CHECK(!IS_WRITE(cmdReg));
-    CHECK(IS_RDY(cmdReg));
+    CHECK_EQUAL(DataReg, GET_COMMAND(controller.cmdReg));
+    CHECK(!IS_WRITE(controller.cmdReg));
+    CHECK(IS_RDY(controller.cmdReg));
     // Master polls device to check data is ready
     ExpectsForReceiveHandlerRWCmdReg(READ_CH_A_CMD);
-    Controller_ReceiveHandler(nBytesSent);
-    Controller_ConsumeCommand(mockLifeTesterA, mockLifeTesterB);
+    Controller_ReceiveHandler(&controller, nBytesSent);
+    Controller_ConsumeCommand(&controller);
     // Next the master will read cmd reg
     ExpectCommsLedSwitchOn();
-    ExpectTransmitByte(cmdReg);
+    ExpectTransmitByte(controller.cmdReg);
     ExpectCommsLedSwitchOff();
-    Controller_RequestHandler();
+    Controller_RequestHandler(&controller);
     // and finally just read out the data -  should not be overwritten
     ExpectCommsLedSwitchOn();
-    ExpectSendTransmitBuffer(&transmitBuffer);
+    ExpectSendTransmitBuffer(&controller.transmitBuffer);
     ExpectCommsLedSwitchOff();
-    Controller_RequestHandler();
-    CHECK_EQUAL(Ok, GET_ERROR(cmdReg));
-    CHECK_EQUAL(LIFETESTER_CH_B, GET_CHANNEL(cmdReg));
-    CHECK_EQUAL(timeExpectedB, ReadUint32(&transmitBuffer));
-    CHECK_EQUAL(vExpectedB, ReadUint8(&transmitBuffer));
-    CHECK_EQUAL(iExpectedB, ReadUint16(&transmitBuffer));
-    CHECK_EQUAL(tempExpectedB, ReadUint16(&transmitBuffer));
-    CHECK_EQUAL(adcReadExpectedB, ReadUint16(&transmitBuffer));
-    CHECK_EQUAL(errorExpectedB, ReadUint8(&transmitBuffer));
+    Controller_RequestHandler(&controller);
+    CHECK_EQUAL(Ok, GET_ERROR(controller.cmdReg));
+    CHECK_EQUAL(LIFETESTER_CH_B, GET_CHANNEL(controller.cmdReg));
+    CHECK_EQUAL(timeExpectedB, ReadUint32(&controller.transmitBuffer));
+    CHECK_EQUAL(vExpectedB, ReadUint8(&controller.transmitBuffer));
+    CHECK_EQUAL(iExpectedB, ReadUint16(&controller.transmitBuffer));
+    CHECK_EQUAL(tempExpectedB, ReadUint16(&controller.transmitBuffer));
+    CHECK_EQUAL(adcReadExpectedB, ReadUint16(&controller.transmitBuffer));
+    CHECK_EQUAL(errorExpectedB, ReadUint8(&controller.transmitBuffer));
     mock().checkExpectations();
 }
 
@@ -657,24 +681,26 @@ TEST(ControllerTestGroup, ReadMeasurementParams)
     // request to write command reg for channel A
     ExpectsForReceiveHandlerRWCmdReg(WRITE_CH_A_CMD);
     const uint8_t nBytesSent = 1U;
-    Controller_ReceiveHandler(nBytesSent);
+    Controller_ReceiveHandler(&controller, nBytesSent);
     // Now write the read params command to reg
     ExpectsForReceiveHandlerRWCmdReg(READ_PARAMS);
-    Controller_ReceiveHandler(nBytesSent);
-    CHECK_EQUAL(ParamsReg, GET_COMMAND(cmdReg));
-    CHECK(!IS_WRITE(cmdReg));
-    CHECK(!IS_RDY(cmdReg));
-    CHECK_EQUAL(Ok, GET_ERROR(cmdReg));
+    Controller_ReceiveHandler(&controller, nBytesSent);
+    CHECK_EQUAL(ParamsReg, GET_COMMAND(controller.cmdReg));
+    CHECK(!IS_WRITE(controller.cmdReg));
+    CHECK(!IS_RDY(controller.cmdReg));
+    CHECK_EQUAL(Ok, GET_ERROR(controller.cmdReg));
     // Command is consumed - expect calls getting params to load into buffer
     mock().expectOneCall("Config_GetSettleTime").andReturnValue(settleTime);
     mock().expectOneCall("Config_GetTrackDelay").andReturnValue(trackDelay);
     mock().expectOneCall("Config_GetSampleTime").andReturnValue(sampleTime);
     mock().expectOneCall("Config_GetThresholdCurrent").andReturnValue(thresholdCurrent);
-    Controller_ConsumeCommand(mockLifeTesterA, mockLifeTesterB);
-    CHECK_EQUAL(settleTime, ReadUint16(&transmitBuffer));
-    CHECK_EQUAL(trackDelay, ReadUint16(&transmitBuffer));
-    CHECK_EQUAL(sampleTime, ReadUint16(&transmitBuffer));
-    CHECK_EQUAL(thresholdCurrent, ReadUint16(&transmitBuffer));
+    mock().expectOneCall("Config_GetTrackingAlgorithms").andReturnValue(trackingAlgorithms);
+    Controller_ConsumeCommand(&controller);
+    CHECK_EQUAL(settleTime, ReadUint16(&controller.transmitBuffer));
+    CHECK_EQUAL(trackDelay, ReadUint16(&controller.transmitBuffer));
+    CHECK_EQUAL(sampleTime, ReadUint16(&controller.transmitBuffer));
+    CHECK_EQUAL(thresholdCurrent, ReadUint16(&controller.transmitBuffer));
+    CHECK_EQUAL(trackingAlgorithms, ReadUint8(&controller.transmitBuffer));
     mock().checkExpectations();
 }
 
@@ -687,19 +713,19 @@ TEST(ControllerTestGroup, SetMeasurementParams)
     // request to write command reg for channel A
     ExpectsForReceiveHandlerRWCmdReg(WRITE_CH_A_CMD);
     uint8_t nBytesSent = 1U;
-    Controller_ReceiveHandler(nBytesSent);
+    Controller_ReceiveHandler(&controller, nBytesSent);
     // Now write the write params command to reg
     ExpectsForReceiveHandlerRWCmdReg(WRITE_PARAMS);
-    Controller_ReceiveHandler(nBytesSent);
-    CHECK_EQUAL(ParamsReg, GET_COMMAND(cmdReg));
-    CHECK(IS_WRITE(cmdReg));
-    CHECK(!IS_RDY(cmdReg));
+    Controller_ReceiveHandler(&controller, nBytesSent);
+    CHECK_EQUAL(ParamsReg, GET_COMMAND(controller.cmdReg));
+    CHECK(IS_WRITE(controller.cmdReg));
+    CHECK(!IS_RDY(controller.cmdReg));
     // Controller will clear the read buffer ready to read in params
     ExpectReadBufferFlush();
-    Controller_ConsumeCommand(mockLifeTesterA, mockLifeTesterB);
-    CHECK(IS_RDY(cmdReg));
+    Controller_ConsumeCommand(&controller);
+    CHECK(IS_RDY(controller.cmdReg));
     /*
-     Master sends data as 4 byte string of measurement params 
+     Master sends data as 9 byte string of measurement params 
      - expect setters to get called
      */
     ExpectCommsLedSwitchOn();
@@ -719,10 +745,53 @@ TEST(ControllerTestGroup, SetMeasurementParams)
     ExpectReceiveByte(GET_MSB(thresholdCurrent));
     mock().expectOneCall("Config_SetThresholdCurrent")
         .withParameter("iThreshold", thresholdCurrent);
+    ExpectReceiveByte(trackingAlgorithms);
+    mock().expectOneCall("Config_SetTrackingAlgorithms")
+        .withParameter("algorithms", trackingAlgorithms);
     ExpectCommsLedSwitchOff();
     // receive handler needs all params in a single transaction
-    Controller_ReceiveHandler(PARAMS_REG_SIZE);
-    CHECK_EQUAL(Ok, GET_ERROR(cmdReg));
+    Controller_ReceiveHandler(&controller, PARAMS_REG_SIZE);
+    CHECK_EQUAL(Ok, GET_ERROR(controller.cmdReg));
+    mock().checkExpectations();
+}
+
+/*
+ Masters from before tracking algorithms were added write 8 bytes. The params
+ they know about are set and the tracking algorithms are left alone.
+*/
+TEST(ControllerTestGroup, SetMeasurementParamsWithoutTrackingAlgorithms)
+{
+    ExpectsForReceiveHandlerRWCmdReg(WRITE_CH_A_CMD);
+    const uint8_t nBytesSent = 1U;
+    Controller_ReceiveHandler(&controller, nBytesSent);
+    ExpectsForReceiveHandlerRWCmdReg(WRITE_PARAMS);
+    Controller_ReceiveHandler(&controller, nBytesSent);
+    ExpectReadBufferFlush();
+    Controller_ConsumeCommand(&controller);
+    CHECK(IS_RDY(controller.cmdReg));
+
+    ExpectCommsLedSwitchOn();
+    ExpectReceiveByte(GET_LSB(settleTime));
+    ExpectReceiveByte(GET_MSB(settleTime));
+    mock().expectOneCall("Config_SetSettleTime")
+        .withParameter("tSettle", settleTime);
+    ExpectReceiveByte(GET_LSB(trackDelay));
+    ExpectReceiveByte(GET_MSB(trackDelay));
+    mock().expectOneCall("Config_SetTrackDelay")
+       .withParameter("tDelay", trackDelay);
+    ExpectReceiveByte(GET_LSB(sampleTime));
+    ExpectReceiveByte(GET_MSB(sampleTime));
+    mock().expectOneCall("Config_SetSampleTime")
+        .withParameter("tSample", sampleTime);
+    ExpectReceiveByte(GET_LSB(thresholdCurrent));
+    ExpectReceiveByte(GET_MSB(thresholdCurrent));
+    mock().expectOneCall("Config_SetThresholdCurrent")
+        .withParameter("iThreshold", thresholdCurrent);
+    // no Config_SetTrackingAlgorithms call
+    ExpectCommsLedSwitchOff();
+    Controller_ReceiveHandler(&controller, PARAMS_REG_SIZE_NO_ALGORITHMS);
+    CHECK_EQUAL(Ok, GET_ERROR(controller.cmdReg));
+    CHECK(!IS_WRITE(controller.cmdReg));
     mock().checkExpectations();
 }
 
@@ -730,31 +799,70 @@ TEST(ControllerTestGroup, SetMeasurementParamsRegWrongSize)
 {    
     ExpectsForReceiveHandlerRWCmdReg(WRITE_CH_A_CMD);
     const uint8_t nBytesSent = 1U;
-    Controller_ReceiveHandler(nBytesSent);
-    CHECK_EQUAL(Ok, GET_ERROR(cmdReg));
+    Controller_ReceiveHandler(&controller, nBytesSent);
+    CHECK_EQUAL(Ok, GET_ERROR(controller.cmdReg));
     // Now write the write params command to reg
     ExpectsForReceiveHandlerRWCmdReg(WRITE_PARAMS);
-    Controller_ReceiveHandler(nBytesSent);
-    CHECK_EQUAL(ParamsReg, GET_COMMAND(cmdReg));
-    CHECK(IS_WRITE(cmdReg));
-    CHECK(!IS_RDY(cmdReg));
-    CHECK_EQUAL(Ok, GET_ERROR(cmdReg));
+    Controller_ReceiveHandler(&controller, nBytesSent);
+    CHECK_EQUAL(ParamsReg, GET_COMMAND(controller.cmdReg));
+    CHECK(IS_WRITE(controller.cmdReg));
+    CHECK(!IS_RDY(controller.cmdReg));
+    CHECK_EQUAL(Ok, GET_ERROR(controller.cmdReg));
     // Controller will clear the read buffer ready to read in params
     ExpectReadBufferFlush();
-    Controller_ConsumeCommand(mockLifeTesterA, mockLifeTesterB);
-    CHECK(IS_RDY(cmdReg));
-    CHECK_EQUAL(Ok, GET_ERROR(cmdReg));
+    Controller_ConsumeCommand(&controller);
+    CHECK(IS_RDY(controller.cmdReg));
+    CHECK_EQUAL(Ok, GET_ERROR(controller.cmdReg));
     // Slave only recieves 1 byte not the 4 required for setting params
     ExpectCommsLedSwitchOn();
     // No read expected - device throws data away.
     ExpectReadBufferFlush();
     ExpectCommsLedSwitchOff();
-    Controller_ReceiveHandler(nBytesSent);
+    Controller_ReceiveHandler(&controller, nBytesSent);
     // Error raised by controller
     CHECK(IsEmpty(&mockRxBuffer));
-    CHECK(IS_RDY(cmdReg));
-    CHECK_EQUAL(ParamsReg, GET_COMMAND(cmdReg));
-    CHECK(IS_WRITE(cmdReg));
-    CHECK_EQUAL(BadParamsError, GET_ERROR(cmdReg));
+    CHECK(IS_RDY(controller.cmdReg));
+    CHECK_EQUAL(ParamsReg, GET_COMMAND(controller.cmdReg));
+    CHECK(IS_WRITE(controller.cmdReg));
+    CHECK_EQUAL(BadParamsError, GET_ERROR(controller.cmdReg));
     mock().checkExpectations();
-}
\ No newline at end of file
+}
+TEST(ControllerTestGroup, ResetChannelSelectedByChannelByte)
+{
+    const uint8_t channel = 3U;
+    // First request a write to the cmd reg
+    ExpectsForReceiveHandlerRWCmdReg(WRITE_CH_A_CMD);
+    Controller_ReceiveHandler(&controller, 1U);
+    Controller_ConsumeCommand(&controller);
+    // then write the reset command followed by the channel number
+    ExpectsForReceiveHandlerCmdWithChannel(RESET_CH_A, channel);
+    Controller_ReceiveHandler(&controller, 2U);
+    CHECK_EQUAL(Reset, GET_COMMAND(controller.cmdReg));
+    CHECK(!IS_RDY(controller.cmdReg));
+    CHECK_EQUAL(channel, controller.cmdChannel);
+    mock().expectOneCall("StateMachine_Reset")
+        .withParameter("lifeTester", &mockLifeTesters[channel]);
+    Controller_ConsumeCommand(&controller);
+    CHECK(IS_RDY(controller.cmdReg));
+    CHECK_EQUAL(Ok, GET_ERROR(controller.cmdReg));
+    mock().checkExpectations();
+}
+
+TEST(ControllerTestGroup, RequestDataFromChannelNotInTableSetsError)
+{
+    // First request a write to the cmd reg
+    ExpectsForReceiveHandlerRWCmdReg(WRITE_CH_A_CMD);
+    Controller_ReceiveHandler(&controller, 1U);
+    Controller_ConsumeCommand(&controller);
+    // ask for data from a channel the board doesn't have
+    ExpectsForReceiveHandlerCmdWithChannel(READ_CH_A_DATA, N_MOCK_LIFETESTERS);
+    Controller_ReceiveHandler(&controller, 2U);
+    CHECK_EQUAL(DataReg, GET_COMMAND(controller.cmdReg));
+    CHECK(!IS_RDY(controller.cmdReg));
+    // nothing loaded into the transmit buffer
+    Controller_ConsumeCommand(&controller);
+    CHECK(IS_RDY(controller.cmdReg));
+    CHECK(IsEmpty(&controller.transmitBuffer));
+    CHECK_EQUAL(UnkownCmdError, GET_ERROR(controller.cmdReg));
+    mock().checkExpectations();
+}
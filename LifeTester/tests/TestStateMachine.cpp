@@ -10,7 +10,10 @@
 // support
 #include "Arduino.h"   // arduino function prototypes eg. millis (defined here)
 #include "Config.h"
+#include "IoStats.h"
 #include "IoWrapper.h"
+#include "MppStore.h"
+#include "TimerWheel.h"
 #include <string.h>
 
 /*******************************************************************************
@@ -294,12 +297,22 @@ static double shockleyDiode[][3] =
 // Calculated in SchockleyData.py
 const static uint8_t mppCodeShockley = 58U;
 
-// Mocks the time returned to the source by calls to millis
+// Time the lifetester's timers have been serviced up to
 static uint32_t mockTime;
 
+// Wheel the lifetester's timers run on
+static TimerWheel_t wheel;
+
+// Io stats and mpp store the lifetester is given by the board
+static IoStats_t ioStats;
+static MppStore_t mppStore;
+
 // Mocks the current returned from the adc
 static uint16_t mockCurrent;
 
+// Time the mux takes to settle when a window is claimed. See MockIoWrapper.cpp
+extern uint16_t mockMuxSettleTime;
+
 // Mock lifetester object that's used in lots of tests.
 static LifeTester_t *mockLifeTester;
 
@@ -327,6 +340,42 @@ static uint16_t TestGetAdcCodeConstantCurrent(uint8_t dacCode)
     return FIXED_CURRENT;
 }
 
+// Device that's gone open circuit - no current at any voltage
+static uint16_t TestGetAdcCodeZero(uint8_t dacCode)
+{
+    dacCode;
+    return 0U;
+}
+
+/*
+ Device with a parabolic power curve peaking at testPeakV. Lets the fitted mpp
+ be checked between dac codes.
+*/
+static double testPeakV;
+
+static uint16_t TestGetAdcCodeForParabola(uint8_t dacCode)
+{
+    const double p = 1.5E6 - 1.0E3 * (dacCode - testPeakV) * (dacCode - testPeakV);
+    return ((dacCode == 0U) || (p <= 0.0)) ? 0U : (uint16_t)(p / dacCode + 0.5);
+}
+
+/*
+ Device with a lopsided power peak at testPeakV. Power rises slowly towards it
+ and falls away twenty times as fast after it, so a quadratic through the
+ points around the peak has its vertex more than a code below it.
+*/
+static double TestGetPowerForSteepPeak(uint8_t dacCode)
+{
+    const double dv = dacCode - testPeakV;
+    return 1.5E6 + ((dv < 0.0) ? 1.0E3 * dv : -2.0E4 * dv);
+}
+
+static uint16_t TestGetAdcCodeForSteepPeak(uint8_t dacCode)
+{
+    const double p = TestGetPowerForSteepPeak(dacCode);
+    return ((dacCode == 0U) || (p <= 0.0)) ? 0U : (uint16_t)(p / dacCode + 0.5);
+}
+
 static bool ThisMeasurementActive(LifeTester_t const *const lifeTester)
 {
     LifeTesterData_t const *const data = &lifeTester->data;
@@ -351,6 +400,18 @@ static bool ScanMeasurementActive(LifeTester_t const *const lifeTester)
             && (data->pActive == &data->pScan));
 }
 
+// Moves time on to t and fires the lifetester's timers that are due
+static void SetTime(uint32_t t)
+{
+    mockTime = t;
+    TimerWheel_Service(&wheel, mockTime);
+}
+
+static void AdvanceTime(uint32_t dt)
+{
+    SetTime(mockTime + dt);
+}
+
 /*******************************************************************************
 * MOCKS FOR TESTS
 ********************************************************************************/
@@ -396,10 +457,25 @@ static void MocksForSampleCurrent(LifeTester_t const *const lifeTester)
         .andReturnValue(mockCurrent);
 }
 
-static void MocksForGetTime(void)
+static void MocksForClaimSampleWindow(LifeTester_t const *const lifeTester,
+                                      bool granted)
+{
+    mock().expectOneCall("AdcClaimSampleWindow")
+        .withParameter("channel", lifeTester->io.adc)
+        .andReturnValue(granted);
+}
+
+// current sampled in the measurement's own window
+static void MocksForSampleCurrentInWindow(LifeTester_t const *const lifeTester)
+{
+    MocksForClaimSampleWindow(lifeTester, true);
+    MocksForSampleCurrent(lifeTester);
+}
+
+static void MocksForCancelAdcRead(LifeTester_t const *const lifeTester)
 {
-    mock().expectOneCall("millis").
-        andReturnValue(mockTime);
+    mock().expectOneCall("AdcCancelLifeTesterRead")
+        .withParameter("channel", lifeTester->io.adc);
 }
 
 static void MocksForInitLedSetup(void)
@@ -418,25 +494,41 @@ static void MocksForScanLedSetup(void)
     mock().expectOneCall("Flasher::keepFlashing");
 }
 
-static void MockForLedUpdate(void)
-{
-    mock().expectOneCall("Flasher::update");
-}
-
 static void MockForLedOff(void)
 {
     mock().expectOneCall("Flasher::off");
 }
 
-static void MocksForPrintNewMpp(void)
+static void MocksForCheckLight(uint16_t light, uint8_t threshold)
 {
+    mock().expectOneCall("Config_GetLightChangeThreshold").andReturnValue(threshold);
     mock().expectOneCall("analogRead")
         .withParameter("pin", LIGHT_SENSOR_PIN)
-        .andReturnValue(0);
+        .andReturnValue(light);
+}
+
+static void MocksForCheckDwell(uint8_t drift)
+{
+    mock().expectOneCall("Config_GetDwellDrift").andReturnValue(drift);
+}
+
+/*
+ light is read by the light change check at the end of the cycle and printed.
+ The dwell check comes after it.
+*/
+static void MocksForPrintNewMppAtLight(uint16_t light)
+{
+    MocksForCheckLight(light, LIGHT_CHANGE_THRESHOLD);
+    MocksForCheckDwell(DWELL_DRIFT);
     mock().expectOneCall("TempReadDegC")
         .andReturnValue(0.0);
 }
 
+static void MocksForPrintNewMpp(void)
+{
+    MocksForPrintNewMppAtLight(0U);
+}
+
 static void MocksForFlashLedOnce(void)
 {
     mock().expectOneCall("Flasher::stopAfter")
@@ -449,20 +541,24 @@ static void MocksForFlashLedTwice(void)
         .withParameter("n", 2);
 }
 
+// settle time and sampling window timers are started for each measurement
+static void MocksForStartMeasurementTimers(void)
+{
+    mock().expectOneCall("Config_GetSettleTime").andReturnValue(SETTLE_TIME);
+    mock().expectOneCall("Config_GetSampleTime").andReturnValue(SAMPLING_TIME);
+}
+
 static void MocksForMeasureScanPointEntry(LifeTester_t const *const lifeTester) 
 {    
     MocksForSetDacToScanVoltage(mockLifeTester);
-    MocksForGetTime();
+    MocksForStartMeasurementTimers();
 }
 
-static void MocksForScanModeEntry()
+static void MocksForScanModeEntry(uint8_t strategy, uint8_t stopMargin)
 {
     MocksForScanLedSetup();
-}
-
-static void MocksForScanModeStep(void)
-{
-    MockForLedUpdate();
+    mock().expectOneCall("Config_GetScanStrategy").andReturnValue(strategy);
+    mock().expectOneCall("Config_GetScanStopMargin").andReturnValue(stopMargin);
 }
 
 static void MocksForScanModeExit(void)
@@ -470,84 +566,94 @@ static void MocksForScanModeExit(void)
     MockForLedOff();
 }
 
-static void MocksForMeasureDataNoAdcRead(void)
+static void MocksForMeasureDataNoAdcReadWithTolerance(uint8_t tolerance)
 {
-    MocksForGetTime();
     mock().expectOneCall("Config_GetSettleTime").andReturnValue(SETTLE_TIME);
     mock().expectOneCall("Config_GetSampleTime").andReturnValue(SAMPLING_TIME);
+    mock().expectOneCall("Config_GetSampleTolerance").andReturnValue(tolerance);
+}
+
+static void MocksForMeasureDataNoAdcRead(void)
+{
+    MocksForMeasureDataNoAdcReadWithTolerance(SAMPLE_TOLERANCE);
+}
+
+// window timer fires. The window is closed to free the adc.
+static void MocksForMeasureDataSamplingDone(LifeTester_t const *const lifeTester)
+{
+    MocksForCancelAdcRead(lifeTester);
 }
 
 static void MocksForMeasureDataReadAdc(LifeTester_t const *const lifeTester)
 {
     MocksForMeasureDataNoAdcRead();
-    MocksForSampleCurrent(mockLifeTester);
+    MocksForSampleCurrentInWindow(mockLifeTester);
+}
+
+static void MocksForGetTrackingAlgorithms(uint8_t algorithm)
+{
+    // same algorithm selected for all channels
+    const uint8_t algorithms = (algorithm == INC_CONDUCTANCE) ? 0xFFU : 0U;
+    mock().expectOneCall("Config_GetTrackingAlgorithms").andReturnValue(algorithms);
 }
 
-static void MocksForTrackingModeStep(void)
+static void MocksForGetStepLimits(uint8_t dvMin, uint8_t dvMax)
 {
-    MockForLedUpdate();
+    mock().expectOneCall("Config_GetMinStep").andReturnValue(dvMin);
+    mock().expectOneCall("Config_GetMaxStep").andReturnValue(dvMax);
 }
 
 static void MocksForTrackingModeStepIncreaseV(void)
 {
-    MockForLedUpdate();
+    MocksForGetTrackingAlgorithms(PERTURB_OBSERVE);
+    MocksForGetStepLimits(DV_MPPT_MIN, DV_MPPT_MAX);
     MocksForFlashLedTwice();
     MocksForPrintNewMpp();
 }
 
+static void MocksForGetReuseLimit(uint8_t limit)
+{
+    mock().expectOneCall("Config_GetReuseLimit").andReturnValue(limit);
+}
+
 static void MocksForTrackingModeStepDecreaseV(void)
 {
-    MockForLedUpdate();
+    MocksForGetTrackingAlgorithms(PERTURB_OBSERVE);
+    MocksForGetStepLimits(DV_MPPT_MIN, DV_MPPT_MAX);
     MocksForFlashLedOnce();
     MocksForPrintNewMpp();
 }
 
 static void MocksForTrackingDelayEntry(void)
 {
-    MocksForGetTime();
-}
-
-static void MocksForTrackingDelayStep(void)
-{
-    MocksForGetTime();
     mock().expectOneCall("Config_GetTrackDelay").andReturnValue(TRACK_DELAY_TIME);
-
 }
 
 static void MocksForMeasureThisPointEntry(LifeTester_t const *const lifeTester) 
 {    
     MocksForSetDacToThisVoltage(mockLifeTester);
-    MocksForGetTime();
+    MocksForStartMeasurementTimers();
 }
 
 static void MocksForMeasureNextPointEntry(LifeTester_t const *const lifeTester) 
 {    
     MocksForSetDacToNextVoltage(mockLifeTester);
-    MocksForGetTime();
+    MocksForStartMeasurementTimers();
 }
 
 static void MocksForInitialiseStepAdcRead(LifeTester_t const *const lifeTester)
 {
-    MockForLedUpdate();
-    MocksForGetTime();
-    mock().expectOneCall("Config_GetSettleTime").andReturnValue(SETTLE_TIME); 
-    // delay time expired so adc will be sampled
+    // settle time expired so adc will be sampled
     MocksForSampleCurrent(mockLifeTester);
     mock().expectOneCall("Config_GetThresholdCurrent").andReturnValue(THRESHOLD_CURRENT); 
 }
 
 static void MocksForInitialiseEntry(LifeTester_t const *const lifeTester)
 {
-    MocksForGetTime();
+    MocksForCancelAdcRead(lifeTester);
     MocksForInitDac(mockLifeTester);
     MocksForInitLedSetup();    
-}
-
-static void MocksForInitialiseStepNoAdcRead(void)
-{
-    MocksForGetTime();
     mock().expectOneCall("Config_GetSettleTime").andReturnValue(SETTLE_TIME); 
-    MockForLedUpdate();
 }
 
 static void MocksForErrorLedSetup(void)
@@ -558,30 +664,80 @@ static void MocksForErrorLedSetup(void)
     mock().expectOneCall("Flasher::keepFlashing");
 }
 
-static void MocksForErrorEntry(LifeTester_t const *const lifeTester)
+static void MocksForLoadMpp(LifeTester_t const *const lifeTester,
+                            MppRecord_t const *const stored)
+{
+    mock().expectOneCall("MppStore_Load")
+        .withParameter("store", (const void *)lifeTester->mppStore)
+        .withParameter("channel", lifeTester->io.channel)
+        .andReturnValue((const void *)stored);
+}
+
+static void MocksForSaveMpp(LifeTester_t const *const lifeTester,
+                            uint8_t v,
+                            ErrorCode_t error)
+{
+    mock().expectOneCall("MppStore_Save")
+        .withParameter("store", (const void *)lifeTester->mppStore)
+        .withParameter("channel", lifeTester->io.channel)
+        .withParameter("v", v)
+        .withParameter("error", (uint8_t)error);
+}
+
+// mpp is stored along with the error so the channel doesn't warm start
+static void MocksForErrorEntry(LifeTester_t const *const lifeTester,
+                               ErrorCode_t error)
 {
     MocksForErrorLedSetup();
     MocksForSetDacToVoltage(lifeTester, 0U);
+    MocksForCancelAdcRead(lifeTester);
+    MocksForSaveMpp(lifeTester, lifeTester->data.vThis, error);
 }
 
 
-static void SetupForScanningMode(LifeTester_t *const lifeTester)
+static void SetupForScanningModeWithStrategy(LifeTester_t *const lifeTester,
+                                             uint8_t strategy,
+                                             uint8_t stopMargin)
 {
     // note that mocks are needed to pass data to source
     const uint32_t tInit       = 2436U;
     const uint32_t tElapsed    = SETTLE_TIME + 1U;
-                   mockTime    = tInit;
                    // Set current to get through init checks
                    mockCurrent = THRESHOLD_CURRENT + 1U; 
+    SetTime(tInit);
     MocksForInitialiseEntry(mockLifeTester);
     StateMachine_Reset(mockLifeTester);
-    mockTime += tElapsed;
+    AdvanceTime(tElapsed);
     MocksForInitialiseStepAdcRead(mockLifeTester);
+    MocksForLoadMpp(mockLifeTester, NULL);
     // mode change to Scanning mode - entry function sets led
-    MocksForScanModeEntry();
+    MocksForScanModeEntry(strategy, stopMargin);
     StateMachine_UpdateStep(mockLifeTester);
 }
 
+/*
+ Goes through init with an mpp stored for the channel. Scanning mode is entered
+ for the warm start check so no scan config is read.
+*/
+static void SetupForWarmStart(LifeTester_t *const lifeTester,
+                              MppRecord_t const *const stored)
+{
+    mockCurrent = THRESHOLD_CURRENT + 1U;
+    SetTime(2436U);
+    MocksForInitialiseEntry(lifeTester);
+    StateMachine_Reset(lifeTester);
+    AdvanceTime(SETTLE_TIME + 1U);
+    MocksForInitialiseStepAdcRead(lifeTester);
+    MocksForLoadMpp(lifeTester, stored);
+    MocksForScanLedSetup();
+    StateMachine_UpdateStep(lifeTester);
+}
+
+static void SetupForScanningMode(LifeTester_t *const lifeTester)
+{
+    SetupForScanningModeWithStrategy(lifeTester, SCAN_LINEAR, SCAN_NO_EARLY_STOP);
+}
+
 /*******************************************************************************
  * UNIT TESTS
  ******************************************************************************/
@@ -598,12 +754,16 @@ TEST_GROUP(IVTestGroup)
 
         // Initialised data
         const LifeTester_t lifetesterSetup = {
-            {chASelect, 0U},    // io
-            Flasher(LED_A_PIN), // led
+            {0U, NULL, chASelect, NULL, 0U, NULL}, // io
+            Flasher(LED_A_PIN, NULL), // led
             {0},                // data
             0U,                 // timer
             ok,                 // error
-            &StateNone
+            &StateNone,         // state
+            NULL,               // config
+            &wheel,             // timers
+            &ioStats,           // ioStats
+            &mppStore           // mppStore
         };
         // Copy to a static variable for tests to work on
         static LifeTester_t lifeTesterForTest = lifetesterSetup;
@@ -612,7 +772,10 @@ TEST_GROUP(IVTestGroup)
         // Access with a pointer from tests
         mockLifeTester = &lifeTesterForTest;
         mockTime = 0U;
+        TimerWheel_Init(&wheel, mockTime);
+        IoStats_Reset(&ioStats);
         mockCurrent = 0U;
+        mockMuxSettleTime = 0U;
         mock().enable();
     }
 
@@ -634,15 +797,15 @@ TEST_GROUP(IVTestGroup)
 TEST(IVTestGroup, UpdatingInitialiseStateDuringPostDelayTime)
 {
     // timer will be reset
-    mockTime = 2436U;
+    SetTime(2436U);
     MocksForInitialiseEntry(mockLifeTester);
     StateMachine_Reset(mockLifeTester);
     CHECK_EQUAL(mockTime, mockLifeTester->timer);
     const uint8_t expectedData[sizeof(LifeTesterData_t)] = {0U};
     MEMCMP_EQUAL(expectedData, &mockLifeTester->data, sizeof(LifeTesterData_t));
     POINTERS_EQUAL(&StateInitialiseDevice, mockLifeTester->state);
-    // timer will be checked again in step function.
-    MocksForInitialiseStepNoAdcRead();
+    // settle timer hasn't fired so the step does nothing
+    AdvanceTime(SETTLE_TIME - 1U);
     StateMachine_UpdateStep(mockLifeTester);
     // expect the state and data not to change
     MEMCMP_EQUAL(expectedData, &mockLifeTester->data, sizeof(LifeTesterData_t));
@@ -651,6 +814,24 @@ TEST(IVTestGroup, UpdatingInitialiseStateDuringPostDelayTime)
     mock().checkExpectations();
 }
 
+/*
+ Nothing happens in initialise until the settle timer fires so the loop can
+ idle. Once it has the short-circuit current is read on the next update.
+*/
+TEST(IVTestGroup, InitialiseWaitsForSettleTimer)
+{
+    SetTime(2436U);
+    MocksForInitialiseEntry(mockLifeTester);
+    StateMachine_Reset(mockLifeTester);
+    CHECK(StateMachine_Waiting(mockLifeTester));
+    AdvanceTime(SETTLE_TIME - 1U);
+    CHECK(StateMachine_Waiting(mockLifeTester));
+    AdvanceTime(1U);
+    CHECK(mockLifeTester->data.settled);
+    CHECK(!StateMachine_Waiting(mockLifeTester));
+    mock().checkExpectations();
+}
+
 /*
  Update state machine while in initialise mode after post settle time. adc will 
  be read and value returned above threshold so no error expected. State machine
@@ -660,7 +841,7 @@ TEST(IVTestGroup, UpdatingInitialiseStateAfterPostDelayTimeAdcReadOk)
 {
     const uint32_t tInit       = 2436U;
     const uint32_t tElapsed    = SETTLE_TIME + 1U;
-                   mockTime    = tInit;
+    SetTime(tInit);
                    mockCurrent = THRESHOLD_CURRENT; 
     MocksForInitialiseEntry(mockLifeTester);
     StateMachine_Reset(mockLifeTester);
@@ -669,11 +850,12 @@ TEST(IVTestGroup, UpdatingInitialiseStateAfterPostDelayTimeAdcReadOk)
     MEMCMP_EQUAL(expectedData, &mockLifeTester->data, sizeof(LifeTesterData_t));
     POINTERS_EQUAL(&StateInitialiseDevice, mockLifeTester->state);
 
-    // timer checked to see if measurement is due
-    mockTime += tElapsed;
+    // settle timer fires then the short-circuit current is read
+    AdvanceTime(tElapsed);
     MocksForInitialiseStepAdcRead(mockLifeTester);
+    MocksForLoadMpp(mockLifeTester, NULL);
     // Mode change to scanning expected - entry fn will setup led
-    MocksForScanModeEntry();
+    MocksForScanModeEntry(SCAN_LINEAR, SCAN_NO_EARLY_STOP);
     // New parent is NULL so nothing else should happen.
     StateMachine_UpdateStep(mockLifeTester);
     // expect the mode to change and for scan activated
@@ -692,7 +874,7 @@ TEST(IVTestGroup, UpdatingInitialiseStateAfterPostDelayTimeAdcReadLowCurrent)
 {
     const uint32_t tInit       = 2436U;
     const uint32_t tElapsed    = SETTLE_TIME + 1U;
-                   mockTime    = tInit;
+    SetTime(tInit);
                    mockCurrent = THRESHOLD_CURRENT - 1U; 
     MocksForInitialiseEntry(mockLifeTester);
     StateMachine_Reset(mockLifeTester);
@@ -700,8 +882,8 @@ TEST(IVTestGroup, UpdatingInitialiseStateAfterPostDelayTimeAdcReadLowCurrent)
     const uint8_t expectedData[sizeof(LifeTesterData_t)] = {0U};
     MEMCMP_EQUAL(expectedData, &mockLifeTester->data, sizeof(LifeTesterData_t));
     POINTERS_EQUAL(&StateInitialiseDevice, mockLifeTester->state);
-    // timer will be checked again in step function.
-    mockTime += tElapsed;
+    // settle timer fires then the short-circuit current is read
+    AdvanceTime(tElapsed);
     MocksForInitialiseStepAdcRead(mockLifeTester);
     StateMachine_UpdateStep(mockLifeTester);
     CHECK_EQUAL(1U, mockLifeTester->data.nErrorReads);
@@ -719,7 +901,7 @@ TEST(IVTestGroup, UpdatingInitialiseStateAfterPostDelayTimeAdcReadSaturated)
 {
     const uint32_t tInit       = 2436U;
     const uint32_t tElapsed    = SETTLE_TIME + 1U;
-                   mockTime    = tInit;
+    SetTime(tInit);
                    mockCurrent = MAX_CURRENT; 
     MocksForInitialiseEntry(mockLifeTester);
     StateMachine_Reset(mockLifeTester);
@@ -727,8 +909,8 @@ TEST(IVTestGroup, UpdatingInitialiseStateAfterPostDelayTimeAdcReadSaturated)
     const uint8_t expectedData[sizeof(LifeTesterData_t)] = {0U};
     MEMCMP_EQUAL(expectedData, &mockLifeTester->data, sizeof(LifeTesterData_t));
     POINTERS_EQUAL(&StateInitialiseDevice, mockLifeTester->state);
-    // timer will be checked again in step function.
-    mockTime += tElapsed;
+    // settle timer fires then the short-circuit current is read
+    AdvanceTime(tElapsed);
     MocksForInitialiseStepAdcRead(mockLifeTester);
     StateMachine_UpdateStep(mockLifeTester);
     CHECK_EQUAL(1U, mockLifeTester->data.nErrorReads);
@@ -745,16 +927,15 @@ TEST(IVTestGroup, UpdatingInitialiseStateAfterTooManyBadReadingsTransitionToErro
 {
     const uint32_t tInit       = 2436U;
     const uint32_t tElapsed    = SETTLE_TIME + 1U;
-                   mockTime    = tInit;
+    SetTime(tInit);
                    mockCurrent = MAX_CURRENT;
     MocksForInitialiseEntry(mockLifeTester);
     StateMachine_Reset(mockLifeTester);
     CHECK_EQUAL(tInit, mockLifeTester->timer);
     POINTERS_EQUAL(&StateInitialiseDevice, mockLifeTester->state);
-    mockTime += tElapsed;
+    AdvanceTime(tElapsed);
     mockLifeTester->data.nErrorReads = MAX_ERROR_READS + 1U;
-    MocksForInitialiseStepNoAdcRead();
-    MocksForErrorEntry(mockLifeTester);
+    MocksForErrorEntry(mockLifeTester, ok);
     StateMachine_UpdateStep(mockLifeTester);
     POINTERS_EQUAL(&StateError, mockLifeTester->state);
     mock().checkExpectations();
@@ -773,15 +954,13 @@ that the dac is broken so that setting does not actually change the dac output.*
 TEST(IVTestGroup, UpdatingInScanModeBeforeSamplingWindowDoesNothing)
 {
     SetupForScanningMode(mockLifeTester);
-    const LifeTesterData_t dataBefore = mockLifeTester->data;
     // mock for scanning mode step
-    MocksForScanModeStep();
     MocksForMeasureScanPointEntry(mockLifeTester);
     StateMachine_UpdateStep(mockLifeTester);
     POINTERS_EQUAL(&StateMeasureScanDataPoint, mockLifeTester->state);
+    const LifeTesterData_t dataBefore = mockLifeTester->data;
     // mocks for update during sampling before settled
-    mockTime += SETTLE_TIME - 1U;
-    MocksForScanModeStep();
+    AdvanceTime(SETTLE_TIME - 1U);
     MocksForMeasureDataNoAdcRead();
     StateMachine_UpdateStep(mockLifeTester);
     const LifeTesterData_t dataAfter = mockLifeTester->data;
@@ -801,22 +980,20 @@ TEST(IVTestGroup, UpdatingScanInSampleScanCurrentAdcMeasurementExpected)
     // Now in scanning mode parent of measure scan point
     const uint8_t vMock = 32U;
     mockLifeTester->data.vScan = vMock; 
-    MocksForScanModeStep();
     MocksForMeasureScanPointEntry(mockLifeTester);
     StateMachine_UpdateStep(mockLifeTester);
-    mockTime += SETTLE_TIME;
+    AdvanceTime(SETTLE_TIME);
 
     // queue up some current measurements
     const uint32_t iMock[]       = {3487U, 2435U, 3488U};
     const uint32_t nMeasurements = 3U;
     for (int i = 0; i < nMeasurements; i++)
     {
-        mockTime += 10U;
+        AdvanceTime(10U);
         const uint32_t tElapsed = mockTime - mockLifeTester->timer;
         const bool     sampling = (tElapsed >= SETTLE_TIME)
                                    && (tElapsed < (SETTLE_TIME + SAMPLING_TIME));
         CHECK(sampling);
-        MocksForScanModeStep();
         mockCurrent = iMock[i];
         MocksForMeasureDataReadAdc(mockLifeTester);
         StateMachine_UpdateStep(mockLifeTester);
@@ -826,10 +1003,8 @@ TEST(IVTestGroup, UpdatingScanInSampleScanCurrentAdcMeasurementExpected)
     CHECK_EQUAL(nMeasurements, mockLifeTester->data.nSamples);
     POINTERS_EQUAL(&StateMeasureScanDataPoint, mockLifeTester->state);
     // sampling finished. Check average is calculated.
-    mockTime += SAMPLING_TIME;
-    MocksForScanModeStep();
-    MocksForMeasureDataNoAdcRead();
-    StateMachine_UpdateStep(mockLifeTester); 
+    MocksForMeasureDataSamplingDone(mockLifeTester);
+    AdvanceTime(SAMPLING_TIME);
     const uint32_t iMockAve = iMockSum / nMeasurements;
     CHECK_EQUAL(iMockAve, mockLifeTester->data.iScan);
     const uint32_t pExpected = vMock * iMockAve;
@@ -840,6 +1015,132 @@ TEST(IVTestGroup, UpdatingScanInSampleScanCurrentAdcMeasurementExpected)
     mock().checkExpectations();
 }
 
+/*
+ Samples a scan point with the adaptive sampling tolerance set, taking currents
+ from iMock until the measurement finishes or the samples run out.
+*/
+static void SampleScanPointWithTolerance(uint8_t tolerance,
+                                         uint16_t const *const iMock,
+                                         uint8_t nMock)
+{
+    SetupForScanningMode(mockLifeTester);
+    mockLifeTester->data.vScan = 32U;
+    MocksForMeasureScanPointEntry(mockLifeTester);
+    StateMachine_UpdateStep(mockLifeTester);
+    AdvanceTime(SETTLE_TIME);
+    for (uint8_t i = 0U; (i < nMock)
+         && (mockLifeTester->state == &StateMeasureScanDataPoint); i++)
+    {
+        AdvanceTime(10U);
+        mockCurrent = iMock[i];
+        MocksForMeasureDataNoAdcReadWithTolerance(tolerance);
+        MocksForSampleCurrentInWindow(mockLifeTester);
+        StateMachine_UpdateStep(mockLifeTester);
+    }
+}
+
+/*
+ Adaptive sampling. A steady current has no variance so the window ends as soon
+ as SAMPLE_MIN_COUNT samples have been taken.
+*/
+TEST(IVTestGroup, AdaptiveSamplingEndsEarlyForSteadyCurrent)
+{
+    const uint16_t iMock[] = {3487U, 3487U, 3487U, 3487U, 3487U, 3487U};
+    // window is closed for the other channel as soon as it's done
+    MocksForCancelAdcRead(mockLifeTester);
+    SampleScanPointWithTolerance(2U, iMock, 6U);
+    POINTERS_EQUAL(&StateScanningMode, mockLifeTester->state);
+    CHECK_EQUAL(SAMPLE_MIN_COUNT, mockLifeTester->data.nSamples);
+    CHECK_EQUAL(3487U, mockLifeTester->data.iScan);
+    CHECK_EQUAL(0U, mockLifeTester->data.iVarScan);
+    mock().checkExpectations();
+}
+
+/*
+ Noisy current. Alternating 1000 and 1100 gives a standard error of ~50 / sqrt(n)
+ so a tolerance of 5 codes isn't reached. The whole window is sampled and the
+ variance, 8 * 50^2 / 7, is kept with the point.
+*/
+TEST(IVTestGroup, AdaptiveSamplingUsesWholeWindowForNoisyCurrent)
+{
+    const uint16_t iMock[] = {1000U, 1100U, 1000U, 1100U, 1000U, 1100U, 1000U, 1100U};
+    SampleScanPointWithTolerance(5U, iMock, 8U);
+    POINTERS_EQUAL(&StateMeasureScanDataPoint, mockLifeTester->state);
+    CHECK_EQUAL(8U, mockLifeTester->data.nSamples);
+    MocksForMeasureDataSamplingDone(mockLifeTester);
+    AdvanceTime(SAMPLING_TIME);
+    POINTERS_EQUAL(&StateScanningMode, mockLifeTester->state);
+    CHECK_EQUAL(1050U, mockLifeTester->data.iScan);
+    CHECK_EQUAL(8U * 50U * 50U / 7U, mockLifeTester->data.iVarScan);
+    mock().checkExpectations();
+}
+
+/*
+ Sampling windows are given out one channel at a time. While another channel
+ has the adc this one holds its window back rather than letting it run out. The
+ hold is armed once however long it lasts, and the window starts when the adc
+ is granted.
+*/
+TEST(IVTestGroup, SamplingWaitsForOtherChannelsWindow)
+{
+    SetupForScanningMode(mockLifeTester);
+    MocksForMeasureScanPointEntry(mockLifeTester);
+    StateMachine_UpdateStep(mockLifeTester);
+    const uint32_t tStart = mockLifeTester->timer;
+    AdvanceTime(SETTLE_TIME + SAMPLING_TIME - 1U);
+    for (uint8_t i = 0U; i < 3U; i++)
+    {
+        MocksForMeasureDataNoAdcRead();
+        MocksForClaimSampleWindow(mockLifeTester, false);
+        StateMachine_UpdateStep(mockLifeTester);
+        CHECK(mockLifeTester->data.windowPending);
+        CHECK_EQUAL(tStart, mockLifeTester->timer);
+        // long past where the window would have closed
+        AdvanceTime(SAMPLING_TIME);
+    }
+    CHECK_EQUAL(0U, mockLifeTester->data.nSamples);
+    POINTERS_EQUAL(&StateMeasureScanDataPoint, mockLifeTester->state);
+
+    MocksForMeasureDataReadAdc(mockLifeTester);
+    StateMachine_UpdateStep(mockLifeTester);
+    CHECK(!mockLifeTester->data.windowPending);
+    CHECK_EQUAL(SETTLE_TIME, mockTime - mockLifeTester->timer);
+    CHECK_EQUAL(1U, mockLifeTester->data.nSamples);
+    AdvanceTime(SAMPLING_TIME - 1U);
+    POINTERS_EQUAL(&StateMeasureScanDataPoint, mockLifeTester->state);
+    MocksForMeasureDataSamplingDone(mockLifeTester);
+    AdvanceTime(1U);
+    POINTERS_EQUAL(&StateScanningMode, mockLifeTester->state);
+    mock().checkExpectations();
+}
+
+/*
+ A window that has to wait for the adc mux to settle onto this channel's input
+ is lengthened by the mux settle time so that it still samples for the whole
+ sample time.
+*/
+TEST(IVTestGroup, SampleWindowLengthenedByMuxSettleTime)
+{
+    const uint16_t tMuxSettle = 120U;
+    mockMuxSettleTime = tMuxSettle;
+    SetupForScanningMode(mockLifeTester);
+    MocksForMeasureScanPointEntry(mockLifeTester);
+    StateMachine_UpdateStep(mockLifeTester);
+    AdvanceTime(SETTLE_TIME);
+    MocksForMeasureDataReadAdc(mockLifeTester);
+    StateMachine_UpdateStep(mockLifeTester);
+    CHECK(mockLifeTester->data.windowOpen);
+    CHECK_EQUAL(1U, mockLifeTester->data.nSamples);
+
+    // window would have closed here without the mux settling
+    AdvanceTime(SAMPLING_TIME);
+    POINTERS_EQUAL(&StateMeasureScanDataPoint, mockLifeTester->state);
+    MocksForMeasureDataSamplingDone(mockLifeTester);
+    AdvanceTime(tMuxSettle);
+    POINTERS_EQUAL(&StateScanningMode, mockLifeTester->state);
+    mock().checkExpectations();
+}
+
 /*
  If no samples are taken in measure scan data point during the sampling window
  then the timer should be reset so the sampling window can run again. No 
@@ -849,17 +1150,52 @@ TEST(IVTestGroup, UpdatingScanNoAdcSamplesTimerShouldReset)
 {
     SetupForScanningMode(mockLifeTester);
     // mock for scanning mode step
-    MocksForScanModeStep();
     // mocks for measaure scan point entry
     MocksForMeasureScanPointEntry(mockLifeTester);
     // transition into measure scan point fn
     StateMachine_UpdateStep(mockLifeTester); 
     POINTERS_EQUAL(&StateMeasureScanDataPoint, mockLifeTester->state);
-    mockTime += (SETTLE_TIME + SAMPLING_TIME);
-    MocksForScanModeStep();
-    MocksForMeasureDataNoAdcRead();
-    StateMachine_UpdateStep(mockLifeTester); 
+    // window closed and the settle time and window started again
+    MocksForMeasureDataSamplingDone(mockLifeTester);
+    MocksForStartMeasurementTimers();
+    AdvanceTime(SETTLE_TIME + SAMPLING_TIME);
     CHECK_EQUAL(mockTime, mockLifeTester->timer);
+    CHECK(!mockLifeTester->data.settled);
+    POINTERS_EQUAL(&StateMeasureScanDataPoint, mockLifeTester->state);
+    mock().checkExpectations();
+}
+
+// While a point settles the channel waits for its timer. Once settled it polls the adc.
+TEST(IVTestGroup, MeasurementWaitsWhileSettling)
+{
+    SetupForScanningMode(mockLifeTester);
+    CHECK(!StateMachine_Waiting(mockLifeTester));
+    MocksForMeasureScanPointEntry(mockLifeTester);
+    StateMachine_UpdateStep(mockLifeTester);
+    CHECK(StateMachine_Waiting(mockLifeTester));
+    AdvanceTime(SETTLE_TIME);
+    CHECK(!StateMachine_Waiting(mockLifeTester));
+    mock().checkExpectations();
+}
+
+/*
+ Going to the error state part way through a measurement stops the settle and
+ window timers so they don't post events to the error state later.
+*/
+TEST(IVTestGroup, ErrorStopsMeasurementTimers)
+{
+    SetupForScanningMode(mockLifeTester);
+    MocksForMeasureScanPointEntry(mockLifeTester);
+    StateMachine_UpdateStep(mockLifeTester);
+    MocksForScanModeExit();
+    MocksForErrorEntry(mockLifeTester, ok);
+    StateMachine_PostEvent(mockLifeTester, ErrorEvent);
+    POINTERS_EQUAL(&StateError, mockLifeTester->state);
+    CHECK(StateMachine_Waiting(mockLifeTester));
+    // no calls expected when the timers would have fired
+    AdvanceTime(SETTLE_TIME + SAMPLING_TIME);
+    CHECK_EQUAL(TIMER_WHEEL_IDLE, TimerWheel_TimeToNext(&wheel));
+    POINTERS_EQUAL(&StateError, mockLifeTester->state);
     mock().checkExpectations();
 }
 
@@ -878,28 +1214,24 @@ TEST(IVTestGroup, RunIvScanNoErrorExpectDiodeMppReturned)
     while (vMock <= V_SCAN_MAX)
     {
         // Transition into measure scan point...
-        MocksForScanModeStep();
         // mocks for measaure scan point entry
         MocksForMeasureScanPointEntry(mockLifeTester);
         StateMachine_UpdateStep(mockLifeTester);
         // Force a measurement
-        mockTime += SETTLE_TIME;
+        AdvanceTime(SETTLE_TIME);
         mockCurrent = TestGetAdcCodeForDiode(vMock);
-        MocksForScanModeStep();
         MocksForMeasureDataReadAdc(mockLifeTester);
         StateMachine_UpdateStep(mockLifeTester);
         POINTERS_EQUAL(&StateMeasureScanDataPoint, mockLifeTester->state);
         CHECK_EQUAL(vMock, DacGetOutput(mockLifeTester));
         // sampling done. Transition back to scanning mode (parent)
-        mockTime += SAMPLING_TIME;
         vMock += DV_SCAN;
-        MocksForScanModeStep();
-        MocksForMeasureDataNoAdcRead();
-        StateMachine_UpdateStep(mockLifeTester);
+        MocksForMeasureDataSamplingDone(mockLifeTester);
+        AdvanceTime(SAMPLING_TIME);
     }
     POINTERS_EQUAL(&StateScanningMode, mockLifeTester->state);
     // should change from scanning->tracking mode
-    MocksForScanModeStep();
+    MocksForSaveMpp(mockLifeTester, mockLifeTester->data.vScanMpp, ok);
     MocksForScanModeExit();
     StateMachine_UpdateStep(mockLifeTester);
     CHECK_EQUAL(mppCodeShockley, mockLifeTester->data.vThis);
@@ -923,30 +1255,25 @@ TEST(IVTestGroup, RunIvScanBadDiodeNoMppReturned)
     while (vMock <= V_SCAN_MAX)
     {
         // Transition into measure scan point...
-        MocksForScanModeStep();
         // mocks for measaure scan point entry
         MocksForMeasureScanPointEntry(mockLifeTester);
         StateMachine_UpdateStep(mockLifeTester);
         // Force a measurement
-        mockTime += SETTLE_TIME;
+        AdvanceTime(SETTLE_TIME);
         mockCurrent = TestGetAdcCodeConstantCurrent(vMock);
-        MocksForScanModeStep();
         MocksForMeasureDataReadAdc(mockLifeTester);
         StateMachine_UpdateStep(mockLifeTester);
         POINTERS_EQUAL(&StateMeasureScanDataPoint, mockLifeTester->state);
         CHECK_EQUAL(vMock, DacGetOutput(mockLifeTester));
         // sampling done. Transition back to scanning mode (parent)
-        mockTime += SAMPLING_TIME;
         vMock += DV_SCAN;
-        MocksForScanModeStep();
-        MocksForMeasureDataNoAdcRead();
-        StateMachine_UpdateStep(mockLifeTester);
+        MocksForMeasureDataSamplingDone(mockLifeTester);
+        AdvanceTime(SAMPLING_TIME);
     }
     POINTERS_EQUAL(&StateScanningMode, mockLifeTester->state);
     // should change from scanning->error mode
-    MocksForScanModeStep();
     MocksForScanModeExit();
-    MocksForErrorEntry(mockLifeTester);
+    MocksForErrorEntry(mockLifeTester, invalidScan);
     StateMachine_UpdateStep(mockLifeTester);
     CHECK_EQUAL(0U, mockLifeTester->data.vThis);
     CHECK_EQUAL(invalidScan, mockLifeTester->error);
@@ -954,61 +1281,309 @@ TEST(IVTestGroup, RunIvScanBadDiodeNoMppReturned)
     mock().checkExpectations();
 }
 
-/*******************************************************************************
-* TESTS FOR UPDATING IN TRACKING MODE
-********************************************************************************/
 /*
- Complete tracking measurement cycle - power at next is higher so expect the 
- drive voltage to increase.
+ Measures scan points until the scan is done, taking the current at each point
+ from adcCode. Returns the number of points measured.
 */
-TEST(IVTestGroup, CompleteTrackingMeasurementCycleNextMorePowerIncreaseV)
+static uint8_t RunScanUntilDone(uint16_t (*adcCode)(uint8_t dacCode))
 {
-    // Setup for tracking mode.
-    const uint8_t  vThis = 42U;
-    const uint8_t  vNext = vThis + DV_MPPT;
-    const uint16_t iThis = 34623;
-    const uint16_t iNext = 45353;
-    const uint32_t pThis = iThis * vThis;
-    const uint32_t pNext = iNext * vNext;
-    mockLifeTester->data.vThis = vThis;
-    mockLifeTester->data.vNext = vNext;
-    mockLifeTester->state = &StateTrackingMode;
-    mockTime = 34524U;
-    // Begin with tracking delay step
-    MocksForTrackingModeStep();
-    MocksForTrackingDelayEntry();
+    uint8_t nPoints = 0U;
+    while (!mockLifeTester->data.scanDone)
+    {
+        const uint8_t vMock = mockLifeTester->data.vScan;
+        MocksForMeasureScanPointEntry(mockLifeTester);
+        StateMachine_UpdateStep(mockLifeTester);
+        AdvanceTime(SETTLE_TIME);
+        mockCurrent = adcCode(vMock);
+        MocksForMeasureDataReadAdc(mockLifeTester);
+        StateMachine_UpdateStep(mockLifeTester);
+        CHECK_EQUAL(vMock, DacGetOutput(mockLifeTester));
+        MocksForMeasureDataSamplingDone(mockLifeTester);
+        AdvanceTime(SAMPLING_TIME);
+        nPoints++;
+    }
+    return nPoints;
+}
+
+/*
+ With a stop margin the linear scan ends a few points past the diode's open
+ circuit voltage. The last point is the final point for the shape check so the
+ scan is still valid.
+*/
+TEST(IVTestGroup, RunIvScanStopsPastOpenCircuit)
+{
+    const uint8_t stopMargin = 3U;
+    SetupForScanningModeWithStrategy(mockLifeTester, SCAN_LINEAR, stopMargin);
+    const uint8_t nPoints = RunScanUntilDone(TestGetAdcCodeForDiode);
+    const uint8_t vLast = mockLifeTester->data.vScan;
+    CHECK(vLast < V_SCAN_MAX);
+    CHECK_EQUAL(vLast - V_SCAN_MIN + 1U, nPoints);
+    // the stop margin points and the one before were all below MIN_CURRENT
+    for (uint8_t v = vLast - stopMargin; v <= vLast; v++)
+    {
+        CHECK(TestGetAdcCodeForDiode(v) < MIN_CURRENT);
+    }
+    CHECK(TestGetAdcCodeForDiode(vLast - stopMargin - 1U) >= MIN_CURRENT);
+    CHECK_EQUAL(mockLifeTester->data.pScan, mockLifeTester->data.pScanFinal);
+    MocksForSaveMpp(mockLifeTester, mockLifeTester->data.vScanMpp, ok);
+    MocksForScanModeExit();
     StateMachine_UpdateStep(mockLifeTester);
-    POINTERS_EQUAL(&StateTrackingDelay, mockLifeTester->state);
-    CHECK_EQUAL(mockTime, mockLifeTester->timer);
-    mockTime += TRACK_DELAY_TIME;
-    MocksForTrackingModeStep();
-    MocksForTrackingDelayStep();
+    CHECK_EQUAL(mppCodeShockley, mockLifeTester->data.vThis);
+    CHECK_EQUAL(ok, mockLifeTester->error);
+    POINTERS_EQUAL(&StateTrackingMode, mockLifeTester->state);
+    mock().checkExpectations();
+}
+
+/*
+ Golden-section scan of a shockley diode. It should measure far fewer points
+ than the linear scan and still land next to the mpp.
+*/
+TEST(IVTestGroup, RunGoldenSectionScanExpectDiodeMppReturned)
+{
+    SetupForScanningModeWithStrategy(mockLifeTester, SCAN_GOLDEN_SECTION,
+                                     SCAN_NO_EARLY_STOP);
+    const uint8_t nPoints = RunScanUntilDone(TestGetAdcCodeForDiode);
+    CHECK(nPoints <= 15U);
+    POINTERS_EQUAL(&StateScanningMode, mockLifeTester->state);
+    MocksForSaveMpp(mockLifeTester, mockLifeTester->data.vScanMpp, ok);
+    MocksForScanModeExit();
     StateMachine_UpdateStep(mockLifeTester);
+    CHECK(abs((int)mockLifeTester->data.vThis - (int)mppCodeShockley) <= 1);
+    CHECK_EQUAL(ok, mockLifeTester->error);
     POINTERS_EQUAL(&StateTrackingMode, mockLifeTester->state);
-    // Now transition to measure this point
-    MocksForTrackingModeStep();
-    MocksForMeasureThisPointEntry(mockLifeTester);
+    mock().checkExpectations();
+}
+
+/*
+ The golden-section scan still measures both ends of the range so a device
+ without a hill-shaped power curve raises an error.
+*/
+TEST(IVTestGroup, RunGoldenSectionScanBadDiodeNoMppReturned)
+{
+    SetupForScanningModeWithStrategy(mockLifeTester, SCAN_GOLDEN_SECTION,
+                                     SCAN_NO_EARLY_STOP);
+    RunScanUntilDone(TestGetAdcCodeConstantCurrent);
+    MocksForScanModeExit();
+    MocksForErrorEntry(mockLifeTester, invalidScan);
     StateMachine_UpdateStep(mockLifeTester);
-    POINTERS_EQUAL(&StateMeasureThisDataPoint, mockLifeTester->state);
-    CHECK(ThisMeasurementActive(mockLifeTester));
-    CHECK_EQUAL(vThis, DacGetOutput(mockLifeTester));
-    CHECK_EQUAL(false, mockLifeTester->data.thisDone);
-    CHECK_EQUAL(false, mockLifeTester->data.nextDone);
+    CHECK_EQUAL(invalidScan, mockLifeTester->error);
+    POINTERS_EQUAL(&StateError, mockLifeTester->state);
+    mock().checkExpectations();
+}
+
+/*
+ The power curve peaks between dac codes. The quadratic fitted to the points
+ around the best one finds the peak to within a sixteenth of a code and
+ tracking starts from the nearest code.
+*/
+TEST(IVTestGroup, ScanFitFindsMppBetweenCodes)
+{
+    testPeakV = 40.25;
+    SetupForScanningMode(mockLifeTester);
+    RunScanUntilDone(TestGetAdcCodeForParabola);
+    CHECK_EQUAL(40U, mockLifeTester->data.vScanMpp);
+    CHECK(abs((int)mockLifeTester->data.vScanFit - 644) <= 1);
+    CHECK(abs((int)mockLifeTester->data.pScanFit - 1500000) < 1000);
+    MocksForSaveMpp(mockLifeTester, 40U, ok);
+    MocksForScanModeExit();
+    StateMachine_UpdateStep(mockLifeTester);
+    CHECK_EQUAL(40U, mockLifeTester->data.vThis);
+
+    testPeakV = 40.75;
+    SetupForScanningMode(mockLifeTester);
+    RunScanUntilDone(TestGetAdcCodeForParabola);
+    CHECK_EQUAL(41U, mockLifeTester->data.vScanMpp);
+    CHECK(abs((int)mockLifeTester->data.vScanFit - 652) <= 1);
+    mock().checkExpectations();
+}
+
+/*
+ The fitted vertex is beyond the points either side of the best one so it's
+ clamped a code below it. The power is the quadratic's value there, not at its
+ vertex. With d the powers relative to the peak, -2000, -1000, -20000 and
+ -40000, a0 = -3600, a1 = -9500 and a2 = -4500 so it's 1400 above the peak.
+*/
+TEST(IVTestGroup, ScanFitPowerAtClampedVertexIsFitAtClamp)
+{
+    testPeakV = 40.0;
+    SetupForScanningMode(mockLifeTester);
+    RunScanUntilDone(TestGetAdcCodeForSteepPeak);
+    CHECK_EQUAL(40U, mockLifeTester->data.vScanMpp);
+    CHECK_EQUAL((40U << SCAN_FIT_SHIFT) - (1U << SCAN_FIT_SHIFT),
+                mockLifeTester->data.vScanFit);
+    const int32_t pExpected = (int32_t)TestGetPowerForSteepPeak(40U) + 1400;
+    CHECK(abs((int32_t)mockLifeTester->data.pScanFit - pExpected) < 100);
+    mock().checkExpectations();
+}
+
+// Without two points measured after the best one the best point is used
+TEST(IVTestGroup, ScanFitNeedsPointsEitherSide)
+{
+    testPeakV = V_SCAN_MAX - 1U;
+    SetupForScanningMode(mockLifeTester);
+    RunScanUntilDone(TestGetAdcCodeForParabola);
+    CHECK_EQUAL(V_SCAN_MAX - 1U, mockLifeTester->data.vScanMpp);
+    CHECK_EQUAL((V_SCAN_MAX - 1U) << SCAN_FIT_SHIFT, mockLifeTester->data.vScanFit);
+    CHECK_EQUAL(mockLifeTester->data.pScanMpp, mockLifeTester->data.pScanFit);
+    mock().checkExpectations();
+}
+
+/*
+ The stored mpp is checked at WARM_START_SPAN either side. If it's still the
+ highest point tracking starts from it without a full scan.
+*/
+TEST(IVTestGroup, WarmStartFromStoredMppGoesStraightToTracking)
+{
+    const MppRecord_t stored = {mppCodeShockley, 0U, ok};
+    SetupForWarmStart(mockLifeTester, &stored);
+    POINTERS_EQUAL(&StateScanningMode, mockLifeTester->state);
+    CHECK_EQUAL(mppCodeShockley - WARM_START_SPAN, mockLifeTester->data.vScan);
+    const uint8_t nPoints = RunScanUntilDone(TestGetAdcCodeForDiode);
+    CHECK_EQUAL(3U, nPoints);
+    MocksForSaveMpp(mockLifeTester, mppCodeShockley, ok);
+    MocksForScanModeExit();
+    StateMachine_UpdateStep(mockLifeTester);
+    CHECK_EQUAL(mppCodeShockley, mockLifeTester->data.vThis);
+    CHECK_EQUAL(mppCodeShockley + DV_MPPT, mockLifeTester->data.vNext);
+    CHECK_EQUAL(ok, mockLifeTester->error);
+    POINTERS_EQUAL(&StateTrackingMode, mockLifeTester->state);
+    mock().checkExpectations();
+}
+
+/*
+ The power at the stored mpp is what was stored so the device and light are as
+ they were. The mpp has moved a little past the top point so the check isn't a
+ hill but tracking starts from the best point without a full scan.
+*/
+TEST(IVTestGroup, WarmStartSamePowerTracksFromBestPoint)
+{
+    const uint8_t vStored = mppCodeShockley - 3U;
+    const uint8_t vBest = vStored + WARM_START_SPAN;
+    const MppRecord_t stored =
+        {vStored, (uint32_t)TestGetAdcCodeForDiode(vStored) * vStored, ok};
+    SetupForWarmStart(mockLifeTester, &stored);
+    RunScanUntilDone(TestGetAdcCodeForDiode);
+    CHECK(mockLifeTester->data.warmStartMatch);
+    CHECK_EQUAL(vBest, mockLifeTester->data.vScanMpp);
+    MocksForSaveMpp(mockLifeTester, vBest, ok);
+    MocksForScanModeExit();
+    StateMachine_UpdateStep(mockLifeTester);
+    CHECK_EQUAL(ok, mockLifeTester->error);
+    CHECK_EQUAL(vBest, mockLifeTester->data.vThis);
+    POINTERS_EQUAL(&StateTrackingMode, mockLifeTester->state);
+    mock().checkExpectations();
+}
+
+/*
+ The power at the stored mpp has changed and the mpp has moved away from it so
+ the light or device has changed too. A light change re-scan runs around the
+ best point instead of the full scan.
+*/
+TEST(IVTestGroup, WarmStartPowerChangedRescansAroundBestPoint)
+{
+    const uint8_t vStored = mppCodeShockley / 2U;
+    const uint8_t vBest = vStored + WARM_START_SPAN;
+    const MppRecord_t stored = {vStored, 0U, ok};
+    SetupForWarmStart(mockLifeTester, &stored);
+    RunScanUntilDone(TestGetAdcCodeForDiode);
+    CHECK(!mockLifeTester->data.warmStartMatch);
+    StateMachine_UpdateStep(mockLifeTester);
+    CHECK_EQUAL(ok, mockLifeTester->error);
+    CHECK(!mockLifeTester->data.warmStart);
+    CHECK(mockLifeTester->data.rescan);
+    CHECK(!mockLifeTester->data.scanDone);
+    CHECK_EQUAL(vBest - LIGHT_RESCAN_SPAN, mockLifeTester->data.vScan);
+    CHECK_EQUAL(vBest + LIGHT_RESCAN_SPAN, mockLifeTester->data.vScanHigh);
+    POINTERS_EQUAL(&StateScanningMode, mockLifeTester->state);
+    mock().checkExpectations();
+}
+
+/*
+ Nothing was measured at any of the points so there's no best point to re-scan
+ around. The full scan runs instead of going to the error state.
+*/
+TEST(IVTestGroup, WarmStartFallsBackToFullScanIfNoPower)
+{
+    const MppRecord_t stored = {mppCodeShockley, 0U, ok};
+    SetupForWarmStart(mockLifeTester, &stored);
+    RunScanUntilDone(TestGetAdcCodeZero);
+    mock().expectOneCall("Config_GetScanStrategy").andReturnValue(SCAN_LINEAR);
+    mock().expectOneCall("Config_GetScanStopMargin").andReturnValue(SCAN_NO_EARLY_STOP);
+    StateMachine_UpdateStep(mockLifeTester);
+    CHECK_EQUAL(ok, mockLifeTester->error);
+    CHECK(!mockLifeTester->data.warmStart);
+    CHECK(!mockLifeTester->data.scanDone);
+    CHECK_EQUAL(V_SCAN_MIN, mockLifeTester->data.vScan);
+    CHECK_EQUAL(0U, mockLifeTester->data.pScanMpp);
+    POINTERS_EQUAL(&StateScanningMode, mockLifeTester->state);
+    mock().checkExpectations();
+}
+
+// An mpp stored when the channel was in error isn't used
+TEST(IVTestGroup, WarmStartNotUsedIfStoredWithError)
+{
+    const MppRecord_t stored = {mppCodeShockley, 0U, invalidScan};
+    mockCurrent = THRESHOLD_CURRENT + 1U;
+    SetTime(2436U);
+    MocksForInitialiseEntry(mockLifeTester);
+    StateMachine_Reset(mockLifeTester);
+    AdvanceTime(SETTLE_TIME + 1U);
+    MocksForInitialiseStepAdcRead(mockLifeTester);
+    MocksForLoadMpp(mockLifeTester, &stored);
+    MocksForScanModeEntry(SCAN_LINEAR, SCAN_NO_EARLY_STOP);
+    StateMachine_UpdateStep(mockLifeTester);
+    CHECK(!mockLifeTester->data.warmStart);
+    CHECK_EQUAL(V_SCAN_MIN, mockLifeTester->data.vScan);
+    mock().checkExpectations();
+}
+
+/*******************************************************************************
+* TESTS FOR UPDATING IN TRACKING MODE
+********************************************************************************/
+/*
+ Complete tracking measurement cycle - power at next is higher so expect the 
+ drive voltage to increase.
+*/
+TEST(IVTestGroup, CompleteTrackingMeasurementCycleNextMorePowerIncreaseV)
+{
+    // Setup for tracking mode.
+    const uint8_t  vThis = 42U;
+    const uint8_t  vNext = vThis + DV_MPPT;
+    const uint16_t iThis = 34623;
+    const uint16_t iNext = 45353;
+    const uint32_t pThis = iThis * vThis;
+    const uint32_t pNext = iNext * vNext;
+    mockLifeTester->data.vThis = vThis;
+    mockLifeTester->data.vNext = vNext;
+    mockLifeTester->state = &StateTrackingMode;
+    SetTime(34524U);
+    // Begin with tracking delay step
+    MocksForTrackingDelayEntry();
+    StateMachine_UpdateStep(mockLifeTester);
+    POINTERS_EQUAL(&StateTrackingDelay, mockLifeTester->state);
+    CHECK_EQUAL(mockTime, mockLifeTester->timer);
+    // delay timer fires and tracking mode carries on
+    AdvanceTime(TRACK_DELAY_TIME);
+    POINTERS_EQUAL(&StateTrackingMode, mockLifeTester->state);
+    // Now transition to measure this point
+    MocksForMeasureThisPointEntry(mockLifeTester);
+    StateMachine_UpdateStep(mockLifeTester);
+    POINTERS_EQUAL(&StateMeasureThisDataPoint, mockLifeTester->state);
+    CHECK(ThisMeasurementActive(mockLifeTester));
+    CHECK_EQUAL(vThis, DacGetOutput(mockLifeTester));
+    CHECK_EQUAL(false, mockLifeTester->data.thisDone);
+    CHECK_EQUAL(false, mockLifeTester->data.nextDone);
     // Settling time done so measurement expected
-    mockTime += SETTLE_TIME;
-    MocksForTrackingModeStep();
+    AdvanceTime(SETTLE_TIME);
     mockCurrent = iThis;
     MocksForMeasureDataReadAdc(mockLifeTester);
     StateMachine_UpdateStep(mockLifeTester);
     POINTERS_EQUAL(&StateMeasureThisDataPoint, mockLifeTester->state);
     // Sampling done so transition back to tracking mode parent
-    mockTime += SAMPLING_TIME;
-    MocksForTrackingModeStep();
-    MocksForMeasureDataNoAdcRead();
-    StateMachine_UpdateStep(mockLifeTester);
+    MocksForMeasureDataSamplingDone(mockLifeTester);
+    AdvanceTime(SAMPLING_TIME);
     POINTERS_EQUAL(&StateTrackingMode, mockLifeTester->state);
     // This point measured so expect transition to Next
-    MocksForTrackingModeStep();
     MocksForMeasureNextPointEntry(mockLifeTester);
     StateMachine_UpdateStep(mockLifeTester);
     POINTERS_EQUAL(&StateMeasureNextDataPoint, mockLifeTester->state);
@@ -1016,22 +1591,20 @@ TEST(IVTestGroup, CompleteTrackingMeasurementCycleNextMorePowerIncreaseV)
     CHECK_EQUAL(mockTime, mockLifeTester->timer);
     CHECK_EQUAL(vNext, DacGetOutput(mockLifeTester));
     // Settling time done so measurement expected
-    mockTime += SETTLE_TIME;
-    MocksForTrackingModeStep();
+    AdvanceTime(SETTLE_TIME);
     mockCurrent = iNext;
     MocksForMeasureDataReadAdc(mockLifeTester);
     StateMachine_UpdateStep(mockLifeTester);
     POINTERS_EQUAL(&StateMeasureNextDataPoint, mockLifeTester->state);
     // Sampling done so transition back to tracking mode parent
-    mockTime += SAMPLING_TIME;
-    MocksForTrackingModeStep();
-    MocksForMeasureDataNoAdcRead();
-    StateMachine_UpdateStep(mockLifeTester);
+    MocksForMeasureDataSamplingDone(mockLifeTester);
+    AdvanceTime(SAMPLING_TIME);
     POINTERS_EQUAL(&StateTrackingMode, mockLifeTester->state);
     CHECK_EQUAL(true, mockLifeTester->data.thisDone);
     CHECK_EQUAL(true, mockLifeTester->data.nextDone);
     // Cycle has finished. Expect Led and working voltage to be updated
     MocksForTrackingModeStepIncreaseV();
+    MocksForGetReuseLimit(0U);
     StateMachine_UpdateStep(mockLifeTester);
     CHECK_EQUAL(vThis + DV_MPPT, mockLifeTester->data.vThis);
     CHECK_EQUAL(vNext + DV_MPPT, mockLifeTester->data.vNext);
@@ -1060,20 +1633,16 @@ TEST(IVTestGroup, CompleteTrackingMeasurementCycleThisMorePowerDecreaseV)
     mockLifeTester->data.vThis = vThis;
     mockLifeTester->data.vNext = vNext;
     mockLifeTester->state = &StateTrackingMode;
-    mockTime = 34524U;
+    SetTime(34524U);
     // Begin with tracking delay step
-    MocksForTrackingModeStep();
     MocksForTrackingDelayEntry();
     StateMachine_UpdateStep(mockLifeTester);
     POINTERS_EQUAL(&StateTrackingDelay, mockLifeTester->state);
     CHECK_EQUAL(mockTime, mockLifeTester->timer);
-    mockTime += TRACK_DELAY_TIME;
-    MocksForTrackingModeStep();
-    MocksForTrackingDelayStep();
-    StateMachine_UpdateStep(mockLifeTester);
+    // delay timer fires and tracking mode carries on
+    AdvanceTime(TRACK_DELAY_TIME);
     POINTERS_EQUAL(&StateTrackingMode, mockLifeTester->state);
     // Now transition to measure this point
-    MocksForTrackingModeStep();
     MocksForMeasureThisPointEntry(mockLifeTester);
     StateMachine_UpdateStep(mockLifeTester);
     POINTERS_EQUAL(&StateMeasureThisDataPoint, mockLifeTester->state);
@@ -1081,37 +1650,30 @@ TEST(IVTestGroup, CompleteTrackingMeasurementCycleThisMorePowerDecreaseV)
     CHECK_EQUAL(false, mockLifeTester->data.thisDone);
     CHECK_EQUAL(false, mockLifeTester->data.nextDone);
     // Settling time done so measurement expected
-    mockTime += SETTLE_TIME;
-    MocksForTrackingModeStep();
+    AdvanceTime(SETTLE_TIME);
     mockCurrent = iThis;
     MocksForMeasureDataReadAdc(mockLifeTester);
     StateMachine_UpdateStep(mockLifeTester);
     POINTERS_EQUAL(&StateMeasureThisDataPoint, mockLifeTester->state);
     // Sampling done so transition back to tracking mode parent
-    mockTime += SAMPLING_TIME;
-    MocksForTrackingModeStep();
-    MocksForMeasureDataNoAdcRead();
-    StateMachine_UpdateStep(mockLifeTester);
+    MocksForMeasureDataSamplingDone(mockLifeTester);
+    AdvanceTime(SAMPLING_TIME);
     POINTERS_EQUAL(&StateTrackingMode, mockLifeTester->state);
     // This point measured so expect transition to Next
-    MocksForTrackingModeStep();
     MocksForMeasureNextPointEntry(mockLifeTester);
     StateMachine_UpdateStep(mockLifeTester);
     POINTERS_EQUAL(&StateMeasureNextDataPoint, mockLifeTester->state);
     CHECK_EQUAL(mockTime, mockLifeTester->timer);
     CHECK_EQUAL(vNext, DacGetOutput(mockLifeTester));
     // Settling time done so measurement expected
-    mockTime += SETTLE_TIME;
-    MocksForTrackingModeStep();
+    AdvanceTime(SETTLE_TIME);
     mockCurrent = iNext;
     MocksForMeasureDataReadAdc(mockLifeTester);
     StateMachine_UpdateStep(mockLifeTester);
     POINTERS_EQUAL(&StateMeasureNextDataPoint, mockLifeTester->state);
     // Sampling done so transition back to tracking mode parent
-    mockTime += SAMPLING_TIME;
-    MocksForTrackingModeStep();
-    MocksForMeasureDataNoAdcRead();
-    StateMachine_UpdateStep(mockLifeTester);
+    MocksForMeasureDataSamplingDone(mockLifeTester);
+    AdvanceTime(SAMPLING_TIME);
     POINTERS_EQUAL(&StateTrackingMode, mockLifeTester->state);
     CHECK_EQUAL(true, mockLifeTester->data.thisDone);
     CHECK_EQUAL(true, mockLifeTester->data.nextDone);
@@ -1138,12 +1700,9 @@ TEST(IVTestGroup, LowCurrentDetectedIncrementsErrorReadingsCounter)
     mockLifeTester->data.nSamples = 1U;
     mockLifeTester->data.nErrorReads = 0U;
     mockLifeTester->state = &StateMeasureThisDataPoint;
-    const uint32_t tInit = 34524U;
-    mockTime = tInit + SETTLE_TIME + SAMPLING_TIME;
     ActivateThisMeasurement(mockLifeTester);
-    MocksForTrackingModeStep();
-    MocksForMeasureDataNoAdcRead();
-    StateMachine_UpdateStep(mockLifeTester);
+    MocksForMeasureDataSamplingDone(mockLifeTester);
+    StateMachine_PostEvent(mockLifeTester, SampleWindowDoneEvent);
     POINTERS_EQUAL(&StateTrackingMode, mockLifeTester->state);
     CHECK_EQUAL(1U, mockLifeTester->data.nErrorReads);
     CHECK_EQUAL(lowCurrent, mockLifeTester->error);
@@ -1157,12 +1716,9 @@ TEST(IVTestGroup, SaturatedCurrentDetectedIncrementsErrorReadingsCounter)
     mockLifeTester->data.nSamples = 1U;
     mockLifeTester->data.nErrorReads = 0U;
     mockLifeTester->state = &StateMeasureThisDataPoint;
-    const uint32_t tInit = 34524U;
-    mockTime = tInit + SETTLE_TIME + SAMPLING_TIME;
     ActivateThisMeasurement(mockLifeTester);
-    MocksForTrackingModeStep();
-    MocksForMeasureDataNoAdcRead();
-    StateMachine_UpdateStep(mockLifeTester);
+    MocksForMeasureDataSamplingDone(mockLifeTester);
+    StateMachine_PostEvent(mockLifeTester, SampleWindowDoneEvent);
     POINTERS_EQUAL(&StateTrackingMode, mockLifeTester->state);
     CHECK_EQUAL(1U, mockLifeTester->data.nErrorReads);
     CHECK_EQUAL(currentLimit, mockLifeTester->error);
@@ -1180,12 +1736,9 @@ TEST(IVTestGroup, NormalCurrentReadingResetsErrorReadingsCounter)
     mockLifeTester->data.nSamples = 1U;
     mockLifeTester->data.nErrorReads = 1U;
     mockLifeTester->state = &StateMeasureThisDataPoint;
-    const uint32_t tInit = 34524U;
-    mockTime = tInit + SETTLE_TIME + SAMPLING_TIME;
     ActivateThisMeasurement(mockLifeTester);
-    MocksForTrackingModeStep();
-    MocksForMeasureDataNoAdcRead();
-    StateMachine_UpdateStep(mockLifeTester);
+    MocksForMeasureDataSamplingDone(mockLifeTester);
+    StateMachine_PostEvent(mockLifeTester, SampleWindowDoneEvent);
     POINTERS_EQUAL(&StateTrackingMode, mockLifeTester->state);
     CHECK_EQUAL(0U, mockLifeTester->data.nErrorReads);
     CHECK_EQUAL(ok, mockLifeTester->error);
@@ -1201,9 +1754,577 @@ TEST(IVTestGroup, TrackingModeTooManyBadReadingsTransitionToErrorState)
     // Setup for tracking mode.
     mockLifeTester->data.nErrorReads = MAX_ERROR_READS + 1U;
     mockLifeTester->state = &StateTrackingMode;
-    MocksForTrackingModeStep();
-    MocksForErrorEntry(mockLifeTester);
+    MocksForErrorEntry(mockLifeTester, ok);
     StateMachine_UpdateStep(mockLifeTester);
     POINTERS_EQUAL(&StateError, mockLifeTester->state);
     mock().checkExpectations();
-}
\ No newline at end of file
+}
+
+/*
+ Sets up tracking mode at the end of a cycle with both points measured and the
+ given powers at this and next.
+*/
+static void SetupForEndOfTrackingCycle(LifeTester_t *const lifeTester,
+                                       uint16_t iThis,
+                                       uint16_t iNext)
+{
+    LifeTesterData_t *const data = &lifeTester->data;
+    data->vThis = 42U;
+    data->vNext = data->vThis + DV_MPPT;
+    data->iThis = iThis;
+    data->iNext = iNext;
+    data->pThis = iThis * data->vThis;
+    data->pNext = iNext * data->vNext;
+    data->thisDone = true;
+    data->nextDone = true;
+    data->delayDone = true;
+    lifeTester->state = &StateTrackingMode;
+}
+
+/*
+ Reuse enabled. Moving uphill carries the next point's measurement forward to
+ this point so the following cycle only measures the new next point.
+*/
+TEST(IVTestGroup, TrackingUphillWithReuseCarriesNextMeasurementForward)
+{
+    SetupForEndOfTrackingCycle(mockLifeTester, 34623U, 45353U);
+    const uint8_t  vNext = mockLifeTester->data.vNext;
+    const uint32_t pNext = mockLifeTester->data.pNext;
+    MocksForTrackingModeStepIncreaseV();
+    MocksForGetReuseLimit(REUSE_UNLIMITED);
+    StateMachine_UpdateStep(mockLifeTester);
+    CHECK_EQUAL(vNext, mockLifeTester->data.vThis);
+    CHECK_EQUAL(45353U, mockLifeTester->data.iThis);
+    CHECK_EQUAL(pNext, mockLifeTester->data.pThis);
+    CHECK_EQUAL(true, mockLifeTester->data.thisDone);
+    CHECK_EQUAL(false, mockLifeTester->data.nextDone);
+    CHECK_EQUAL(1U, mockLifeTester->data.nReused);
+
+    // After the tracking delay the next point is measured straight away
+    SetTime(34524U);
+    MocksForTrackingDelayEntry();
+    StateMachine_UpdateStep(mockLifeTester);
+    AdvanceTime(TRACK_DELAY_TIME);
+    MocksForMeasureNextPointEntry(mockLifeTester);
+    StateMachine_UpdateStep(mockLifeTester);
+    POINTERS_EQUAL(&StateMeasureNextDataPoint, mockLifeTester->state);
+    CHECK(NextMeasurementActive(mockLifeTester));
+    mock().checkExpectations();
+}
+
+/*
+ Reuse limit reached - this point is measured again even though the tracker
+ moved uphill. Counter restarts.
+*/
+TEST(IVTestGroup, TrackingUphillReuseLimitReachedMeasuresThisAgain)
+{
+    const uint8_t limit = 3U;
+    SetupForEndOfTrackingCycle(mockLifeTester, 34623U, 45353U);
+    mockLifeTester->data.nReused = limit;
+    MocksForTrackingModeStepIncreaseV();
+    MocksForGetReuseLimit(limit);
+    StateMachine_UpdateStep(mockLifeTester);
+    CHECK_EQUAL(false, mockLifeTester->data.thisDone);
+    CHECK_EQUAL(0U, mockLifeTester->data.nReused);
+    mock().checkExpectations();
+}
+
+/*
+ Moving downhill never reuses a measurement. The old this point becomes the new
+ next point so both are measured again and the reuse counter restarts.
+*/
+TEST(IVTestGroup, TrackingDownhillResetsReuseCounter)
+{
+    SetupForEndOfTrackingCycle(mockLifeTester, 45353U, 34623U);
+    mockLifeTester->data.nReused = 2U;
+    MocksForTrackingModeStepDecreaseV();
+    StateMachine_UpdateStep(mockLifeTester);
+    CHECK_EQUAL(false, mockLifeTester->data.thisDone);
+    CHECK_EQUAL(false, mockLifeTester->data.nextDone);
+    CHECK_EQUAL(0U, mockLifeTester->data.nReused);
+    mock().checkExpectations();
+}
+
+/*
+ Adaptive step. The step scales with the square of the normalised slope of the
+ power curve |dP|/(dV * I) and is clamped to the configured limits. Far below
+ the mpp the slope is ~1 so the maximum step is taken once the last step was at
+ least half of it. The next measurement isn't reused since this point hasn't
+ moved onto the next point.
+*/
+TEST(IVTestGroup, TrackingAdaptiveStepFarFromMppTakesMaxStep)
+{
+    const uint8_t dvMax = 8U;
+    // current is flat so dP = I * dV and the slope is 1
+    SetupForEndOfTrackingCycle(mockLifeTester, 1000U, 1000U);
+    mockLifeTester->data.dvLast = dvMax / 2U;
+    const uint8_t vThis = mockLifeTester->data.vThis;
+    MocksForGetTrackingAlgorithms(PERTURB_OBSERVE);
+    MocksForGetStepLimits(DV_MPPT_MIN, dvMax);
+    MocksForFlashLedTwice();
+    MocksForPrintNewMpp();
+    StateMachine_UpdateStep(mockLifeTester);
+    CHECK_EQUAL(vThis + dvMax, mockLifeTester->data.vThis);
+    CHECK_EQUAL(vThis + dvMax + DV_MPPT, mockLifeTester->data.vNext);
+    CHECK_EQUAL(dvMax, mockLifeTester->data.dvLast);
+    CHECK_EQUAL(false, mockLifeTester->data.thisDone);
+    CHECK_EQUAL(0U, mockLifeTester->data.nReused);
+    mock().checkExpectations();
+}
+
+/*
+ The step at most doubles from one cycle to the next so a single noisy slope
+ can't throw the tracker a long way. The first step after a scan starts from
+ the minimum.
+*/
+TEST(IVTestGroup, TrackingAdaptiveStepAtMostDoublesLastStep)
+{
+    const uint8_t dvMax = 8U;
+    SetupForEndOfTrackingCycle(mockLifeTester, 1000U, 1000U);
+    mockLifeTester->data.dvLast = 0;
+    const uint8_t vThis = mockLifeTester->data.vThis;
+    MocksForGetTrackingAlgorithms(PERTURB_OBSERVE);
+    MocksForGetStepLimits(DV_MPPT_MIN, dvMax);
+    MocksForFlashLedTwice();
+    MocksForPrintNewMpp();
+    StateMachine_UpdateStep(mockLifeTester);
+    CHECK_EQUAL(vThis + 2U * DV_MPPT_MIN, mockLifeTester->data.vThis);
+
+    SetupForEndOfTrackingCycle(mockLifeTester, 1000U, 1000U);
+    mockLifeTester->data.dvLast = 3;
+    MocksForGetTrackingAlgorithms(PERTURB_OBSERVE);
+    MocksForGetStepLimits(DV_MPPT_MIN, dvMax);
+    MocksForFlashLedTwice();
+    MocksForPrintNewMpp();
+    StateMachine_UpdateStep(mockLifeTester);
+    CHECK_EQUAL(vThis + 6U, mockLifeTester->data.vThis);
+    mock().checkExpectations();
+}
+
+/*
+ If the light moved since the last cycle the slope is down to the light and not
+ the power curve. The minimum step is taken however steep it looks.
+*/
+TEST(IVTestGroup, TrackingAdaptiveStepLightMovedTakesMinStep)
+{
+    const uint8_t  dvMax = 8U;
+    const uint16_t light = 500U;
+    const uint16_t tolerance = (light * DV_LIGHT_TOLERANCE) >> 8U;
+    SetupForEndOfTrackingCycle(mockLifeTester, 1000U, 1000U);
+    mockLifeTester->data.dvLast = dvMax;
+    mockLifeTester->data.light = light;
+    mockLifeTester->data.lightAvg = (uint16_t)(light << LIGHT_FILTER_SHIFT);
+    mockLifeTester->data.lightAvgValid = true;
+    const uint8_t vThis = mockLifeTester->data.vThis;
+    MocksForGetTrackingAlgorithms(PERTURB_OBSERVE);
+    MocksForGetStepLimits(DV_MPPT_MIN, dvMax);
+    MocksForFlashLedTwice();
+    MocksForPrintNewMppAtLight(light + tolerance + 1U);
+    MocksForGetReuseLimit(0U);
+    StateMachine_UpdateStep(mockLifeTester);
+    CHECK_EQUAL(vThis + DV_MPPT_MIN, mockLifeTester->data.vThis);
+
+    // within tolerance the slope is trusted
+    SetupForEndOfTrackingCycle(mockLifeTester, 1000U, 1000U);
+    mockLifeTester->data.dvLast = dvMax;
+    mockLifeTester->data.light = light;
+    MocksForGetTrackingAlgorithms(PERTURB_OBSERVE);
+    MocksForGetStepLimits(DV_MPPT_MIN, dvMax);
+    MocksForFlashLedTwice();
+    MocksForPrintNewMppAtLight(light + tolerance);
+    StateMachine_UpdateStep(mockLifeTester);
+    CHECK_EQUAL(vThis + dvMax, mockLifeTester->data.vThis);
+    mock().checkExpectations();
+}
+
+/*
+ Current can't rise with voltage so a slope above 1 means the light changed
+ between the two measurements. The minimum step is taken.
+*/
+TEST(IVTestGroup, TrackingAdaptiveStepIgnoresSlopeAboveOne)
+{
+    const uint8_t dvMax = 8U;
+    SetupForEndOfTrackingCycle(mockLifeTester, 34623U, 45353U);
+    const uint8_t vNext = mockLifeTester->data.vNext;
+    MocksForGetTrackingAlgorithms(PERTURB_OBSERVE);
+    MocksForGetStepLimits(DV_MPPT_MIN, dvMax);
+    MocksForFlashLedTwice();
+    MocksForPrintNewMpp();
+    MocksForGetReuseLimit(0U);
+    StateMachine_UpdateStep(mockLifeTester);
+    CHECK_EQUAL(vNext, mockLifeTester->data.vThis);
+    mock().checkExpectations();
+}
+
+// Part way up the hill the step scales with the square of the slope
+TEST(IVTestGroup, TrackingAdaptiveStepScalesWithSlope)
+{
+    const uint8_t dvMax = 8U;
+    // dP = 43 * 990 - 42 * 1000 = 570, slope = 0.57 so step is 8 * 0.57^2 = 2
+    SetupForEndOfTrackingCycle(mockLifeTester, 1000U, 990U);
+    const uint8_t vThis = mockLifeTester->data.vThis;
+    MocksForGetTrackingAlgorithms(PERTURB_OBSERVE);
+    MocksForGetStepLimits(DV_MPPT_MIN, dvMax);
+    MocksForFlashLedTwice();
+    MocksForPrintNewMpp();
+    StateMachine_UpdateStep(mockLifeTester);
+    CHECK_EQUAL(vThis + 2U, mockLifeTester->data.vThis);
+    mock().checkExpectations();
+}
+
+/*
+ Close to the mpp the slope is ~0 so the minimum step is taken. Moving onto the
+ next point means its measurement can still be reused.
+*/
+TEST(IVTestGroup, TrackingAdaptiveStepNearMppTakesMinStep)
+{
+    const uint8_t dvMax = 8U;
+    SetupForEndOfTrackingCycle(mockLifeTester, 1000U, 977U);
+    const uint8_t vNext = mockLifeTester->data.vNext;
+    MocksForGetTrackingAlgorithms(PERTURB_OBSERVE);
+    MocksForGetStepLimits(DV_MPPT_MIN, dvMax);
+    MocksForFlashLedTwice();
+    MocksForPrintNewMpp();
+    MocksForGetReuseLimit(REUSE_UNLIMITED);
+    StateMachine_UpdateStep(mockLifeTester);
+    CHECK_EQUAL(vNext, mockLifeTester->data.vThis);
+    CHECK_EQUAL(true, mockLifeTester->data.thisDone);
+    mock().checkExpectations();
+}
+
+/*
+ Downhill steps scale with the slope too. Reversing means the last step crossed
+ the mpp so the step is at most half of it, closing in on the mpp rather than
+ swinging across it. Moving down doesn't take the voltage below zero.
+*/
+TEST(IVTestGroup, TrackingAdaptiveStepHalvesOnReversalAndClampsAtZero)
+{
+    const uint8_t dvMax = 8U;
+    // no current at the next point so the slope is clamped to 1
+    SetupForEndOfTrackingCycle(mockLifeTester, 45353U, 0U);
+    mockLifeTester->data.dvLast = dvMax;
+    MocksForGetTrackingAlgorithms(PERTURB_OBSERVE);
+    MocksForGetStepLimits(DV_MPPT_MIN, dvMax);
+    MocksForFlashLedOnce();
+    MocksForPrintNewMpp();
+    const uint8_t vThis = mockLifeTester->data.vThis;
+    StateMachine_UpdateStep(mockLifeTester);
+    CHECK_EQUAL(vThis - dvMax / 2U, mockLifeTester->data.vThis);
+    CHECK_EQUAL(-(int16_t)(dvMax / 2U), mockLifeTester->data.dvLast);
+
+    // carrying on downhill the step can grow again
+    SetupForEndOfTrackingCycle(mockLifeTester, 45353U, 0U);
+    mockLifeTester->data.dvLast = -(int16_t)(dvMax / 2U);
+    MocksForGetTrackingAlgorithms(PERTURB_OBSERVE);
+    MocksForGetStepLimits(DV_MPPT_MIN, dvMax);
+    MocksForFlashLedOnce();
+    MocksForPrintNewMpp();
+    StateMachine_UpdateStep(mockLifeTester);
+    CHECK_EQUAL(vThis - dvMax, mockLifeTester->data.vThis);
+
+    SetupForEndOfTrackingCycle(mockLifeTester, 45353U, 0U);
+    mockLifeTester->data.vThis = 0U;
+    mockLifeTester->data.vNext = DV_MPPT;
+    MocksForGetTrackingAlgorithms(PERTURB_OBSERVE);
+    MocksForGetStepLimits(DV_MPPT_MIN, dvMax);
+    MocksForFlashLedOnce();
+    MocksForPrintNewMpp();
+    StateMachine_UpdateStep(mockLifeTester);
+    CHECK_EQUAL(0U, mockLifeTester->data.vThis);
+    CHECK_EQUAL(DV_MPPT, mockLifeTester->data.vNext);
+    CHECK_EQUAL(0, mockLifeTester->data.dvLast);
+    mock().checkExpectations();
+}
+
+/*
+ Incremental conductance holds at the mpp. dP = 43 * 977 - 42 * 1000 = 11 which
+ is within tolerance of I * dV so neither point moves.
+*/
+TEST(IVTestGroup, TrackingIncCondHoldsAtMpp)
+{
+    SetupForEndOfTrackingCycle(mockLifeTester, 1000U, 977U);
+    const uint8_t vThis = mockLifeTester->data.vThis;
+    const uint8_t vNext = mockLifeTester->data.vNext;
+    MocksForGetTrackingAlgorithms(INC_CONDUCTANCE);
+    MocksForPrintNewMpp();
+    StateMachine_UpdateStep(mockLifeTester);
+    CHECK_EQUAL(vThis, mockLifeTester->data.vThis);
+    CHECK_EQUAL(vNext, mockLifeTester->data.vNext);
+    CHECK_EQUAL(false, mockLifeTester->data.thisDone);
+    mock().checkExpectations();
+}
+
+// Away from the mpp incremental conductance steps the same way as perturb-observe
+TEST(IVTestGroup, TrackingIncCondMovesAwayFromMpp)
+{
+    SetupForEndOfTrackingCycle(mockLifeTester, 1000U, 990U);
+    const uint8_t vThis = mockLifeTester->data.vThis;
+    MocksForGetTrackingAlgorithms(INC_CONDUCTANCE);
+    MocksForGetStepLimits(DV_MPPT_MIN, DV_MPPT_MAX);
+    MocksForFlashLedTwice();
+    MocksForPrintNewMpp();
+    MocksForGetReuseLimit(REUSE_UNLIMITED);
+    StateMachine_UpdateStep(mockLifeTester);
+    CHECK_EQUAL(vThis + DV_MPPT_MIN, mockLifeTester->data.vThis);
+
+    SetupForEndOfTrackingCycle(mockLifeTester, 1000U, 900U);
+    const uint8_t vThisDown = mockLifeTester->data.vThis;
+    MocksForGetTrackingAlgorithms(INC_CONDUCTANCE);
+    MocksForGetStepLimits(DV_MPPT_MIN, DV_MPPT_MAX);
+    MocksForFlashLedOnce();
+    MocksForPrintNewMpp();
+    StateMachine_UpdateStep(mockLifeTester);
+    CHECK_EQUAL(vThisDown - DV_MPPT_MIN, mockLifeTester->data.vThis);
+    mock().checkExpectations();
+}
+
+// While tracking the mpp is stored every MPP_SAVE_CYCLES cycles
+TEST(IVTestGroup, TrackingStoresMppPeriodically)
+{
+    SetupForEndOfTrackingCycle(mockLifeTester, 45353U, 0U);
+    mockLifeTester->data.nSinceSave = MPP_SAVE_CYCLES - 1U;
+    const uint8_t vThis = mockLifeTester->data.vThis;
+    MocksForTrackingModeStepDecreaseV();
+    MocksForSaveMpp(mockLifeTester, vThis - DV_MPPT_MIN, ok);
+    StateMachine_UpdateStep(mockLifeTester);
+    CHECK_EQUAL(0U, mockLifeTester->data.nSinceSave);
+    mock().checkExpectations();
+}
+
+// re-scan on a 25% change in light
+const static uint8_t testLightChange = 64U;
+
+/*
+ A sudden step in light re-scans around the mpp instead of tracking. The scan
+ covers LIGHT_RESCAN_SPAN either side of this point.
+*/
+TEST(IVTestGroup, TrackingLightStepStartsLocalRescan)
+{
+    SetupForEndOfTrackingCycle(mockLifeTester, 1000U, 1000U);
+    const uint8_t vThis = mockLifeTester->data.vThis;
+    mockLifeTester->data.lightAvg = 400U << LIGHT_FILTER_SHIFT;
+    mockLifeTester->data.lightAvgValid = true;
+    MocksForCheckLight(600U, testLightChange);
+    MocksForScanLedSetup();
+    StateMachine_UpdateStep(mockLifeTester);
+    POINTERS_EQUAL(&StateScanningMode, mockLifeTester->state);
+    CHECK(mockLifeTester->data.rescan);
+    CHECK(!mockLifeTester->data.thisDone);
+    CHECK_EQUAL(SCAN_LOCAL, mockLifeTester->data.scanStrategy);
+    CHECK_EQUAL(vThis - LIGHT_RESCAN_SPAN, mockLifeTester->data.vScan);
+    CHECK_EQUAL(vThis + LIGHT_RESCAN_SPAN, mockLifeTester->data.vScanHigh);
+    CHECK(!mockLifeTester->data.lightAvgValid);
+    mock().checkExpectations();
+}
+
+/*
+ A dark average is still an average. Light coming back after it re-scans
+ rather than being taken as the first reading since a scan.
+*/
+TEST(IVTestGroup, TrackingLightAfterDarkStartsLocalRescan)
+{
+    SetupForEndOfTrackingCycle(mockLifeTester, 1000U, 1000U);
+    mockLifeTester->data.lightAvg = 0U;
+    mockLifeTester->data.lightAvgValid = true;
+    MocksForCheckLight(400U, testLightChange);
+    MocksForScanLedSetup();
+    StateMachine_UpdateStep(mockLifeTester);
+    POINTERS_EQUAL(&StateScanningMode, mockLifeTester->state);
+    CHECK(mockLifeTester->data.rescan);
+    mock().checkExpectations();
+}
+
+// Slow drifts are followed by the running average. Disabled checks never re-scan.
+TEST(IVTestGroup, TrackingSmallOrDisabledLightChangeKeepsTracking)
+{
+    SetupForEndOfTrackingCycle(mockLifeTester, 45353U, 34623U);
+    mockLifeTester->data.lightAvg = 400U << LIGHT_FILTER_SHIFT;
+    mockLifeTester->data.lightAvgValid = true;
+    MocksForGetTrackingAlgorithms(PERTURB_OBSERVE);
+    MocksForGetStepLimits(DV_MPPT_MIN, DV_MPPT_MAX);
+    MocksForFlashLedOnce();
+    MocksForCheckLight(440U, testLightChange);
+    MocksForCheckDwell(DWELL_DRIFT);
+    mock().expectOneCall("TempReadDegC").andReturnValue(0.0);
+    StateMachine_UpdateStep(mockLifeTester);
+    POINTERS_EQUAL(&StateTrackingMode, mockLifeTester->state);
+    CHECK_EQUAL(440U, mockLifeTester->data.light);
+    CHECK_EQUAL((400U << LIGHT_FILTER_SHIFT) - 400U + 440U,
+                mockLifeTester->data.lightAvg);
+
+    SetupForEndOfTrackingCycle(mockLifeTester, 45353U, 34623U);
+    MocksForGetTrackingAlgorithms(PERTURB_OBSERVE);
+    MocksForGetStepLimits(DV_MPPT_MIN, DV_MPPT_MAX);
+    MocksForFlashLedOnce();
+    MocksForCheckLight(1000U, LIGHT_CHANGE_OFF);
+    MocksForCheckDwell(DWELL_DRIFT);
+    mock().expectOneCall("TempReadDegC").andReturnValue(0.0);
+    StateMachine_UpdateStep(mockLifeTester);
+    POINTERS_EQUAL(&StateTrackingMode, mockLifeTester->state);
+    CHECK(!mockLifeTester->data.rescan);
+    mock().checkExpectations();
+}
+
+// resume tracking on a 1/32 change in power while dwelling
+const static uint8_t testDwellDrift = 8U;
+
+// mocks for a tracking cycle that stays dwelling at the mpp
+static void MocksForDwellCycle(void)
+{
+    MocksForCheckLight(0U, LIGHT_CHANGE_THRESHOLD);
+    MocksForCheckDwell(testDwellDrift);
+    mock().expectOneCall("TempReadDegC").andReturnValue(0.0);
+}
+
+/*
+ Sets up the end of a cycle dwelling at this point with power pDwell, nDwell
+ cycles after the next point was last checked.
+*/
+static void SetupForDwelling(LifeTester_t *const lifeTester,
+                             uint16_t iThis,
+                             uint16_t iNext,
+                             uint32_t pDwell,
+                             uint8_t nDwell)
+{
+    SetupForEndOfTrackingCycle(lifeTester, iThis, iNext);
+    lifeTester->data.dwell = true;
+    lifeTester->data.pDwell = pDwell;
+    lifeTester->data.nDwell = nDwell;
+}
+
+/*
+ Perturb-observe has cycled within DWELL_DETECT_SPAN codes for long enough.
+ Tracking moves to the best point seen in the cycle, which is the next point
+ here, and only measures that point from then on.
+*/
+TEST(IVTestGroup, TrackingOscillationStartsDwellAtBestPoint)
+{
+    SetupForEndOfTrackingCycle(mockLifeTester, 1000U, 980U);
+    const uint8_t  vNext = mockLifeTester->data.vNext;
+    const uint32_t pNext = mockLifeTester->data.pNext;
+    mockLifeTester->data.vCycleLow = mockLifeTester->data.vThis - 1U;
+    mockLifeTester->data.vCycleHigh = mockLifeTester->data.vThis;
+    mockLifeTester->data.vBest = mockLifeTester->data.vThis - 1U;
+    mockLifeTester->data.pBest = pNext - 100U;
+    mockLifeTester->data.nCycle = DWELL_DETECT_CYCLES - 1U;
+    MocksForDwellCycle();
+    StateMachine_UpdateStep(mockLifeTester);
+    CHECK(mockLifeTester->data.dwell);
+    CHECK_EQUAL(vNext, mockLifeTester->data.vThis);
+    CHECK_EQUAL(vNext + DV_MPPT, mockLifeTester->data.vNext);
+    CHECK_EQUAL(pNext, mockLifeTester->data.pDwell);
+    CHECK(!mockLifeTester->data.thisDone);
+    CHECK(mockLifeTester->data.nextDone);
+    mock().checkExpectations();
+}
+
+// Moving further than DWELL_DETECT_SPAN isn't a limit cycle so tracking goes on
+TEST(IVTestGroup, TrackingMovingAwayDoesNotDwell)
+{
+    SetupForEndOfTrackingCycle(mockLifeTester, 45353U, 34623U);
+    const uint8_t vThis = mockLifeTester->data.vThis;
+    mockLifeTester->data.vCycleLow = vThis - DWELL_DETECT_SPAN - 1U;
+    mockLifeTester->data.vCycleHigh = vThis - DWELL_DETECT_SPAN - 1U;
+    mockLifeTester->data.nCycle = DWELL_DETECT_CYCLES - 1U;
+    MocksForCheckLight(0U, LIGHT_CHANGE_THRESHOLD);
+    MocksForCheckDwell(testDwellDrift);
+    MocksForGetTrackingAlgorithms(PERTURB_OBSERVE);
+    MocksForGetStepLimits(DV_MPPT_MIN, DV_MPPT_MAX);
+    MocksForFlashLedOnce();
+    mock().expectOneCall("TempReadDegC").andReturnValue(0.0);
+    StateMachine_UpdateStep(mockLifeTester);
+    CHECK(!mockLifeTester->data.dwell);
+    CHECK_EQUAL(1U, mockLifeTester->data.nCycle);
+    CHECK_EQUAL(vThis, mockLifeTester->data.vCycleLow);
+    CHECK_EQUAL(vThis - DV_MPPT_MIN, mockLifeTester->data.vThis);
+    mock().checkExpectations();
+}
+
+/*
+ While dwelling the point stays put and the next point is only measured every
+ DWELL_PERTURB_CYCLES cycles. A check that finds less power there keeps dwelling.
+*/
+TEST(IVTestGroup, DwellingHoldsAndChecksNextPointPeriodically)
+{
+    SetupForDwelling(mockLifeTester, 1000U, 900U, 42000U, 0U);
+    const uint8_t vThis = mockLifeTester->data.vThis;
+    for (uint8_t i = 1U; i <= DWELL_PERTURB_CYCLES; i++)
+    {
+        MocksForDwellCycle();
+        StateMachine_UpdateStep(mockLifeTester);
+        CHECK_EQUAL(vThis, mockLifeTester->data.vThis);
+        CHECK_EQUAL(i, mockLifeTester->data.nDwell);
+        CHECK_EQUAL(i < DWELL_PERTURB_CYCLES, mockLifeTester->data.nextDone);
+        SetupForDwelling(mockLifeTester, 1000U, 900U, 42000U, i);
+    }
+    MocksForDwellCycle();
+    StateMachine_UpdateStep(mockLifeTester);
+    CHECK(mockLifeTester->data.dwell);
+    CHECK_EQUAL(0U, mockLifeTester->data.nDwell);
+    CHECK(mockLifeTester->data.nextDone);
+    mock().checkExpectations();
+}
+
+/*
+ A drift in power of more than DWELL_DRIFT/256 stops dwelling. Both points are
+ measured again before tracking moves.
+*/
+TEST(IVTestGroup, DwellingPowerDriftResumesTracking)
+{
+    // pThis = 42 * 1000 = 42000, 8/256 of pDwell = 1500
+    SetupForDwelling(mockLifeTester, 1000U, 900U, 48000U, 3U);
+    const uint8_t vThis = mockLifeTester->data.vThis;
+    MocksForCheckLight(0U, LIGHT_CHANGE_THRESHOLD);
+    MocksForCheckDwell(testDwellDrift);
+    StateMachine_UpdateStep(mockLifeTester);
+    CHECK(!mockLifeTester->data.dwell);
+    CHECK_EQUAL(vThis, mockLifeTester->data.vThis);
+    CHECK(!mockLifeTester->data.thisDone);
+    CHECK(!mockLifeTester->data.nextDone);
+    mock().checkExpectations();
+}
+
+// More power at the next point when it's checked means the mpp has moved up
+TEST(IVTestGroup, DwellingUphillNextPointResumesTracking)
+{
+    SetupForDwelling(mockLifeTester, 1000U, 1000U, 42000U, DWELL_PERTURB_CYCLES);
+    const uint8_t vNext = mockLifeTester->data.vNext;
+    MocksForCheckLight(0U, LIGHT_CHANGE_THRESHOLD);
+    MocksForCheckDwell(testDwellDrift);
+    MocksForGetTrackingAlgorithms(PERTURB_OBSERVE);
+    MocksForGetStepLimits(DV_MPPT_MIN, DV_MPPT_MAX);
+    MocksForFlashLedTwice();
+    mock().expectOneCall("TempReadDegC").andReturnValue(0.0);
+    MocksForGetReuseLimit(0U);
+    StateMachine_UpdateStep(mockLifeTester);
+    CHECK(!mockLifeTester->data.dwell);
+    CHECK_EQUAL(vNext, mockLifeTester->data.vThis);
+    mock().checkExpectations();
+}
+
+/*
+ The mpp of the diode is above the re-scan window so the scan isn't a hill.
+ Tracking restarts from the best point at the top of the window rather than
+ going to the error state.
+*/
+TEST(IVTestGroup, RescanOutsideWindowTracksFromBestPoint)
+{
+    SetupForEndOfTrackingCycle(mockLifeTester, 1000U, 1000U);
+    const uint8_t vTop = mockLifeTester->data.vThis + LIGHT_RESCAN_SPAN;
+    CHECK(vTop < mppCodeShockley);
+    mockLifeTester->data.lightAvg = 400U << LIGHT_FILTER_SHIFT;
+    mockLifeTester->data.lightAvgValid = true;
+    MocksForCheckLight(100U, testLightChange);
+    MocksForScanLedSetup();
+    StateMachine_UpdateStep(mockLifeTester);
+    const uint8_t nPoints = RunScanUntilDone(TestGetAdcCodeForDiode);
+    CHECK_EQUAL((2U * LIGHT_RESCAN_SPAN) / LIGHT_RESCAN_STEP + 1U, nPoints);
+    MocksForSaveMpp(mockLifeTester, vTop, ok);
+    MocksForScanModeExit();
+    StateMachine_UpdateStep(mockLifeTester);
+    CHECK_EQUAL(vTop, mockLifeTester->data.vThis);
+    CHECK_EQUAL(ok, mockLifeTester->error);
+    CHECK(!mockLifeTester->data.rescan);
+    POINTERS_EQUAL(&StateTrackingMode, mockLifeTester->state);
+    mock().checkExpectations();
+}
@@ -0,0 +1,93 @@
+#include "Arduino.h"
+#include "SimMCP4802.h"
+#include "SimSpi.h"
+#include <stdio.h>
+
+// Command bits - see MCP4802Private.h
+#define CH_SELECT_BIT       (15U)
+#define GAIN_SELECT_BIT     (13U)  // 0 = 2x, 1 = 1x
+#define SHDN_BIT            (12U)  // 0 = shutdown, 1 = active
+#define DATA_MASK           (0xFFU)
+#define DATA_OFFSET         (4U)
+#define COMMAND_BYTES       (2U)
+
+typedef struct SimDacChannel_s {
+    uint8_t code;
+    uint8_t gain;
+    bool    active;
+} SimDacChannel_t;
+
+static SimDacChannel_t channels[SIM_MCP4802_CHANNELS];
+static uint16_t        command;
+static uint8_t         nBytes;
+static uint32_t        writeCount;
+
+static void Select(void)
+{
+    command = 0U;
+    nBytes = 0U;
+}
+
+static uint8_t Transfer(uint8_t mosi)
+{
+    command = (uint16_t)((command << 8U) | mosi);
+    nBytes++;
+    return 0U; // dac has no data output
+}
+
+static void Deselect(void)
+{
+    if (nBytes == COMMAND_BYTES)
+    {
+        SimDacChannel_t *const ch = &channels[bitRead(command, CH_SELECT_BIT)];
+        ch->code = bitExtract(command, DATA_MASK, DATA_OFFSET);
+        ch->gain = bitRead(command, GAIN_SELECT_BIT) ? 1U : 2U;
+        ch->active = bitRead(command, SHDN_BIT);
+        writeCount++;
+    }
+    else if (nBytes > 0U)
+    {
+        fprintf(stderr, "SimMCP4802: ignoring %u byte command\n", nBytes);
+    }
+    nBytes = 0U;
+}
+
+static const SimSpiDevice_t mcp4802Device = {Select, Transfer, Deselect};
+
+void SimMCP4802_Attach(uint8_t chipSelectPin)
+{
+    memset(channels, 0U, sizeof(channels));
+    for (uint8_t ch = 0U; ch < SIM_MCP4802_CHANNELS; ch++)
+    {
+        channels[ch].gain = 1U;
+    }
+    nBytes = 0U;
+    writeCount = 0U;
+    SimSpi_AttachDevice(chipSelectPin, &mcp4802Device);
+}
+
+uint8_t SimMCP4802_GetCode(uint8_t channel)
+{
+    return channels[channel % SIM_MCP4802_CHANNELS].code;
+}
+
+uint8_t SimMCP4802_GetGain(uint8_t channel)
+{
+    return channels[channel % SIM_MCP4802_CHANNELS].gain;
+}
+
+double SimMCP4802_GetVoltage(uint8_t channel)
+{
+    SimDacChannel_t const *const ch = &channels[channel % SIM_MCP4802_CHANNELS];
+    return ch->active ? SimMCP4802_CodeToVoltage(ch->code, ch->gain) : 0.0;
+}
+
+double SimMCP4802_CodeToVoltage(uint8_t code, uint8_t gain)
+{
+    return (code / 256.0) * SIM_MCP4802_VREF * gain;
+}
+
+uint32_t SimMCP4802_GetWriteCount(void)
+{
+    return writeCount;
+}
@@ -0,0 +1,41 @@
+/*
+ Model of the MCP4802 dual 8-bit DAC for the native simulation build. Decodes
+ the 16-bit write command clocked in while chip select is low and latches the
+ output on the rising edge.
+*/
+#ifndef SIMMCP4802_H
+#define SIMMCP4802_H
+
+#ifdef _cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SIM_MCP4802_CHANNELS    (2U)
+#define SIM_MCP4802_VREF        (2.048)  // internal reference voltage (V)
+
+// Connects the dac to the simulated spi bus and resets outputs to zero.
+void SimMCP4802_Attach(uint8_t chipSelectPin);
+
+// Last code latched onto the given channel
+uint8_t SimMCP4802_GetCode(uint8_t channel);
+
+// Output gain (1 or 2) last latched onto the given channel
+uint8_t SimMCP4802_GetGain(uint8_t channel);
+
+// Output voltage of the given channel including gain and shutdown state
+double SimMCP4802_GetVoltage(uint8_t channel);
+
+// Converts a code to an output voltage for the given gain (1 or 2)
+double SimMCP4802_CodeToVoltage(uint8_t code, uint8_t gain);
+
+// Number of commands latched since attaching - any channel
+uint32_t SimMCP4802_GetWriteCount(void);
+
+#ifdef _cplusplus
+}
+#endif
+
+#endif // SIMMCP4802_H
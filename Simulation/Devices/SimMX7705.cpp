@@ -0,0 +1,437 @@
+#include "Arduino.h"
+#include "SimMX7705.h"
+
+// Comms register - see MX7705Private.h
+#define REG_SELECT_OFFSET       (4U)
+#define REG_SELECT_MASK         (7U)
+#define CH_SELECT_OFFSET        (0U)
+#define CH_SELECT_MASK          (3U)
+#define RW_BIT                  (3U)
+#define DRDY_BIT                (7U)
+#define COMMS_WRITE_MASK        (0x7FU) // DRDY bit is read only
+
+// Setup register
+#define FSYNC_BIT               (0U)
+#define BUFFER_BIT              (1U)
+#define BIPOLAR_UNIPOLAR_BIT    (2U)
+#define PGA_OFFSET              (3U)
+#define PGA_MASK                (7U)
+#define MODE_OFFSET             (6U)
+#define MODE_MASK               (3U)
+
+// Clock register
+#define FILTER_SELECT_MASK      (3U)
+#define FILTER_SELECT_OFFSET    (0U)
+#define CLK_BIT                 (2U)
+#define CLKDIV_BIT              (3U)
+#define MXID_BIT                (7U)    // maxim id - always reads 1
+#define CLOCK_WRITE_MASK        (0x1FU) // bits 5-7 are read only
+
+// power on defaults from the datasheet
+#define SETUP_REG_DEFAULT       (0x01U)
+#define CLOCK_REG_DEFAULT       (0x05U | (1U << MXID_BIT))
+#define NO_DATA_BYTE            (0xFFU)
+
+// digital filter timing in conversion periods
+#define SETTLE_PERIODS          (3U)
+#define SELF_CALIB_PERIODS      (6U)
+#define NO_CONVERSION           (UINT64_MAX)
+
+#define FULL_SCALE_CODE         (65536.0)
+#define MAX_CODE                (0xFFFFU)
+
+// Registers selected by the RS0-2 bits of the comms register
+typedef enum RegisterSelection_e {
+    CommsReg,
+    SetupReg,
+    ClockReg,
+    DataReg,
+    TestReg,
+    NoOperation,
+    OffsetReg,
+    GainReg,
+    NumberOfEntries
+} RegisterSelection_t;
+
+// Setup register mode bits
+typedef enum SimAdcMode_e {
+    NormalMode,
+    SelfCalibMode,
+    ZeroScaleCalibMode,
+    FullScaleCalibMode
+} SimAdcMode_t;
+
+// What the serial interface expects to receive next
+typedef struct SimAdcOperation_s {
+    RegisterSelection_t reg;
+    bool                readOp;
+    uint8_t             bytesLeft;
+    uint32_t            shiftReg;
+} SimAdcOperation_t;
+
+// State of the modulator and digital filter
+typedef struct SimAdcFilter_s {
+    uint64_t tNext;       // time of the next conversion (us)
+    uint64_t tSwitch;     // time the mux last changed channel (us)
+    uint8_t  prevChannel; // channel connected before the last switch
+    bool     calibrating; // self calibration in progress
+} SimAdcFilter_t;
+
+typedef struct SimAdc_s {
+    uint8_t             commsReg;
+    uint8_t             setupReg;
+    uint8_t             clockReg;
+    uint16_t            dataReg;
+    bool                dataRead;  // data reg has been read since last conversion
+    SimAdcOperation_t   op;
+    SimAdcFilter_t      filter;
+    SimMX7705Config_t   config;
+    SimMX7705Stats_t    stats;
+} SimAdc_t;
+
+static SimAdc_t adc;
+
+/*******************************************************************************
+* ANALOG FRONT END AND FILTER
+*******************************************************************************/
+static uint8_t GetChannel(void)
+{
+    return bitExtract(adc.commsReg, CH_SELECT_MASK, CH_SELECT_OFFSET);
+}
+
+static uint64_t Now(void)
+{
+    return (adc.config.now != NULL) ? adc.config.now() : 0U;
+}
+
+// Differential voltage at the modulator input for a mux setting (CH1/CH0)
+static double GetInputVoltage(uint8_t channel)
+{
+    // 0 = AIN1+/AIN1-, 1 = AIN2+/AIN2-. 2 and 3 short the inputs to AIN1-.
+    const bool external = (channel < SIM_MX7705_CHANNELS);
+    const double current = (external && (adc.config.input != NULL)) ?
+        adc.config.input(channel) : 0.0;
+    return current * adc.config.transimpedance;
+}
+
+static uint16_t VoltageToCode(double v)
+{
+    const double gain = SimMX7705_GetGain();
+    const double scaled = v * gain / adc.config.vRef;
+    const bool   unipolar = bitRead(adc.setupReg, BIPOLAR_UNIPOLAR_BIT);
+    const double code = unipolar ?
+        (scaled * FULL_SCALE_CODE) : ((1.0 + scaled) * (FULL_SCALE_CODE / 2.0));
+    if (code <= 0.0)
+    {
+        return 0U;
+    }
+    return (code >= MAX_CODE) ? MAX_CODE : (uint16_t)code;
+}
+
+/*
+ Fraction of the filter window occupied by the new input u conversion periods
+ after a step. The sinc3 filter has a quadratic b-spline impulse response three
+ periods long so the step response is the cubic integral of that.
+*/
+static double FilterStepResponse(double u)
+{
+    if (u <= 0.0)
+    {
+        return 0.0;
+    }
+    else if (u < 1.0)
+    {
+        return (u * u * u) / 6.0;
+    }
+    else if (u < 2.0)
+    {
+        return ((-2.0 * u * u * u) + (9.0 * u * u) - (9.0 * u) + 3.0) / 6.0;
+    }
+    else if (u < 3.0)
+    {
+        return 1.0 - ((3.0 - u) * (3.0 - u) * (3.0 - u)) / 6.0;
+    }
+    else
+    {
+        return 1.0;
+    }
+}
+
+// Output of a conversion finishing at time t
+static uint16_t Convert(uint64_t t)
+{
+    const double   vNew = GetInputVoltage(GetChannel());
+    const double   vOld = GetInputVoltage(adc.filter.prevChannel);
+    const uint32_t period = SimMX7705_GetConversionPeriod();
+    const double   u = (double)(t - adc.filter.tSwitch) / period;
+    const double   w = FilterStepResponse(u);
+    return VoltageToCode(vOld + w * (vNew - vOld));
+}
+
+// Restarts the filter - no valid data until it has settled again
+static void RestartFilter(uint8_t extraPeriods)
+{
+    const uint64_t t = Now();
+    const bool     fsync = bitRead(adc.setupReg, FSYNC_BIT);
+    const uint32_t period = SimMX7705_GetConversionPeriod();
+    adc.filter.tSwitch = t;
+    adc.filter.prevChannel = GetChannel();
+    adc.filter.tNext = fsync ?
+        NO_CONVERSION : t + (uint64_t)(SETTLE_PERIODS + extraPeriods) * period;
+    bitSet(adc.commsReg, DRDY_BIT);
+}
+
+// Runs any conversions that have completed since the last update
+static void UpdateConversions(void)
+{
+    const uint64_t t = Now();
+    if ((adc.filter.tNext == NO_CONVERSION) || (t < adc.filter.tNext))
+    {
+        return;
+    }
+    const uint32_t period = SimMX7705_GetConversionPeriod();
+    const uint64_t nConversions = 1U + (t - adc.filter.tNext) / period;
+    const uint64_t tLast = adc.filter.tNext + (nConversions - 1U) * period;
+    adc.dataReg = Convert(tLast);
+    adc.dataRead = false;
+    adc.filter.tNext = tLast + period;
+    adc.stats.conversions += nConversions;
+    bitClear(adc.commsReg, DRDY_BIT);
+
+    if (adc.filter.calibrating)
+    {
+        // part returns to normal mode once calibration is done
+        adc.filter.calibrating = false;
+        bitInsert(adc.setupReg, NormalMode, MODE_MASK, MODE_OFFSET);
+    }
+}
+
+// Mux switches as soon as a comms write selects a different channel
+static void SelectChannel(uint8_t channel)
+{
+    const uint8_t prev = GetChannel();
+    bitInsert(adc.commsReg, channel, CH_SELECT_MASK, CH_SELECT_OFFSET);
+    if (channel != prev)
+    {
+        adc.filter.prevChannel = prev;
+        adc.filter.tSwitch = Now();
+    }
+}
+
+/*******************************************************************************
+* REGISTERS
+*******************************************************************************/
+static uint8_t RegisterBytes(RegisterSelection_t reg)
+{
+    switch (reg)
+    {
+        case CommsReg:
+        case SetupReg:
+        case ClockReg:
+        case TestReg:
+            return 1U;
+        case DataReg:
+            return 2U;
+        case OffsetReg:
+        case GainReg:
+            return 3U;
+        default:  // NoOperation
+            return 0U;
+    }
+}
+
+static uint32_t ReadRegister(RegisterSelection_t reg)
+{
+    switch (reg)
+    {
+        case CommsReg:
+            adc.stats.commsReads++;
+            if (bitRead(adc.commsReg, DRDY_BIT))
+            {
+                adc.stats.busyPolls++;
+            }
+            return adc.commsReg;
+        case SetupReg:
+            return adc.setupReg;
+        case ClockReg:
+            return adc.clockReg;
+        case DataReg:
+            adc.stats.dataReads++;
+            if (adc.dataRead)
+            {
+                adc.stats.staleReads++;
+            }
+            // DRDY goes high once the data has been read
+            adc.dataRead = true;
+            bitSet(adc.commsReg, DRDY_BIT);
+            return adc.dataReg;
+        default:
+            // test and calibration registers are not modelled
+            return 0U;
+    }
+}
+
+static void WriteSetupReg(uint8_t value)
+{
+    adc.setupReg = value;
+    const SimAdcMode_t mode =
+        (SimAdcMode_t)bitExtract(value, MODE_MASK, MODE_OFFSET);
+    adc.filter.calibrating = (mode != NormalMode);
+    RestartFilter(adc.filter.calibrating ? SELF_CALIB_PERIODS : 0U);
+}
+
+static void WriteRegister(RegisterSelection_t reg, uint32_t value)
+{
+    switch (reg)
+    {
+        case SetupReg:
+            WriteSetupReg(value & 0xFFU);
+            break;
+        case ClockReg:
+            bitInsert(adc.clockReg, (uint8_t)value, CLOCK_WRITE_MASK, 0U);
+            RestartFilter(0U);
+            break;
+        default:
+            // data, test and calibration registers are not modelled
+            break;
+    }
+}
+
+// A byte received when no operation is pending is always a comms register write
+static void WriteCommsReg(uint8_t mosi)
+{
+    if (bitRead(mosi, DRDY_BIT))
+    {
+        // writes are ignored unless the 0/DRDY bit is 0
+        return;
+    }
+    const RegisterSelection_t reg =
+        (RegisterSelection_t)bitExtract(mosi, REG_SELECT_MASK, REG_SELECT_OFFSET);
+    SelectChannel(bitExtract(mosi, CH_SELECT_MASK, CH_SELECT_OFFSET));
+    bitInsert(adc.commsReg, mosi, COMMS_WRITE_MASK, 0U);
+
+    adc.op.reg = reg;
+    adc.op.readOp = bitRead(mosi, RW_BIT);
+    // selecting the comms register for a write just waits for the next command
+    adc.op.bytesLeft = ((reg == CommsReg) && !adc.op.readOp) ?
+        0U : RegisterBytes(reg);
+    adc.op.shiftReg = adc.op.readOp ? ReadRegister(reg) : 0U;
+}
+
+static uint8_t Transfer(uint8_t mosi)
+{
+    UpdateConversions();
+
+    uint8_t miso = NO_DATA_BYTE;
+    if (adc.op.bytesLeft == 0U)
+    {
+        WriteCommsReg(mosi);
+    }
+    else if (adc.op.readOp)
+    {
+        adc.op.bytesLeft--;
+        miso = (adc.op.shiftReg >> (8U * adc.op.bytesLeft)) & 0xFFU;
+    }
+    else
+    {
+        adc.op.shiftReg = (adc.op.shiftReg << 8U) | mosi;
+        adc.op.bytesLeft--;
+        if (adc.op.bytesLeft == 0U)
+        {
+            WriteRegister(adc.op.reg, adc.op.shiftReg);
+        }
+    }
+    return miso;
+}
+
+/*
+ Chip select only frames the transfer - the serial interface keeps its place in
+ a register operation between transactions.
+*/
+const SimSpiDevice_t simMX7705Device = {NULL, Transfer, NULL};
+
+/*******************************************************************************
+* PUBLIC API
+*******************************************************************************/
+void SimMX7705_Reset(SimMX7705Config_t const *config)
+{
+    memset(&adc, 0U, sizeof(adc));
+    adc.config = *config;
+    adc.setupReg = SETUP_REG_DEFAULT;
+    adc.clockReg = CLOCK_REG_DEFAULT;
+    adc.dataRead = true;
+    RestartFilter(0U);
+}
+
+uint8_t SimMX7705_GetCommsReg(void)
+{
+    UpdateConversions();
+    return adc.commsReg;
+}
+
+uint8_t SimMX7705_GetSetupReg(void)
+{
+    UpdateConversions();
+    return adc.setupReg;
+}
+
+uint8_t SimMX7705_GetClockReg(void)
+{
+    return adc.clockReg;
+}
+
+uint8_t SimMX7705_GetGain(void)
+{
+    return 1U << bitExtract(adc.setupReg, PGA_MASK, PGA_OFFSET);
+}
+
+uint8_t SimMX7705_GetChannel(void)
+{
+    return GetChannel();
+}
+
+/*
+ Output data rates in the datasheet are for a 1MHz (CLK = 0) or 2.4576MHz
+ (CLK = 1) clock after the CLKDIV divider. They scale with the actual clock.
+*/
+uint32_t SimMX7705_GetConversionPeriod(void)
+{
+    static const double rates[2][4] = {
+        {20.0, 25.0, 100.0, 200.0},  // CLK = 0
+        {50.0, 60.0, 250.0, 500.0}   // CLK = 1
+    };
+    static const double nominalClock[2] = {1.0E6, 2.4576E6};
+    const uint8_t clk = bitRead(adc.clockReg, CLK_BIT);
+    const uint8_t fs = bitExtract(adc.clockReg, FILTER_SELECT_MASK, FILTER_SELECT_OFFSET);
+    const double  divider = bitRead(adc.clockReg, CLKDIV_BIT) ? 2.0 : 1.0;
+    const double  clock = adc.config.masterClock / divider;
+    const double  rate = rates[clk][fs] * clock / nominalClock[clk];
+    return (uint32_t)(1.0E6 / rate);
+}
+
+uint32_t SimMX7705_GetTimeToReady(void)
+{
+    UpdateConversions();
+    if (!bitRead(adc.commsReg, DRDY_BIT))
+    {
+        return 0U;
+    }
+    else if (adc.filter.tNext == NO_CONVERSION)
+    {
+        return SIM_MX7705_NOT_CONVERTING;
+    }
+    else
+    {
+        return (uint32_t)(adc.filter.tNext - Now());
+    }
+}
+
+uint16_t SimMX7705_GetSettledCode(uint8_t channel)
+{
+    return VoltageToCode(GetInputVoltage(channel));
+}
+
+SimMX7705Stats_t const *SimMX7705_GetStats(void)
+{
+    return &adc.stats;
+}
@@ -0,0 +1,91 @@
+/*
+ Register level emulator of the MX7705 16-bit sigma-delta ADC. Sits behind the
+ spi layer so that the real driver can talk to it in simulations and tests.
+
+ Modelled:
+ - comms register protocol: a write to the comms register selects the register,
+   channel and direction of the next operation.
+ - setup and clock registers. Self-calibration, filter sync and writes to either
+   register restart the digital filter.
+ - DRDY timing. Output data rate follows the clock register (CLK, CLKDIV, FS1/0)
+   scaled by the master clock frequency. The filter needs 3 conversion periods
+   to settle after a restart and self-calibration takes another 6.
+ - PGA gain and unipolar/bipolar coding.
+ - input channel muxing. The filter is not reset when the channel changes so
+   conversions within 3 periods of a switch mix old and new inputs.
+ Analog input comes from a pluggable current source and current sense circuit.
+*/
+#ifndef SIMMX7705_H
+#define SIMMX7705_H
+
+#ifdef _cplusplus
+extern "C" {
+#endif
+
+#include "SimSpi.h"     // SimSpiDevice_t
+#include <stdint.h>
+
+#define SIM_MX7705_CHANNELS         (2U)          // AIN1 and AIN2
+#define SIM_MX7705_MASTER_CLOCK     (1000000UL)   // clock out from timer 2 (Hz)
+#define SIM_MX7705_VREF             (2.5)         // reference voltage (V)
+#define SIM_MX7705_NOT_CONVERTING   (0xFFFFFFFFUL) // no conversion due
+
+// Returns the current (A) into the given analog input (0 = AIN1, 1 = AIN2)
+typedef double SimMX7705CurrentFn_t(uint8_t input);
+
+// Returns the time in microseconds
+typedef uint64_t SimMX7705TimeFn_t(void);
+
+typedef struct SimMX7705Config_s {
+    uint32_t              masterClock;    // frequency at CLKIN (Hz)
+    double                vRef;           // reference voltage (V)
+    double                transimpedance; // current sense gain ahead of the adc (V/A)
+    SimMX7705CurrentFn_t *input;          // current source for each analog input
+    SimMX7705TimeFn_t    *now;            // time source
+} SimMX7705Config_t;
+
+// Bus activity seen by the emulator since it was reset
+typedef struct SimMX7705Stats_s {
+    uint32_t commsReads;   // reads of the comms register (DRDY polls)
+    uint32_t busyPolls;    // ...of which returned DRDY = 1 (not ready)
+    uint32_t dataReads;    // reads of the data register
+    uint32_t staleReads;   // ...of which returned data that had already been read
+    uint32_t conversions;  // conversions completed by the adc
+} SimMX7705Stats_t;
+
+// Spi device interface - attach to a chip select pin with SimSpi_AttachDevice
+extern const SimSpiDevice_t simMX7705Device;
+
+// Resets registers to power-on defaults with the given configuration
+void SimMX7705_Reset(SimMX7705Config_t const *config);
+
+// Register contents
+uint8_t SimMX7705_GetCommsReg(void);
+uint8_t SimMX7705_GetSetupReg(void);
+uint8_t SimMX7705_GetClockReg(void);
+
+// PGA gain multiplier set in the setup register (1 - 128)
+uint8_t SimMX7705_GetGain(void);
+
+// Channel currently connected to the modulator by the mux (CH1/CH0 bits)
+uint8_t SimMX7705_GetChannel(void);
+
+// Time between conversions for the current clock settings (us)
+uint32_t SimMX7705_GetConversionPeriod(void);
+
+/*
+ Time until DRDY next goes low (us). 0 while a conversion is waiting to be read
+ and SIM_MX7705_NOT_CONVERTING while the filter is held by FSYNC.
+*/
+uint32_t SimMX7705_GetTimeToReady(void);
+
+// Code that a settled conversion of the given channel would produce now
+uint16_t SimMX7705_GetSettledCode(uint8_t channel);
+
+SimMX7705Stats_t const *SimMX7705_GetStats(void);
+
+#ifdef _cplusplus
+}
+#endif
+
+#endif // SIMMX7705_H
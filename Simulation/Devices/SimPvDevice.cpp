@@ -0,0 +1,262 @@
+#include "SimMCP4802.h" // SIM_MCP4802_VREF
+#include "SimMX7705.h"  // SIM_MX7705_VREF
+#include "SimPvDevice.h"
+#include <stddef.h>
+#include <string.h>
+
+#define DAC_FULL_SCALE_CODE     (256.0)
+#define ADC_FULL_SCALE_CODE     (65536.0)
+#define ADC_MAX_CODE            (0xFFFFU)
+
+#define SOLVER_TOLERANCE        (1.0E-12) // A
+#define SOLVER_MAX_ITERATIONS   (100U)
+#define MPP_TOLERANCE           (1.0E-06) // V
+#define GOLDEN_RATIO            (0.6180339887498949)
+#define RNG_SEED_DEFAULT        (0x2545F491U)
+
+// Device parameters adjusted for the operating conditions
+typedef struct SimPvOperatingPoint_s {
+    double iL;
+    double i0;
+    double nVt;
+    double rS;
+    double rSh;
+} SimPvOperatingPoint_t;
+
+static SimPvOperatingPoint_t GetOperatingPoint(SimPvDevice_t const *device,
+                                               double               t)
+{
+    SimPvParams_t const *const p = &device->params;
+    const double tK = SimPv_GetTemperature(device, t) + SIM_PV_KELVIN;
+    const double tRefK = p->tRef + SIM_PV_KELVIN;
+    const double dT = tK - tRefK;
+    const double eGOnNk = p->eG / (p->n * SIM_PV_K_ON_Q);
+    SimPvOperatingPoint_t op;
+    op.iL = p->iL * SimPv_GetIrradiance(device, t) * (1.0 + p->alpha * dT);
+    op.i0 = p->i0 * pow(tK / tRefK, 3.0) * exp(eGOnNk * (1.0 / tRefK - 1.0 / tK));
+    op.nVt = p->n * SIM_PV_K_ON_Q * tK;
+    op.rS = p->rS;
+    op.rSh = p->rSh;
+    return op;
+}
+
+// Residual of the diode equation and its derivative with respect to current
+static double Residual(SimPvOperatingPoint_t const *op, double v, double i,
+                       double *dResidual)
+{
+    const double vD = v + i * op->rS;
+    const double diode = op->i0 * exp(vD / op->nVt);
+    const double shunt = isinf(op->rSh) ? 0.0 : (vD / op->rSh);
+    const double dShunt = isinf(op->rSh) ? 0.0 : (op->rS / op->rSh);
+    *dResidual = -(diode * op->rS / op->nVt) - dShunt - 1.0;
+    return op->iL - (diode - op->i0) - shunt - i;
+}
+
+/*
+ The residual falls monotonically with current so the root is unique. Newton
+ steps are kept inside a bracket that is narrowed by bisection when a step
+ would leave it.
+*/
+static double SolveCurrent(SimPvOperatingPoint_t const *op, double v)
+{
+    double dR;
+    double lo = op->iL;
+    double hi = op->iL;
+    double step = 1.0 + op->iL;
+    while (Residual(op, v, lo, &dR) < 0.0)
+    {
+        lo -= step;
+        step *= 2.0;
+    }
+    step = 1.0 + op->iL;
+    while (Residual(op, v, hi, &dR) > 0.0)
+    {
+        hi += step;
+        step *= 2.0;
+    }
+
+    double i = 0.5 * (lo + hi);
+    for (uint8_t k = 0U; k < SOLVER_MAX_ITERATIONS; k++)
+    {
+        const double r = Residual(op, v, i, &dR);
+        if (fabs(r) < SOLVER_TOLERANCE)
+        {
+            break;
+        }
+        if (r > 0.0)
+        {
+            lo = i;
+        }
+        else
+        {
+            hi = i;
+        }
+        const double iNewton = i - r / dR;
+        i = ((iNewton > lo) && (iNewton < hi)) ? iNewton : 0.5 * (lo + hi);
+    }
+    return i;
+}
+
+// xorshift32 - small and repeatable across platforms
+static uint32_t NextRandom(SimPvDevice_t *device)
+{
+    uint32_t x = device->rngState;
+    x ^= x << 13U;
+    x ^= x >> 17U;
+    x ^= x << 5U;
+    device->rngState = x;
+    return x;
+}
+
+// Standard normal deviate by the Box-Muller transform
+static double NextGaussian(SimPvDevice_t *device)
+{
+    const double u1 = (NextRandom(device) + 1.0) / 4294967297.0;
+    const double u2 = NextRandom(device) / 4294967296.0;
+    return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+void SimPv_Init(SimPvDevice_t       *device,
+                SimPvParams_t const *params,
+                SimPvProfileFn_t    *irradiance,
+                SimPvProfileFn_t    *temperature,
+                SimPvNoise_t const  *noise)
+{
+    memset(device, 0U, sizeof(SimPvDevice_t));
+    device->params = *params;
+    device->irradiance = irradiance;
+    device->temperature = temperature;
+    if (noise != NULL)
+    {
+        device->noise = *noise;
+    }
+    // xorshift state must not be zero
+    device->rngState = (device->noise.seed != 0U) ?
+        device->noise.seed : RNG_SEED_DEFAULT;
+}
+
+double SimPv_GetIrradiance(SimPvDevice_t const *device, double t)
+{
+    return (device->irradiance != NULL) ? device->irradiance(t) : 1.0;
+}
+
+double SimPv_GetTemperature(SimPvDevice_t const *device, double t)
+{
+    return (device->temperature != NULL) ?
+        device->temperature(t) : device->params.tRef;
+}
+
+double SimPv_GetCurrent(SimPvDevice_t const *device, double v, double t)
+{
+    const SimPvOperatingPoint_t op = GetOperatingPoint(device, t);
+    return SolveCurrent(&op, v);
+}
+
+double SimPv_MeasureCurrent(SimPvDevice_t *device, double v, double t)
+{
+    const double vNoise = (device->noise.voltage > 0.0) ?
+        device->noise.voltage * NextGaussian(device) : 0.0;
+    const double iNoise = (device->noise.current > 0.0) ?
+        device->noise.current * NextGaussian(device) : 0.0;
+    return SimPv_GetCurrent(device, v + vNoise, t) + iNoise;
+}
+
+// Current is zero at open circuit so the series resistance drops out
+double SimPv_GetVoc(SimPvDevice_t const *device, double t)
+{
+    const SimPvOperatingPoint_t op = GetOperatingPoint(device, t);
+    if (op.iL <= 0.0)
+    {
+        return 0.0;
+    }
+    double lo = 0.0;
+    double hi = op.nVt * log(op.iL / op.i0 + 1.0);
+    for (uint8_t k = 0U; (k < SOLVER_MAX_ITERATIONS) && ((hi - lo) > MPP_TOLERANCE); k++)
+    {
+        const double v = 0.5 * (lo + hi);
+        if (SolveCurrent(&op, v) > 0.0)
+        {
+            lo = v;
+        }
+        else
+        {
+            hi = v;
+        }
+    }
+    return 0.5 * (lo + hi);
+}
+
+// Power is unimodal between short and open circuit - golden section search
+double SimPv_GetMpp(SimPvDevice_t const *device, double t, double *vMpp)
+{
+    const SimPvOperatingPoint_t op = GetOperatingPoint(device, t);
+    double a = 0.0;
+    double b = SimPv_GetVoc(device, t);
+    double x1 = b - GOLDEN_RATIO * (b - a);
+    double x2 = a + GOLDEN_RATIO * (b - a);
+    double p1 = x1 * SolveCurrent(&op, x1);
+    double p2 = x2 * SolveCurrent(&op, x2);
+    while ((b - a) > MPP_TOLERANCE)
+    {
+        if (p1 > p2)
+        {
+            b = x2;
+            x2 = x1;
+            p2 = p1;
+            x1 = b - GOLDEN_RATIO * (b - a);
+            p1 = x1 * SolveCurrent(&op, x1);
+        }
+        else
+        {
+            a = x1;
+            x1 = x2;
+            p1 = p2;
+            x2 = a + GOLDEN_RATIO * (b - a);
+            p2 = x2 * SolveCurrent(&op, x2);
+        }
+    }
+    const double v = 0.5 * (a + b);
+    if (vMpp != NULL)
+    {
+        *vMpp = v;
+    }
+    return v * SolveCurrent(&op, v);
+}
+
+double SimPv_InterpolateProfile(SimPvProfilePoint_t const *points,
+                                uint8_t                    nPoints,
+                                double                     t)
+{
+    if (t <= points[0].t)
+    {
+        return points[0].value;
+    }
+    for (uint8_t k = 1U; k < nPoints; k++)
+    {
+        if (t < points[k].t)
+        {
+            SimPvProfilePoint_t const *const p0 = &points[k - 1U];
+            SimPvProfilePoint_t const *const p1 = &points[k];
+            const double f = (t - p0->t) / (p1->t - p0->t);
+            return p0->value + f * (p1->value - p0->value);
+        }
+    }
+    return points[nPoints - 1U].value;
+}
+
+double SimPv_DacCodeToVoltage(uint8_t code, uint8_t dacGain)
+{
+    return (code / DAC_FULL_SCALE_CODE) * SIM_MCP4802_VREF * dacGain;
+}
+
+uint16_t SimPv_CurrentToAdcCode(double current, double transimpedance,
+                                uint8_t pgaGain)
+{
+    const double code =
+        current * transimpedance * pgaGain / SIM_MX7705_VREF * ADC_FULL_SCALE_CODE;
+    if (code <= 0.0)
+    {
+        return 0U;
+    }
+    return (code >= ADC_MAX_CODE) ? ADC_MAX_CODE : (uint16_t)code;
+}
@@ -0,0 +1,112 @@
+/*
+ Single diode model of a photovoltaic device under test for simulations and
+ benchmarks. Current at a bias voltage V is the solution of
+
+   I = IL - I0 * (exp((V + I*Rs) / (n*Vt)) - 1) - (V + I*Rs) / Rsh
+
+ Photocurrent scales with irradiance and temperature and saturation current
+ follows the usual T^3 * exp(-Eg/kT) law. Irradiance and temperature are
+ functions of time and measurement noise can be added to readings.
+ Helpers map dac codes to bias voltages and currents to adc codes using the
+ references of the MCP4802 and MX7705.
+*/
+#ifndef SIMPVDEVICE_H
+#define SIMPVDEVICE_H
+
+#ifdef _cplusplus
+extern "C" {
+#endif
+
+#include <math.h>
+#include <stdint.h>
+
+#define SIM_PV_KELVIN           (273.15)
+#define SIM_PV_K_ON_Q           (8.617333E-05) // boltzmann / charge (V/K)
+#define SIM_PV_EG_SILICON       (1.12)         // band gap (eV)
+
+/*
+ Ideal diode used to generate the unit test data in ShockleyData.py. The
+ reference temperature gives the same thermal voltage of 25.9mV.
+*/
+#define SIM_PV_IDEAL_DIODE                                   \
+    {1.0, 1.0E-09, 1.0, 0.0, INFINITY, 0.0, SIM_PV_EG_SILICON, \
+     (0.0259 / SIM_PV_K_ON_Q) - SIM_PV_KELVIN}
+
+// Returns irradiance (suns) or temperature (deg C) at a time in seconds
+typedef double SimPvProfileFn_t(double t);
+
+typedef struct SimPvParams_s {
+    double iL;    // photocurrent at 1 sun and reference temperature (A)
+    double i0;    // saturation current at reference temperature (A)
+    double n;     // ideality factor
+    double rS;    // series resistance (ohm)
+    double rSh;   // shunt resistance (ohm) - INFINITY for none
+    double alpha; // relative temperature coefficient of photocurrent (1/K)
+    double eG;    // band gap (eV)
+    double tRef;  // reference temperature (deg C)
+} SimPvParams_t;
+
+// Gaussian measurement noise. Standard deviations of zero give exact readings.
+typedef struct SimPvNoise_s {
+    double   voltage; // error in the applied bias (V)
+    double   current; // error in the measured current (A)
+    uint32_t seed;    // seeds the generator so runs are repeatable
+} SimPvNoise_t;
+
+typedef struct SimPvDevice_s {
+    SimPvParams_t     params;
+    SimPvProfileFn_t *irradiance;  // NULL for 1 sun
+    SimPvProfileFn_t *temperature; // NULL for the reference temperature
+    SimPvNoise_t      noise;
+    uint32_t          rngState;
+} SimPvDevice_t;
+
+// Point in a piecewise linear profile
+typedef struct SimPvProfilePoint_s {
+    double t;     // time (s)
+    double value; // irradiance (suns) or temperature (deg C)
+} SimPvProfilePoint_t;
+
+// Sets up a device. Profiles may be NULL and noise may be NULL for none.
+void SimPv_Init(SimPvDevice_t       *device,
+                SimPvParams_t const *params,
+                SimPvProfileFn_t    *irradiance,
+                SimPvProfileFn_t    *temperature,
+                SimPvNoise_t const  *noise);
+
+// Irradiance (suns) and temperature (deg C) at time t (s)
+double SimPv_GetIrradiance(SimPvDevice_t const *device, double t);
+double SimPv_GetTemperature(SimPvDevice_t const *device, double t);
+
+// Exact current (A) at bias v (V) and time t (s)
+double SimPv_GetCurrent(SimPvDevice_t const *device, double v, double t);
+
+// Current reading including measurement noise
+double SimPv_MeasureCurrent(SimPvDevice_t *device, double v, double t);
+
+// Open circuit voltage (V) at time t (s)
+double SimPv_GetVoc(SimPvDevice_t const *device, double t);
+
+// Finds the maximum power point at time t. Returns power (W), vMpp may be NULL.
+double SimPv_GetMpp(SimPvDevice_t const *device, double t, double *vMpp);
+
+// Value of a piecewise linear profile at time t. Held constant beyond the ends.
+double SimPv_InterpolateProfile(SimPvProfilePoint_t const *points,
+                                uint8_t                    nPoints,
+                                double                     t);
+
+// Bias voltage for a dac code with the MCP4802 reference and gain (1 or 2)
+double SimPv_DacCodeToVoltage(uint8_t code, uint8_t dacGain);
+
+/*
+ Unipolar MX7705 code for a current through a sense circuit with the given
+ transimpedance (V/A) and pga gain (1 - 128). Clamped to the code range.
+*/
+uint16_t SimPv_CurrentToAdcCode(double current, double transimpedance,
+                                uint8_t pgaGain);
+
+#ifdef _cplusplus
+}
+#endif
+
+#endif // SIMPVDEVICE_H
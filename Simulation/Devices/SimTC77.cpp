@@ -0,0 +1,38 @@
+#include "Arduino.h"
+#include "SimSpi.h"
+#include "SimTC77.h"
+
+#define DEG_C_PER_CODE      (0.0625)
+#define TEMP_OFFSET         (3U)    // temperature in bits 15-3
+#define READY_BIT           (2U)    // set once first conversion is complete
+
+static uint16_t readReg;
+static uint8_t  byteIdx;
+
+static void Select(void)
+{
+    byteIdx = 0U;
+}
+
+// Temperature register is shifted out msb first
+static uint8_t Transfer(uint8_t mosi)
+{
+    const uint8_t miso = (byteIdx == 0U) ? (readReg >> 8U) : (readReg & 0xFFU);
+    byteIdx++;
+    return miso;
+}
+
+static const SimSpiDevice_t tc77Device = {Select, Transfer, NULL};
+
+void SimTC77_Attach(uint8_t chipSelectPin)
+{
+    SimTC77_SetTemperature(25.0);
+    SimSpi_AttachDevice(chipSelectPin, &tc77Device);
+}
+
+void SimTC77_SetTemperature(double degC)
+{
+    const int16_t code = (int16_t)(degC / DEG_C_PER_CODE);
+    readReg = (uint16_t)(code << TEMP_OFFSET);
+    bitSet(readReg, READY_BIT);
+}
@@ -0,0 +1,24 @@
+/*
+ Model of the TC77 temperature sensor for the native simulation build. Always
+ returns a completed conversion of the temperature set here.
+*/
+#ifndef SIMTC77_H
+#define SIMTC77_H
+
+#ifdef _cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+// Connects the sensor to the simulated spi bus
+void SimTC77_Attach(uint8_t chipSelectPin);
+
+// Sets the temperature reported by the sensor in deg C
+void SimTC77_SetTemperature(double degC);
+
+#ifdef _cplusplus
+}
+#endif
+
+#endif // SIMTC77_H
@@ -0,0 +1,567 @@
+/*
+ MPPT tracking efficiency benchmark. Runs the lifetester state machine on both
+ channels against simulated devices under a set of standard irradiance traces
+ and reports for each channel:
+
+ - energy harvested as a fraction of the energy available at the true mpp
+ - time from StateMachine_Reset until the tracker first holds the dac within a
+   code of the best dac code
+ - longest time the dac was more than a code from the best code after that
+ - steady state oscillation of the dac code over the last quarter of the run
+ - mpp updates per minute (measurements of the next point started)
+
+ Results are written to stdout as csv, one line per trace and channel. Serial
+ output from the firmware is discarded.
+*/
+#include "Arduino.h"
+#include "Config.h"
+#include "IoWrapper.h"
+#include "LifeTesterTypes.h"
+#include "MppStore.h"
+#include "SimClock.h"
+#include "SimEeprom.h"
+#include "SimIo.h"
+#include "SimLoop.h"
+#include "SimMCP4802.h"
+#include "SimMX7705.h"
+#include "SimPvDevice.h"
+#include "SimSpi.h"
+#include "SimTC77.h"
+#include "StateMachine.h"
+#include "TimerWheel.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define N_CHANNELS              (2U)
+#define DEFAULT_DURATION_S      (3600U)
+#define DEFAULT_SAMPLE_MS       (100U)
+#define IDLE_TICK_MS            (1U)
+#define MPP_TOLERANCE_CODES     (1)
+#define STEADY_STATE_FRACTION   (0.75)  // oscillation measured after this
+
+// Cloud flicker - shadows of 30% irradiance with soft edges
+#define CLOUD_PERIOD_S          (120.0)
+#define CLOUD_LENGTH_S          (20.0)
+#define CLOUD_EDGE_S            (3.0)
+#define CLOUD_DEPTH             (0.7)
+
+// Light sensor reading at 1 sun - the 10-bit reading saturates at 1023
+#define LIGHT_SENSOR_FULL_SUN   (800.0)
+
+// Degradation - loss of photocurrent and growth of series resistance by the end
+#define DEGRADATION_IL_LOSS     (0.2)
+#define DEGRADATION_RS_GAIN     (0.05)  // ohm
+
+// Heat - device temperature step, which moves the mpp without changing the light
+#define HEAT_STEP_K             (30.0)
+
+typedef struct BenchTrace_s {
+    const char       *name;
+    SimPvProfileFn_t *irradiance;
+    SimPvProfileFn_t *temperature; // NULL for the reference temperature
+    bool              degrades;
+} BenchTrace_t;
+
+typedef struct BenchOptions_s {
+    uint32_t    duration;    // s of virtual time per trace
+    uint32_t    samplePeriod;// ms between samples of the metrics
+    double      noise;       // standard deviation of current noise (A)
+    uint8_t     reuseLimit;  // see Config_SetReuseLimit
+    uint8_t     maxStep;     // see Config_SetMaxStep
+    uint8_t     algorithms;  // see Config_SetTrackingAlgorithms
+    uint8_t     scanStrategy;// see Config_SetScanStrategy
+    uint8_t     stopMargin;  // see Config_SetScanStopMargin
+    uint32_t    resetPeriod; // s between resets of both channels, 0 = never
+    uint8_t     lightChange; // see Config_SetLightChangeThreshold
+    uint8_t     sampleTolerance; // see Config_SetSampleTolerance
+    uint8_t     dwellDrift;      // see Config_SetDwellDrift
+    const char *trace;       // run a single trace or NULL for all
+} BenchOptions_t;
+
+// Metrics accumulated for one channel
+typedef struct BenchResult_s {
+    double   energy;       // J delivered by the device
+    double   energyMpp;    // J available at the mpp
+    double   tFirstMpp;    // s or negative if never reached
+    double   tOffMpp;      // s when the tracker last left the mpp, negative while at it
+    double   tMaxOffMpp;   // longest time away from the mpp after first reaching it (s)
+    uint8_t  codeMin;      // dac codes in steady state
+    uint8_t  codeMax;
+    double   codeErrSqSum; // squared distance from best code in steady state
+    uint32_t nSteady;
+    uint32_t nUpdates;     // tracking cycles - counted as next measurements
+    bool     measuringNext;
+    bool     error;        // channel ended in the error state
+} BenchResult_t;
+
+static const SimPvParams_t dutParams = SIM_PV_IDEAL_DIODE;
+// sense resistor chosen so that the light current is 80% of adc full scale
+static const double dutTransimpedance = 0.8 * SIM_MX7705_VREF / dutParams.iL;
+static SimPvDevice_t duts[N_CHANNELS];
+static double traceDuration;
+static SimPvProfileFn_t *lightTrace;
+
+/*******************************************************************************
+* IRRADIANCE TRACES
+*******************************************************************************/
+static double ConstantTrace(double t)
+{
+    return 1.0;
+}
+
+// Drops to half at a third of the way through and recovers at two thirds
+static double StepTrace(double t)
+{
+    const double f = t / traceDuration;
+    return ((f >= (1.0 / 3.0)) && (f < (2.0 / 3.0))) ? 0.5 : 1.0;
+}
+
+// Sunrise from 20% to full irradiance over the run
+static double RampTrace(double t)
+{
+    const SimPvProfilePoint_t ramp[] = {{0.0, 0.2}, {traceDuration, 1.0}};
+    return SimPv_InterpolateProfile(ramp, 2U, t);
+}
+
+static double CloudTrace(double t)
+{
+    const SimPvProfilePoint_t cloud[] = {
+        {0.0, 1.0},
+        {CLOUD_PERIOD_S - CLOUD_LENGTH_S - CLOUD_EDGE_S, 1.0},
+        {CLOUD_PERIOD_S - CLOUD_LENGTH_S, 1.0 - CLOUD_DEPTH},
+        {CLOUD_PERIOD_S - CLOUD_EDGE_S, 1.0 - CLOUD_DEPTH},
+        {CLOUD_PERIOD_S, 1.0}
+    };
+    return SimPv_InterpolateProfile(cloud, 5U, fmod(t, CLOUD_PERIOD_S));
+}
+
+/*
+ Device heats up by HEAT_STEP_K a third of the way through and cools at two
+ thirds. Light is constant so only tracking follows the mpp as it moves.
+*/
+static double HeatTrace(double t)
+{
+    const double f = t / traceDuration;
+    const double tRef = dutParams.tRef;
+    return ((f >= (1.0 / 3.0)) && (f < (2.0 / 3.0))) ? (tRef + HEAT_STEP_K) : tRef;
+}
+
+static const BenchTrace_t traces[] = {
+    {"constant",    ConstantTrace, NULL,      false},
+    {"step",        StepTrace,     NULL,      false},
+    {"ramp",        RampTrace,     NULL,      false},
+    {"cloud",       CloudTrace,    NULL,      false},
+    {"degradation", ConstantTrace, NULL,      true},
+    {"heat",        ConstantTrace, HeatTrace, false}
+};
+
+/*******************************************************************************
+* SIMULATION
+*******************************************************************************/
+static double GetDutCurrent(uint8_t channel)
+{
+    const double v = SimMCP4802_GetVoltage(channel);
+    const double t = SimClock_GetMicros() / 1.0E6;
+    return SimPv_MeasureCurrent(&duts[channel], v, t);
+}
+
+// Light sensor sees the same irradiance as the devices
+static uint16_t ReadLightSensor(uint8_t pin)
+{
+    const double t = SimClock_GetMicros() / 1.0E6;
+    return (uint16_t)min(lightTrace(t) * LIGHT_SENSOR_FULL_SUN, 1023.0);
+}
+
+// Degradation is applied directly to the device parameters as time passes
+static void UpdateDegradation(BenchTrace_t const *trace, double t)
+{
+    if (trace->degrades)
+    {
+        const double f = t / traceDuration;
+        for (uint8_t ch = 0U; ch < N_CHANNELS; ch++)
+        {
+            duts[ch].params.iL = dutParams.iL * (1.0 - DEGRADATION_IL_LOSS * f);
+            duts[ch].params.rS = dutParams.rS + DEGRADATION_RS_GAIN * f;
+        }
+    }
+}
+
+static void AttachPeripherals(BenchTrace_t const *trace, double noise)
+{
+    const SimMX7705Config_t adcConfig = {
+        SIM_MX7705_MASTER_CLOCK,
+        SIM_MX7705_VREF,
+        dutTransimpedance,
+        GetDutCurrent,
+        SimClock_GetMicros
+    };
+    for (uint8_t ch = 0U; ch < N_CHANNELS; ch++)
+    {
+        const SimPvNoise_t dutNoise = {0.0, noise, ch + 1U};
+        SimPv_Init(&duts[ch], &dutParams, trace->irradiance, trace->temperature,
+                   &dutNoise);
+    }
+    SimIo_Reset();
+    lightTrace = trace->irradiance;
+    SimIo_AttachAnalogInput(LIGHT_SENSOR_PIN, ReadLightSensor);
+    SimSpi_Reset();
+    SimMCP4802_Attach(DAC_CS_PIN);
+    SimMX7705_Reset(&adcConfig);
+    SimSpi_AttachDevice(ADC_CS_PIN, &simMX7705Device);
+    SimTC77_Attach(TEMP_CS_PIN);
+}
+
+// Best code the dac can set - the mpp lies between the codes either side of it
+static uint8_t GetBestCode(SimPvDevice_t const *device, double t, uint8_t gain)
+{
+    double vMpp;
+    (void)SimPv_GetMpp(device, t, &vMpp);
+    const double lsb = SimPv_DacCodeToVoltage(1U, gain);
+    const uint8_t lower = (uint8_t)(vMpp / lsb);
+    const double vLower = SimPv_DacCodeToVoltage(lower, gain);
+    const double vUpper = SimPv_DacCodeToVoltage(lower + 1U, gain);
+    const double pLower = vLower * SimPv_GetCurrent(device, vLower, t);
+    const double pUpper = vUpper * SimPv_GetCurrent(device, vUpper, t);
+    return (pUpper > pLower) ? (lower + 1U) : lower;
+}
+
+// Scanning, initialising and error states don't count as tracking the mpp
+static bool IsTracking(LifeTester_t const *lifeTester)
+{
+    static const char *const trackingStates[] = {
+        "StateTrackingMode",
+        "StateTrackingDelay",
+        "StateMeasureThisDataPoint",
+        "StateMeasureNextDataPoint"
+    };
+    for (uint8_t i = 0U; i < (sizeof(trackingStates) / sizeof(trackingStates[0])); i++)
+    {
+        if (strcmp(lifeTester->state->label, trackingStates[i]) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void SampleMetrics(LifeTester_t const *lifeTester, double t, double dt,
+                          BenchResult_t *result)
+{
+    const uint8_t ch = lifeTester->io.dac;
+    SimPvDevice_t const *const device = &duts[lifeTester->io.adc];
+    const double v = SimMCP4802_GetVoltage(ch);
+    const uint8_t bestCode = GetBestCode(device, t, SimMCP4802_GetGain(ch));
+    const int16_t codeErr = (int16_t)lifeTester->data.vThis - bestCode;
+
+    // load can only sink current from the device
+    result->energy += v * max(SimPv_GetCurrent(device, v, t), 0.0) * dt;
+    result->energyMpp += SimPv_GetMpp(device, t, NULL) * dt;
+
+    const bool measuringNext =
+        (strcmp(lifeTester->state->label, "StateMeasureNextDataPoint") == 0);
+    if (measuringNext && !result->measuringNext)
+    {
+        result->nUpdates++;
+    }
+    result->measuringNext = measuringNext;
+
+    const bool atMpp = IsTracking(lifeTester)
+                       && (abs(codeErr) <= MPP_TOLERANCE_CODES);
+    if (atMpp && (result->tFirstMpp < 0.0))
+    {
+        result->tFirstMpp = t;
+    }
+    if (atMpp)
+    {
+        result->tOffMpp = -1.0;
+    }
+    else if (result->tFirstMpp >= 0.0)
+    {
+        if (result->tOffMpp < 0.0)
+        {
+            result->tOffMpp = t;
+        }
+        result->tMaxOffMpp = max(result->tMaxOffMpp, t + dt - result->tOffMpp);
+    }
+    if ((t >= (STEADY_STATE_FRACTION * traceDuration)) && IsTracking(lifeTester))
+    {
+        const uint8_t code = lifeTester->data.vThis;
+        result->codeMin = (result->nSteady == 0U) ? code : min(result->codeMin, code);
+        result->codeMax = (result->nSteady == 0U) ? code : max(result->codeMax, code);
+        result->codeErrSqSum += (double)codeErr * codeErr;
+        result->nSteady++;
+    }
+}
+
+static void RunTrace(BenchTrace_t const *trace, BenchOptions_t const *options,
+                     BenchResult_t *results)
+{
+    MCP4802_t dac;
+    IoAdc_t   adc;
+    TC77_t    tempSensor = {0};  // only read for printing - left uninitialised
+    Config_t  config;
+    TimerWheel_t timers;
+    MppStore_t mppStore;
+    LifeTester_t channels[N_CHANNELS] = {
+        {{0U, &dac, chASelect, &adc, 0U, &tempSensor},
+         Flasher(LED_A_PIN, &timers), {0}, 0U, ok, NULL, &config, &timers,
+         NULL, &mppStore},
+        {{1U, &dac, chBSelect, &adc, 1U, &tempSensor},
+         Flasher(LED_B_PIN, &timers), {0}, 0U, ok, NULL, &config, &timers,
+         NULL, &mppStore}
+    };
+    traceDuration = options->duration;
+    SimClock_Reset();
+    TimerWheel_Init(&timers, millis());
+    SimEeprom_Erase();
+    MppStore_Init(&mppStore, MPP_STORE_BASE, MPP_STORE_CHANNELS);
+    AttachPeripherals(trace, options->noise);
+    // i/o isn't counted - the benchmark only looks at tracking
+    DacInit(&dac, DAC_CS_PIN, NULL);
+    AdcInit(&adc, ADC_CS_PIN, NULL);
+    Config_InitParams(&config);
+    Config_SetReuseLimit(&config, options->reuseLimit);
+    Config_SetMaxStep(&config, options->maxStep);
+    Config_SetTrackingAlgorithms(&config, options->algorithms);
+    Config_SetScanStrategy(&config, options->scanStrategy);
+    Config_SetScanStopMargin(&config, options->stopMargin);
+    Config_SetLightChangeThreshold(&config, options->lightChange);
+    Config_SetSampleTolerance(&config, options->sampleTolerance);
+    Config_SetDwellDrift(&config, options->dwellDrift);
+
+    const uint64_t tStart = SimClock_GetMicros();
+    const uint64_t tEnd = tStart + (uint64_t)options->duration * 1000000U;
+    const uint64_t dtSample = (uint64_t)options->samplePeriod * 1000U;
+    const uint64_t dtReset = (uint64_t)options->resetPeriod * 1000000U;
+    uint64_t tSample = tStart;
+    uint64_t tReset = tStart + dtReset;
+    for (uint8_t ch = 0U; ch < N_CHANNELS; ch++)
+    {
+        memset(&results[ch], 0U, sizeof(BenchResult_t));
+        results[ch].tFirstMpp = -1.0;
+        results[ch].tOffMpp = -1.0;
+        StateMachine_Reset(&channels[ch]);
+    }
+
+    while (SimClock_GetMicros() < tEnd)
+    {
+        const uint64_t tLoop = SimClock_GetMicros();
+        if ((dtReset > 0U) && (tLoop >= tReset))
+        {
+            // eg. power cycle or reset command - the eeprom survives
+            for (uint8_t ch = 0U; ch < N_CHANNELS; ch++)
+            {
+                StateMachine_Reset(&channels[ch]);
+            }
+            tReset += dtReset;
+        }
+        for (uint8_t ch = 0U; ch < N_CHANNELS; ch++)
+        {
+            // serviced per channel so each sees timers that came due while the other ran
+            TimerWheel_Service(&timers, millis());
+            StateMachine_UpdateStep(&channels[ch]);
+        }
+        SimLoop_SkipIdle(&timers, channels, N_CHANNELS, IDLE_TICK_MS);
+        // dac output was held over the whole pass so sample on a fixed grid
+        while ((tSample < SimClock_GetMicros()) && (tSample < tEnd))
+        {
+            const double t = (tSample - tStart) / 1.0E6;
+            UpdateDegradation(trace, t);
+            for (uint8_t ch = 0U; ch < N_CHANNELS; ch++)
+            {
+                SampleMetrics(&channels[ch], t, dtSample / 1.0E6, &results[ch]);
+            }
+            tSample += dtSample;
+        }
+    }
+    for (uint8_t ch = 0U; ch < N_CHANNELS; ch++)
+    {
+        results[ch].error = (strcmp(channels[ch].state->label, "StateError") == 0);
+    }
+}
+
+/*******************************************************************************
+* REPORTING
+*******************************************************************************/
+static void PrintHeader(FILE *out)
+{
+    fprintf(out, "trace,channel,duration_s,energy_fraction,t_first_mpp_s,"
+                 "t_max_off_mpp_s,osc_range_codes,osc_rms_codes,updates_per_min,error\n");
+}
+
+static void PrintResult(FILE *out, BenchTrace_t const *trace, uint8_t ch,
+                        BenchOptions_t const *options,
+                        BenchResult_t const *result)
+{
+    const double fraction = (result->energyMpp > 0.0) ?
+        (result->energy / result->energyMpp) : 0.0;
+    const uint8_t range = (result->nSteady > 0U) ?
+        (result->codeMax - result->codeMin) : 0U;
+    const double rms = (result->nSteady > 0U) ?
+        sqrt(result->codeErrSqSum / result->nSteady) : 0.0;
+    const double updateRate = result->nUpdates * 60.0 / options->duration;
+    fprintf(out, "%s,%u,%u,%.6f,%.3f,%.3f,%u,%.3f,%.2f,%u\n",
+            trace->name, ch, options->duration, fraction, result->tFirstMpp,
+            result->tMaxOffMpp, range, rms, updateRate, result->error);
+}
+
+static void PrintUsage(const char *name)
+{
+    fprintf(stderr,
+        "usage: %s [-t seconds] [-s sample_ms] [-n noise_a] [-u reuse] [-m max_step]\n"
+        "          [-a algorithms] [-i scan] [-e stop_margin]\n"
+        "          [-w reset_s] [-l light_change] [-q tolerance]\n"
+        "          [-d dwell_drift] [-r trace]\n"
+        "  -t  virtual time to run each trace (default %u s)\n"
+        "  -s  period for sampling energy and dac codes (default %u ms)\n"
+        "  -n  standard deviation of current measurement noise (default 0 A)\n"
+        "  -u  cycles in a row that may reuse the next measurement after moving\n"
+        "      uphill (default %u, %u = no limit)\n"
+        "  -m  largest adaptive tracking step in dac codes (default %u = fixed\n"
+        "      step)\n"
+        "  -a  tracking algorithm bit per channel, 0 = perturb-observe,\n"
+        "      1 = incremental conductance (default 0x%02X)\n"
+        "  -i  initial scan, 0 = linear, 1 = golden-section (default %u)\n"
+        "  -e  points below minimum current that end a linear scan early\n"
+        "      (default %u, %u = always scan to the end)\n"
+        "  -w  reset both channels every reset_s seconds (default 0 = never)\n"
+        "  -l  light change in 256ths that starts a re-scan around the mpp\n"
+        "      (default %u, %u = never)\n"
+        "  -q  standard error in adc codes that ends a sampling window early\n"
+        "      (default %u, %u = always sample the whole window)\n"
+        "  -d  power drift in 256ths that ends dwelling at the mpp\n"
+        "      (default %u, %u = never dwell)\n"
+        "  -r  run a single trace:",
+        name, DEFAULT_DURATION_S, DEFAULT_SAMPLE_MS, REUSE_LIMIT, REUSE_UNLIMITED,
+        DV_MPPT_MAX, TRACKING_ALGORITHMS, SCAN_STRATEGY, SCAN_STOP_MARGIN,
+        SCAN_NO_EARLY_STOP, LIGHT_CHANGE_THRESHOLD, LIGHT_CHANGE_OFF,
+        SAMPLE_TOLERANCE, SAMPLE_TOLERANCE_OFF, DWELL_DRIFT, DWELL_DRIFT_OFF);
+    for (uint8_t i = 0U; i < (sizeof(traces) / sizeof(traces[0])); i++)
+    {
+        fprintf(stderr, " %s", traces[i].name);
+    }
+    fprintf(stderr, "\n");
+}
+
+static bool ParseOptions(int argc, char **argv, BenchOptions_t *options)
+{
+    options->duration = DEFAULT_DURATION_S;
+    options->samplePeriod = DEFAULT_SAMPLE_MS;
+    options->noise = 0.0;
+    options->reuseLimit = REUSE_LIMIT;
+    options->maxStep = DV_MPPT_MAX;
+    options->algorithms = TRACKING_ALGORITHMS;
+    options->scanStrategy = SCAN_STRATEGY;
+    options->stopMargin = SCAN_STOP_MARGIN;
+    options->resetPeriod = 0U;
+    options->lightChange = LIGHT_CHANGE_THRESHOLD;
+    options->sampleTolerance = SAMPLE_TOLERANCE;
+    options->dwellDrift = DWELL_DRIFT;
+    options->trace = NULL;
+    for (int i = 1; i < argc; i++)
+    {
+        const bool hasValue = (i + 1) < argc;
+        if ((strcmp(argv[i], "-t") == 0) && hasValue)
+        {
+            options->duration = strtoul(argv[++i], NULL, 0);
+        }
+        else if ((strcmp(argv[i], "-s") == 0) && hasValue)
+        {
+            options->samplePeriod = strtoul(argv[++i], NULL, 0);
+        }
+        else if ((strcmp(argv[i], "-n") == 0) && hasValue)
+        {
+            options->noise = strtod(argv[++i], NULL);
+        }
+        else if ((strcmp(argv[i], "-u") == 0) && hasValue)
+        {
+            options->reuseLimit = strtoul(argv[++i], NULL, 0);
+        }
+        else if ((strcmp(argv[i], "-m") == 0) && hasValue)
+        {
+            options->maxStep = strtoul(argv[++i], NULL, 0);
+        }
+        else if ((strcmp(argv[i], "-a") == 0) && hasValue)
+        {
+            options->algorithms = strtoul(argv[++i], NULL, 0);
+        }
+        else if ((strcmp(argv[i], "-i") == 0) && hasValue)
+        {
+            options->scanStrategy = strtoul(argv[++i], NULL, 0);
+        }
+        else if ((strcmp(argv[i], "-e") == 0) && hasValue)
+        {
+            options->stopMargin = strtoul(argv[++i], NULL, 0);
+        }
+        else if ((strcmp(argv[i], "-w") == 0) && hasValue)
+        {
+            options->resetPeriod = strtoul(argv[++i], NULL, 0);
+        }
+        else if ((strcmp(argv[i], "-l") == 0) && hasValue)
+        {
+            options->lightChange = strtoul(argv[++i], NULL, 0);
+        }
+        else if ((strcmp(argv[i], "-q") == 0) && hasValue)
+        {
+            options->sampleTolerance = strtoul(argv[++i], NULL, 0);
+        }
+        else if ((strcmp(argv[i], "-d") == 0) && hasValue)
+        {
+            options->dwellDrift = strtoul(argv[++i], NULL, 0);
+        }
+        else if ((strcmp(argv[i], "-r") == 0) && hasValue)
+        {
+            options->trace = argv[++i];
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return (options->duration > 0U) && (options->samplePeriod > 0U);
+}
+
+int main(int argc, char **argv)
+{
+    BenchOptions_t options;
+    if (!ParseOptions(argc, argv, &options))
+    {
+        PrintUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // keep stdout for results and send firmware serial output to /dev/null
+    FILE *const out = fdopen(dup(fileno(stdout)), "w");
+    if ((out == NULL) || (freopen("/dev/null", "w", stdout) == NULL))
+    {
+        perror("MpptBenchmark");
+        return EXIT_FAILURE;
+    }
+
+    bool traceFound = false;
+    PrintHeader(out);
+    for (uint8_t i = 0U; i < (sizeof(traces) / sizeof(traces[0])); i++)
+    {
+        if ((options.trace != NULL) && (strcmp(options.trace, traces[i].name) != 0))
+        {
+            continue;
+        }
+        BenchResult_t results[N_CHANNELS];
+        RunTrace(&traces[i], &options, results);
+        for (uint8_t ch = 0U; ch < N_CHANNELS; ch++)
+        {
+            PrintResult(out, &traces[i], ch, &options, &results[ch]);
+        }
+        fflush(out);
+        traceFound = true;
+    }
+    if (!traceFound)
+    {
+        PrintUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
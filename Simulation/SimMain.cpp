@@ -0,0 +1,166 @@
+/*
+ Native host simulation of the lifetester firmware. The full firmware (setup and
+ loop in LifeTester.cpp, state machine, controller and hardware drivers) runs
+ against simulated peripherals with a virtual clock so that long tracking runs
+ finish in seconds. Serial output from the firmware is written to stdout.
+*/
+#include "Arduino.h"
+#include "Config.h"
+#include "IoStats.h"
+#include "LifeTesterTypes.h"
+#include "SimClock.h"
+#include "SimIo.h"
+#include "SimLoop.h"
+#include "SimMCP4802.h"
+#include "SimMX7705.h"
+#include "SimPvDevice.h"
+#include "SimSpi.h"
+#include "SimTC77.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define DEFAULT_DURATION_S      (3600U)
+#define DEFAULT_IDLE_TICK_MS    (1U)
+
+#define LIGHT_SENSOR_READING    (512U)
+
+typedef struct SimOptions_s {
+    uint32_t duration;  // seconds of virtual time to simulate
+    uint32_t idleTick;  // ms added when idle with no timer or conversion due
+    bool     quiet;     // discard firmware serial output
+    bool     ioReport;  // print i/o cost of each tracking cycle
+    double   maxWallTime; // fail if the run takes longer (s). 0 for no limit
+} SimOptions_t;
+
+// Ideal diode - same parameters as ShockleyData.py used in unit tests
+static const SimPvParams_t dutParams = SIM_PV_IDEAL_DIODE;
+// sense resistor chosen so that the light current is 80% of adc full scale
+static const double dutTransimpedance = 0.8 * SIM_MX7705_VREF / dutParams.iL;
+static SimPvDevice_t duts[SIM_MX7705_CHANNELS];
+
+// Channel table in LifeTester.cpp - a channel for each adc input
+extern LifeTester_t channels[SIM_MX7705_CHANNELS];
+
+// Current from the device connected to the dac channel at the voltage it sets
+static double GetDutCurrent(uint8_t channel)
+{
+    const double v = SimMCP4802_GetVoltage(channel);
+    const double t = SimClock_GetMicros() / 1.0E6;
+    return SimPv_MeasureCurrent(&duts[channel], v, t);
+}
+
+static uint16_t ReadLightSensor(uint8_t pin)
+{
+    return LIGHT_SENSOR_READING;
+}
+
+static void PrintUsage(const char *name)
+{
+    fprintf(stderr,
+        "usage: %s [-t seconds] [-i idle_tick_ms] [-q] [-c] [-w seconds]\n"
+        "  -t  virtual time to simulate (default %u s)\n"
+        "  -i  time added to the clock when the firmware is idle with no timer\n"
+        "      or adc conversion due (default %u ms)\n"
+        "  -q  discard serial output from the firmware\n"
+        "  -c  print spi bytes, chip select toggles, delays and adc polls\n"
+        "      by state at the end of each tracking cycle\n"
+        "  -w  exit with an error if the run takes longer than this (wall\n"
+        "      clock seconds)\n",
+        name, DEFAULT_DURATION_S, DEFAULT_IDLE_TICK_MS);
+}
+
+static bool ParseOptions(int argc, char **argv, SimOptions_t *options)
+{
+    options->duration = DEFAULT_DURATION_S;
+    options->idleTick = DEFAULT_IDLE_TICK_MS;
+    options->quiet = false;
+    options->ioReport = false;
+    options->maxWallTime = 0.0;
+    for (int i = 1; i < argc; i++)
+    {
+        const bool hasValue = (i + 1) < argc;
+        if ((strcmp(argv[i], "-t") == 0) && hasValue)
+        {
+            options->duration = strtoul(argv[++i], NULL, 0);
+        }
+        else if ((strcmp(argv[i], "-i") == 0) && hasValue)
+        {
+            options->idleTick = strtoul(argv[++i], NULL, 0);
+        }
+        else if ((strcmp(argv[i], "-w") == 0) && hasValue)
+        {
+            options->maxWallTime = strtod(argv[++i], NULL);
+        }
+        else if (strcmp(argv[i], "-q") == 0)
+        {
+            options->quiet = true;
+        }
+        else if (strcmp(argv[i], "-c") == 0)
+        {
+            options->ioReport = true;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return (options->idleTick > 0U);
+}
+
+static void AttachPeripherals(void)
+{
+    for (uint8_t ch = 0U; ch < SIM_MX7705_CHANNELS; ch++)
+    {
+        SimPv_Init(&duts[ch], &dutParams, NULL, NULL, NULL);
+    }
+    SimMCP4802_Attach(DAC_CS_PIN);
+    const SimMX7705Config_t adcConfig = {
+        SIM_MX7705_MASTER_CLOCK,
+        SIM_MX7705_VREF,
+        dutTransimpedance,
+        GetDutCurrent,
+        SimClock_GetMicros
+    };
+    SimMX7705_Reset(&adcConfig);
+    SimSpi_AttachDevice(ADC_CS_PIN, &simMX7705Device);
+    SimTC77_Attach(TEMP_CS_PIN);
+    SimIo_AttachAnalogInput(LIGHT_SENSOR_PIN, ReadLightSensor);
+}
+
+int main(int argc, char **argv)
+{
+    SimOptions_t options;
+    if (!ParseOptions(argc, argv, &options))
+    {
+        PrintUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (options.quiet && (freopen("/dev/null", "w", stdout) == NULL))
+    {
+        perror("freopen");
+        return EXIT_FAILURE;
+    }
+
+    const clock_t wallStart = clock();
+    SimClock_Reset();
+    AttachPeripherals();
+    setup();
+    // both channels share the board's stats
+    IoStats_SetCycleReport(channels[0].ioStats, options.ioReport);
+    SimLoop_Run(loop, channels, SIM_MX7705_CHANNELS,
+                (uint64_t)options.duration * 1000U, options.idleTick);
+    fflush(stdout);
+
+    const double wallTime = (double)(clock() - wallStart) / CLOCKS_PER_SEC;
+    const double simTime = SimClock_GetMillis() / 1000.0;
+    fprintf(stderr, "simulated %.0f s in %.2f s (%.0fx real time)\n",
+            simTime, wallTime, (wallTime > 0.0) ? (simTime / wallTime) : 0.0);
+    if ((options.maxWallTime > 0.0) && (wallTime > options.maxWallTime))
+    {
+        fprintf(stderr, "slower than the %.1f s limit\n", options.maxWallTime);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,12 @@
+/*
+ Host replacement for Arduino.h used by the native simulation build only. The
+ real header is pulled in with UNIT_TEST defined (no avr includes) and a host
+ implementation of the Serial object is added on top.
+*/
+#ifndef SIM_ARDUINO_H
+#define SIM_ARDUINO_H
+
+#include "../../Arduino/Arduino.h"
+#include "SimSerial.h"
+
+#endif // SIM_ARDUINO_H
@@ -0,0 +1,34 @@
+/*
+ Host replacement for the arduino SPI library used by the native simulation
+ build. Bytes are routed to the simulated peripheral whose chip select line is
+ held low and the virtual clock is advanced by the time taken to shift them out.
+*/
+#ifndef _SPI_H_INCLUDED
+#define _SPI_H_INCLUDED
+
+#include <Arduino.h>
+#include "SpiConfig.h"
+
+class SPISettings {
+  public:
+    SPISettings(uint32_t clock, uint8_t bitOrder, uint8_t dataMode)
+        : clock(clock), bitOrder(bitOrder), dataMode(dataMode) {}
+    SPISettings()
+        : clock(4000000), bitOrder(MSBFIRST), dataMode(SPI_MODE0) {}
+    uint32_t clock;
+    uint8_t  bitOrder;
+    uint8_t  dataMode;
+};
+
+class SPIClass {
+  public:
+    static void begin();
+    static void beginTransaction(SPISettings settings);
+    static uint8_t transfer(uint8_t data);
+    static void endTransaction(void);
+    static void end();
+};
+
+extern SPIClass SPI;
+
+#endif
@@ -0,0 +1,57 @@
+#include "Arduino.h"
+#include "SimClock.h"
+
+// microseconds elapsed since the clock was reset
+static uint64_t clockMicros = 0U;
+
+void SimClock_Reset(void)
+{
+    clockMicros = 0U;
+}
+
+void SimClock_AdvanceMicros(uint32_t dt)
+{
+    clockMicros += dt;
+}
+
+void SimClock_AdvanceMillis(uint32_t dt)
+{
+    clockMicros += (uint64_t)dt * 1000U;
+}
+
+uint64_t SimClock_GetMicros(void)
+{
+    return clockMicros;
+}
+
+uint64_t SimClock_GetMillis(void)
+{
+    return clockMicros / 1000U;
+}
+
+/*******************************************************************************
+* ARDUINO TIME FUNCTIONS
+*******************************************************************************/
+/*
+ millis and micros are truncated to 32 bits so that they overflow at the same
+ point as on the atmega328 (~49 days and ~71 minutes respectively).
+*/
+unsigned long millis(void)
+{
+    return (uint32_t)(clockMicros / 1000U);
+}
+
+unsigned long micros(void)
+{
+    return (uint32_t)clockMicros;
+}
+
+void delay(unsigned long ms)
+{
+    SimClock_AdvanceMillis(ms);
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    SimClock_AdvanceMicros(us);
+}
@@ -0,0 +1,36 @@
+/*
+ Virtual clock for the native simulation build. Replaces the arduino time
+ functions millis(), micros(), delay() and delayMicroseconds(). Time only moves
+ when something advances it - blocking delays and modelled bus transfers jump
+ the clock forward instead of sleeping so that days of tracking can be replayed
+ in seconds.
+*/
+#ifndef SIMCLOCK_H
+#define SIMCLOCK_H
+
+#ifdef _cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+// Resets virtual time to zero
+void SimClock_Reset(void);
+
+// Moves virtual time forward by the given number of microseconds
+void SimClock_AdvanceMicros(uint32_t dt);
+
+// Moves virtual time forward by the given number of milliseconds
+void SimClock_AdvanceMillis(uint32_t dt);
+
+// Total virtual time elapsed since reset in microseconds. Never wraps.
+uint64_t SimClock_GetMicros(void);
+
+// Total virtual time elapsed since reset in milliseconds. Never wraps.
+uint64_t SimClock_GetMillis(void);
+
+#ifdef _cplusplus
+}
+#endif
+
+#endif // SIMCLOCK_H
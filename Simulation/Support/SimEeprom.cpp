@@ -0,0 +1,49 @@
+#include "EEPROM.h"
+#include "SimEeprom.h"
+#include <string.h> // memset
+
+static uint8_t  eeprom[SIM_EEPROM_SIZE];
+static uint32_t writes[SIM_EEPROM_SIZE];
+static bool     erased = false;
+
+// Memory starts erased without needing an explicit call at startup
+static void EraseOnFirstUse(void)
+{
+    if (!erased)
+    {
+        SimEeprom_Erase();
+    }
+}
+
+void SimEeprom_Erase(void)
+{
+    memset(eeprom, 0xFF, sizeof(eeprom));
+    memset(writes, 0, sizeof(writes));
+    erased = true;
+}
+
+uint32_t SimEeprom_GetWrites(uint16_t idx)
+{
+    return (idx < SIM_EEPROM_SIZE) ? writes[idx] : 0U;
+}
+
+uint8_t EEPROMClass::read(int idx)
+{
+    EraseOnFirstUse();
+    return ((idx >= 0) && (idx < (int)SIM_EEPROM_SIZE)) ? eeprom[idx] : 0xFFU;
+}
+
+void EEPROMClass::update(int idx, uint8_t val)
+{
+    EraseOnFirstUse();
+    if ((idx >= 0) && (idx < (int)SIM_EEPROM_SIZE) && (eeprom[idx] != val))
+    {
+        eeprom[idx] = val;
+        writes[idx]++;
+    }
+}
+
+uint16_t EEPROMClass::length()
+{
+    return SIM_EEPROM_SIZE;
+}
@@ -0,0 +1,27 @@
+/*
+ Simulated eeprom for the native simulation build. Implements the EEPROM object
+ from EEPROM.h on top of a ram array that starts erased (0xFF) and counts the
+ writes to each byte so that wear can be checked.
+*/
+#ifndef SIMEEPROM_H
+#define SIMEEPROM_H
+
+#ifdef _cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#define SIM_EEPROM_SIZE         (1024U)  // atmega328p
+
+// Erases every byte back to 0xFF and clears the write counts
+void SimEeprom_Erase(void);
+
+// Number of times a byte has been written since the last erase
+uint32_t SimEeprom_GetWrites(uint16_t idx);
+
+#ifdef _cplusplus
+}
+#endif
+
+#endif // SIMEEPROM_H
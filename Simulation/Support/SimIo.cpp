@@ -0,0 +1,99 @@
+#include "Arduino.h"
+#include "SimIo.h"
+#include <stdio.h>
+
+typedef struct SimPin_s {
+    uint8_t             mode;
+    uint8_t             level;
+    SimPinListenerFn_t *listener;
+} SimPin_t;
+
+static SimPin_t            digitalPins[SIM_N_DIGITAL_PINS];
+static SimAnalogInputFn_t *analogInputs[SIM_N_ANALOG_PINS];
+
+static bool DigitalPinValid(uint8_t pin)
+{
+    if (pin >= SIM_N_DIGITAL_PINS)
+    {
+        fprintf(stderr, "SimIo: digital pin %u out of range\n", pin);
+        return false;
+    }
+    return true;
+}
+
+void SimIo_Reset(void)
+{
+    memset(digitalPins, 0U, sizeof(digitalPins));
+    memset(analogInputs, 0U, sizeof(analogInputs));
+}
+
+void SimIo_AttachPinListener(uint8_t pin, SimPinListenerFn_t *listener)
+{
+    if (DigitalPinValid(pin))
+    {
+        digitalPins[pin].listener = listener;
+    }
+}
+
+void SimIo_AttachAnalogInput(uint8_t pin, SimAnalogInputFn_t *input)
+{
+    if (pin < SIM_N_ANALOG_PINS)
+    {
+        analogInputs[pin] = input;
+    }
+}
+
+bool SimIo_IsPinHigh(uint8_t pin)
+{
+    return DigitalPinValid(pin) && (digitalPins[pin].level == HIGH);
+}
+
+bool SimIo_IsPinDrivenLow(uint8_t pin)
+{
+    return DigitalPinValid(pin)
+           && (digitalPins[pin].mode == OUTPUT)
+           && (digitalPins[pin].level == LOW);
+}
+
+/*******************************************************************************
+* ARDUINO PIN FUNCTIONS
+*******************************************************************************/
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    if (DigitalPinValid(pin))
+    {
+        digitalPins[pin].mode = mode;
+    }
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+    if (DigitalPinValid(pin))
+    {
+        SimPin_t *const p = &digitalPins[pin];
+        const uint8_t level = (value == LOW) ? LOW : HIGH;
+        const bool changed = (p->level != level);
+        p->level = level;
+        if (changed && (p->listener != NULL))
+        {
+            p->listener(pin, level);
+        }
+    }
+}
+
+int digitalRead(uint8_t pin)
+{
+    return SimIo_IsPinHigh(pin) ? HIGH : LOW;
+}
+
+int analogRead(uint8_t pin)
+{
+    const bool connected = (pin < SIM_N_ANALOG_PINS)
+                           && (analogInputs[pin] != NULL);
+    return connected ? analogInputs[pin](pin) : 0;
+}
+
+void analogWrite(uint8_t pin, int val)
+{
+    digitalWrite(pin, (val > 0) ? HIGH : LOW);
+}
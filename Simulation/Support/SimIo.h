@@ -0,0 +1,44 @@
+/*
+ Simulated digital and analog pins for the native simulation build. Implements
+ the arduino pin functions and lets simulated peripherals listen to output pins
+ (eg. chip select lines) and drive analog inputs (eg. the light sensor).
+*/
+#ifndef SIMIO_H
+#define SIMIO_H
+
+#ifdef _cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SIM_N_DIGITAL_PINS      (20U)
+#define SIM_N_ANALOG_PINS       (6U)
+
+// Called whenever the level of a digital output pin changes
+typedef void SimPinListenerFn_t(uint8_t pin, uint8_t level);
+
+// Returns a 10-bit analog reading for the pin
+typedef uint16_t SimAnalogInputFn_t(uint8_t pin);
+
+// Clears all pin states, listeners and analog inputs
+void SimIo_Reset(void);
+
+// Registers a function to be called when a digital pin changes level
+void SimIo_AttachPinListener(uint8_t pin, SimPinListenerFn_t *listener);
+
+// Registers a function that supplies analogRead values for the pin
+void SimIo_AttachAnalogInput(uint8_t pin, SimAnalogInputFn_t *input);
+
+// Returns the level last written to a digital pin
+bool SimIo_IsPinHigh(uint8_t pin);
+
+// Returns true if the pin has been configured as an output and is driven low
+bool SimIo_IsPinDrivenLow(uint8_t pin);
+
+#ifdef _cplusplus
+}
+#endif
+
+#endif // SIMIO_H
@@ -0,0 +1,78 @@
+#include "Arduino.h"
+#include "SimClock.h"
+#include "SimLoop.h"
+#include "SimMX7705.h"
+#include "StateMachine.h"
+
+#define NOTHING_DUE     (UINT64_MAX)
+
+// Time the next timer on the wheel is due (us) or NOTHING_DUE
+static uint64_t GetNextTimer(TimerWheel_t const *timers)
+{
+    const uint32_t tNext = TimerWheel_TimeToNext(timers);
+    if (tNext == TIMER_WHEEL_IDLE)
+    {
+        return NOTHING_DUE;
+    }
+    // the wheel counts from its last service which may be behind the clock
+    const int32_t tLeft = (int32_t)(TimerWheel_Now(timers) + tNext - millis());
+    const uint64_t tDue = SimClock_GetMillis() + ((tLeft > 0) ? tLeft : 0);
+    return tDue * 1000U;
+}
+
+// Time DRDY next goes low (us) or NOTHING_DUE
+static uint64_t GetNextConversion(void)
+{
+    const uint32_t tReady = SimMX7705_GetTimeToReady();
+    return (tReady == SIM_MX7705_NOT_CONVERTING) ?
+        NOTHING_DUE : SimClock_GetMicros() + tReady;
+}
+
+bool SimLoop_SkipIdle(TimerWheel_t const *timers,
+                      LifeTester_t const *channels,
+                      uint8_t nChannels,
+                      uint32_t idleTick)
+{
+    bool waiting = true;
+    for (uint8_t i = 0U; i < nChannels; i++)
+    {
+        waiting = waiting && StateMachine_Waiting(&channels[i]);
+    }
+    const uint64_t tConversion = GetNextConversion();
+    const uint64_t tNow = SimClock_GetMicros();
+    // a channel that isn't waiting on a timer is polling the adc
+    if (!waiting && (tConversion <= tNow))
+    {
+        return false;
+    }
+
+    const uint64_t tTimer = GetNextTimer(timers);
+    const uint64_t tNext = waiting ?
+        tTimer : ((tTimer < tConversion) ? tTimer : tConversion);
+    if (tNext == NOTHING_DUE)
+    {
+        SimClock_AdvanceMillis(idleTick);
+    }
+    else if (tNext > tNow)
+    {
+        SimClock_AdvanceMicros((uint32_t)(tNext - tNow));
+    }
+    else
+    {
+        // overdue timer - serviced on the next pass
+    }
+    return true;
+}
+
+void SimLoop_Run(SimLoopFn_t *pass,
+                 LifeTester_t const *channels,
+                 uint8_t nChannels,
+                 uint64_t tEnd,
+                 uint32_t idleTick)
+{
+    while (SimClock_GetMillis() < tEnd)
+    {
+        pass();
+        SimLoop_SkipIdle(channels[0].timers, channels, nChannels, idleTick);
+    }
+}
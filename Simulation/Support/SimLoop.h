@@ -0,0 +1,45 @@
+/*
+ Runs the firmware against the virtual clock. On its own the firmware only moves
+ the clock by the few us of spi traffic in each pass of its loop. Passes where
+ it can only wait - every channel waiting on a timer, or the adc without a new
+ conversion - skip the clock straight to the next timer or DRDY edge instead of
+ crawling there a poll at a time.
+*/
+#ifndef SIMLOOP_H
+#define SIMLOOP_H
+
+#ifdef _cplusplus
+extern "C" {
+#endif
+
+#include "LifeTesterTypes.h"
+#include "TimerWheel.h"
+#include <stdint.h>
+
+/*
+ Call after each pass of the firmware's loop. If the firmware is idle the clock
+ moves to the next timer due on the wheel or, unless every channel is waiting
+ on a timer, the adc's next conversion if that's sooner. idleTick (ms) is used
+ if neither is due. Returns false and leaves the clock alone if the firmware
+ isn't idle.
+*/
+bool SimLoop_SkipIdle(TimerWheel_t const *timers,
+                      LifeTester_t const *channels,
+                      uint8_t nChannels,
+                      uint32_t idleTick);
+
+// A pass of the firmware's main loop eg. loop() from LifeTester.cpp
+typedef void SimLoopFn_t(void);
+
+// Runs passes of the main loop until the clock reaches tEnd (ms)
+void SimLoop_Run(SimLoopFn_t *pass,
+                 LifeTester_t const *channels,
+                 uint8_t nChannels,
+                 uint64_t tEnd,
+                 uint32_t idleTick);
+
+#ifdef _cplusplus
+}
+#endif
+
+#endif // SIMLOOP_H
@@ -0,0 +1,128 @@
+#include "SimSerial.h"
+#include <stdio.h>
+#include <string.h>
+
+SimSerial Serial;
+
+static FILE *output = stdout;
+
+void SimSerial_SetOutput(FILE *out)
+{
+    output = out;
+}
+
+void SimSerial::begin(unsigned long baud)
+{
+    // nothing to configure on the host
+}
+
+size_t SimSerial::printNumber(unsigned long n, int base)
+{
+    char buf[8U * sizeof(long) + 1U];
+    char *str = &buf[sizeof(buf) - 1U];
+    *str = '\0';
+    if (base < 2)
+    {
+        base = DEC;
+    }
+    do
+    {
+        const char digit = n % base;
+        n /= base;
+        *--str = (digit < 10) ? (digit + '0') : (digit + 'A' - 10);
+    } while (n);
+    return print(str);
+}
+
+size_t SimSerial::print(const char str[])
+{
+    if (output != NULL)
+    {
+        fputs(str, output);
+    }
+    return strlen(str);
+}
+
+size_t SimSerial::print(char c)
+{
+    return (output != NULL) ? (size_t)(putc(c, output) != EOF) : 1U;
+}
+
+size_t SimSerial::print(unsigned char n, int base)
+{
+    return printNumber(n, base);
+}
+
+size_t SimSerial::print(int n, int base)
+{
+    return print((long)n, base);
+}
+
+size_t SimSerial::print(unsigned int n, int base)
+{
+    return printNumber(n, base);
+}
+
+size_t SimSerial::print(long n, int base)
+{
+    if ((base == DEC) && (n < 0))
+    {
+        return print('-') + printNumber(-n, base);
+    }
+    return printNumber(n, base);
+}
+
+size_t SimSerial::print(unsigned long n, int base)
+{
+    return printNumber(n, base);
+}
+
+size_t SimSerial::print(double n, int digits)
+{
+    return (output != NULL) ? (size_t)fprintf(output, "%.*f", digits, n) : 0U;
+}
+
+size_t SimSerial::println(void)
+{
+    return print('\n');
+}
+
+size_t SimSerial::println(const char str[])
+{
+    return print(str) + println();
+}
+
+size_t SimSerial::println(char c)
+{
+    return print(c) + println();
+}
+
+size_t SimSerial::println(unsigned char n, int base)
+{
+    return print(n, base) + println();
+}
+
+size_t SimSerial::println(int n, int base)
+{
+    return print(n, base) + println();
+}
+
+size_t SimSerial::println(unsigned int n, int base)
+{
+    return print(n, base) + println();
+}
+
+size_t SimSerial::println(long n, int base)
+{
+    return print(n, base) + println();
+}
+
+size_t SimSerial::println(unsigned long n, int base)
+{
+    return print(n, base) + println();
+}
+
+size_t SimSerial::println(double n, int digits)
+{
+    return print(n, digits) + println();
+}
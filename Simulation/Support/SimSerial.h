@@ -0,0 +1,43 @@
+/*
+ Minimal host implementation of the arduino Serial port. Output is written to
+ stdout in the same format as the arduino Print class.
+*/
+#ifndef SIMSERIAL_H
+#define SIMSERIAL_H
+
+#include "Print.h" // DEC, HEX, OCT, BIN
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+class SimSerial
+{
+  public:
+    void begin(unsigned long baud);
+    size_t print(const char str[]);
+    size_t print(char c);
+    size_t print(unsigned char n, int base = DEC);
+    size_t print(int n, int base = DEC);
+    size_t print(unsigned int n, int base = DEC);
+    size_t print(long n, int base = DEC);
+    size_t print(unsigned long n, int base = DEC);
+    size_t print(double n, int digits = 2);
+    size_t println(void);
+    size_t println(const char str[]);
+    size_t println(char c);
+    size_t println(unsigned char n, int base = DEC);
+    size_t println(int n, int base = DEC);
+    size_t println(unsigned int n, int base = DEC);
+    size_t println(long n, int base = DEC);
+    size_t println(unsigned long n, int base = DEC);
+    size_t println(double n, int digits = 2);
+  private:
+    size_t printNumber(unsigned long n, int base);
+};
+
+extern SimSerial Serial;
+
+// Sends serial output to out instead of stdout. NULL discards it.
+void SimSerial_SetOutput(FILE *out);
+
+#endif // SIMSERIAL_H
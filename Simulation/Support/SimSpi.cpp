@@ -0,0 +1,120 @@
+#include "Arduino.h"
+#include "SimClock.h"
+#include "SimIo.h"
+#include "SimSpi.h"
+#include "SPI.h"
+#include <stdio.h>
+
+#define SPI_MAX_CLOCK           (8000000UL)  // F_CPU / 2 on the atmega328
+#define NO_DEVICE_BYTE          (0xFFU)      // miso is pulled high when floating
+
+SPIClass SPI;
+
+static SimSpiDevice_t const *devices[SIM_N_DIGITAL_PINS];
+static uint32_t clockSpeed = SPI_MAX_CLOCK;
+static uint32_t residualNanos; // part of a microsecond not yet added to clock
+
+/*
+ The avr spi clock is derived from F_CPU by a power of two divider so the
+ requested speed is rounded down to the nearest available rate.
+*/
+static uint32_t GetAvrClockSpeed(uint32_t requested)
+{
+    uint32_t speed = SPI_MAX_CLOCK;
+    while ((speed > requested) && (speed > (SPI_MAX_CLOCK / 64U)))
+    {
+        speed /= 2U;
+    }
+    return speed;
+}
+
+static void ChipSelectChanged(uint8_t pin, uint8_t level)
+{
+    SimSpiDevice_t const *const device = devices[pin];
+    if (level == LOW)
+    {
+        if (device->select != NULL)
+        {
+            device->select();
+        }
+    }
+    else
+    {
+        if (device->deselect != NULL)
+        {
+            device->deselect();
+        }
+    }
+}
+
+void SimSpi_AttachDevice(uint8_t chipSelectPin, SimSpiDevice_t const *device)
+{
+    if (chipSelectPin < SIM_N_DIGITAL_PINS)
+    {
+        devices[chipSelectPin] = device;
+        SimIo_AttachPinListener(chipSelectPin, ChipSelectChanged);
+    }
+}
+
+void SimSpi_Reset(void)
+{
+    for (uint8_t pin = 0U; pin < SIM_N_DIGITAL_PINS; pin++)
+    {
+        if (devices[pin] != NULL)
+        {
+            SimIo_AttachPinListener(pin, NULL);
+            devices[pin] = NULL;
+        }
+    }
+    clockSpeed = SPI_MAX_CLOCK;
+    residualNanos = 0U;
+}
+
+/*******************************************************************************
+* ARDUINO SPI LIBRARY
+*******************************************************************************/
+void SPIClass::begin()
+{
+    // nothing to do - bus is always available
+}
+
+void SPIClass::beginTransaction(SPISettings settings)
+{
+    clockSpeed = GetAvrClockSpeed(settings.clock);
+}
+
+uint8_t SPIClass::transfer(uint8_t data)
+{
+    // time taken to clock out 8 bits
+    residualNanos += (8000000000ULL / clockSpeed);
+    SimClock_AdvanceMicros(residualNanos / 1000U);
+    residualNanos %= 1000U;
+
+    uint8_t miso = NO_DEVICE_BYTE;
+    uint8_t nSelected = 0U;
+    for (uint8_t pin = 0U; pin < SIM_N_DIGITAL_PINS; pin++)
+    {
+        SimSpiDevice_t const *const device = devices[pin];
+        if ((device != NULL) && SimIo_IsPinDrivenLow(pin))
+        {
+            miso = device->transfer(data);
+            nSelected++;
+        }
+    }
+    if (nSelected > 1U)
+    {
+        fprintf(stderr, "SimSpi: bus contention - %u devices selected\n",
+                nSelected);
+    }
+    return miso;
+}
+
+void SPIClass::endTransaction(void)
+{
+    // nothing to do
+}
+
+void SPIClass::end()
+{
+    // nothing to do
+}
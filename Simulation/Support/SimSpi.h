@@ -0,0 +1,30 @@
+/*
+ Simulated SPI bus. Peripheral models attach to a chip select pin and are
+ notified when they are selected/deselected and when a byte is transferred.
+*/
+#ifndef SIMSPI_H
+#define SIMSPI_H
+
+#ifdef _cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+typedef struct SimSpiDevice_s {
+    void    (*select)(void);          // chip select falling edge
+    uint8_t (*transfer)(uint8_t mosi); // returns the byte shifted out on miso
+    void    (*deselect)(void);        // chip select rising edge
+} SimSpiDevice_t;
+
+// Connects a simulated peripheral to the bus on the given chip select pin
+void SimSpi_AttachDevice(uint8_t chipSelectPin, SimSpiDevice_t const *device);
+
+// Disconnects all peripherals
+void SimSpi_Reset(void);
+
+#ifdef _cplusplus
+}
+#endif
+
+#endif // SIMSPI_H
@@ -0,0 +1,131 @@
+#include "SimWire.h"
+#include "Wire.h"
+#include <string.h>
+
+TwoWire Wire;
+
+static uint8_t rxBuffer[BUFFER_LENGTH];  // master -> slave
+static uint8_t rxLength;
+static uint8_t rxIndex;
+static uint8_t txBuffer[BUFFER_LENGTH];  // slave -> master
+static uint8_t txLength;
+static uint8_t slaveAddress;
+static void (*receiveHandler)(int);
+static void (*requestHandler)(void);
+
+void SimWire_MasterWrite(uint8_t const *data, uint8_t numBytes)
+{
+    rxLength = (numBytes > BUFFER_LENGTH) ? BUFFER_LENGTH : numBytes;
+    rxIndex = 0U;
+    memcpy(rxBuffer, data, rxLength);
+    if (receiveHandler != NULL)
+    {
+        receiveHandler(rxLength);
+    }
+}
+
+uint8_t SimWire_MasterRead(uint8_t *data, uint8_t maxBytes)
+{
+    txLength = 0U;
+    if (requestHandler != NULL)
+    {
+        requestHandler();
+    }
+    const uint8_t nBytes = (txLength > maxBytes) ? maxBytes : txLength;
+    memcpy(data, txBuffer, nBytes);
+    return nBytes;
+}
+
+uint8_t SimWire_GetSlaveAddress(void)
+{
+    return slaveAddress;
+}
+
+/*******************************************************************************
+* ARDUINO WIRE LIBRARY (SLAVE SIDE)
+*******************************************************************************/
+TwoWire::TwoWire()
+{
+}
+
+void TwoWire::begin()
+{
+    slaveAddress = 0U;
+}
+
+void TwoWire::begin(uint8_t address)
+{
+    slaveAddress = address;
+}
+
+void TwoWire::begin(int address)
+{
+    begin((uint8_t)address);
+}
+
+void TwoWire::end()
+{
+    receiveHandler = NULL;
+    requestHandler = NULL;
+}
+
+void TwoWire::setClock(uint32_t clock)
+{
+    // bus timing is not modelled
+}
+
+size_t TwoWire::write(uint8_t data)
+{
+    if (txLength < BUFFER_LENGTH)
+    {
+        txBuffer[txLength] = data;
+        txLength++;
+        return 1U;
+    }
+    return 0U;
+}
+
+size_t TwoWire::write(const uint8_t *data, size_t quantity)
+{
+    size_t nWritten = 0U;
+    while ((nWritten < quantity) && write(data[nWritten]))
+    {
+        nWritten++;
+    }
+    return nWritten;
+}
+
+int TwoWire::available(void)
+{
+    return rxLength - rxIndex;
+}
+
+int TwoWire::read(void)
+{
+    if (rxIndex < rxLength)
+    {
+        const uint8_t data = rxBuffer[rxIndex];
+        rxIndex++;
+        return data;
+    }
+    return -1;
+}
+
+int TwoWire::peek(void)
+{
+    return (rxIndex < rxLength) ? rxBuffer[rxIndex] : -1;
+}
+
+void TwoWire::flush(void)
+{
+}
+
+void TwoWire::onReceive(void (*function)(int))
+{
+    receiveHandler = function;
+}
+
+void TwoWire::onRequest(void (*function)(void))
+{
+    requestHandler = function;
+}
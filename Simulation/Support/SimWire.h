@@ -0,0 +1,30 @@
+/*
+ Master side of the simulated I2C bus. Calls are delivered synchronously to the
+ handlers registered by the slave with Wire.onReceive/Wire.onRequest.
+*/
+#ifndef SIMWIRE_H
+#define SIMWIRE_H
+
+#ifdef _cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+// Writes bytes from master to slave. Slave receive handler is called.
+void SimWire_MasterWrite(uint8_t const *data, uint8_t numBytes);
+
+/*
+ Requests data from the slave. Slave request handler is called and bytes that
+ it writes are copied into data. Returns the number of bytes received.
+*/
+uint8_t SimWire_MasterRead(uint8_t *data, uint8_t maxBytes);
+
+// Address the slave joined the bus with
+uint8_t SimWire_GetSlaveAddress(void);
+
+#ifdef _cplusplus
+}
+#endif
+
+#endif // SIMWIRE_H
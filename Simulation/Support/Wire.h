@@ -0,0 +1,34 @@
+/*
+ Host replacement for the arduino Wire library used by the native simulation
+ build. The lifetester is always the slave - SimWire.h provides the master side
+ so that simulations can issue commands over the simulated I2C bus.
+*/
+#ifndef TwoWire_h
+#define TwoWire_h
+
+#include <inttypes.h>
+#include <stddef.h>
+#define BUFFER_LENGTH 32
+
+class TwoWire
+{
+  public:
+    TwoWire();
+    void begin();
+    void begin(uint8_t);
+    void begin(int);
+    void end();
+    void setClock(uint32_t);
+    size_t write(uint8_t);
+    size_t write(const uint8_t *, size_t);
+    int available(void);
+    int read(void);
+    int peek(void);
+    void flush(void);
+    void onReceive( void (*)(int) );
+    void onRequest( void (*)(void) );
+};
+
+extern TwoWire Wire;
+
+#endif  // include guard
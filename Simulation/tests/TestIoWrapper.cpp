@@ -0,0 +1,179 @@
+// CppUnit Test framework
+#include "CppUTest/TestHarness.h"
+
+// Code under test
+#include "IoWrapper.h"
+
+// support
+#include "Arduino.h"
+#include "Config.h"
+#include "LifeTesterTypes.h"
+#include "MX7705.h"
+#include "SimClock.h"
+#include "SimMX7705.h"
+#include "SimSpi.h"
+#include <stdlib.h>
+
+#define TRANSIMPEDANCE           (2.0)    // V/A
+#define MAX_DATA_READS           (10U)    // a read gives up after this many
+
+// Conversion time for the clock settings written by AdcInit - 25Hz at 1MHz
+#define CONVERSION_TIME          (40U)    // ms
+
+// Channel table in LifeTester.cpp - both channels are on the same adc
+extern LifeTester_t channels[SIM_MX7705_CHANNELS];
+
+static double inputCurrent[SIM_MX7705_CHANNELS]; // A
+
+static double GetInputCurrent(uint8_t input)
+{
+    return inputCurrent[input];
+}
+
+/*
+ Polls a channel until it returns a sample, jumping the clock to each DRDY edge
+ in between. Returns the number of conversions read from the adc, including
+ those that were thrown away.
+*/
+static uint32_t ReadCurrent(LifeTester_t const *const lifeTester, uint16_t *sample)
+{
+    const uint32_t dataReadsStart = SimMX7705_GetStats()->dataReads;
+    for (uint8_t i = 0U; i < MAX_DATA_READS; i++)
+    {
+        const uint32_t tReady = SimMX7705_GetTimeToReady();
+        CHECK(tReady != SIM_MX7705_NOT_CONVERTING);
+        SimClock_AdvanceMicros(tReady);
+        if (AdcPollLifeTesterCurrent(lifeTester, sample))
+        {
+            break;
+        }
+    }
+    return SimMX7705_GetStats()->dataReads - dataReadsStart;
+}
+
+// Polls a channel at the next DRDY edge without waiting for a sample
+static bool PollAtNextConversion(LifeTester_t const *const lifeTester)
+{
+    uint16_t sample;
+    SimClock_AdvanceMicros(SimMX7705_GetTimeToReady());
+    return AdcPollLifeTesterCurrent(lifeTester, &sample);
+}
+
+// Sample is the code the input settles to - the filter can be a us short of it
+static void CheckSampleSettled(uint8_t input, uint16_t sample)
+{
+    CHECK(abs((int32_t)sample - (int32_t)SimMX7705_GetSettledCode(input)) <= 1);
+}
+
+TEST_GROUP(IoWrapperTestGroup)
+{
+    void setup(void)
+    {
+        const SimMX7705Config_t adcConfig = {
+            SIM_MX7705_MASTER_CLOCK,
+            SIM_MX7705_VREF,
+            TRANSIMPEDANCE,
+            GetInputCurrent,
+            SimClock_GetMicros
+        };
+        inputCurrent[0] = 0.25;
+        inputCurrent[1] = 0.5;
+        SimClock_Reset();
+        SimSpi_Reset();
+        SimMX7705_Reset(&adcConfig);
+        SimSpi_AttachDevice(ADC_CS_PIN, &simMX7705Device);
+        AdcInit(channels[0].io.adcDevice, ADC_CS_PIN, channels[0].ioStats);
+    }
+
+    void teardown(void)
+    {
+        for (uint8_t ch = 0U; ch < SIM_MX7705_CHANNELS; ch++)
+        {
+            AdcCancelLifeTesterRead(&channels[ch]);
+        }
+    }
+};
+
+/*
+ Switching the mux to another input throws away MX7705_MUX_SETTLE_CONVERSIONS
+ conversions. The sample returned after them is the settled input.
+*/
+TEST(IoWrapperTestGroup, MuxSwitchThrowsAwaySettleConversions)
+{
+    uint16_t sample;
+    CHECK_EQUAL(MX7705_MUX_SETTLE_CONVERSIONS + 1U, ReadCurrent(&channels[0], &sample));
+    CheckSampleSettled(0U, sample);
+    CHECK_EQUAL(MX7705_MUX_SETTLE_CONVERSIONS + 1U, ReadCurrent(&channels[1], &sample));
+    CheckSampleSettled(1U, sample);
+    CHECK_EQUAL(MX7705_MUX_SETTLE_CONVERSIONS + 1U, ReadCurrent(&channels[0], &sample));
+    CheckSampleSettled(0U, sample);
+}
+
+// Reads that stay on the same input use the first conversion
+TEST(IoWrapperTestGroup, SameInputThrowsNothingAway)
+{
+    uint16_t sample;
+    (void)ReadCurrent(&channels[0], &sample);
+    for (uint8_t i = 0U; i < 3U; i++)
+    {
+        CHECK_EQUAL(1U, ReadCurrent(&channels[0], &sample));
+        CheckSampleSettled(0U, sample);
+    }
+    // closing a read after it's settled doesn't start settling again
+    AdcCancelLifeTesterRead(&channels[0]);
+    CHECK_EQUAL(1U, ReadCurrent(&channels[0], &sample));
+}
+
+/*
+ A read cancelled while the mux settles doesn't leave the count part way
+ through. The next read on the same input throws the whole lot away.
+*/
+TEST(IoWrapperTestGroup, CancelWhileSettlingStartsSettlingAgain)
+{
+    uint16_t sample;
+    CHECK_FALSE(PollAtNextConversion(&channels[0]));
+    CHECK_EQUAL(MX7705_MUX_SETTLE_CONVERSIONS - 1U,
+                channels[0].io.adcDevice->muxSettleReads);
+    AdcCancelLifeTesterRead(&channels[0]);
+    CHECK_EQUAL(MX7705_MUX_SETTLE_CONVERSIONS + 1U, ReadCurrent(&channels[0], &sample));
+    CheckSampleSettled(0U, sample);
+}
+
+/*
+ Opening a window drops another channel's read, part way through settling or
+ not. The window's owner starts settling from the beginning, even on the input
+ the dropped read was settling onto.
+*/
+TEST(IoWrapperTestGroup, WindowHandoverStartsSettlingAgain)
+{
+    uint16_t sample;
+    CHECK_FALSE(PollAtNextConversion(&channels[0]));
+    CHECK(AdcClaimSampleWindow(&channels[1]));
+    // other channel's read was dropped and it's locked out until the window closes
+    CHECK_FALSE(AdcPollLifeTesterCurrent(&channels[0], &sample));
+    CHECK_EQUAL(MX7705_MUX_SETTLE_CONVERSIONS + 1U, ReadCurrent(&channels[1], &sample));
+    CheckSampleSettled(1U, sample);
+    AdcCancelLifeTesterRead(&channels[1]);
+
+    CHECK_FALSE(PollAtNextConversion(&channels[0]));
+    CHECK(AdcClaimSampleWindow(&channels[0]));
+    CHECK_EQUAL(MX7705_MUX_SETTLE_CONVERSIONS + 1U, ReadCurrent(&channels[0], &sample));
+    CheckSampleSettled(0U, sample);
+    // the window's own reads don't hand anything over
+    CHECK(AdcClaimSampleWindow(&channels[0]));
+    CHECK_EQUAL(1U, ReadCurrent(&channels[0], &sample));
+}
+
+// Time to settle is the conversions still to be thrown away for that input
+TEST(IoWrapperTestGroup, MuxSettleTimeIsConversionsStillToThrowAway)
+{
+    uint16_t sample;
+    const uint16_t tMuxSettle = MX7705_MUX_SETTLE_CONVERSIONS * CONVERSION_TIME;
+    CHECK_EQUAL(tMuxSettle, AdcGetMuxSettleTime(&channels[0]));
+    (void)ReadCurrent(&channels[0], &sample);
+    CHECK_EQUAL(0U, AdcGetMuxSettleTime(&channels[0]));
+    CHECK_EQUAL(tMuxSettle, AdcGetMuxSettleTime(&channels[1]));
+    CHECK_FALSE(PollAtNextConversion(&channels[1]));
+    CHECK_EQUAL(tMuxSettle - CONVERSION_TIME, AdcGetMuxSettleTime(&channels[1]));
+    CHECK_EQUAL(tMuxSettle, AdcGetMuxSettleTime(&channels[0]));
+}
@@ -0,0 +1,136 @@
+// CppUnit Test framework
+#include "CppUTest/TestHarness.h"
+
+// Code under test
+#include "MppStore.h"
+
+// support
+#include "EEPROM.h"     // implemented by the simulated eeprom
+#include "SimEeprom.h"
+
+#define RING_SIZE    (MPP_STORE_SLOTS * MPP_STORE_RECORD_SIZE)
+
+static MppStore_t store;
+
+static uint16_t SlotAddress(uint8_t channel, uint8_t slot)
+{
+    return MPP_STORE_BASE + channel * RING_SIZE + slot * MPP_STORE_RECORD_SIZE;
+}
+
+static MppRecord_t MakeRecord(uint8_t v)
+{
+    const MppRecord_t record = {v, (uint32_t)(1000U * v + 0x12345678U), 0U};
+    return record;
+}
+
+static void CheckRecordsEqual(MppRecord_t const *expected,
+                              MppRecord_t const *actual)
+{
+    CHECK_EQUAL(expected->v, actual->v);
+    CHECK_EQUAL(expected->p, actual->p);
+    CHECK_EQUAL(expected->error, actual->error);
+}
+
+TEST_GROUP(MppStoreTestGroup)
+{
+    void setup(void)
+    {
+        SimEeprom_Erase();
+        MppStore_Init(&store, MPP_STORE_BASE, MPP_STORE_CHANNELS);
+    }
+
+    void teardown(void)
+    {
+    }
+};
+
+// Nothing has been stored so there's no warm start
+TEST(MppStoreTestGroup, LoadFromErasedEepromFails)
+{
+    MppRecord_t record;
+    CHECK(!MppStore_Load(&store, 0U, &record));
+    CHECK(!MppStore_Load(&store, 1U, &record));
+}
+
+// Each channel gets back what it stored last
+TEST(MppStoreTestGroup, LoadReturnsLastRecordSavedForChannel)
+{
+    const MppRecord_t a = MakeRecord(58U);
+    const MppRecord_t b = {61U, 0xCAFEU, 4U};
+    MppStore_Save(&store, 0U, &a);
+    MppStore_Save(&store, 1U, &b);
+    MppRecord_t record;
+    CHECK(MppStore_Load(&store, 0U, &record));
+    CheckRecordsEqual(&a, &record);
+    CHECK(MppStore_Load(&store, 1U, &record));
+    CheckRecordsEqual(&b, &record);
+    // channels outside the store are ignored
+    MppStore_Save(&store, MPP_STORE_CHANNELS, &a);
+    CHECK(!MppStore_Load(&store, MPP_STORE_CHANNELS, &record));
+}
+
+/*
+ Saves go round the ring so every slot takes the same share of writes. Runs long
+ enough for the sequence number to wrap.
+*/
+TEST(MppStoreTestGroup, SavesAreSpreadEvenlyOverTheRing)
+{
+    const uint16_t nLaps = 20U;
+    MppRecord_t last;
+    for (uint16_t i = 0U; i < (nLaps * MPP_STORE_SLOTS); i++)
+    {
+        last = MakeRecord((uint8_t)i);
+        MppStore_Save(&store, 0U, &last);
+    }
+    for (uint8_t slot = 0U; slot < MPP_STORE_SLOTS; slot++)
+    {
+        // sequence number changes on every write to the slot
+        CHECK_EQUAL(nLaps, SimEeprom_GetWrites(SlotAddress(0U, slot)));
+    }
+    MppRecord_t record;
+    CHECK(MppStore_Load(&store, 0U, &record));
+    CheckRecordsEqual(&last, &record);
+    // other channel untouched
+    CHECK_EQUAL(0U, SimEeprom_GetWrites(SlotAddress(1U, 0U)));
+}
+
+// A slot that fails its checksum (eg. reset part way through a save) is skipped
+TEST(MppStoreTestGroup, CorruptNewestRecordFallsBackToPrevious)
+{
+    const MppRecord_t older = MakeRecord(40U);
+    const MppRecord_t newer = MakeRecord(41U);
+    MppStore_Save(&store, 0U, &older);
+    MppStore_Save(&store, 0U, &newer);
+    const uint16_t vAddress = SlotAddress(0U, 1U) + 1U;
+    EEPROM.update(vAddress, EEPROM.read(vAddress) ^ 0x01U);
+    MppRecord_t record;
+    CHECK(MppStore_Load(&store, 0U, &record));
+    CheckRecordsEqual(&older, &record);
+    // the next save goes after the newest valid record
+    MppStore_Save(&store, 0U, &newer);
+    CHECK(MppStore_Load(&store, 0U, &record));
+    CheckRecordsEqual(&newer, &record);
+}
+
+// Stores placed apart in eeprom keep their own records for the same channel
+TEST(MppStoreTestGroup, StoresDontShareRecords)
+{
+    MppStore_t other;
+    MppStore_Init(&other, MPP_STORE_BASE + RING_SIZE, 1U);
+    const MppRecord_t a = MakeRecord(30U);
+    const MppRecord_t b = MakeRecord(31U);
+    MppStore_Save(&store, 0U, &a);
+    MppStore_Save(&other, 0U, &b);
+    MppRecord_t record;
+    CHECK(MppStore_Load(&store, 0U, &record));
+    CheckRecordsEqual(&a, &record);
+    CHECK(MppStore_Load(&other, 0U, &record));
+    CheckRecordsEqual(&b, &record);
+    // the other store's ring is where channel 1 of the first one would be
+    CHECK(MppStore_Load(&store, 1U, &record));
+    CheckRecordsEqual(&b, &record);
+    // only one ring in the other store, and no store at all saves nothing
+    MppStore_Save(&other, 1U, &a);
+    CHECK(!MppStore_Load(&other, 1U, &record));
+    CHECK(!MppStore_Load(NULL, 0U, &record));
+}
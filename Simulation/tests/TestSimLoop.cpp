@@ -0,0 +1,84 @@
+// CppUnit Test framework
+#include "CppUTest/TestHarness.h"
+
+// Code under test
+#include "SimLoop.h"
+
+// support
+#include "Arduino.h"
+#include "Config.h"
+#include "LifeTesterTypes.h"
+#include "SimClock.h"
+#include "SimIo.h"
+#include "SimMCP4802.h"
+#include "SimMX7705.h"
+#include "SimPvDevice.h"
+#include "SimSpi.h"
+#include "SimTC77.h"
+#include <string.h>
+
+// An hour of virtual time - see the speed target in Simulation/Makefile for how long it takes
+#define SIM_TIME_MS             (3600000U)
+#define IDLE_TICK_MS            (1U)
+
+// Channel table in LifeTester.cpp
+extern LifeTester_t channels[SIM_MX7705_CHANNELS];
+
+static const SimPvParams_t dutParams = SIM_PV_IDEAL_DIODE;
+static SimPvDevice_t duts[SIM_MX7705_CHANNELS];
+
+static double GetDutCurrent(uint8_t channel)
+{
+    const double v = SimMCP4802_GetVoltage(channel);
+    return SimPv_MeasureCurrent(&duts[channel], v, SimClock_GetMicros() / 1.0E6);
+}
+
+static uint16_t ReadLightSensor(uint8_t pin)
+{
+    return 512U;
+}
+
+TEST_GROUP(SimLoopTestGroup)
+{
+    void setup(void)
+    {
+        const SimMX7705Config_t adcConfig = {
+            SIM_MX7705_MASTER_CLOCK,
+            SIM_MX7705_VREF,
+            0.8 * SIM_MX7705_VREF / dutParams.iL,
+            GetDutCurrent,
+            SimClock_GetMicros
+        };
+        for (uint8_t ch = 0U; ch < SIM_MX7705_CHANNELS; ch++)
+        {
+            SimPv_Init(&duts[ch], &dutParams, NULL, NULL, NULL);
+        }
+        SimClock_Reset();
+        SimIo_Reset();
+        SimIo_AttachAnalogInput(LIGHT_SENSOR_PIN, ReadLightSensor);
+        SimSpi_Reset();
+        SimMCP4802_Attach(DAC_CS_PIN);
+        SimMX7705_Reset(&adcConfig);
+        SimSpi_AttachDevice(ADC_CS_PIN, &simMX7705Device);
+        SimTC77_Attach(TEMP_CS_PIN);
+        SimSerial_SetOutput(NULL);
+    }
+};
+
+/*
+ Skipping idle time doesn't skip anything the firmware is waiting for. The whole
+ firmware runs for an hour of virtual time and is still tracking at the end.
+*/
+TEST(SimLoopTestGroup, HourOfTrackingReachesEndWithoutError)
+{
+    ::setup();
+    SimLoop_Run(loop, channels, SIM_MX7705_CHANNELS, SIM_TIME_MS, IDLE_TICK_MS);
+    CHECK(SimClock_GetMillis() >= SIM_TIME_MS);
+    // still tracking rather than stuck in an error
+    for (uint8_t ch = 0U; ch < SIM_MX7705_CHANNELS; ch++)
+    {
+        CHECK_EQUAL(ok, channels[ch].error);
+        CHECK(strcmp(channels[ch].state->label, "StateError") != 0);
+        CHECK(channels[ch].data.vThis > 0U);
+    }
+}
@@ -0,0 +1,236 @@
+// CppUnit Test framework
+#include "CppUTest/TestHarness.h"
+
+// Code under test
+#include "SimMX7705.h"
+
+// support
+#include "Arduino.h"       // millis - implemented here
+#include "MX7705.h"        // real driver talks to the emulator
+#include "MX7705Private.h" // register commands
+#include "SpiCommon.h"     // spi functions - implemented here
+#include <math.h>
+
+#define ADC_CS_PIN               (10U)
+#define TRANSIMPEDANCE           (2.0)    // V/A
+#define FULL_SCALE_CODE          (65536.0)
+#define ONE_MS                   (1000U)  // us
+
+// Period for the clock settings written by MX7705_Init - 25Hz at 1MHz
+#define CONVERSION_PERIOD_INIT   (40000U)
+
+static uint64_t timeNow;                         // us
+static double   inputCurrent[SIM_MX7705_CHANNELS]; // A
+static uint32_t transactions;                    // cs low to cs high
+static MX7705_t adc;                             // driver under test
+
+/*******************************************************************************
+ * Spi and timing functions used by the driver - routed to the emulator
+ ******************************************************************************/
+unsigned long millis(void)
+{
+    return (unsigned long)(timeNow / ONE_MS);
+}
+
+void InitChipSelectPin(const uint8_t pin)
+{
+}
+
+// Chip select setup and hold are the only time a transaction takes here
+void OpenSpiConnection(const SpiSettings_t *settings)
+{
+    timeNow += settings->chipSelectSetup;
+    transactions++;
+}
+
+uint8_t SpiTransferByte(const uint8_t transmit)
+{
+    return simMX7705Device.transfer(transmit);
+}
+
+void CloseSpiConnection(const SpiSettings_t *settings)
+{
+    timeNow += settings->chipSelectHold;
+}
+
+/*******************************************************************************
+ * Private function implementations for tests
+ ******************************************************************************/
+static double GetInputCurrent(uint8_t input)
+{
+    return inputCurrent[input];
+}
+
+static uint64_t GetTime(void)
+{
+    return timeNow;
+}
+
+static uint16_t ExpectedCode(double current, uint8_t gain)
+{
+    return (uint16_t)(current * TRANSIMPEDANCE * gain / SIM_MX7705_VREF
+                      * FULL_SCALE_CODE);
+}
+
+/*******************************************************************************
+ * Unit tests
+ ******************************************************************************/
+TEST_GROUP(SimMX7705TestGroup)
+{
+    void setup(void)
+    {
+        const SimMX7705Config_t config = {
+            SIM_MX7705_MASTER_CLOCK,
+            SIM_MX7705_VREF,
+            TRANSIMPEDANCE,
+            GetInputCurrent,
+            GetTime
+        };
+        timeNow = 0U;
+        transactions = 0U;
+        inputCurrent[0] = 0.25;
+        inputCurrent[1] = 0.5;
+        SimMX7705_Reset(&config);
+    }
+
+    void teardown(void)
+    {
+    }
+};
+
+// Driver initialisation writes and verifies the clock and setup registers.
+TEST(SimMX7705TestGroup, DriverInitialisesEmulatorOk)
+{
+    MX7705_Init(&adc, ADC_CS_PIN, 0U);
+
+    CHECK_FALSE(MX7705_GetError(&adc));
+    CHECK_EQUAL(MX7705_WRITE_CLOCK_SETTINGS, SimMX7705_GetClockReg());
+    CHECK_EQUAL(CONVERSION_PERIOD_INIT, SimMX7705_GetConversionPeriod());
+    CHECK_EQUAL(1U, SimMX7705_GetGain());
+}
+
+// Output data rate follows CLK, CLKDIV and FS bits and the master clock
+TEST(SimMX7705TestGroup, ConversionPeriodFollowsClockRegister)
+{
+    // power on default - CLK = 1, FS = 01: 60Hz at 2.4576MHz ie. 24.4Hz at 1MHz
+    CHECK_EQUAL(40960U, SimMX7705_GetConversionPeriod());
+
+    // request clock reg write then write CLK = 0, CLKDIV = 1, FS = 11
+    simMX7705Device.transfer(0x20U);
+    simMX7705Device.transfer(0x0BU);
+    CHECK_EQUAL(10000U, SimMX7705_GetConversionPeriod());
+}
+
+// Data is only ready once self calibration and filter settling have finished.
+TEST(SimMX7705TestGroup, ReadDataWaitsForCalibrationAndSettling)
+{
+    MX7705_Init(&adc, ADC_CS_PIN, 0U);
+    const uint16_t code = MX7705_ReadData(&adc, 0U);
+
+    CHECK_FALSE(MX7705_GetError(&adc));
+    CHECK_EQUAL(ExpectedCode(inputCurrent[0], 1U), code);
+    // self calibration then 3 conversions to settle
+    CHECK(timeNow >= 9U * CONVERSION_PERIOD_INIT);
+    CHECK(SimMX7705_GetStats()->busyPolls > 0U);
+    CHECK_EQUAL(1U, SimMX7705_GetStats()->dataReads);
+    CHECK_EQUAL(0U, SimMX7705_GetStats()->staleReads);
+}
+
+// Each register access is one transaction - a ready conversion takes a DRDY
+// poll and a data read.
+TEST(SimMX7705TestGroup, ReadDataWhenReadyTakesTwoTransactions)
+{
+    MX7705_Init(&adc, ADC_CS_PIN, 0U);
+    timeNow += 9U * CONVERSION_PERIOD_INIT;
+    transactions = 0U;
+
+    CHECK_EQUAL(ExpectedCode(inputCurrent[0], 1U), MX7705_ReadData(&adc, 0U));
+    CHECK_EQUAL(2U, transactions);
+    CHECK_EQUAL(1U, MX7705_GetPollCount(&adc));
+}
+
+// Code scales with the pga gain set through the driver
+TEST(SimMX7705TestGroup, SetGainScalesCode)
+{
+    MX7705_Init(&adc, ADC_CS_PIN, 0U);
+    (void)MX7705_ReadData(&adc, 0U);
+
+    MX7705_SetGain(&adc, 2U, 0U);
+    CHECK_EQUAL(2U, MX7705_GetGain(&adc, 0U));
+    CHECK_EQUAL(4U, SimMX7705_GetGain());
+    const uint16_t code = MX7705_ReadData(&adc, 0U);
+    CHECK_EQUAL(ExpectedCode(inputCurrent[0], 4U), code);
+}
+
+// Input beyond full scale clamps to the maximum code
+TEST(SimMX7705TestGroup, OverRangeInputClamps)
+{
+    inputCurrent[0] = 10.0;
+    MX7705_Init(&adc, ADC_CS_PIN, 0U);
+
+    CHECK_EQUAL(0xFFFFU, MX7705_ReadData(&adc, 0U));
+}
+
+/*
+ The filter isn't reset by a channel change so the first conversion after
+ switching is a mixture of both inputs. Full settling takes 3 periods.
+*/
+TEST(SimMX7705TestGroup, ChannelSwitchNeedsSettlingTime)
+{
+    MX7705_Init(&adc, ADC_CS_PIN, 0U);
+    const uint16_t codeCh0 = MX7705_ReadData(&adc, 0U);
+    const uint16_t codeCh1 = MX7705_ReadData(&adc, 1U);
+
+    CHECK_EQUAL(1U, SimMX7705_GetChannel());
+    CHECK(codeCh1 > codeCh0);
+    CHECK(codeCh1 < ExpectedCode(inputCurrent[1], 1U));
+
+    timeNow += 3U * CONVERSION_PERIOD_INIT;
+    CHECK_EQUAL(ExpectedCode(inputCurrent[1], 1U), MX7705_ReadData(&adc, 1U));
+}
+
+/*
+ Reading the data register sets DRDY until the next conversion completes. Bytes
+ go straight to the emulator here so that time only moves when the test says so.
+*/
+TEST(SimMX7705TestGroup, DataReadSetsDrdyUntilNextConversion)
+{
+    // FSYNC is set at power on - filter only runs after initialisation
+    CHECK(bitRead(SimMX7705_GetCommsReg(), DRDY_BIT));
+    MX7705_Init(&adc, ADC_CS_PIN, 0U);
+    timeNow += 9U * CONVERSION_PERIOD_INIT;
+    CHECK_FALSE(bitRead(SimMX7705_GetCommsReg(), DRDY_BIT));
+
+    // request data reg read on channel 0 then clock out 2 bytes
+    simMX7705Device.transfer(MX7705_REQUEST_DATA_READ_CH0);
+    simMX7705Device.transfer(0U);
+    simMX7705Device.transfer(0U);
+    CHECK(bitRead(SimMX7705_GetCommsReg(), DRDY_BIT));
+
+    timeNow += SimMX7705_GetConversionPeriod();
+    CHECK_FALSE(bitRead(SimMX7705_GetCommsReg(), DRDY_BIT));
+    CHECK_EQUAL(1U, SimMX7705_GetStats()->dataReads);
+    // calibration finished - back to normal mode
+    CHECK_EQUAL(0U, bitExtract(SimMX7705_GetSetupReg(), MODE_MASK, MODE_OFFSET));
+}
+
+// Time to ready counts down to the next DRDY edge and is 0 until data is read
+TEST(SimMX7705TestGroup, TimeToReadyIsTimeToNextDrdyEdge)
+{
+    CHECK_EQUAL(SIM_MX7705_NOT_CONVERTING, SimMX7705_GetTimeToReady());
+    MX7705_Init(&adc, ADC_CS_PIN, 0U);
+    const uint32_t tReady = SimMX7705_GetTimeToReady();
+    CHECK(tReady > 0U);
+    timeNow += tReady - 1U;
+    CHECK(bitRead(SimMX7705_GetCommsReg(), DRDY_BIT));
+    CHECK_EQUAL(1U, SimMX7705_GetTimeToReady());
+    timeNow += 1U;
+    CHECK_EQUAL(0U, SimMX7705_GetTimeToReady());
+    timeNow += ONE_MS;
+    CHECK_EQUAL(0U, SimMX7705_GetTimeToReady());
+
+    simMX7705Device.transfer(MX7705_REQUEST_DATA_READ_CH0);
+    simMX7705Device.transfer(0U);
+    simMX7705Device.transfer(0U);
+    CHECK_EQUAL(CONVERSION_PERIOD_INIT - ONE_MS, SimMX7705_GetTimeToReady());
+}
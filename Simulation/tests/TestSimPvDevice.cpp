@@ -0,0 +1,164 @@
+// CppUnit Test framework
+#include "CppUTest/TestHarness.h"
+
+// Code under test
+#include "SimPvDevice.h"
+
+// support
+#include <math.h>
+#include <stddef.h>
+
+#define IDEAL_DIODE_MPP_CODE    (58U)   // from diode.txt
+#define TOLERANCE               (1.0E-09)
+
+static const SimPvParams_t idealDiode = SIM_PV_IDEAL_DIODE;
+
+// Silicon cell with parasitic resistances and temperature dependence
+static const SimPvParams_t realCell = {
+    0.5,      // iL
+    1.0E-10,  // i0
+    1.3,      // n
+    0.2,      // rS
+    50.0,     // rSh
+    0.0005,   // alpha
+    SIM_PV_EG_SILICON,
+    25.0      // tRef
+};
+
+static const SimPvProfilePoint_t stepProfile[] = {
+    {0.0,  1.0},
+    {10.0, 1.0},
+    {20.0, 0.5}
+};
+
+static double StepIrradiance(double t)
+{
+    return SimPv_InterpolateProfile(stepProfile, 3U, t);
+}
+
+static double HotTemperature(double t)
+{
+    return 65.0;
+}
+
+static SimPvDevice_t device;
+
+TEST_GROUP(SimPvDeviceTestGroup)
+{
+    void setup(void)
+    {
+        SimPv_Init(&device, &idealDiode, NULL, NULL, NULL);
+    }
+
+    void teardown(void)
+    {
+    }
+};
+
+// With no resistances the current is given explicitly by the shockley equation
+TEST(SimPvDeviceTestGroup, IdealDiodeMatchesShockleyEquation)
+{
+    for (double v = 0.0; v < 0.6; v += 0.05)
+    {
+        const double expected = 1.0 - 1.0E-09 * (exp(v / 0.0259) - 1.0);
+        DOUBLES_EQUAL(expected, SimPv_GetCurrent(&device, v, 0.0), TOLERANCE);
+    }
+}
+
+// Mpp of the ideal diode is the same dac code as the unit test data
+TEST(SimPvDeviceTestGroup, IdealDiodeMppMatchesTestData)
+{
+    double vMpp;
+    (void)SimPv_GetMpp(&device, 0.0, &vMpp);
+    const double vCode = SimPv_DacCodeToVoltage(IDEAL_DIODE_MPP_CODE, 1U);
+    const double vStep = SimPv_DacCodeToVoltage(1U, 1U);
+    CHECK(fabs(vMpp - vCode) < vStep);
+}
+
+// Solution satisfies the implicit equation with series and shunt resistance
+TEST(SimPvDeviceTestGroup, CurrentSatisfiesSingleDiodeEquation)
+{
+    SimPv_Init(&device, &realCell, NULL, NULL, NULL);
+    const double nVt = realCell.n * SIM_PV_K_ON_Q * (25.0 + SIM_PV_KELVIN);
+    for (double v = -0.2; v < 0.8; v += 0.1)
+    {
+        const double i = SimPv_GetCurrent(&device, v, 0.0);
+        const double vD = v + i * realCell.rS;
+        const double expected = realCell.iL
+            - realCell.i0 * (exp(vD / nVt) - 1.0) - vD / realCell.rSh;
+        DOUBLES_EQUAL(expected, i, TOLERANCE);
+    }
+}
+
+// Current is zero at open circuit and the mpp lies between 0 and Voc
+TEST(SimPvDeviceTestGroup, VocAndMppConsistent)
+{
+    SimPv_Init(&device, &realCell, NULL, NULL, NULL);
+    const double voc = SimPv_GetVoc(&device, 0.0);
+    DOUBLES_EQUAL(0.0, SimPv_GetCurrent(&device, voc, 0.0), 1.0E-05);
+
+    double vMpp;
+    const double pMpp = SimPv_GetMpp(&device, 0.0, &vMpp);
+    CHECK((vMpp > 0.0) && (vMpp < voc));
+    CHECK(pMpp > (vMpp - 0.01) * SimPv_GetCurrent(&device, vMpp - 0.01, 0.0));
+    CHECK(pMpp > (vMpp + 0.01) * SimPv_GetCurrent(&device, vMpp + 0.01, 0.0));
+}
+
+// Heating raises photocurrent slightly but saturation current lowers Voc
+TEST(SimPvDeviceTestGroup, TemperatureLowersVoc)
+{
+    SimPv_Init(&device, &realCell, NULL, NULL, NULL);
+    const double vocCold = SimPv_GetVoc(&device, 0.0);
+    const double iscCold = SimPv_GetCurrent(&device, 0.0, 0.0);
+
+    SimPv_Init(&device, &realCell, NULL, HotTemperature, NULL);
+    CHECK(SimPv_GetVoc(&device, 0.0) < vocCold);
+    CHECK(SimPv_GetCurrent(&device, 0.0, 0.0) > iscCold);
+}
+
+// Photocurrent follows the irradiance profile
+TEST(SimPvDeviceTestGroup, IrradianceProfileScalesPhotocurrent)
+{
+    SimPv_Init(&device, &idealDiode, StepIrradiance, NULL, NULL);
+    DOUBLES_EQUAL(1.0, SimPv_GetCurrent(&device, 0.0, 5.0), TOLERANCE);
+    DOUBLES_EQUAL(0.75, SimPv_GetCurrent(&device, 0.0, 15.0), TOLERANCE);
+    DOUBLES_EQUAL(0.5, SimPv_GetCurrent(&device, 0.0, 100.0), TOLERANCE);
+}
+
+// Noise is zero mean with the requested standard deviation and repeatable
+TEST(SimPvDeviceTestGroup, MeasurementNoiseStatistics)
+{
+    const SimPvNoise_t noise = {0.0, 0.01, 1234U};
+    const uint16_t nSamples = 10000U;
+    const double i = SimPv_GetCurrent(&device, 0.3, 0.0);
+    SimPv_Init(&device, &idealDiode, NULL, NULL, &noise);
+    double sum = 0.0;
+    double sumSq = 0.0;
+    for (uint16_t k = 0U; k < nSamples; k++)
+    {
+        const double err = SimPv_MeasureCurrent(&device, 0.3, 0.0) - i;
+        sum += err;
+        sumSq += err * err;
+    }
+    const double mean = sum / nSamples;
+    const double sd = sqrt(sumSq / nSamples - mean * mean);
+    DOUBLES_EQUAL(0.0, mean, 0.0005);
+    DOUBLES_EQUAL(noise.current, sd, 0.0005);
+
+    SimPvDevice_t repeat;
+    SimPv_Init(&repeat, &idealDiode, NULL, NULL, &noise);
+    SimPv_Init(&device, &idealDiode, NULL, NULL, &noise);
+    DOUBLES_EQUAL(SimPv_MeasureCurrent(&device, 0.3, 0.0),
+                  SimPv_MeasureCurrent(&repeat, 0.3, 0.0), 0.0);
+}
+
+// Dac and adc mappings use the MCP4802 and MX7705 references
+TEST(SimPvDeviceTestGroup, DacAndAdcCodeMappings)
+{
+    DOUBLES_EQUAL(1.024, SimPv_DacCodeToVoltage(128U, 1U), TOLERANCE);
+    DOUBLES_EQUAL(2.048, SimPv_DacCodeToVoltage(128U, 2U), TOLERANCE);
+
+    CHECK_EQUAL(32768U, SimPv_CurrentToAdcCode(0.5, 2.5, 1U));
+    CHECK_EQUAL(0xFFFFU, SimPv_CurrentToAdcCode(0.5, 2.5, 2U));
+    CHECK_EQUAL(0U, SimPv_CurrentToAdcCode(-0.1, 2.5, 1U));
+}
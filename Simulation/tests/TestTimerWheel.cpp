@@ -0,0 +1,227 @@
+// CppUnit Test framework
+#include "CppUTest/TestHarness.h"
+
+// Code under test
+#include "TimerWheel.h"
+
+#include <stdint.h>
+
+#define MAX_FIRED   (8U)
+
+static TimerWheel_t wheel;
+static Timer_t      timerA;
+static Timer_t      timerB;
+static Timer_t      timerC;
+
+// Record of callbacks in the order they were made
+static uint8_t  nFired;
+static void     *firedContext[MAX_FIRED];
+static uint8_t  firedEvent[MAX_FIRED];
+static uint32_t firedTime[MAX_FIRED];
+
+static void RecordFired(void *context, uint8_t event)
+{
+    if (nFired < MAX_FIRED)
+    {
+        firedContext[nFired] = context;
+        firedEvent[nFired] = event;
+        firedTime[nFired] = TimerWheel_Now(&wheel);
+    }
+    nFired++;
+}
+
+// Restarts itself with no delay every time it fires
+static void RestartFired(void *context, uint8_t event)
+{
+    RecordFired(context, event);
+    TimerWheel_Start(&wheel, (Timer_t *)context, 0U, RestartFired, context, event);
+}
+
+// Stops timer B which is due at the same time
+static void StopOtherFired(void *context, uint8_t event)
+{
+    RecordFired(context, event);
+    TimerWheel_Stop(&wheel, &timerB);
+}
+
+TEST_GROUP(TimerWheelTestGroup)
+{
+    void setup(void)
+    {
+        TimerWheel_Init(&wheel, 0U);
+        timerA.running = false;
+        timerB.running = false;
+        timerC.running = false;
+        nFired = 0U;
+    }
+
+    void teardown(void)
+    {
+    }
+};
+
+// A one-shot fires once when it's due with the context and event it was given
+TEST(TimerWheelTestGroup, OneShotFiresOnceWhenDue)
+{
+    TimerWheel_Start(&wheel, &timerA, 10U, RecordFired, &timerB, 7U);
+    CHECK(TimerWheel_IsRunning(&timerA));
+    TimerWheel_Service(&wheel, 9U);
+    CHECK_EQUAL(0U, nFired);
+    TimerWheel_Service(&wheel, 10U);
+    CHECK_EQUAL(1U, nFired);
+    POINTERS_EQUAL(&timerB, firedContext[0]);
+    CHECK_EQUAL(7U, firedEvent[0]);
+    CHECK_EQUAL(10U, firedTime[0]);
+    CHECK(!TimerWheel_IsRunning(&timerA));
+    TimerWheel_Service(&wheel, 100U);
+    CHECK_EQUAL(1U, nFired);
+}
+
+/*
+ A periodic timer is re-armed from when it was due, not from when it was
+ serviced, so late servicing doesn't make it drift.
+*/
+TEST(TimerWheelTestGroup, PeriodicTimerDoesntDriftWhenServicedLate)
+{
+    TimerWheel_StartPeriodic(&wheel, &timerA, 10U, RecordFired, NULL, 1U);
+    TimerWheel_Service(&wheel, 13U);
+    CHECK_EQUAL(1U, nFired);
+    CHECK_EQUAL(7U, TimerWheel_TimeToNext(&wheel));
+    TimerWheel_Service(&wheel, 19U);
+    CHECK_EQUAL(1U, nFired);
+    TimerWheel_Service(&wheel, 20U);
+    CHECK_EQUAL(2U, nFired);
+    CHECK(TimerWheel_IsRunning(&timerA));
+}
+
+// Periods missed altogether are dropped rather than fired back to back
+TEST(TimerWheelTestGroup, PeriodicTimerDropsMissedPeriods)
+{
+    TimerWheel_StartPeriodic(&wheel, &timerA, 10U, RecordFired, NULL, 1U);
+    TimerWheel_Service(&wheel, 35U);
+    CHECK_EQUAL(1U, nFired);
+    CHECK_EQUAL(10U, TimerWheel_TimeToNext(&wheel));
+    TimerWheel_Service(&wheel, 44U);
+    CHECK_EQUAL(1U, nFired);
+    TimerWheel_Service(&wheel, 45U);
+    CHECK_EQUAL(2U, nFired);
+}
+
+TEST(TimerWheelTestGroup, StoppedTimerDoesntFire)
+{
+    TimerWheel_Start(&wheel, &timerA, 10U, RecordFired, NULL, 1U);
+    TimerWheel_StartPeriodic(&wheel, &timerB, 5U, RecordFired, NULL, 2U);
+    TimerWheel_Stop(&wheel, &timerA);
+    TimerWheel_Stop(&wheel, &timerB);
+    CHECK(!TimerWheel_IsRunning(&timerA));
+    CHECK(!TimerWheel_IsRunning(&timerB));
+    TimerWheel_Service(&wheel, 50U);
+    CHECK_EQUAL(0U, nFired);
+    // stopping again does nothing
+    TimerWheel_Stop(&wheel, &timerA);
+    CHECK_EQUAL(TIMER_WHEEL_IDLE, TimerWheel_TimeToNext(&wheel));
+}
+
+// Starting a running timer moves it rather than adding a second firing
+TEST(TimerWheelTestGroup, RestartingTimerMovesDueTime)
+{
+    TimerWheel_Start(&wheel, &timerA, 10U, RecordFired, NULL, 1U);
+    TimerWheel_Service(&wheel, 5U);
+    TimerWheel_Start(&wheel, &timerA, 10U, RecordFired, NULL, 2U);
+    TimerWheel_Service(&wheel, 10U);
+    CHECK_EQUAL(0U, nFired);
+    TimerWheel_Service(&wheel, 15U);
+    CHECK_EQUAL(1U, nFired);
+    CHECK_EQUAL(2U, firedEvent[0]);
+}
+
+// Timers a whole turn of the wheel apart share a slot. Only the due one fires.
+TEST(TimerWheelTestGroup, TimersSharingSlotFireWhenEachIsDue)
+{
+    TimerWheel_Start(&wheel, &timerA, 5U, RecordFired, &timerA, 1U);
+    TimerWheel_Start(&wheel, &timerB, 5U + TIMER_WHEEL_SLOTS, RecordFired, &timerB, 2U);
+    TimerWheel_Service(&wheel, 5U);
+    CHECK_EQUAL(1U, nFired);
+    POINTERS_EQUAL(&timerA, firedContext[0]);
+    TimerWheel_Service(&wheel, 5U + TIMER_WHEEL_SLOTS);
+    CHECK_EQUAL(2U, nFired);
+    POINTERS_EQUAL(&timerB, firedContext[1]);
+}
+
+// A gap longer than the wheel fires everything due in it
+TEST(TimerWheelTestGroup, LongGapFiresAllTimersDue)
+{
+    TimerWheel_Start(&wheel, &timerA, 3U, RecordFired, &timerA, 1U);
+    TimerWheel_Start(&wheel, &timerB, 40U, RecordFired, &timerB, 2U);
+    TimerWheel_Start(&wheel, &timerC, 100U, RecordFired, &timerC, 3U);
+    TimerWheel_Service(&wheel, 50U);
+    CHECK_EQUAL(2U, nFired);
+    CHECK(!TimerWheel_IsRunning(&timerA));
+    CHECK(!TimerWheel_IsRunning(&timerB));
+    CHECK(TimerWheel_IsRunning(&timerC));
+    CHECK_EQUAL(50U, TimerWheel_TimeToNext(&wheel));
+}
+
+// Timers due at the same time fire in the order they were started
+TEST(TimerWheelTestGroup, TimersDueTogetherFireInStartOrder)
+{
+    TimerWheel_Start(&wheel, &timerA, 8U, RecordFired, &timerA, 1U);
+    TimerWheel_Start(&wheel, &timerB, 8U, RecordFired, &timerB, 2U);
+    TimerWheel_Service(&wheel, 8U);
+    CHECK_EQUAL(2U, nFired);
+    CHECK_EQUAL(1U, firedEvent[0]);
+    CHECK_EQUAL(2U, firedEvent[1]);
+}
+
+// A callback can stop another timer that's due in the same service
+TEST(TimerWheelTestGroup, CallbackCanStopTimerDueAtSameTime)
+{
+    TimerWheel_Start(&wheel, &timerA, 8U, StopOtherFired, &timerA, 1U);
+    TimerWheel_Start(&wheel, &timerB, 8U, RecordFired, &timerB, 2U);
+    TimerWheel_Service(&wheel, 8U);
+    CHECK_EQUAL(1U, nFired);
+    CHECK(!TimerWheel_IsRunning(&timerB));
+}
+
+/*
+ A timer restarted from its own callback with no delay waits for the next
+ service rather than firing again straight away.
+*/
+TEST(TimerWheelTestGroup, ZeroDelayRestartFiresOnNextService)
+{
+    TimerWheel_Start(&wheel, &timerA, 0U, RestartFired, &timerA, 1U);
+    TimerWheel_Service(&wheel, 0U);
+    CHECK_EQUAL(0U, nFired);
+    TimerWheel_Service(&wheel, 1U);
+    CHECK_EQUAL(1U, nFired);
+    TimerWheel_Service(&wheel, 1U);
+    CHECK_EQUAL(1U, nFired);
+    TimerWheel_Service(&wheel, 2U);
+    CHECK_EQUAL(2U, nFired);
+}
+
+// Time to the next timer is from the last service and 0 once it's overdue
+TEST(TimerWheelTestGroup, TimeToNextFromLastService)
+{
+    CHECK_EQUAL(TIMER_WHEEL_IDLE, TimerWheel_TimeToNext(&wheel));
+    TimerWheel_Start(&wheel, &timerA, 30U, RecordFired, NULL, 1U);
+    TimerWheel_Start(&wheel, &timerB, 12U, RecordFired, NULL, 2U);
+    CHECK_EQUAL(12U, TimerWheel_TimeToNext(&wheel));
+    TimerWheel_Service(&wheel, 20U);
+    CHECK_EQUAL(10U, TimerWheel_TimeToNext(&wheel));
+    wheel.now = 35U;  // as if time moved on without a service
+    CHECK_EQUAL(0U, TimerWheel_TimeToNext(&wheel));
+}
+
+// Due times are compared as differences so timers keep working as millis wraps
+TEST(TimerWheelTestGroup, TimersFireAcrossMillisWrap)
+{
+    TimerWheel_Init(&wheel, 0xFFFFFFF0UL);
+    TimerWheel_Start(&wheel, &timerA, 0x20U, RecordFired, NULL, 1U);
+    TimerWheel_Service(&wheel, 0xFFFFFFFFUL);
+    CHECK_EQUAL(0U, nFired);
+    TimerWheel_Service(&wheel, 0x0FU);
+    CHECK_EQUAL(0U, nFired);
+    TimerWheel_Service(&wheel, 0x10U);
+    CHECK_EQUAL(1U, nFired);
+}
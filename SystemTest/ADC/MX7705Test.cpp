@@ -11,6 +11,7 @@
 
 const uint8_t AdcCsPin = ADC_CS_PIN;
 const uint8_t LedPin = LED_A_PIN;
+static MX7705_t adc;
 
 void setup()
 { 
@@ -19,16 +20,16 @@ void setup()
     SPI.begin();
     Serial.print("Initialising ADC on pin ");
     Serial.println(AdcCsPin);
-    MX7705_Init(AdcCsPin, 0U);
-    MX7705_Init(AdcCsPin, 1U);
+    MX7705_Init(&adc, AdcCsPin, 0U);
+    MX7705_Init(&adc, AdcCsPin, 1U);
     Serial.println("Done");
 
     
     Serial.print("getting gain...");
-    Serial.println(MX7705_GetGain(0U));
+    Serial.println(MX7705_GetGain(&adc, 0U));
     
     // Serial.println("setting gain...");
-    // MX7705_SetGain(0U, 0U);
+    // MX7705_SetGain(&adc, 0U, 0U);
     
     // Initialising LED for error condition
     pinMode(LedPin, OUTPUT);
@@ -38,10 +39,10 @@ void setup()
 
 void loop()
 {
-    const uint16_t adcDataCh0 = MX7705_ReadData(0U);
-    const uint16_t adcDataCh1 = MX7705_ReadData(1U);
+    const uint16_t adcDataCh0 = MX7705_ReadData(&adc, 0U);
+    const uint16_t adcDataCh1 = MX7705_ReadData(&adc, 1U);
 
-    if (MX7705_GetError())
+    if (MX7705_GetError(&adc))
     {
         digitalWrite(LedPin, HIGH);
     }
@@ -19,6 +19,8 @@ typedef struct mockDacState_s {
     dacChannel_t chB;          // channel B output
 } dacState_t;
 
+static MCP4802_t mcp4802;
+
 static void PrintDacStatus(dacState_t *dac)
 {
     const float voltageA = (float)dac->chA.output * V_REF / (float)DAC_MAX_CODE;
@@ -38,7 +40,7 @@ void setup()
 {
     Serial.begin(9600);
     SpiBegin();
-    MCP4802_Init(DAC_CS_PIN);
+    MCP4802_Init(&mcp4802, DAC_CS_PIN);
     Serial.println("shdn(A/B)     gain  code(A/B) voltage(A/B)");
 }
 
@@ -53,8 +55,8 @@ void loop()
     };
     static uint16_t counter = 0U;
 
-    MCP4802_Output(dacACode, chASelect);
-    MCP4802_Output(dacBCode, chBSelect);
+    MCP4802_Output(&mcp4802, dacACode, chASelect);
+    MCP4802_Output(&mcp4802, dacBCode, chBSelect);
 
 
     dac.chA.output = dacACode;
@@ -1,17 +1,22 @@
 #include "Arduino.h"
 #include "Config.h"
 #include "LedFlash.h"
+#include "TimerWheel.h"
 
-Flasher LedA(LED_A_PIN);
-Flasher LedB(LED_B_PIN);
+static TimerWheel_t timers;
+
+Flasher LedA(LED_A_PIN, &timers);
+Flasher LedB(LED_B_PIN, &timers);
 
 void setup()
 {
+ TimerWheel_Init(&timers, millis());
  LedA.t(100, 100);
+ LedA.keepFlashing();
+ LedB.keepFlashing();
 }
 
 void loop()
 {
-	LedA.update();
-	LedB.update();
+	TimerWheel_Service(&timers, millis());
 }
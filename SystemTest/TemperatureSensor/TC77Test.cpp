@@ -2,18 +2,24 @@
 #include "Config.h"
 #include "Print.h"
 #include "TC77.h"
+#include "TimerWheel.h"
+
+static TC77_t tc77;
+static TimerWheel_t timers;
 
 void setup()
 {
   // put your setup code here, to run once:
   Serial.begin(9600);
-  TC77_Init(TEMP_CS_PIN);
+  TimerWheel_Init(&timers, millis());
+  TC77_Init(&tc77, TEMP_CS_PIN, &timers);
 }
 
 void loop()
 {
-  TC77_Update();
-  uint16_t rawData = TC77_GetRawData();
+  // sensor is read by its timer
+  TimerWheel_Service(&timers, millis());
+  uint16_t rawData = TC77_GetRawData(&tc77);
   Serial.println(rawData);
   Serial.println(TC77_ConvertToTemp(rawData));
   delay(1000);